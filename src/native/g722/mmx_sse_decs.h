@@ -24,6 +24,7 @@
  *
  * $Id: mmx_sse_decs.h,v 1.1 2009/07/12 09:23:09 steveu Exp $
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 
 #if !defined(_MMX_SSE_DECS_H_)
 #define _MMX_SSE_DECS_H_
@@ -55,6 +56,9 @@
 #if defined(SPANDSP_USE_SSE5)
 #include <bmmintrin.h>
 #endif
+#if defined(SPANDSP_USE_NEON)
+#include <arm_neon.h>
+#endif
 
 #endif
 
@@ -24,6 +24,7 @@
  *
  * $Id: vector_int.c,v 1.26.4.1 2009/12/28 11:54:59 steveu Exp $
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 
 /*! \file */
 
@@ -249,6 +250,35 @@ SPAN_DECLARE(int32_t) vec_dot_prodi16(const int16_t x[], const int16_t y[], int
         : "S" (x), "D" (y), "a" (n)
         : "cc"
     );
+#elif defined(SPANDSP_USE_NEON)
+    int32x4_t sum;
+    int i;
+
+    sum = vdupq_n_s32(0);
+    for (i = 0;  i + 8 <= n;  i += 8)
+    {
+        int16x8_t a = vld1q_s16(&x[i]);
+        int16x8_t b = vld1q_s16(&y[i]);
+
+        sum = vmlal_s16(sum, vget_low_s16(a), vget_low_s16(b));
+        sum = vmlal_s16(sum, vget_high_s16(a), vget_high_s16(b));
+    }
+    if (i + 4 <= n)
+    {
+        sum = vmlal_s16(sum, vld1_s16(&x[i]), vld1_s16(&y[i]));
+        i += 4;
+    }
+#if defined(__aarch64__)
+    z = vaddvq_s32(sum);
+#else
+    {
+        int32x2_t pair = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+
+        z = vget_lane_s32(vpadd_s32(pair, pair), 0);
+    }
+#endif
+    for (  ;  i < n;  i++)
+        z += (int32_t) x[i]*(int32_t) y[i];
 #else
     int i;
 
@@ -0,0 +1,189 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+#ifndef audio_io_health_h
+#define audio_io_health_h
+
+#include <stdint.h>
+
+/**
+ * The IO health of a native audio stream: how regularly and how quickly its
+ * device callbacks (or reads and writes) run compared with the buffer period,
+ * and how often data is lost. Written with relaxed atomics from the IO
+ * threads and copied as a whole into a Java long[] by the audio backends.
+ *
+ * The times are taken by the callers from the clock of their backend and
+ * passed in nanoseconds.
+ */
+
+/** The number of log2 microsecond buckets of the jitter histogram. */
+#define AUDIO_IO_HEALTH_BUCKETS 16
+
+/** The indexes of the values in a snapshot. */
+enum
+{
+    AUDIO_IO_HEALTH_CALLBACKS = 0,
+    AUDIO_IO_HEALTH_PERIOD_MICROS,
+    AUDIO_IO_HEALTH_JITTER_MAX_MICROS,
+    AUDIO_IO_HEALTH_DURATION_SUM_MICROS,
+    AUDIO_IO_HEALTH_DURATION_MAX_MICROS,
+    AUDIO_IO_HEALTH_DEADLINE_MISSES,
+    AUDIO_IO_HEALTH_UNDERRUNS,
+    AUDIO_IO_HEALTH_OVERRUNS,
+    AUDIO_IO_HEALTH_TRYLOCK_SKIPS,
+    AUDIO_IO_HEALTH_CONVERSION_SUM_MICROS,
+    AUDIO_IO_HEALTH_CONVERSION_MAX_MICROS,
+    AUDIO_IO_HEALTH_JITTER_BUCKETS,
+    AUDIO_IO_HEALTH_LENGTH
+        = AUDIO_IO_HEALTH_JITTER_BUCKETS + AUDIO_IO_HEALTH_BUCKETS
+};
+
+typedef struct
+{
+    uint64_t values[AUDIO_IO_HEALTH_LENGTH];
+    /* The start of the previous callback, not part of a snapshot. */
+    uint64_t lastCallbackNanos;
+} AudioIOHealth;
+
+static inline void
+AudioIOHealth_add(AudioIOHealth *health, int index, uint64_t value)
+{
+    __atomic_fetch_add(health->values + index, value, __ATOMIC_RELAXED);
+}
+
+static inline void
+AudioIOHealth_max(AudioIOHealth *health, int index, uint64_t value)
+{
+    uint64_t max = __atomic_load_n(health->values + index, __ATOMIC_RELAXED);
+
+    while(value > max
+            && !__atomic_compare_exchange_n(
+                    health->values + index,
+                    &max,
+                    value,
+                    1,
+                    __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED))
+        ;
+}
+
+/**
+ * Records the start of a callback: its interval since the previous one is
+ * compared with the buffer period and the deviation is added to the jitter
+ * histogram. An interval of more than twice the period is a deadline miss.
+ *
+ * @param nowNanos The start of the callback.
+ * @param periodNanos The duration of the audio exchanged by the callback.
+ */
+static inline void
+AudioIOHealth_beginCallback(
+        AudioIOHealth *health,
+        uint64_t nowNanos,
+        uint64_t periodNanos)
+{
+    uint64_t lastNanos = health->lastCallbackNanos;
+
+    health->lastCallbackNanos = nowNanos;
+    AudioIOHealth_add(health, AUDIO_IO_HEALTH_CALLBACKS, 1);
+    __atomic_store_n(
+            health->values + AUDIO_IO_HEALTH_PERIOD_MICROS,
+            periodNanos / 1000,
+            __ATOMIC_RELAXED);
+
+    if(lastNanos != 0 && nowNanos > lastNanos && periodNanos != 0)
+    {
+        uint64_t intervalNanos = nowNanos - lastNanos;
+        uint64_t jitterMicros
+            = ((intervalNanos > periodNanos)
+                    ? (intervalNanos - periodNanos)
+                    : (periodNanos - intervalNanos))
+                / 1000;
+        int bucket = 0;
+
+        while((jitterMicros >> (bucket + 1)) != 0
+                && bucket < AUDIO_IO_HEALTH_BUCKETS - 1)
+        {
+            ++bucket;
+        }
+        AudioIOHealth_add(
+                health,
+                AUDIO_IO_HEALTH_JITTER_BUCKETS + bucket,
+                1);
+        AudioIOHealth_max(
+                health,
+                AUDIO_IO_HEALTH_JITTER_MAX_MICROS,
+                jitterMicros);
+        if(intervalNanos > 2 * periodNanos)
+        {
+            AudioIOHealth_add(health, AUDIO_IO_HEALTH_DEADLINE_MISSES, 1);
+        }
+    }
+}
+
+/**
+ * Records the end of a callback. A callback which runs for longer than the
+ * buffer period is a deadline miss.
+ */
+static inline void
+AudioIOHealth_endCallback(
+        AudioIOHealth *health,
+        uint64_t startNanos,
+        uint64_t endNanos,
+        uint64_t periodNanos)
+{
+    uint64_t durationNanos = (endNanos > startNanos) ? (endNanos - startNanos) : 0;
+
+    AudioIOHealth_add(
+            health,
+            AUDIO_IO_HEALTH_DURATION_SUM_MICROS,
+            durationNanos / 1000);
+    AudioIOHealth_max(
+            health,
+            AUDIO_IO_HEALTH_DURATION_MAX_MICROS,
+            durationNanos / 1000);
+    if(periodNanos != 0 && durationNanos > periodNanos)
+    {
+        AudioIOHealth_add(health, AUDIO_IO_HEALTH_DEADLINE_MISSES, 1);
+    }
+}
+
+/** Records the time spent converting samples. */
+static inline void
+AudioIOHealth_addConversion(AudioIOHealth *health, uint64_t nanos)
+{
+    AudioIOHealth_add(
+            health,
+            AUDIO_IO_HEALTH_CONVERSION_SUM_MICROS,
+            nanos / 1000);
+    AudioIOHealth_max(
+            health,
+            AUDIO_IO_HEALTH_CONVERSION_MAX_MICROS,
+            nanos / 1000);
+}
+
+/**
+ * Copies the values of a specific AudioIOHealth.
+ *
+ * @return The number of values copied.
+ */
+static inline int
+AudioIOHealth_snapshot(AudioIOHealth *health, int64_t *values, int length)
+{
+    int i;
+
+    if(length > AUDIO_IO_HEALTH_LENGTH)
+    {
+        length = AUDIO_IO_HEALTH_LENGTH;
+    }
+    for(i = 0; i < length; ++i)
+    {
+        values[i] = __atomic_load_n(health->values + i, __ATOMIC_RELAXED);
+    }
+    return length;
+}
+
+#endif
@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 
 #include "JAWTRenderer.h"
 
@@ -14,6 +15,14 @@
 #include <string.h>
 #include <X11/extensions/Xvlib.h>
 
+/**
+ * The number of frames which may be coalesced into a frame that is still
+ * waiting to be painted before a paint is requested again, in case the
+ * request which is pending has been lost e.g. because the component was not
+ * showing.
+ */
+#define JAWT_RENDERER_MAX_COALESCED_FRAMES 15
+
 typedef struct _JAWTRenderer
 {
     Display *display;
@@ -30,6 +39,12 @@ typedef struct _JAWTRenderer
     int dataOffsets[3];
     int dataPitches[3];
     jint dataWidth;
+
+    /**
+     * The number of frames processed since the last one to be painted was
+     * turned into the image.
+     */
+    int coalescedFrames;
 }
 JAWTRenderer;
 
@@ -37,6 +52,7 @@ static XvImage *_JAWTRenderer_createImage(JAWTRenderer *renderer);
 static int _JAWTRenderer_freeImage(JAWTRenderer *renderer);
 static XvPortID _JAWTRenderer_grabPort
     (JAWTRenderer *renderer, JAWT_X11DrawingSurfaceInfo *x11dsi);
+static void _JAWTRenderer_setSyncToVBlank(Display *display, XvPortID port);
 static int _JAWTRenderer_ungrabPort(JAWTRenderer *renderer);
 
 void
@@ -78,6 +94,8 @@ JAWTRenderer_open(JNIEnv *jniEnv, jclass clazz, jobject component)
                 renderer->dataHeight = 0;
                 renderer->dataLength = 0;
                 renderer->dataWidth = 0;
+
+                renderer->coalescedFrames = 0;
             }
         }
         else
@@ -161,6 +179,11 @@ JAWTRenderer_paint
     return JNI_TRUE;
 }
 
+/*
+ * Returns JNI_FALSE without an error if the frame has been coalesced into one
+ * which is still waiting to be painted, so that a paint is requested once per
+ * frame which is actually presented rather than once per frame received.
+ */
 jboolean
 JAWTRenderer_process
     (JNIEnv *jniEnv, jclass clazz,
@@ -173,8 +196,15 @@ JAWTRenderer_process
         JAWTRenderer *renderer;
         char *rendererData;
         jint dataLength;
+        jboolean paintIsPending;
 
         renderer = (JAWTRenderer *) (intptr_t) handle;
+        paintIsPending
+            = (renderer->dataLength
+                    && (renderer->coalescedFrames
+                            < JAWT_RENDERER_MAX_COALESCED_FRAMES))
+                ? JNI_TRUE
+                : JNI_FALSE;
         rendererData = renderer->data;
         dataLength = sizeof(jint) * length;
         if (!rendererData || (renderer->dataCapacity < dataLength))
@@ -277,6 +307,12 @@ JAWTRenderer_process
                 dataOffsets[2] = offsetU + pitchUV * height / 2;
             }
             renderer->dataLength = dataLength;
+            if (JNI_TRUE == paintIsPending)
+            {
+                renderer->coalescedFrames++;
+                return JNI_FALSE;
+            }
+            renderer->coalescedFrames = 0;
         }
         else
             return JNI_FALSE;
@@ -489,6 +525,7 @@ _JAWTRenderer_createImage(JAWTRenderer *renderer)
              * again.
              */
             renderer->dataLength = 0;
+            renderer->coalescedFrames = 0;
         }
     }
     renderer->image = image;
@@ -606,6 +643,7 @@ _JAWTRenderer_grabPort
                             {
                                 grabbedPort = port;
                                 renderer->imageFormatID = imageFormat->id;
+                                _JAWTRenderer_setSyncToVBlank(display, port);
                             }
                             break;
                         }
@@ -624,6 +662,50 @@ _JAWTRenderer_grabPort
     return grabbedPort;
 }
 
+/*
+ * Makes XvPutImage on a specific port wait for the vertical blank where the
+ * adaptor supports it so that frames are not torn and no paint is wasted on a
+ * frame which is replaced before it is scanned out.
+ */
+static void
+_JAWTRenderer_setSyncToVBlank(Display *display, XvPortID port)
+{
+    XvAttribute *attributes;
+    int attributeCount;
+
+    attributes = XvQueryPortAttributes(display, port, &attributeCount);
+    if (attributes)
+    {
+        int attributeIndex;
+
+        for (attributeIndex = 0;
+                attributeIndex < attributeCount;
+                attributeIndex++)
+        {
+            XvAttribute *attribute;
+
+            attribute = attributes + attributeIndex;
+            if ((attribute->flags & XvSettable)
+                    && !strcmp(attribute->name, "XV_SYNC_TO_VBLANK"))
+            {
+                Atom atom;
+
+                atom = XInternAtom(display, attribute->name, True);
+                if (None != atom)
+                {
+                    XvSetPortAttribute(
+                        display,
+                        port,
+                        atom,
+                        (1 > attribute->max_value) ? attribute->max_value : 1);
+                }
+                break;
+            }
+        }
+        XFree(attributes);
+    }
+}
+
 static int
 _JAWTRenderer_ungrabPort(JAWTRenderer *renderer)
 {
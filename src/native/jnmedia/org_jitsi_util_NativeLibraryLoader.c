@@ -0,0 +1,594 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_util_NativeLibraryLoader.h"
+
+#include <string.h>
+
+#include "../g722/net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIDecoder.h"
+#include "../g722/net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIEncoder.h"
+#include "../opus/org_jitsi_impl_neomedia_codec_audio_opus_Opus.h"
+#include "../pcm/org_jitsi_impl_neomedia_NativeArrayIOUtils.h"
+#include "../pcm/org_jitsi_impl_neomedia_protocol_NativePcmFifo.h"
+#include "../speex/net_java_sip_communicator_impl_neomedia_codec_audio_speex_Speex.h"
+
+#ifdef JNMEDIA_RTP
+#include "../rtp/org_jitsi_impl_neomedia_transport_NativeIoRing.h"
+#include "../rtp/org_jitsi_impl_neomedia_transport_NativePacer.h"
+#include "../rtp/org_jitsi_impl_neomedia_transport_NativePacketLogger.h"
+#include "../rtp/org_jitsi_impl_neomedia_transport_RetransmissionHistory.h"
+#endif /* #ifdef JNMEDIA_RTP */
+
+#ifdef JNMEDIA_RECORDING
+#include "../recording/org_jitsi_impl_neomedia_MultitrackRecorder.h"
+#endif /* #ifdef JNMEDIA_RECORDING */
+
+/**
+ * The combined jnmedia library which bundles the portable native libraries
+ * (jnopus, jng722, jnspeex, jnpcm and, on Linux, jnrtp and the multitrack
+ * recorder) into a single shared library.
+ * Rather than leaving the JVM to resolve each native method by looking up its
+ * Java_ symbol, the methods of a class are registered explicitly with
+ * RegisterNatives when the class is initialized, so the methods of the codecs
+ * which are never used are never bound.
+ */
+
+static JNINativeMethod JNMedia_OpusMethods[] =
+{
+    {
+        "decode",
+        "(J[BII[BIII)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decode
+    },
+    {
+        "decoder_create",
+        "(II)J",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decoder_1create
+    },
+    {
+        "decoder_destroy",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decoder_1destroy
+    },
+    {
+        "decoder_get_nb_samples",
+        "(J[BII)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decoder_1get_1nb_1samples
+    },
+    {
+        "decoder_get_size",
+        "(I)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decoder_1get_1size
+    },
+    {
+        "encode",
+        "(J[BII[BII)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encode
+    },
+    {
+        "encode_accumulated",
+        "(JJ[BIIII[BII)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encode_1accumulated
+    },
+    {
+        "encoder_create",
+        "(III)J",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1create
+    },
+    {
+        "encoder_destroy",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1destroy
+    },
+    {
+        "encoder_get_bandwidth",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1get_1bandwidth
+    },
+    {
+        "encoder_get_bitrate",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1get_1bitrate
+    },
+    {
+        "encoder_get_dtx",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1get_1dtx
+    },
+    {
+        "encoder_get_size",
+        "(I)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1get_1size
+    },
+    {
+        "encoder_get_vbr",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1get_1vbr
+    },
+    {
+        "encoder_get_vbr_constraint",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1get_1vbr_1constraint
+    },
+    {
+        "encoder_get_inband_fec",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1get_1inband_1fec
+    },
+    {
+        "encoder_set_bandwidth",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1bandwidth
+    },
+    {
+        "encoder_set_bitrate",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1bitrate
+    },
+    {
+        "encoder_set_complexity",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1complexity
+    },
+    {
+        "encoder_set_dtx",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1dtx
+    },
+    {
+        "encoder_set_force_channels",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1force_1channels
+    },
+    {
+        "encoder_set_inband_fec",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1inband_1fec
+    },
+    {
+        "encoder_set_max_bandwidth",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1max_1bandwidth
+    },
+    {
+        "encoder_set_packet_loss_perc",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1packet_1loss_1perc
+    },
+    {
+        "encoder_set_vbr",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1vbr
+    },
+    {
+        "encoder_set_vbr_constraint",
+        "(JI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1vbr_1constraint
+    },
+    {
+        "frame_accumulator_create",
+        "(I)J",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_frame_1accumulator_1create
+    },
+    {
+        "frame_accumulator_destroy",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_frame_1accumulator_1destroy
+    },
+    {
+        "packet_get_bandwidth",
+        "([BI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_packet_1get_1bandwidth
+    },
+    {
+        "packet_get_nb_channels",
+        "([BI)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_packet_1get_1nb_1channels
+    },
+    {
+        "packet_get_nb_frames",
+        "([BII)I",
+        Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_packet_1get_1nb_1frames
+    }
+};
+
+static JNINativeMethod JNMedia_g722DecoderMethods[] =
+{
+    {
+        "g722_decoder_close",
+        "(J)V",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIDecoder_g722_1decoder_1close
+    },
+    {
+        "g722_decoder_open",
+        "()J",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIDecoder_g722_1decoder_1open
+    },
+    {
+        "g722_decoder_process",
+        "(J[BI[BII)V",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIDecoder_g722_1decoder_1process
+    }
+};
+
+static JNINativeMethod JNMedia_g722EncoderMethods[] =
+{
+    {
+        "g722_encoder_close",
+        "(J)V",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIEncoder_g722_1encoder_1close
+    },
+    {
+        "g722_encoder_open",
+        "()J",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIEncoder_g722_1encoder_1open
+    },
+    {
+        "g722_encoder_process",
+        "(J[BI[BII)V",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_g722_JNIEncoder_g722_1encoder_1process
+    }
+};
+
+static JNINativeMethod JNMedia_SpeexMethods[] =
+{
+    {
+        "speex_lib_get_mode",
+        "(I)J",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_speex_Speex_speex_1lib_1get_1mode
+    },
+    {
+        "speex_resampler_destroy",
+        "(J)V",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_speex_Speex_speex_1resampler_1destroy
+    },
+    {
+        "speex_resampler_init",
+        "(IIIIJ)J",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_speex_Speex_speex_1resampler_1init
+    },
+    {
+        "speex_resampler_process_interleaved_int",
+        "(J[BII[BII)I",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_speex_Speex_speex_1resampler_1process_1interleaved_1int
+    },
+    {
+        "speex_resampler_set_rate",
+        "(JII)I",
+        Java_net_java_sip_communicator_impl_neomedia_codec_audio_speex_Speex_speex_1resampler_1set_1rate
+    }
+};
+
+static JNINativeMethod JNMedia_NativeArrayIOUtilsMethods[] =
+{
+    {
+        "int16SumOfSquares",
+        "([BII)J",
+        Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int16SumOfSquares
+    },
+    {
+        "int16ToInt32",
+        "([BI[III)V",
+        Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int16ToInt32
+    },
+    {
+        "int32Mix",
+        "([II[IIII)V",
+        Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int32Mix
+    },
+    {
+        "int32ToInt16",
+        "([II[BII)V",
+        Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int32ToInt16
+    }
+};
+
+static JNINativeMethod JNMedia_NativePcmFifoMethods[] =
+{
+    {
+        "create",
+        "(II)J",
+        Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_create
+    },
+    {
+        "destroy",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_destroy
+    },
+    {
+        "getFill",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_getFill
+    },
+    {
+        "getStats",
+        "(J[J)V",
+        Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_getStats
+    },
+    {
+        "read",
+        "(J[BII[J)I",
+        Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_read
+    },
+    {
+        "write",
+        "(J[BIII)I",
+        Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_write
+    }
+};
+
+#ifdef JNMEDIA_RTP
+static JNINativeMethod JNMedia_NativeIoRingMethods[] =
+{
+    {
+        "fileClose",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileClose
+    },
+    {
+        "fileFlush",
+        "(J)I",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileFlush
+    },
+    {
+        "fileOpen",
+        "(Ljava/lang/String;)J",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileOpen
+    },
+    {
+        "fileSeek",
+        "(JJ)I",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileSeek
+    },
+    {
+        "fileTell",
+        "(J)J",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileTell
+    },
+    {
+        "fileWrite",
+        "(J[BII)I",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileWrite
+    },
+    {
+        "isSupported",
+        "()Z",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_isSupported
+    },
+    {
+        "streamClose",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamClose
+    },
+    {
+        "streamGetStats",
+        "(J[J)V",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamGetStats
+    },
+    {
+        "streamOpen",
+        "(Ljava/net/Socket;)J",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamOpen
+    },
+    {
+        "streamReceiveBatch",
+        "(J[B[II)I",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamReceiveBatch
+    },
+    {
+        "streamSend",
+        "(J[BII)Z",
+        Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamSend
+    }
+};
+
+static JNINativeMethod JNMedia_NativePacerMethods[] =
+{
+    {
+        "closeStream",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_transport_NativePacer_closeStream
+    },
+    {
+        "enqueue",
+        "(J[BII[BI)Z",
+        Java_org_jitsi_impl_neomedia_transport_NativePacer_enqueue
+    },
+    {
+        "getStats",
+        "(J[J)V",
+        Java_org_jitsi_impl_neomedia_transport_NativePacer_getStats
+    },
+    {
+        "openStream",
+        "(Ljava/net/DatagramSocket;J)J",
+        Java_org_jitsi_impl_neomedia_transport_NativePacer_openStream
+    },
+    {
+        "setBitrate",
+        "(JJ)V",
+        Java_org_jitsi_impl_neomedia_transport_NativePacer_setBitrate
+    }
+};
+
+static JNINativeMethod JNMedia_NativePacketLoggerMethods[] =
+{
+    {
+        "capture",
+        "([BII[BI[BIZ)Z",
+        Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_capture
+    },
+    {
+        "getStats",
+        "([J)V",
+        Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_getStats
+    },
+    {
+        "start",
+        "(Ljava/lang/String;JII)Z",
+        Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_start
+    },
+    {
+        "stop",
+        "()V",
+        Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_stop
+    }
+};
+
+static JNINativeMethod JNMedia_RetransmissionHistoryMethods[] =
+{
+    {
+        "create",
+        "(Ljava/net/DatagramSocket;I)J",
+        Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_create
+    },
+    {
+        "destroy",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_destroy
+    },
+    {
+        "getStats",
+        "(J[J)V",
+        Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_getStats
+    },
+    {
+        "handleRtcp",
+        "(JJ[BII)I",
+        Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_handleRtcp
+    },
+    {
+        "store",
+        "(J[BII[BI)V",
+        Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_store
+    }
+};
+#endif /* #ifdef JNMEDIA_RTP */
+
+#ifdef JNMEDIA_RECORDING
+static JNINativeMethod JNMedia_MultitrackRecorderMethods[] =
+{
+    {
+        "addTrack",
+        "(JILjava/lang/String;JIII)J",
+        Java_org_jitsi_impl_neomedia_MultitrackRecorder_addTrack
+    },
+    {
+        "close",
+        "(J)V",
+        Java_org_jitsi_impl_neomedia_MultitrackRecorder_close
+    },
+    {
+        "open",
+        "(Ljava/lang/String;)J",
+        Java_org_jitsi_impl_neomedia_MultitrackRecorder_open
+    },
+    {
+        "write",
+        "(J[BII)Z",
+        Java_org_jitsi_impl_neomedia_MultitrackRecorder_write
+    }
+};
+#endif /* #ifdef JNMEDIA_RECORDING */
+
+#define JNMEDIA_CLASS(className, methods) \
+    { className, methods, sizeof(methods) / sizeof(JNINativeMethod) }
+
+/** The native methods of a class bundled into jnmedia. */
+typedef struct
+{
+    /** The binary name of the class with slashes for dots. */
+    const char *className;
+    JNINativeMethod *methods;
+    jint methodCount;
+} JNMedia_Class;
+
+static const JNMedia_Class JNMedia_classes[] =
+{
+    /* jng722 */
+    JNMEDIA_CLASS(
+            "net/java/sip/communicator/impl/neomedia/codec/audio/g722/JNIDecoder",
+            JNMedia_g722DecoderMethods),
+    JNMEDIA_CLASS(
+            "net/java/sip/communicator/impl/neomedia/codec/audio/g722/JNIEncoder",
+            JNMedia_g722EncoderMethods),
+    /* jnspeex */
+    JNMEDIA_CLASS(
+            "net/java/sip/communicator/impl/neomedia/codec/audio/speex/Speex",
+            JNMedia_SpeexMethods),
+    /* jnopus */
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/codec/audio/opus/Opus",
+            JNMedia_OpusMethods),
+    /* jnpcm */
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/NativeArrayIOUtils",
+            JNMedia_NativeArrayIOUtilsMethods),
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/protocol/NativePcmFifo",
+            JNMedia_NativePcmFifoMethods),
+#ifdef JNMEDIA_RTP
+    /* jnrtp */
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/transport/NativeIoRing",
+            JNMedia_NativeIoRingMethods),
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/transport/NativePacer",
+            JNMedia_NativePacerMethods),
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/transport/NativePacketLogger",
+            JNMedia_NativePacketLoggerMethods),
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/transport/RetransmissionHistory",
+            JNMedia_RetransmissionHistoryMethods),
+#endif /* #ifdef JNMEDIA_RTP */
+#ifdef JNMEDIA_RECORDING
+    /* recording */
+    JNMEDIA_CLASS(
+            "org/jitsi/impl/neomedia/MultitrackRecorder",
+            JNMedia_MultitrackRecorderMethods),
+#endif /* #ifdef JNMEDIA_RECORDING */
+};
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_util_NativeLibraryLoader_registerNatives
+    (JNIEnv *env, jclass clazz, jclass nativeClass, jstring className)
+{
+    const char *className_;
+    size_t i;
+    jboolean registered = JNI_FALSE;
+
+    className_ = (*env)->GetStringUTFChars(env, className, NULL);
+    if (!className_)
+        return JNI_FALSE; /* An OutOfMemoryError has been thrown. */
+
+    for (i = 0; i < sizeof(JNMedia_classes) / sizeof(JNMedia_Class); i++)
+    {
+        const JNMedia_Class *c = JNMedia_classes + i;
+
+        if (strcmp(c->className, className_) == 0)
+        {
+            /*
+             * A failure leaves a NoSuchMethodError pending which is thrown in
+             * Java as the failure to load the library would have been.
+             */
+            registered
+                = ((*env)->RegisterNatives(
+                            env,
+                            nativeClass,
+                            c->methods,
+                            c->methodCount)
+                        == JNI_OK)
+                    ? JNI_TRUE
+                    : JNI_FALSE;
+            break;
+        }
+    }
+    (*env)->ReleaseStringUTFChars(env, className, className_);
+    return registered;
+}
@@ -0,0 +1,21 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_util_NativeLibraryLoader */
+
+#ifndef _Included_org_jitsi_util_NativeLibraryLoader
+#define _Included_org_jitsi_util_NativeLibraryLoader
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_util_NativeLibraryLoader
+ * Method:    registerNatives
+ * Signature: (Ljava/lang/Class;Ljava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_util_NativeLibraryLoader_registerNatives
+  (JNIEnv *, jclass, jclass, jstring);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,309 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcm_convert.h"
+#include "telephony.h"
+#include "vector_int.h"
+
+/*
+ * kernel_test checks the SIMD kernels of jnpcm and of the G.722 codec against
+ * scalar references written here, i.e. the NEON kernels when it is built for
+ * aarch64 and run under qemu-aarch64 ('ant test-kernels-arm64') and the SSE2
+ * kernels when it is built for the host ('ant test-kernels'). Every count up
+ * to a few SIMD blocks is tried so that the tails of odd lengths are covered,
+ * at unaligned addresses, with random samples and with the extremes which
+ * saturate. It prints the first mismatch of each kernel and exits with 1 if
+ * there is any.
+ */
+
+/* The largest count tried, a few blocks of 8 samples and an odd tail. */
+#define KERNEL_TEST_MAX_COUNT 67
+
+/* The number of random fills tried per count. */
+#define KERNEL_TEST_ROUNDS 16
+
+/* The byte offset of the arrays, so that the loads are unaligned. */
+#define KERNEL_TEST_MISALIGN 1
+
+typedef enum
+{
+    /* Uniform samples over the whole range. */
+    KERNEL_TEST_RANDOM,
+    /* Samples at and around the limits of the range, which saturate. */
+    KERNEL_TEST_EXTREME
+} KernelTestFill;
+
+static uint32_t kernelTestSeed = 0x2545F491;
+static int kernelTestFailures = 0;
+
+/* xorshift32, so that the runs of the two architectures are the same. */
+static uint32_t KernelTest_random(void)
+{
+    uint32_t x = kernelTestSeed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return kernelTestSeed = x;
+}
+
+/* Gets a random sample within [min, max] or one of min, max and around. */
+static int32_t KernelTest_sample(KernelTestFill fill, int32_t min, int32_t max)
+{
+    if (fill == KERNEL_TEST_EXTREME)
+    {
+        switch (KernelTest_random() % 6)
+        {
+        case 0: return min;
+        case 1: return max;
+        case 2: return min + 1;
+        case 3: return max - 1;
+        case 4: return 0;
+        default: return -1;
+        }
+    }
+    return (int32_t) (min + (int64_t) KernelTest_random()
+        % ((int64_t) max - min + 1));
+}
+
+static void KernelTest_int16Fill(
+        uint8_t *bytes, size_t count,
+        KernelTestFill fill)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        int32_t sample = KernelTest_sample(fill, INT16_MIN, INT16_MAX);
+
+        bytes[2 * i] = (uint8_t) sample;
+        bytes[2 * i + 1] = (uint8_t) (sample >> 8);
+    }
+}
+
+static int32_t KernelTest_int16Load(const uint8_t *bytes)
+{
+    return (int16_t) (bytes[0] | (bytes[1] << 8));
+}
+
+static void KernelTest_fail(
+        const char *kernel, size_t count, size_t index,
+        int64_t expected, int64_t actual)
+{
+    fprintf(stderr,
+            "%s: count %zu, index %zu: expected %" PRId64 ", got %" PRId64
+                "\n",
+            kernel, count, index, expected, actual);
+    kernelTestFailures++;
+}
+
+static int KernelTest_int16ToInt32(size_t count, KernelTestFill fill)
+{
+    uint8_t in[2 * KERNEL_TEST_MAX_COUNT + KERNEL_TEST_MISALIGN] = { 0 };
+    int32_t out[KERNEL_TEST_MAX_COUNT + 1];
+    uint8_t *in_ = in + KERNEL_TEST_MISALIGN;
+    size_t i;
+
+    KernelTest_int16Fill(in_, count, fill);
+    out[count] = 0x5A5A5A5A;
+    PCM_int16ToInt32(in_, out, count);
+    for (i = 0; i < count; i++)
+    {
+        int32_t expected = KernelTest_int16Load(in_ + 2 * i);
+
+        if (out[i] != expected)
+        {
+            KernelTest_fail("int16ToInt32", count, i, expected, out[i]);
+            return 0;
+        }
+    }
+    if (out[count] != 0x5A5A5A5A)
+    {
+        KernelTest_fail("int16ToInt32", count, count, 0x5A5A5A5A, out[count]);
+        return 0;
+    }
+    return 1;
+}
+
+static int KernelTest_int32ToInt16(size_t count, KernelTestFill fill)
+{
+    int32_t in[KERNEL_TEST_MAX_COUNT] = { 0 };
+    uint8_t out[2 * KERNEL_TEST_MAX_COUNT + KERNEL_TEST_MISALIGN + 2];
+    uint8_t *out_ = out + KERNEL_TEST_MISALIGN;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+        in[i] = KernelTest_sample(fill, INT32_MIN, INT32_MAX);
+    out_[2 * count] = out_[2 * count + 1] = 0x5A;
+    PCM_int32ToInt16(in, out_, count);
+    for (i = 0; i < count; i++)
+    {
+        int32_t expected
+            = (in[i] > INT16_MAX)
+                ? INT16_MAX
+                : (in[i] < INT16_MIN) ? INT16_MIN : in[i];
+        int32_t actual = KernelTest_int16Load(out_ + 2 * i);
+
+        if (actual != expected)
+        {
+            KernelTest_fail("int32ToInt16", count, i, expected, actual);
+            return 0;
+        }
+    }
+    if ((out_[2 * count] != 0x5A) || (out_[2 * count + 1] != 0x5A))
+    {
+        KernelTest_fail("int32ToInt16", count, count, 0x5A, out_[2 * count]);
+        return 0;
+    }
+    return 1;
+}
+
+static int KernelTest_int16SumOfSquares(size_t count, KernelTestFill fill)
+{
+    uint8_t in[2 * KERNEL_TEST_MAX_COUNT + KERNEL_TEST_MISALIGN] = { 0 };
+    uint8_t *in_ = in + KERNEL_TEST_MISALIGN;
+    uint64_t expected = 0;
+    uint64_t actual;
+    size_t i;
+
+    KernelTest_int16Fill(in_, count, fill);
+    for (i = 0; i < count; i++)
+    {
+        int64_t sample = KernelTest_int16Load(in_ + 2 * i);
+
+        expected += (uint64_t) (sample * sample);
+    }
+    actual = PCM_int16SumOfSquares(in_, count);
+    if (actual != expected)
+    {
+        KernelTest_fail(
+                "int16SumOfSquares", count, count,
+                (int64_t) expected, (int64_t) actual);
+        return 0;
+    }
+    return 1;
+}
+
+static int KernelTest_int32Mix(size_t count, KernelTestFill fill)
+{
+    /* The mixer mixes 16-bit samples; the kernel supports up to 2^23. */
+    static const int32_t MAX_SAMPLES[] = { INT16_MAX, (1 << 23) - 1 };
+    int32_t in[KERNEL_TEST_MAX_COUNT] = { 0 };
+    int32_t out[KERNEL_TEST_MAX_COUNT + 1];
+    int32_t expected[KERNEL_TEST_MAX_COUNT];
+    size_t m, i;
+
+    for (m = 0; m < sizeof(MAX_SAMPLES) / sizeof(MAX_SAMPLES[0]); m++)
+    {
+        int32_t maxSample = MAX_SAMPLES[m];
+
+        for (i = 0; i < count; i++)
+        {
+            /* The product x is within +/-maxSample, so it rounds exactly. */
+            float x;
+
+            in[i] = KernelTest_sample(fill, -maxSample, maxSample);
+            out[i] = KernelTest_sample(fill, -maxSample, maxSample);
+            /* Java: in + out - Math.round(in * (out / (float) maxSample)) */
+            x = in[i] * (out[i] / (float) maxSample);
+            expected[i]
+                = in[i] + out[i] - (int32_t) floor((double) x + 0.5);
+        }
+        out[count] = 0x5A5A5A5A;
+        PCM_int32Mix(in, out, count, maxSample);
+        for (i = 0; i < count; i++)
+        {
+            if (out[i] != expected[i])
+            {
+                KernelTest_fail("int32Mix", count, i, expected[i], out[i]);
+                return 0;
+            }
+        }
+        if (out[count] != 0x5A5A5A5A)
+        {
+            KernelTest_fail("int32Mix", count, count, 0x5A5A5A5A, out[count]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int KernelTest_vecDotProdi16(size_t count, KernelTestFill fill)
+{
+    int16_t x[KERNEL_TEST_MAX_COUNT + 1];
+    int16_t y[KERNEL_TEST_MAX_COUNT + 1];
+    /* The G.722 filters pass arrays of int16_t at any even address. */
+    int16_t *x_ = x + 1;
+    int64_t sum = 0;
+    int32_t expected;
+    int32_t actual;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        x_[i] = (int16_t) KernelTest_sample(fill, INT16_MIN, INT16_MAX);
+        y[i] = (int16_t) KernelTest_sample(fill, INT16_MIN, INT16_MAX);
+        sum += (int64_t) x_[i] * y[i];
+    }
+    /* The sums of the extremes wrap, in the SIMD lanes as in the scalar. */
+    expected = (int32_t) (uint32_t) sum;
+    actual = vec_dot_prodi16(x_, y, (int) count);
+    if (actual != expected)
+    {
+        KernelTest_fail("vec_dot_prodi16", count, count, expected, actual);
+        return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    static int (*const KERNEL_TESTS[])(size_t, KernelTestFill)
+        = {
+            KernelTest_int16ToInt32,
+            KernelTest_int32ToInt16,
+            KernelTest_int16SumOfSquares,
+            KernelTest_int32Mix,
+            KernelTest_vecDotProdi16
+        };
+    static const char *const KERNEL_NAMES[]
+        = {
+            "int16ToInt32",
+            "int32ToInt16",
+            "int16SumOfSquares",
+            "int32Mix",
+            "vec_dot_prodi16"
+        };
+    size_t k;
+
+    for (k = 0; k < sizeof(KERNEL_TESTS) / sizeof(KERNEL_TESTS[0]); k++)
+    {
+        int passed = 1;
+        size_t count;
+
+        for (count = 0; passed && (count <= KERNEL_TEST_MAX_COUNT); count++)
+        {
+            int round;
+
+            for (round = 0; passed && (round < KERNEL_TEST_ROUNDS); round++)
+            {
+                passed
+                    = KERNEL_TESTS[k](count, KERNEL_TEST_RANDOM)
+                        && KERNEL_TESTS[k](count, KERNEL_TEST_EXTREME);
+            }
+        }
+        printf("%-20s %s\n", KERNEL_NAMES[k], passed ? "ok" : "FAILED");
+    }
+    return (kernelTestFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,462 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "native_log.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/** The number of call sites which are rate limited. */
+#define NATIVE_LOG_SITES 64
+
+/** The largest number of Loggers. */
+#define NATIVE_LOG_LOGGERS 16
+
+/** The time in nanoseconds the thread sleeps when the ring is empty. */
+#define NATIVE_LOG_POLL_NANOS 20000000L
+
+#define NATIVE_LOG_MASK (NATIVE_LOG_CAPACITY - 1)
+
+typedef struct
+{
+    /**
+     * The position in the ring at which the slot may next be written, or that
+     * plus one once it has been written and may be read. It is kept minus the
+     * index of the slot so that the zeroed ring is ready to be written.
+     */
+    uint32_t sequence;
+    int level;
+    const char *name;
+    char message[NATIVE_LOG_MESSAGE_LENGTH];
+} NativeLogRecord;
+
+typedef struct
+{
+    /** The format which identifies the call site or NULL if free. */
+    const char *format;
+    /** The index of the current window of the rate limit. */
+    uint32_t window;
+    /** The number of messages of the call site in the current window. */
+    uint32_t count;
+    /** The number of messages suppressed since one was last logged. */
+    uint32_t suppressed;
+} NativeLogSite;
+
+typedef struct
+{
+    const char *name;
+    jobject logger;
+} NativeLogLogger;
+
+static NativeLogRecord NativeLog_ring[NATIVE_LOG_CAPACITY];
+static uint32_t NativeLog_enqueuePos = 0;
+/** Only accessed by the thread. */
+static uint32_t NativeLog_dequeuePos = 0;
+static uint32_t NativeLog_dropped = 0;
+static NativeLogSite NativeLog_sites[NATIVE_LOG_SITES];
+
+static JavaVM *NativeLog_vm = NULL;
+static pthread_t NativeLog_thread;
+static int NativeLog_running = 0;
+
+/*
+ * The Logger class and methods, resolved when starting, and the Loggers,
+ * only accessed by the thread.
+ */
+static jclass NativeLog_loggerClass = NULL;
+static jmethodID NativeLog_getLoggerMethodID = NULL;
+static jmethodID NativeLog_levelMethodIDs[NATIVE_LOG_DEBUG + 1];
+static NativeLogLogger NativeLog_loggers[NATIVE_LOG_LOGGERS];
+
+static uint32_t
+NativeLog_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ts.tv_sec;
+}
+
+/**
+ * Finds the rate limiting state of the call site with a specific format,
+ * claiming a free one if there is none.
+ *
+ * @return the state of the call site or NULL if the table is full, in which
+ * case the messages are not rate limited
+ */
+static NativeLogSite *
+NativeLog_getSite(const char *format)
+{
+    uintptr_t hash = ((uintptr_t) format) >> 3;
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        NativeLogSite *site
+            = NativeLog_sites + ((hash + i) & (NATIVE_LOG_SITES - 1));
+        const char *siteFormat
+            = __atomic_load_n(&(site->format), __ATOMIC_ACQUIRE);
+
+        if (siteFormat == format)
+            return site;
+        if (!siteFormat)
+        {
+            const char *expected = NULL;
+
+            if (__atomic_compare_exchange_n(
+                        &(site->format),
+                        &expected, format,
+                        0,
+                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+                    || (expected == format))
+            {
+                return site;
+            }
+        }
+    }
+    return NULL;
+}
+
+void
+NativeLog_log(const char *name, int level, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    NativeLog_vlog(name, level, format, args);
+    va_end(args);
+}
+
+void
+NativeLog_vlog(const char *name, int level, const char *format, va_list args)
+{
+    NativeLogSite *site = NativeLog_getSite(format);
+    uint32_t suppressed = 0;
+    uint32_t pos;
+    NativeLogRecord *record;
+    int length;
+
+    if (site)
+    {
+        uint32_t window = NativeLog_seconds() / NATIVE_LOG_RATE_WINDOW_SECONDS;
+        uint32_t siteWindow = __atomic_load_n(&(site->window), __ATOMIC_RELAXED);
+
+        if ((siteWindow != window)
+                && __atomic_compare_exchange_n(
+                        &(site->window),
+                        &siteWindow, window,
+                        0,
+                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            __atomic_store_n(&(site->count), 0, __ATOMIC_RELAXED);
+            suppressed
+                = __atomic_exchange_n(&(site->suppressed), 0, __ATOMIC_RELAXED);
+        }
+        if (__atomic_fetch_add(&(site->count), 1, __ATOMIC_RELAXED)
+                >= NATIVE_LOG_RATE_LIMIT)
+        {
+            __atomic_fetch_add(&(site->suppressed), 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+
+    /* Claims a slot as in a bounded multi-producer queue. */
+    pos = __atomic_load_n(&NativeLog_enqueuePos, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        int32_t diff;
+
+        record = NativeLog_ring + (pos & NATIVE_LOG_MASK);
+        diff
+            = (int32_t)
+                (__atomic_load_n(&(record->sequence), __ATOMIC_ACQUIRE)
+                    + (pos & NATIVE_LOG_MASK)
+                    - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(
+                    &NativeLog_enqueuePos,
+                    &pos, pos + 1,
+                    1,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* The ring is full. */
+            __atomic_fetch_add(&NativeLog_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        else
+        {
+            pos = __atomic_load_n(&NativeLog_enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    record->level = level;
+    record->name = name;
+    length = vsnprintf(record->message, sizeof(record->message), format, args);
+    if ((length >= 0)
+            && (length < (int) sizeof(record->message))
+            && suppressed)
+    {
+        snprintf(
+                record->message + length,
+                sizeof(record->message) - length,
+                " (%u similar messages suppressed)",
+                (unsigned) suppressed);
+    }
+    __atomic_store_n(
+            &(record->sequence),
+            pos + 1 - (pos & NATIVE_LOG_MASK),
+            __ATOMIC_RELEASE);
+}
+
+/**
+ * Gets the Logger with a specific name, creating it the first time.
+ *
+ * @return a global reference to the Logger or NULL
+ */
+static jobject
+NativeLog_getLogger(JNIEnv *env, const char *name)
+{
+    jstring jname;
+    jobject logger;
+    int i;
+
+    for (i = 0; (i < NATIVE_LOG_LOGGERS) && NativeLog_loggers[i].name; i++)
+    {
+        if ((NativeLog_loggers[i].name == name)
+                || (strcmp(NativeLog_loggers[i].name, name) == 0))
+        {
+            return NativeLog_loggers[i].logger;
+        }
+    }
+
+    jname = (*env)->NewStringUTF(env, name);
+    if (!jname)
+    {
+        (*env)->ExceptionClear(env);
+        return NULL;
+    }
+    logger
+        = (*env)->CallStaticObjectMethod(
+                env,
+                NativeLog_loggerClass, NativeLog_getLoggerMethodID,
+                jname);
+    (*env)->DeleteLocalRef(env, jname);
+    if ((*env)->ExceptionCheck(env) || !logger)
+    {
+        (*env)->ExceptionClear(env);
+        return NULL;
+    }
+    if (i < NATIVE_LOG_LOGGERS)
+    {
+        NativeLog_loggers[i].name = name;
+        NativeLog_loggers[i].logger = (*env)->NewGlobalRef(env, logger);
+        (*env)->DeleteLocalRef(env, logger);
+        return NativeLog_loggers[i].logger;
+    }
+    /* Too many Loggers, which leaks a local reference per message. */
+    return logger;
+}
+
+static void
+NativeLog_write(JNIEnv *env, const char *name, int level, char *message)
+{
+    jobject logger = NativeLog_getLogger(env, name);
+    size_t length = strlen(message);
+    size_t i;
+    jstring jmessage;
+
+    if (!logger)
+    {
+        fprintf(stderr, "%s: %s\n", name, message);
+        return;
+    }
+
+    /*
+     * The messages of the native libraries were written to stderr and often
+     * end with a new line. NewStringUTF takes modified UTF-8 so any other
+     * byte than ASCII is replaced.
+     */
+    while ((length > 0)
+            && ((message[length - 1] == '\n')
+                || (message[length - 1] == '\r')))
+    {
+        message[--length] = '\0';
+    }
+    for (i = 0; i < length; i++)
+    {
+        if (message[i] & 0x80)
+            message[i] = '?';
+    }
+
+    jmessage = (*env)->NewStringUTF(env, message);
+    if (jmessage)
+    {
+        if ((level < NATIVE_LOG_ERROR) || (level > NATIVE_LOG_DEBUG))
+            level = NATIVE_LOG_INFO;
+        (*env)->CallVoidMethod(
+                env,
+                logger, NativeLog_levelMethodIDs[level],
+                jmessage);
+        (*env)->DeleteLocalRef(env, jmessage);
+    }
+    if ((*env)->ExceptionCheck(env))
+        (*env)->ExceptionClear(env);
+}
+
+static void *
+NativeLog_run(void *arg)
+{
+    JNIEnv *env = NULL;
+    JavaVMAttachArgs attachArgs;
+    int i;
+
+    attachArgs.version = JNI_VERSION_1_6;
+    attachArgs.name = "NativeLog";
+    attachArgs.group = NULL;
+    if ((*NativeLog_vm)->AttachCurrentThreadAsDaemon(
+                NativeLog_vm,
+                (void **) &env,
+                &attachArgs)
+            != JNI_OK)
+    {
+        return NULL;
+    }
+
+    for (;;)
+    {
+        uint32_t pos = NativeLog_dequeuePos;
+        NativeLogRecord *record = NativeLog_ring + (pos & NATIVE_LOG_MASK);
+        uint32_t sequence
+            = __atomic_load_n(&(record->sequence), __ATOMIC_ACQUIRE)
+                + (pos & NATIVE_LOG_MASK);
+
+        if (sequence == pos + 1)
+        {
+            NativeLog_write(env, record->name, record->level, record->message);
+            __atomic_store_n(
+                    &(record->sequence),
+                    pos + NATIVE_LOG_CAPACITY - (pos & NATIVE_LOG_MASK),
+                    __ATOMIC_RELEASE);
+            NativeLog_dequeuePos = pos + 1;
+        }
+        else
+        {
+            uint32_t dropped
+                = __atomic_exchange_n(&NativeLog_dropped, 0, __ATOMIC_RELAXED);
+            struct timespec ts;
+
+            if (dropped)
+            {
+                char message[64];
+
+                snprintf(
+                        message, sizeof(message),
+                        "Dropped %u native log messages",
+                        (unsigned) dropped);
+                NativeLog_write(
+                        env,
+                        "org.jitsi.util.NativeLog",
+                        NATIVE_LOG_WARN,
+                        message);
+            }
+            /* The ring has been drained since it was stopped. */
+            if (!__atomic_load_n(&NativeLog_running, __ATOMIC_ACQUIRE))
+                break;
+
+            ts.tv_sec = 0;
+            ts.tv_nsec = NATIVE_LOG_POLL_NANOS;
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    for (i = 0; (i < NATIVE_LOG_LOGGERS) && NativeLog_loggers[i].name; i++)
+    {
+        (*env)->DeleteGlobalRef(env, NativeLog_loggers[i].logger);
+        NativeLog_loggers[i].name = NULL;
+        NativeLog_loggers[i].logger = NULL;
+    }
+    (*env)->DeleteGlobalRef(env, NativeLog_loggerClass);
+    NativeLog_loggerClass = NULL;
+    (*NativeLog_vm)->DetachCurrentThread(NativeLog_vm);
+    return NULL;
+}
+
+int
+NativeLog_start(JavaVM *vm)
+{
+    static const char *levelMethodNames[] = { "error", "warn", "info", "debug" };
+    JNIEnv *env = NULL;
+    jclass clazz;
+    int i;
+
+    if (__atomic_load_n(&NativeLog_running, __ATOMIC_ACQUIRE))
+        return 0;
+    if ((*vm)->GetEnv(vm, (void **) &env, JNI_VERSION_1_6) != JNI_OK)
+        return -1;
+
+    clazz = (*env)->FindClass(env, "org/jitsi/util/Logger");
+    if (!clazz)
+    {
+        (*env)->ExceptionClear(env);
+        return -1;
+    }
+    NativeLog_getLoggerMethodID
+        = (*env)->GetStaticMethodID(
+                env,
+                clazz,
+                "getLogger", "(Ljava/lang/String;)Lorg/jitsi/util/Logger;");
+    for (i = 0; NativeLog_getLoggerMethodID && (i <= NATIVE_LOG_DEBUG); i++)
+    {
+        NativeLog_levelMethodIDs[i]
+            = (*env)->GetMethodID(
+                    env,
+                    clazz,
+                    levelMethodNames[i], "(Ljava/lang/Object;)V");
+        if (!NativeLog_levelMethodIDs[i])
+            NativeLog_getLoggerMethodID = NULL;
+    }
+    if (!NativeLog_getLoggerMethodID)
+    {
+        (*env)->ExceptionClear(env);
+        (*env)->DeleteLocalRef(env, clazz);
+        return -1;
+    }
+    NativeLog_loggerClass = (*env)->NewGlobalRef(env, clazz);
+    (*env)->DeleteLocalRef(env, clazz);
+    if (!NativeLog_loggerClass)
+        return -1;
+
+    NativeLog_vm = vm;
+    __atomic_store_n(&NativeLog_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&NativeLog_thread, NULL, NativeLog_run, NULL) != 0)
+    {
+        __atomic_store_n(&NativeLog_running, 0, __ATOMIC_RELEASE);
+        (*env)->DeleteGlobalRef(env, NativeLog_loggerClass);
+        NativeLog_loggerClass = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void
+NativeLog_stop(void)
+{
+    if (__atomic_exchange_n(&NativeLog_running, 0, __ATOMIC_ACQ_REL))
+        pthread_join(NativeLog_thread, NULL);
+}
@@ -0,0 +1,92 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNMEDIA_NATIVE_LOG_H_
+#define _JNMEDIA_NATIVE_LOG_H_
+
+#include <jni.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * An asynchronous logger for the native libraries which may be called from
+ * any thread including real-time audio threads. A message is formatted into
+ * a slot of a lock-free ring and a background thread, attached to the JVM,
+ * passes it to an org.jitsi.util.Logger. Logging never blocks: a message is
+ * dropped if the ring is full. The messages of a call site, identified by its
+ * format, are rate limited and the number of suppressed ones is appended to
+ * the next message which is logged.
+ */
+
+/** The levels of the messages, mapped to the methods of Logger. */
+enum
+{
+    NATIVE_LOG_ERROR = 0,
+    NATIVE_LOG_WARN,
+    NATIVE_LOG_INFO,
+    NATIVE_LOG_DEBUG
+};
+
+/** The number of slots of the ring (power of 2). */
+#define NATIVE_LOG_CAPACITY 256
+
+/** The largest length of a message, including the terminating NUL. */
+#define NATIVE_LOG_MESSAGE_LENGTH 512
+
+/** The largest number of messages of a call site logged per window. */
+#define NATIVE_LOG_RATE_LIMIT 10
+
+/** The length in seconds of the window of the rate limit. */
+#define NATIVE_LOG_RATE_WINDOW_SECONDS 10
+
+/**
+ * Starts the background thread which passes the messages to Java. Must be
+ * called from JNI_OnLoad, or a thread of the JVM, so that the Logger class is
+ * found by the class loader of the library. Messages logged before are kept
+ * in the ring.
+ *
+ * @return 0 on success, -1 otherwise
+ */
+int NativeLog_start(JavaVM *vm);
+
+/**
+ * Stops the background thread after it has passed the messages in the ring
+ * to Java. Called from JNI_OnUnload.
+ */
+void NativeLog_stop(void);
+
+/**
+ * Logs a message.
+ *
+ * @param name the name of the Logger, which must be a string literal as it is
+ * kept by reference
+ * @param level the level of the message
+ * @param format the printf format of the message, which identifies the call
+ * site for the rate limit
+ */
+void NativeLog_log(const char *name, int level, const char *format, ...)
+#ifdef __GNUC__
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+/** Logs a message with the arguments of its format in a va_list. */
+void NativeLog_vlog(
+        const char *name,
+        int level,
+        const char *format,
+        va_list args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _JNMEDIA_NATIVE_LOG_H_ */
@@ -6,6 +6,7 @@
  */
 // Portions (c) Microsoft Corporation. All rights reserved.
 #include "device.h"
+#include "latency_trace.h"
 
 #include <math.h>
 #include <pthread.h>
@@ -194,6 +195,18 @@ OSStatus MacCoreaudio_convert(
 void MacCoreaudio_addAECStream(MacCoreaudio_Stream *stream);
 void MacCoreaudio_removeAECStream(MacCoreaudio_Stream *stream);
 
+uint64_t MacCoreaudio_getHostNanos(const AudioTimeStamp *timeStamp);
+
+uint64_t MacCoreaudio_getPeriodNanos(
+        const AudioBufferList *bufferList,
+        AudioStreamBasicDescription format);
+
+void MacCoreaudio_putInputData(
+        MacCoreaudio_Stream *stream,
+        char *buffer,
+        int bufferLength,
+        uint64_t callbackNanos);
+
 unsigned int MacCoreaudio_aecStreamCapacity = 0;
 unsigned int MacCoreaudio_aecStreamCount = 0;
 pthread_mutex_t MacCoreaudio_aecStreamMutex = PTHREAD_MUTEX_INITIALIZER;
@@ -1795,10 +1808,24 @@ MacCoreaudio_readInputStream(
     int error = 0;
 
     MacCoreaudio_Stream *stream = (MacCoreaudio_Stream *) clientData;
+    uint64_t callbackNanos = LatencyTrace_now();
+    uint64_t inNanos = MacCoreaudio_getHostNanos(inTime);
+
+    if(inNanos != 0 && inNanos <= callbackNanos)
+    {
+        LatencyTrace_record(
+                &stream->latency,
+                LATENCY_STAGE_CAPTURE_DEVICE,
+                callbackNanos - inNanos);
+    }
+
+    uint64_t periodNanos
+        = MacCoreaudio_getPeriodNanos(inData, stream->deviceFormat);
+
+    AudioIOHealth_beginCallback(&stream->health, callbackNanos, periodNanos);
+
     if((error = pthread_mutex_trylock(&stream->mutex)) == 0)
     {
-        void (*callbackFunction)(char*, int, void*, void*)
-            = stream->callbackFunction;
         int i;
 
         if(stream->ioProcId != 0)
@@ -1922,20 +1949,20 @@ MacCoreaudio_readInputStream(
                                 }
 
                                 // Puts data to Java.
-                                callbackFunction(
+                                MacCoreaudio_putInputData(
+                                        stream,
                                         stream->outBuffer,
                                         outTmpLength,
-                                        stream->callbackObject,
-                                        stream->callbackMethod);
+                                        callbackNanos);
                             }
                             else
                             {
                                 // Puts data to Java.
-                                callbackFunction(
+                                MacCoreaudio_putInputData(
+                                        stream,
                                         inputOutTmpBuffer,
                                         inputOutTmpLength,
-                                        stream->callbackObject,
-                                        stream->callbackMethod);
+                                        callbackNanos);
                             }
                             LibJitsi_WebRTC_AEC_completeProcess(aec, 0);
                             LibJitsi_WebRTC_AEC_completeProcess(aec, 1);
@@ -1987,11 +2014,11 @@ MacCoreaudio_readInputStream(
                         }
 
                         // Puts data to Java.
-                        callbackFunction(
+                        MacCoreaudio_putInputData(
+                                stream,
                                 stream->outBuffer,
                                 outTmpLength,
-                                stream->callbackObject,
-                                stream->callbackMethod);
+                                callbackNanos);
                     }
                 }
             }
@@ -2006,17 +2033,30 @@ MacCoreaudio_readInputStream(
                     strerror(errno));
         }
     }
-    // If the error equals EBUSY, this means that the mutex is already locked by
-    // the stop function.
-    else if(error != EBUSY)
+    else
     {
-        MacCoreaudio_log(
-                "%s: %s\n",
-                "MacCoreaudio_readInputStream (coreaudio/device.c): \
-                    \n\tpthread_mutex_lock",
-                strerror(errno));
+        // The captured data is lost.
+        AudioIOHealth_add(&stream->health, AUDIO_IO_HEALTH_TRYLOCK_SKIPS, 1);
+        AudioIOHealth_add(&stream->health, AUDIO_IO_HEALTH_OVERRUNS, 1);
+
+        // If the error equals EBUSY, this means that the mutex is already
+        // locked by the stop function.
+        if(error != EBUSY)
+        {
+            MacCoreaudio_log(
+                    "%s: %s\n",
+                    "MacCoreaudio_readInputStream (coreaudio/device.c): \
+                        \n\tpthread_mutex_lock",
+                    strerror(errno));
+        }
     }
 
+    AudioIOHealth_endCallback(
+            &stream->health,
+            callbackNanos,
+            LatencyTrace_now(),
+            periodNanos);
+
     return noErr;
 }
 
@@ -2044,6 +2084,11 @@ MacCoreaudio_writeOutputStream(
     }
 
     MacCoreaudio_Stream *stream = (MacCoreaudio_Stream *) clientData;
+    uint64_t startNanos = LatencyTrace_now();
+    uint64_t periodNanos
+        = MacCoreaudio_getPeriodNanos(outData, stream->deviceFormat);
+
+    AudioIOHealth_beginCallback(&stream->health, startNanos, periodNanos);
 
     if((error = pthread_mutex_trylock(&stream->mutex)) == 0)
     {
@@ -2066,12 +2111,25 @@ MacCoreaudio_writeOutputStream(
             // Get data from java.
             void (*callbackFunction)(char*, int, void*, void*)
                 = stream->callbackFunction;
+            uint64_t callbackNanos = LatencyTrace_now();
+            uint64_t outNanos = MacCoreaudio_getHostNanos(outTime);
 
             callbackFunction(
                     stream->outBuffer,
                     outConverterInBufferSize,
                     stream->callbackObject,
                     stream->callbackMethod);
+            LatencyTrace_record(
+                    &stream->latency,
+                    LATENCY_STAGE_RENDER_JAVA,
+                    LatencyTrace_now() - callbackNanos);
+            if(outNanos > callbackNanos)
+            {
+                LatencyTrace_record(
+                        &stream->latency,
+                        LATENCY_STAGE_RENDER_DEVICE,
+                        outNanos - callbackNanos);
+            }
             // Convert from java to device.
             if((err = MacCoreaudio_convert(
                             stream,
@@ -2114,7 +2172,10 @@ MacCoreaudio_writeOutputStream(
     }
     else
     {
+        // Nothing is rendered for this period.
         outData->mBuffers[0].mDataByteSize = 0;
+        AudioIOHealth_add(&stream->health, AUDIO_IO_HEALTH_TRYLOCK_SKIPS, 1);
+        AudioIOHealth_add(&stream->health, AUDIO_IO_HEALTH_UNDERRUNS, 1);
 
         // If the error equals EBUSY, this means that the mutex is already
         // locked by the stop function.
@@ -2153,9 +2214,92 @@ MacCoreaudio_writeOutputStream(
         }
     }
 
+    AudioIOHealth_endCallback(
+            &stream->health,
+            startNanos,
+            LatencyTrace_now(),
+            periodNanos);
+
     return noErr;
 }
 
+/**
+ * Returns the host time of a CoreAudio time stamp in nanoseconds.
+ *
+ * @param timeStamp The time stamp.
+ *
+ * @return The host time of the time stamp in nanoseconds, or 0 if it has no
+ * valid host time.
+ */
+uint64_t MacCoreaudio_getHostNanos(const AudioTimeStamp *timeStamp)
+{
+    if(timeStamp == NULL
+            || (timeStamp->mFlags & kAudioTimeStampHostTimeValid) == 0)
+    {
+        return 0;
+    }
+    return AudioConvertHostTimeToNanos(timeStamp->mHostTime);
+}
+
+/**
+ * Returns the duration of the audio in a buffer list exchanged with a device.
+ *
+ * @param bufferList The buffer list.
+ * @param format The format of the device.
+ *
+ * @return The duration of the audio in nanoseconds, or 0 if unknown.
+ */
+uint64_t MacCoreaudio_getPeriodNanos(
+        const AudioBufferList *bufferList,
+        AudioStreamBasicDescription format)
+{
+    if(bufferList == NULL
+            || bufferList->mNumberBuffers == 0
+            || format.mBytesPerFrame == 0
+            || format.mSampleRate <= 0)
+    {
+        return 0;
+    }
+    return (uint64_t)
+        ((bufferList->mBuffers[0].mDataByteSize / format.mBytesPerFrame)
+            * 1000000000.0 / format.mSampleRate);
+}
+
+/**
+ * Puts captured data to Java and traces the time the data has spent since the
+ * input callback has been called and in Java.
+ *
+ * @param stream The input stream.
+ * @param buffer The data to put to Java.
+ * @param bufferLength The length of the data.
+ * @param callbackNanos The host time at which the input callback has been
+ * called, in nanoseconds.
+ */
+void MacCoreaudio_putInputData(
+        MacCoreaudio_Stream *stream,
+        char *buffer,
+        int bufferLength,
+        uint64_t callbackNanos)
+{
+    void (*callbackFunction)(char*, int, void*, void*)
+        = stream->callbackFunction;
+    uint64_t startNanos = LatencyTrace_now();
+
+    LatencyTrace_record(
+            &stream->latency,
+            LATENCY_STAGE_CAPTURE_PROCESS,
+            startNanos - callbackNanos);
+    callbackFunction(
+            buffer,
+            bufferLength,
+            stream->callbackObject,
+            stream->callbackMethod);
+    LatencyTrace_record(
+            &stream->latency,
+            LATENCY_STAGE_CAPTURE_JAVA,
+            LatencyTrace_now() - startNanos);
+}
+
 void
 MacCoreaudio_writeOutputStreamToAECStream(
         MacCoreaudio_Stream *src,
@@ -2831,14 +2975,19 @@ OSStatus MacCoreaudio_convert(
         outBufferList.mBuffers[0].mDataByteSize = outBufferLength;
         outBufferList.mBuffers[0].mData = outBuffer;
 
-        if((err = AudioConverterFillComplexBuffer(
-                        converter,
-                        MacCoreaudio_converterComplexInputDataProc,
-                        stream, // corresponding to inUserData
-                        &outputDataPacketSize,
-                        &outBufferList,
-                        NULL))
-                != noErr)
+        uint64_t startNanos = LatencyTrace_now();
+
+        err = AudioConverterFillComplexBuffer(
+                converter,
+                MacCoreaudio_converterComplexInputDataProc,
+                stream, // corresponding to inUserData
+                &outputDataPacketSize,
+                &outBufferList,
+                NULL);
+        AudioIOHealth_addConversion(
+                &stream->health,
+                LatencyTrace_now() - startNanos);
+        if(err != noErr)
         {
             MacCoreaudio_log(
                     "MacCoreaudio_convert (coreaudio/device.c): \
@@ -13,6 +13,8 @@
 #include <CoreAudio/CoreAudio.h>
 #include <CoreFoundation/CFString.h>
 
+#include "audio_io_health.h"
+#include "latency_trace.h"
 #include "libjitsi_webrtc_aec.h"
 
 
@@ -45,6 +47,9 @@ typedef struct _MacCoreaudio_Stream
     /* Input streams only. */
     LibJitsi_WebRTC_AEC *aec;
     unsigned char isEchoCancel;
+
+    AudioIOHealth health;
+    LatencyTrace latency;
 } MacCoreaudio_Stream;
 
 int MacCoreaudio_isInputDevice(const char *deviceUID);
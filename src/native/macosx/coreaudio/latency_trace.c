@@ -0,0 +1,110 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "latency_trace.h"
+
+#include <CoreAudio/HostTime.h>
+
+/**
+ * Lock-free histograms of the time audio frames spend in each native stage of
+ * a stream. They are written with atomic increments from the real-time
+ * CoreAudio thread of the stream and read as a whole by a single JNI
+ * snapshot.
+ */
+
+/**
+ * Returns the current host time in nanoseconds, the clock of the timestamps
+ * CoreAudio passes to the IO callbacks.
+ */
+uint64_t LatencyTrace_now()
+{
+    return AudioConvertHostTimeToNanos(AudioGetCurrentHostTime());
+}
+
+/**
+ * Records the time an audio frame of a stream has spent in a specific stage.
+ *
+ * @param trace The histograms of the stream.
+ * @param stage The LATENCY_STAGE_ constant of the stage.
+ * @param nanos The time spent in the stage, in nanoseconds.
+ */
+void LatencyTrace_record(LatencyTrace *trace, int stage, uint64_t nanos)
+{
+    LatencyTrace_Histogram *histogram;
+    uint64_t micros = nanos / 1000;
+    uint64_t max;
+    int bucket = 0;
+
+    if(stage < 0 || stage >= LATENCY_STAGE_COUNT)
+    {
+        return;
+    }
+    histogram = trace->histograms + stage;
+
+    while((micros >> (bucket + 1)) != 0
+            && bucket < LATENCY_TRACE_BUCKETS - 1)
+    {
+        ++bucket;
+    }
+
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sumMicros, micros, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->buckets[bucket], 1, __ATOMIC_RELAXED);
+
+    max = __atomic_load_n(&histogram->maxMicros, __ATOMIC_RELAXED);
+    while(micros > max
+            && !__atomic_compare_exchange_n(
+                    &histogram->maxMicros,
+                    &max,
+                    micros,
+                    1,
+                    __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED))
+        ;
+}
+
+/**
+ * Copies the histograms of all stages of a stream, LATENCY_TRACE_STAGE_LENGTH
+ * values per stage.
+ *
+ * @param trace The histograms of the stream.
+ * @param values The array to fill.
+ * @param length The length of values.
+ * @param reset Whether to reset the histograms after copying them.
+ *
+ * @return The number of values filled.
+ */
+int LatencyTrace_snapshot(
+        LatencyTrace *trace,
+        int64_t *values,
+        int length,
+        int reset)
+{
+    int stage;
+    int i;
+    int n = 0;
+
+    for(stage = 0; stage < LATENCY_STAGE_COUNT; ++stage)
+    {
+        LatencyTrace_Histogram *histogram = trace->histograms + stage;
+        uint64_t *src = (uint64_t *) histogram;
+
+        if(n + LATENCY_TRACE_STAGE_LENGTH > length)
+        {
+            break;
+        }
+        for(i = 0; i < LATENCY_TRACE_STAGE_LENGTH; ++i)
+        {
+            values[n++]
+                = reset
+                    ? __atomic_exchange_n(src + i, 0, __ATOMIC_RELAXED)
+                    : __atomic_load_n(src + i, __ATOMIC_RELAXED);
+        }
+    }
+    return n;
+}
@@ -0,0 +1,68 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+#ifndef latency_trace_h
+#define latency_trace_h
+
+#include <stdint.h>
+
+/**
+ * Lock-free histograms of the time audio frames spend in each native stage
+ * between the device and Java, kept per stream. Look at corresponding ".c"
+ * file for documentation.
+ */
+
+/** The stages of the audio path which are traced natively. */
+enum
+{
+    /* From the capture by the device to the input callback. */
+    LATENCY_STAGE_CAPTURE_DEVICE = 0,
+    /* From the input callback to the delivery to Java (conversion and AEC). */
+    LATENCY_STAGE_CAPTURE_PROCESS,
+    /* The time spent in Java receiving captured data. */
+    LATENCY_STAGE_CAPTURE_JAVA,
+    /* The time spent in Java providing data to render. */
+    LATENCY_STAGE_RENDER_JAVA,
+    /* From the output callback to the playback by the device. */
+    LATENCY_STAGE_RENDER_DEVICE,
+    LATENCY_STAGE_COUNT
+};
+
+/** The number of log2 microsecond buckets of a histogram. */
+#define LATENCY_TRACE_BUCKETS 24
+
+/**
+ * The number of values per stage in a snapshot: the count, the sum and the
+ * maximum in microseconds and then the buckets.
+ */
+#define LATENCY_TRACE_STAGE_LENGTH (3 + LATENCY_TRACE_BUCKETS)
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t sumMicros;
+    uint64_t maxMicros;
+    uint64_t buckets[LATENCY_TRACE_BUCKETS];
+} LatencyTrace_Histogram;
+
+/** The histograms of all native stages of a stream, zeroed when unused. */
+typedef struct
+{
+    LatencyTrace_Histogram histograms[LATENCY_STAGE_COUNT];
+} LatencyTrace;
+
+uint64_t LatencyTrace_now();
+
+void LatencyTrace_record(LatencyTrace *trace, int stage, uint64_t nanos);
+
+int LatencyTrace_snapshot(
+        LatencyTrace *trace,
+        int64_t *values,
+        int length,
+        int reset);
+
+#endif
@@ -4,8 +4,11 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 #include "LibJitsi_WebRTC_AEC.h"
 
+#include "../../log/native_log.h"
+
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/interface/module_common_types.h"
 
@@ -34,6 +37,15 @@ struct _LibJitsi_WebRTC_AEC
     pthread_mutex_t mutex[2];
     struct timeval lastProcess[2];
     AudioStreamBasicDescription format;
+    // The quality and cost metrics, read without the locks by
+    // LibJitsi_WebRTC_AEC_getMetrics.
+    int64_t metrics[LIBJITSI_WEBRTC_AEC_METRIC_LENGTH];
+    // The samples received per stream and their values at the last refresh
+    // of the metrics, to estimate the drift.
+    int64_t samples[2];
+    int64_t refreshSamples[2];
+    int64_t refreshBlocks;
+    double driftPpm;
 };
 
 int16_t *
@@ -60,6 +72,20 @@ LibJitsi_WebRTC_AEC_getNbSampleSinceLastProcess(
         int length,
         int isRenderStream);
 
+void
+LibJitsi_WebRTC_AEC_addMetric(
+        LibJitsi_WebRTC_AEC *aec,
+        int index,
+        int64_t value);
+
+void
+LibJitsi_WebRTC_AEC_setMetric(
+        LibJitsi_WebRTC_AEC *aec,
+        int index,
+        int64_t value);
+
+void LibJitsi_WebRTC_AEC_refreshMetrics(LibJitsi_WebRTC_AEC *aec);
+
 /**
  * Initiates a new webrtc_aec capable instance.
  *
@@ -326,6 +352,24 @@ LibJitsi_WebRTC_AEC_initAudioProcessing(
         return -1;
     }
 
+    // The metrics only cost a few statistics per block in WebRTC.
+    if((err = aec->audioProcessing->echo_cancellation()->enable_metrics(true))
+            != webrtc::AudioProcessing::kNoError
+        || (err = aec->audioProcessing->echo_cancellation()
+                ->enable_delay_logging(true))
+            != webrtc::AudioProcessing::kNoError)
+    {
+        LibJitsi_WebRTC_AEC_log(
+                "%s: 0x%x\n",
+            "LibJitsi_WebRTC_AEC_initAudioProcessing (LibJitsi_WebRTC_AEC.c): \
+            \n\tAudioProcessing::echo_cancellation::enable_metrics",
+                err);
+    }
+    LibJitsi_WebRTC_AEC_setMetric(
+            aec,
+            LIBJITSI_WEBRTC_AEC_METRIC_SUPPRESSION_LEVEL,
+            aec->audioProcessing->echo_cancellation()->suppression_level());
+
     LibJitsi_WebRTC_AEC_unlock(aec, 0);
     LibJitsi_WebRTC_AEC_unlock(aec, 1);
 
@@ -353,10 +397,16 @@ LibJitsi_WebRTC_AEC_process(LibJitsi_WebRTC_AEC *aec)
 
     if(init)
     {
+        LibJitsi_WebRTC_AEC_addMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_BLOCKS,
+                1);
         if(end_render <= aec->dataUsed[1])
         {
             struct timeval currentTime;
             gettimeofday(&currentTime, NULL);
+            uint64_t startNanos
+                = AudioConvertHostTimeToNanos(AudioGetCurrentHostTime());
 
             // Process render stream.
             frame->UpdateFrame(
@@ -418,6 +468,10 @@ LibJitsi_WebRTC_AEC_process(LibJitsi_WebRTC_AEC *aec)
             {
                 nbMs = 500;
             }
+            LibJitsi_WebRTC_AEC_setMetric(
+                    aec,
+                    LIBJITSI_WEBRTC_AEC_METRIC_DELAY_MS,
+                    nbMs);
             if((err = aec->audioProcessing->set_stream_delay_ms(nbMs))
                     != webrtc::AudioProcessing::kNoError)
             {
@@ -444,13 +498,71 @@ LibJitsi_WebRTC_AEC_process(LibJitsi_WebRTC_AEC *aec)
                         aec->data[0] + start_capture,
                         frame->data_,
                         aec->audioProcessingLength * sizeof(int16_t));
+                LibJitsi_WebRTC_AEC_addMetric(
+                        aec,
+                        LIBJITSI_WEBRTC_AEC_METRIC_ECHO_BLOCKS,
+                        1);
+            }
+
+            int64_t processMicros
+                = (AudioConvertHostTimeToNanos(AudioGetCurrentHostTime())
+                        - startNanos)
+                    / 1000;
+            LibJitsi_WebRTC_AEC_addMetric(
+                    aec,
+                    LIBJITSI_WEBRTC_AEC_METRIC_PROCESS_SUM_MICROS,
+                    processMicros);
+            if(processMicros
+                    > aec->metrics[LIBJITSI_WEBRTC_AEC_METRIC_PROCESS_MAX_MICROS])
+            {
+                LibJitsi_WebRTC_AEC_setMetric(
+                        aec,
+                        LIBJITSI_WEBRTC_AEC_METRIC_PROCESS_MAX_MICROS,
+                        processMicros);
             }
 
             start_render = end_render;
             end_render += aec->audioProcessingLength;
         }
+        else
+        {
+            LibJitsi_WebRTC_AEC_addMetric(
+                    aec,
+                    LIBJITSI_WEBRTC_AEC_METRIC_STARVED_BLOCKS,
+                    1);
+        }
         start_capture = end_capture;
         end_capture += aec->audioProcessingLength;
+
+        int renderFillMs
+            = LibJitsi_WebRTC_AEC_getNbMsForSample(
+                    aec,
+                    aec->dataUsed[1] - start_render);
+        LibJitsi_WebRTC_AEC_setMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_CAPTURE_FILL_MS,
+                LibJitsi_WebRTC_AEC_getNbMsForSample(
+                        aec,
+                        aec->dataUsed[0] - start_capture));
+        LibJitsi_WebRTC_AEC_setMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_RENDER_FILL_MS,
+                renderFillMs);
+        if(renderFillMs
+                > aec->metrics[LIBJITSI_WEBRTC_AEC_METRIC_RENDER_FILL_MAX_MS])
+        {
+            LibJitsi_WebRTC_AEC_setMetric(
+                    aec,
+                    LIBJITSI_WEBRTC_AEC_METRIC_RENDER_FILL_MAX_MS,
+                    renderFillMs);
+        }
+
+        // Refreshes the metrics of WebRTC every second.
+        if(aec->metrics[LIBJITSI_WEBRTC_AEC_METRIC_BLOCKS]
+                - aec->refreshBlocks >= 100)
+        {
+            LibJitsi_WebRTC_AEC_refreshMetrics(aec);
+        }
     }
     aec->dataProcessed[0] = start_capture;
     aec->dataProcessed[1] = start_render;
@@ -532,6 +644,7 @@ LibJitsi_WebRTC_AEC_getData(
         return NULL;
     }
     aec->dataUsed[isRenderStream] += length;
+    aec->samples[isRenderStream] += length;
 
     if(!timerisset(&aec->lastProcess[isRenderStream]))
     {
@@ -642,7 +755,9 @@ LibJitsi_WebRTC_AEC_getProcessedData(LibJitsi_WebRTC_AEC *aec)
 }
 
 /**
- * Logs the corresponding error message.
+ * Logs the corresponding error message. The message is passed to the Java
+ * logger asynchronously and rate limited, as the errors of the processing are
+ * logged from the audio threads for every buffer.
  *
  * @param format The format of the error message.
  * @param ... The list of variable specified in the format argument.
@@ -653,7 +768,11 @@ LibJitsi_WebRTC_AEC_log(const char * format, ...)
     va_list args;
 
     va_start(args, format);
-    vfprintf(stderr, format, args);
+    NativeLog_vlog(
+            "org.jitsi.impl.neomedia.device.MacCoreAudioDevice",
+            NATIVE_LOG_ERROR,
+            format,
+            args);
     va_end(args);
 }
 
@@ -814,3 +933,115 @@ LibJitsi_WebRTC_AEC_getNbSampleSinceLastProcess(
     }
     return nbSample;
 }
+
+/**
+ * Adds to a metric so that it may be read without the locks.
+ *
+ * @param index The index of the metric.
+ * @param value The value to add.
+ */
+void
+LibJitsi_WebRTC_AEC_addMetric(
+        LibJitsi_WebRTC_AEC *aec,
+        int index,
+        int64_t value)
+{
+    __atomic_fetch_add(aec->metrics + index, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Sets a metric so that it may be read without the locks.
+ *
+ * @param index The index of the metric.
+ * @param value The new value of the metric.
+ */
+void
+LibJitsi_WebRTC_AEC_setMetric(
+        LibJitsi_WebRTC_AEC *aec,
+        int index,
+        int64_t value)
+{
+    __atomic_store_n(aec->metrics + index, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Refreshes the metrics computed by WebRTC, which aggregates them over a
+ * second, and the drift of the render clock, estimated from the samples
+ * received from each stream since the previous refresh. Called with both
+ * locks held.
+ */
+void
+LibJitsi_WebRTC_AEC_refreshMetrics(LibJitsi_WebRTC_AEC *aec)
+{
+    webrtc::EchoCancellation *echoCancellation
+        = aec->audioProcessing->echo_cancellation();
+    webrtc::EchoCancellation::Metrics metrics;
+    int median, std;
+
+    if(echoCancellation->GetMetrics(&metrics)
+            == webrtc::AudioProcessing::kNoError)
+    {
+        LibJitsi_WebRTC_AEC_setMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_ERL_DB,
+                metrics.echo_return_loss.average);
+        LibJitsi_WebRTC_AEC_setMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_ERLE_DB,
+                metrics.echo_return_loss_enhancement.average);
+    }
+    if(echoCancellation->GetDelayMetrics(&median, &std)
+            == webrtc::AudioProcessing::kNoError)
+    {
+        LibJitsi_WebRTC_AEC_setMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_DELAY_MEDIAN_MS,
+                median);
+        LibJitsi_WebRTC_AEC_setMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_DELAY_STD_MS,
+                std);
+    }
+
+    int64_t capture = aec->samples[0] - aec->refreshSamples[0];
+    int64_t render = aec->samples[1] - aec->refreshSamples[1];
+
+    // Both streams run at the rate of the AEC, so a difference in the samples
+    // they deliver is the drift of their clocks. A window without render is
+    // not an estimate.
+    if(capture > 0 && render > 0)
+    {
+        double driftPpm = (render - capture) * 1000000.0 / capture;
+
+        aec->driftPpm += (driftPpm - aec->driftPpm) / 8;
+        LibJitsi_WebRTC_AEC_setMetric(
+                aec,
+                LIBJITSI_WEBRTC_AEC_METRIC_DRIFT_PPM,
+                (int64_t) lround(aec->driftPpm));
+    }
+    aec->refreshSamples[0] = aec->samples[0];
+    aec->refreshSamples[1] = aec->samples[1];
+    aec->refreshBlocks = aec->metrics[LIBJITSI_WEBRTC_AEC_METRIC_BLOCKS];
+}
+
+/**
+ * Copies the quality and cost metrics of the AEC, as indexed by the
+ * LIBJITSI_WEBRTC_AEC_METRIC_ constants. May be called from any thread.
+ *
+ * @param values The array to fill.
+ * @param length The length of the array.
+ *
+ * @return The number of values filled.
+ */
+int
+LibJitsi_WebRTC_AEC_getMetrics(
+        LibJitsi_WebRTC_AEC *aec,
+        int64_t *values,
+        int length)
+{
+    if(length > LIBJITSI_WEBRTC_AEC_METRIC_LENGTH)
+        length = LIBJITSI_WEBRTC_AEC_METRIC_LENGTH;
+    for(int i = 0; i < length; ++i)
+        values[i] = __atomic_load_n(aec->metrics + i, __ATOMIC_RELAXED);
+    return length;
+}
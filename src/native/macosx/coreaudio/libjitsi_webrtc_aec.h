@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 #ifndef LibJitsi_WebRTC_AEC_h
 #define LibJitsi_WebRTC_AEC_h
 
@@ -23,6 +24,41 @@ extern "C"
 
 typedef struct _LibJitsi_WebRTC_AEC LibJitsi_WebRTC_AEC;
 
+/**
+ * The indexes of the quality and cost metrics of an AEC instance in a
+ * snapshot. The values of WebRTC (ERL, ERLE and the delay metrics) are
+ * refreshed every second, the others for every 10 ms block.
+ */
+enum
+{
+    /* The 10 ms capture blocks processed. */
+    LIBJITSI_WEBRTC_AEC_METRIC_BLOCKS = 0,
+    /* The blocks in which WebRTC has detected echo. */
+    LIBJITSI_WEBRTC_AEC_METRIC_ECHO_BLOCKS,
+    /* The capture blocks passed through without render data to cancel. */
+    LIBJITSI_WEBRTC_AEC_METRIC_STARVED_BLOCKS,
+    /* The average echo return loss and its enhancement in dB. */
+    LIBJITSI_WEBRTC_AEC_METRIC_ERL_DB,
+    LIBJITSI_WEBRTC_AEC_METRIC_ERLE_DB,
+    /* The delay passed to WebRTC with each block. */
+    LIBJITSI_WEBRTC_AEC_METRIC_DELAY_MS,
+    /* The delay estimated by WebRTC and its standard deviation. */
+    LIBJITSI_WEBRTC_AEC_METRIC_DELAY_MEDIAN_MS,
+    LIBJITSI_WEBRTC_AEC_METRIC_DELAY_STD_MS,
+    /* The drift of the render clock from the capture clock (smoothed). */
+    LIBJITSI_WEBRTC_AEC_METRIC_DRIFT_PPM,
+    /* The time spent by WebRTC on the blocks. */
+    LIBJITSI_WEBRTC_AEC_METRIC_PROCESS_SUM_MICROS,
+    LIBJITSI_WEBRTC_AEC_METRIC_PROCESS_MAX_MICROS,
+    /* The audio left in the buffers after processing. */
+    LIBJITSI_WEBRTC_AEC_METRIC_CAPTURE_FILL_MS,
+    LIBJITSI_WEBRTC_AEC_METRIC_RENDER_FILL_MS,
+    LIBJITSI_WEBRTC_AEC_METRIC_RENDER_FILL_MAX_MS,
+    /* The webrtc::EchoCancellation::SuppressionLevel in use. */
+    LIBJITSI_WEBRTC_AEC_METRIC_SUPPRESSION_LEVEL,
+    LIBJITSI_WEBRTC_AEC_METRIC_LENGTH
+};
+
 LibJitsi_WebRTC_AEC *LibJitsi_WebRTC_AEC_init();
 
 void LibJitsi_WebRTC_AEC_free(LibJitsi_WebRTC_AEC *aec);
@@ -59,6 +95,12 @@ LibJitsi_WebRTC_AEC_getCaptureFormat(
         LibJitsi_WebRTC_AEC *aec,
         AudioStreamBasicDescription *format);
 
+int
+LibJitsi_WebRTC_AEC_getMetrics(
+        LibJitsi_WebRTC_AEC *aec,
+        int64_t *values,
+        int length);
+
 int LibJitsi_WebRTC_AEC_lock(LibJitsi_WebRTC_AEC *aec, int isRenderStream);
 
 int LibJitsi_WebRTC_AEC_unlock(LibJitsi_WebRTC_AEC *aec, int isRenderStream);
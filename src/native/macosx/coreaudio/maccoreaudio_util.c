@@ -9,6 +9,7 @@
 #include "MacCoreaudio_util.h"
 
 #include "device.h"
+#include "../../log/native_log.h"
 
 #include <string.h>
 
@@ -69,6 +70,7 @@ JNIEXPORT jint JNICALL
 JNI_OnLoad(JavaVM *vm, void *pvt)
 {
     MacCoreaudio_VM = vm;
+    NativeLog_start(vm);
     MacCoreaudio_log("MacCoreAudio_util: JNI loaded");
     MacCoreaudio_initHotplug();
     return JNI_VERSION_1_6;
@@ -79,6 +81,7 @@ JNI_OnUnload(JavaVM *vm, void *pvt)
 {
     MacCoreaudio_log("MacCoreAudio_util: JNI unloading");
     MacCoreaudio_freeHotplug();
+    NativeLog_stop();
     MacCoreaudio_VM = NULL;
 }
 
@@ -287,7 +290,9 @@ EXIT_LABEL:
 }
 
 /**
- * Logs the corresponding error message.
+ * Logs the corresponding error message. The message is passed to the Java
+ * logger asynchronously so that this may be called from the real-time threads
+ * of CoreAudio.
  *
  * @param error_format The format of the error message.
  * @param ... The list of variable specified in the format argument.
@@ -296,40 +301,14 @@ void MacCoreaudio_log(
         const char * error_format,
         ...)
 {
-	ATTACH();
-
-    if(!envAttached)
-    {
-		return;
-	}
-		
-	jclass clazz = (*env)->FindClass(
-			env,
-			"org/jitsi/impl/neomedia/device/CoreAudioDevice");
-	if (clazz)
-	{
-		jmethodID methodID
-			= (*env)->GetStaticMethodID(env, clazz, "log", "([B)V");
-
-		int error_length = 2048;
-		char error[error_length];
-		va_list arg;
-		va_start (arg, error_format);
-		vsnprintf(error, error_length, error_format, arg);
-		va_end (arg);
-
-		int str_len = strlen(error);
-		jbyteArray bufferBytes = (*env)->NewByteArray(env, str_len);
-		(*env)->SetByteArrayRegion(
-				env,
-				bufferBytes,
-				0,
-				str_len,
-				(jbyte *) error);
-
-		(*env)->CallStaticVoidMethod(env, clazz, methodID, bufferBytes);
-    }
-	
-	DETACH();
+    va_list arg;
+
+    va_start(arg, error_format);
+    NativeLog_vlog(
+            "org.jitsi.impl.neomedia.device.CoreAudioDevice",
+            NATIVE_LOG_INFO,
+            error_format,
+            arg);
+    va_end(arg);
 }
 
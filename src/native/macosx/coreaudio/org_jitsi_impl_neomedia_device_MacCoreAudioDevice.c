@@ -9,6 +9,7 @@
 #include "org_jitsi_impl_neomedia_device_MacCoreAudioDevice.h"
 
 #include "device.h"
+#include "latency_trace.h"
 #include "MacCoreaudio_util.h"
 
 /**
@@ -294,3 +295,68 @@ Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_countOutputChannels
 
     return nbChannels;
 }
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_getStreamAECMetrics
+  (JNIEnv *env, jclass clazz, jlong streamPtr, jlongArray values)
+{
+    MacCoreaudio_Stream * stream = (MacCoreaudio_Stream*) (long) streamPtr;
+    jlong valuesPtr[LIBJITSI_WEBRTC_AEC_METRIC_LENGTH];
+    jint length = (*env)->GetArrayLength(env, values);
+
+    // Only capture streams with echo cancellation have an AEC.
+    if(stream->aec == NULL)
+    {
+        return 0;
+    }
+    length
+        = LibJitsi_WebRTC_AEC_getMetrics(
+                stream->aec,
+                (int64_t *) valuesPtr,
+                length);
+    (*env)->SetLongArrayRegion(env, values, 0, length, valuesPtr);
+
+    return length;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_getStreamIOHealth
+  (JNIEnv *env, jclass clazz, jlong streamPtr, jlongArray values)
+{
+    MacCoreaudio_Stream * stream = (MacCoreaudio_Stream*) (long) streamPtr;
+    jlong valuesPtr[AUDIO_IO_HEALTH_LENGTH];
+    jint length = (*env)->GetArrayLength(env, values);
+
+    length
+        = AudioIOHealth_snapshot(
+                &stream->health,
+                (int64_t *) valuesPtr,
+                length);
+    (*env)->SetLongArrayRegion(env, values, 0, length, valuesPtr);
+
+    return length;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_getStreamLatencySnapshot
+  (JNIEnv *env, jclass clazz, jlong streamPtr, jlongArray values,
+   jboolean reset)
+{
+    MacCoreaudio_Stream * stream = (MacCoreaudio_Stream*) (long) streamPtr;
+    jlong valuesPtr[LATENCY_STAGE_COUNT * LATENCY_TRACE_STAGE_LENGTH];
+    jint length = (*env)->GetArrayLength(env, values);
+
+    if(length > LATENCY_STAGE_COUNT * LATENCY_TRACE_STAGE_LENGTH)
+    {
+        length = LATENCY_STAGE_COUNT * LATENCY_TRACE_STAGE_LENGTH;
+    }
+    length
+        = LatencyTrace_snapshot(
+                &stream->latency,
+                (int64_t *) valuesPtr,
+                length,
+                reset);
+    (*env)->SetLongArrayRegion(env, values, 0, length, valuesPtr);
+
+    return length;
+}
@@ -121,6 +121,30 @@ JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_co
 JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_countOutputChannels
   (JNIEnv *, jclass, jstring);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_device_MacCoreAudioDevice
+ * Method:    getStreamAECMetrics
+ * Signature: (J[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_getStreamAECMetrics
+  (JNIEnv *, jclass, jlong, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_device_MacCoreAudioDevice
+ * Method:    getStreamIOHealth
+ * Signature: (J[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_getStreamIOHealth
+  (JNIEnv *, jclass, jlong, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_device_MacCoreAudioDevice
+ * Method:    getStreamLatencySnapshot
+ * Signature: (J[JZ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_device_MacCoreAudioDevice_getStreamLatencySnapshot
+  (JNIEnv *, jclass, jlong, jlongArray, jboolean);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,12 +4,28 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 
 #include "org_jitsi_impl_neomedia_codec_audio_opus_Opus.h"
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <opus.h>
 
+/**
+ * The PCM of an incomplete frame which is to be completed by the input of
+ * subsequent calls to <tt>encode_accumulated</tt> before it is encoded.
+ */
+typedef struct
+{
+    /** The size in bytes of <tt>pcm</tt>. */
+    jint capacity;
+    /** The number of bytes of <tt>pcm</tt> accumulated so far. */
+    jint length;
+    unsigned char pcm[];
+} FrameAccumulator;
+
 JNIEXPORT jint JNICALL
 Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decode
     (JNIEnv *env, jclass clazz, jlong decoder, jbyteArray input,
@@ -161,13 +177,91 @@ Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encode
     return ret;
 }
 
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encode_1accumulated
+    (JNIEnv *env, jclass clazz, jlong encoder, jlong accumulator,
+        jbyteArray input, jint inputOffset, jint inputLength,
+        jint inputFrameSize, jint channels, jbyteArray output,
+        jint outputOffset, jint outputLength)
+{
+    FrameAccumulator *acc = (FrameAccumulator *) (intptr_t) accumulator;
+    jint frameSizeInBytes = inputFrameSize * channels * sizeof(opus_int16);
+    jbyte *input_;
+    const unsigned char *pcm;
+    jint accumulated;
+    int ret;
+
+    if (!input || !output || !acc || (frameSizeInBytes > acc->capacity))
+        return OPUS_BAD_ARG;
+    /* The frame size has shrunk below what has been accumulated. */
+    if (acc->length >= frameSizeInBytes)
+        acc->length = 0;
+
+    input_ = (*env)->GetPrimitiveArrayCritical(env, input, 0);
+    if (!input_)
+        return OPUS_ALLOC_FAIL;
+
+    accumulated = acc->length;
+    if (!acc->length && (inputLength >= frameSizeInBytes))
+    {
+        /* A whole frame is in the input so it is encoded from there. */
+        pcm = (const unsigned char *) (input_ + inputOffset);
+    }
+    else
+    {
+        jint n = frameSizeInBytes - acc->length;
+
+        if (n > inputLength)
+            n = inputLength;
+        memcpy(acc->pcm + acc->length, input_ + inputOffset, n);
+        acc->length += n;
+        if (acc->length == frameSizeInBytes)
+        {
+            acc->length = 0;
+            pcm = acc->pcm;
+        }
+        else
+            pcm = NULL;
+    }
+
+    if (pcm)
+    {
+        jbyte *output_ = (*env)->GetPrimitiveArrayCritical(env, output, 0);
+
+        if (output_)
+        {
+            ret
+                = opus_encode(
+                        (OpusEncoder *) (intptr_t) encoder,
+                        (const opus_int16 *) pcm,
+                        inputFrameSize,
+                        (unsigned char *) (output_ + outputOffset),
+                        outputLength);
+            (*env)->ReleasePrimitiveArrayCritical(env, output, output_, 0);
+        }
+        else
+            ret = OPUS_ALLOC_FAIL;
+        /*
+         * The frame which failed to be encoded stays accumulated as it was
+         * so that the caller's count of the accumulated bytes, which only
+         * advances on success, remains in sync.
+         */
+        if (ret < 0)
+            acc->length = accumulated;
+    }
+    else
+        ret = 0;
+    (*env)->ReleasePrimitiveArrayCritical(env, input, input_, JNI_ABORT);
+    return ret;
+}
+
 JNIEXPORT jlong JNICALL
 Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1create
-    (JNIEnv *env, jclass clazz, jint Fs, jint channels)
+    (JNIEnv *env, jclass clazz, jint Fs, jint channels, jint application)
 {
     int error;
     OpusEncoder *encoder
-        = opus_encoder_create(Fs, channels, OPUS_APPLICATION_VOIP, &error);
+        = opus_encoder_create(Fs, channels, application, &error);
 
     if (OPUS_OK != error)
         encoder = 0;
@@ -382,6 +476,30 @@ Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1set_1vbr_1constraint
                 OPUS_SET_VBR_CONSTRAINT(x));
 }
 
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_frame_1accumulator_1create
+    (JNIEnv *env, jclass clazz, jint capacity)
+{
+    FrameAccumulator *acc;
+
+    if (capacity <= 0)
+        return 0;
+    acc = malloc(sizeof(FrameAccumulator) + capacity);
+    if (acc)
+    {
+        acc->capacity = capacity;
+        acc->length = 0;
+    }
+    return (jlong) (intptr_t) acc;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_frame_1accumulator_1destroy
+    (JNIEnv *env, jclass clazz, jlong accumulator)
+{
+    free((FrameAccumulator *) (intptr_t) accumulator);
+}
+
 JNIEXPORT jint JNICALL
 Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_packet_1get_1bandwidth
     (JNIEnv *env, jclass clazz, jbyteArray data, jint offset)
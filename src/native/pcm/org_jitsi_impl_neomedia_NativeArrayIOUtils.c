@@ -0,0 +1,116 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_impl_neomedia_NativeArrayIOUtils.h"
+
+#include <stdint.h>
+
+#include "pcm_convert.h"
+
+/*
+ * The offsets and counts are checked in Java. The arrays are accessed with
+ * GetPrimitiveArrayCritical because the conversions are short and do not call
+ * back into the JVM. A failure to get an array, which leaves an
+ * OutOfMemoryError pending, leaves the output as it was.
+ */
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int16SumOfSquares
+    (JNIEnv *env, jclass clazz, jbyteArray in, jint inOffset, jint count)
+{
+    jbyte *in_ = (*env)->GetPrimitiveArrayCritical(env, in, NULL);
+    jlong sum = 0;
+
+    if (in_)
+    {
+        sum
+            = (jlong)
+                PCM_int16SumOfSquares(
+                        (const uint8_t *) (in_ + inOffset),
+                        count);
+        (*env)->ReleasePrimitiveArrayCritical(env, in, in_, JNI_ABORT);
+    }
+    return sum;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int16ToInt32
+    (JNIEnv *env, jclass clazz,
+        jbyteArray in, jint inOffset,
+        jintArray out, jint outOffset,
+        jint count)
+{
+    jbyte *in_ = (*env)->GetPrimitiveArrayCritical(env, in, NULL);
+
+    if (in_)
+    {
+        jint *out_ = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+
+        if (out_)
+        {
+            PCM_int16ToInt32(
+                    (const uint8_t *) (in_ + inOffset),
+                    (int32_t *) (out_ + outOffset),
+                    count);
+            (*env)->ReleasePrimitiveArrayCritical(env, out, out_, 0);
+        }
+        (*env)->ReleasePrimitiveArrayCritical(env, in, in_, JNI_ABORT);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int32Mix
+    (JNIEnv *env, jclass clazz,
+        jintArray in, jint inOffset,
+        jintArray out, jint outOffset,
+        jint count,
+        jint maxSample)
+{
+    jint *in_ = (*env)->GetPrimitiveArrayCritical(env, in, NULL);
+
+    if (in_)
+    {
+        jint *out_ = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+
+        if (out_)
+        {
+            PCM_int32Mix(
+                    (const int32_t *) (in_ + inOffset),
+                    (int32_t *) (out_ + outOffset),
+                    count,
+                    maxSample);
+            (*env)->ReleasePrimitiveArrayCritical(env, out, out_, 0);
+        }
+        (*env)->ReleasePrimitiveArrayCritical(env, in, in_, JNI_ABORT);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int32ToInt16
+    (JNIEnv *env, jclass clazz,
+        jintArray in, jint inOffset,
+        jbyteArray out, jint outOffset,
+        jint count)
+{
+    jint *in_ = (*env)->GetPrimitiveArrayCritical(env, in, NULL);
+
+    if (in_)
+    {
+        jbyte *out_ = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+
+        if (out_)
+        {
+            PCM_int32ToInt16(
+                    (const int32_t *) (in_ + inOffset),
+                    (uint8_t *) (out_ + outOffset),
+                    count);
+            (*env)->ReleasePrimitiveArrayCritical(env, out, out_, 0);
+        }
+        (*env)->ReleasePrimitiveArrayCritical(env, in, in_, JNI_ABORT);
+    }
+}
@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_NativeArrayIOUtils */
+
+#ifndef _Included_org_jitsi_impl_neomedia_NativeArrayIOUtils
+#define _Included_org_jitsi_impl_neomedia_NativeArrayIOUtils
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_impl_neomedia_NativeArrayIOUtils
+ * Method:    int16SumOfSquares
+ * Signature: ([BII)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int16SumOfSquares
+  (JNIEnv *, jclass, jbyteArray, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_NativeArrayIOUtils
+ * Method:    int16ToInt32
+ * Signature: ([BI[III)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int16ToInt32
+  (JNIEnv *, jclass, jbyteArray, jint, jintArray, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_NativeArrayIOUtils
+ * Method:    int32Mix
+ * Signature: ([II[IIII)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int32Mix
+  (JNIEnv *, jclass, jintArray, jint, jintArray, jint, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_NativeArrayIOUtils
+ * Method:    int32ToInt16
+ * Signature: ([II[BII)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_NativeArrayIOUtils_int32ToInt16
+  (JNIEnv *, jclass, jintArray, jint, jbyteArray, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
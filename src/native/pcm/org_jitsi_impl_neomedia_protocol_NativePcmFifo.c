@@ -0,0 +1,106 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_impl_neomedia_protocol_NativePcmFifo.h"
+
+#include <stdint.h>
+
+#include "pcm_fifo.h"
+
+#define STATS_LENGTH 6
+
+/*
+ * The offsets and lengths are checked in Java. The arrays are accessed with
+ * GetPrimitiveArrayCritical because the copies are short and neither block
+ * nor call back into the JVM.
+ */
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_create
+    (JNIEnv *env, jclass clazz, jint capacity, jint frameSize)
+{
+    if ((capacity < 1) || (frameSize < 1))
+        return 0;
+    return (jlong) (intptr_t) PcmFifo_create(capacity, frameSize);
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_destroy
+    (JNIEnv *env, jclass clazz, jlong fifo)
+{
+    PcmFifo_destroy((PcmFifo *) (intptr_t) fifo);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_getFill
+    (JNIEnv *env, jclass clazz, jlong fifo)
+{
+    return (jint) PcmFifo_getFill((PcmFifo *) (intptr_t) fifo);
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_getStats
+    (JNIEnv *env, jclass clazz, jlong fifo, jlongArray stats)
+{
+    PcmFifoStats s;
+    jlong stats_[STATS_LENGTH];
+
+    PcmFifo_getStats((PcmFifo *) (intptr_t) fifo, &s);
+    stats_[0] = s.bytesWritten;
+    stats_[1] = s.bytesRead;
+    stats_[2] = s.bytesDropped;
+    stats_[3] = s.overflows;
+    stats_[4] = s.underruns;
+    stats_[5] = s.maxFill;
+    (*env)->SetLongArrayRegion(env, stats, 0, STATS_LENGTH, stats_);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_read
+    (JNIEnv *env, jclass clazz, jlong fifo, jbyteArray out, jint offset,
+        jint length, jlongArray position)
+{
+    jbyte *out_ = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    size_t read;
+    uint64_t position_ = 0;
+
+    if (!out_)
+        return 0;
+    read
+        = PcmFifo_read(
+                (PcmFifo *) (intptr_t) fifo,
+                (uint8_t *) (out_ + offset), length,
+                &position_);
+    (*env)->ReleasePrimitiveArrayCritical(env, out, out_, 0);
+    if (read)
+    {
+        jlong jposition = (jlong) position_;
+
+        (*env)->SetLongArrayRegion(env, position, 0, 1, &jposition);
+    }
+    return (jint) read;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_write
+    (JNIEnv *env, jclass clazz, jlong fifo, jbyteArray in, jint offset,
+        jint length, jint limit)
+{
+    jbyte *in_ = (*env)->GetPrimitiveArrayCritical(env, in, NULL);
+    size_t dropped;
+
+    if (!in_)
+        return 0;
+    dropped
+        = PcmFifo_write(
+                (PcmFifo *) (intptr_t) fifo,
+                (const uint8_t *) (in_ + offset), length,
+                limit);
+    (*env)->ReleasePrimitiveArrayCritical(env, in, in_, JNI_ABORT);
+    return (jint) dropped;
+}
@@ -0,0 +1,61 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_protocol_NativePcmFifo */
+
+#ifndef _Included_org_jitsi_impl_neomedia_protocol_NativePcmFifo
+#define _Included_org_jitsi_impl_neomedia_protocol_NativePcmFifo
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_impl_neomedia_protocol_NativePcmFifo
+ * Method:    create
+ * Signature: (II)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_create
+  (JNIEnv *, jclass, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_protocol_NativePcmFifo
+ * Method:    destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_destroy
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_protocol_NativePcmFifo
+ * Method:    getFill
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_getFill
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_protocol_NativePcmFifo
+ * Method:    getStats
+ * Signature: (J[J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_getStats
+  (JNIEnv *, jclass, jlong, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_protocol_NativePcmFifo
+ * Method:    read
+ * Signature: (J[BII[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_read
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_protocol_NativePcmFifo
+ * Method:    write
+ * Signature: (J[BIII)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_protocol_NativePcmFifo_write
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "pcm_convert.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PCM_HAVE_NEON
+#endif
+
+/*
+ * The SIMD loops handle the samples by blocks and leave the remainder to the
+ * scalar loops, which are also the whole implementation elsewhere.
+ */
+
+static inline int PCM_load(const uint8_t *p)
+{
+    return (int16_t) (p[0] | (p[1] << 8));
+}
+
+static inline void PCM_store(uint8_t *p, int sample)
+{
+    p[0] = (uint8_t) sample;
+    p[1] = (uint8_t) (sample >> 8);
+}
+
+static inline int PCM_saturate(int32_t sample)
+{
+    if (sample > INT16_MAX)
+        return INT16_MAX;
+    if (sample < INT16_MIN)
+        return INT16_MIN;
+    return sample;
+}
+
+void PCM_int16ToInt32(const uint8_t *in, int32_t *out, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *) (in + 2 * i));
+
+        /* Sign extend by unpacking into the high halves and shifting. */
+        _mm_storeu_si128(
+                (__m128i *) (out + i),
+                _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16));
+        _mm_storeu_si128(
+                (__m128i *) (out + i + 4),
+                _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16));
+    }
+#elif defined(PCM_HAVE_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t a = vreinterpretq_s16_u8(vld1q_u8(in + 2 * i));
+
+        vst1q_s32(out + i, vmovl_s16(vget_low_s16(a)));
+        vst1q_s32(out + i + 4, vmovl_s16(vget_high_s16(a)));
+    }
+#endif
+    for (; i < count; i++)
+        out[i] = PCM_load(in + 2 * i);
+}
+
+void PCM_int32ToInt16(const int32_t *in, uint8_t *out, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (in + i + 4));
+
+        /* packssdw saturates. */
+        _mm_storeu_si128((__m128i *) (out + 2 * i), _mm_packs_epi32(a, b));
+    }
+#elif defined(PCM_HAVE_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t a
+            = vcombine_s16(
+                    vqmovn_s32(vld1q_s32(in + i)),
+                    vqmovn_s32(vld1q_s32(in + i + 4)));
+
+        vst1q_u8(out + 2 * i, vreinterpretq_u8_s16(a));
+    }
+#endif
+    for (; i < count; i++)
+        PCM_store(out + 2 * i, PCM_saturate(in[i]));
+}
+
+uint64_t PCM_int16SumOfSquares(const uint8_t *in, size_t count)
+{
+    uint64_t sum = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t lanes[2];
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *) (in + 2 * i));
+        /*
+         * pmaddwd sums the squares of pairs of samples. The sum of a pair
+         * fits in 32 unsigned bits, so it is zero extended to 64 bits.
+         */
+        __m128i squares = _mm_madd_epi16(a, a);
+
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(squares, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(squares, zero));
+    }
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    sum = lanes[0] + lanes[1];
+#elif defined(PCM_HAVE_NEON)
+    uint64x2_t acc = vdupq_n_u64(0);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t a = vreinterpretq_s16_u8(vld1q_u8(in + 2 * i));
+        int16x4_t lo = vget_low_s16(a);
+        int16x4_t hi = vget_high_s16(a);
+
+        acc = vpadalq_u32(acc, vreinterpretq_u32_s32(vmull_s16(lo, lo)));
+        acc = vpadalq_u32(acc, vreinterpretq_u32_s32(vmull_s16(hi, hi)));
+    }
+    sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#endif
+    for (; i < count; i++)
+    {
+        int sample = PCM_load(in + 2 * i);
+
+        sum += (uint64_t) (sample * sample);
+    }
+    return sum;
+}
+
+void PCM_int32Mix(
+        const int32_t *in, int32_t *out, size_t count,
+        int32_t maxSample)
+{
+    float max = (float) maxSample;
+    size_t i = 0;
+
+    /*
+     * Math.round(float) is floor(x + 0.5) without the rounding of the sum,
+     * so it is computed as floor(x) plus one if the fraction is at least 0.5.
+     * The fraction is exact because x is within 2^23.
+     */
+#if defined(__SSE2__)
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 max_ = _mm_set1_ps(max);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (out + i));
+        __m128 x
+            = _mm_mul_ps(
+                    _mm_cvtepi32_ps(a),
+                    _mm_div_ps(_mm_cvtepi32_ps(b), max_));
+        /* SSE2 has no floor so truncate and step down the negatives. */
+        __m128i whole = _mm_cvttps_epi32(x);
+        __m128 wholef;
+        __m128i rounded;
+
+        whole
+            = _mm_add_epi32(
+                    whole,
+                    _mm_castps_si128(
+                            _mm_cmpgt_ps(_mm_cvtepi32_ps(whole), x)));
+        wholef = _mm_cvtepi32_ps(whole);
+        rounded
+            = _mm_add_epi32(
+                    whole,
+                    _mm_and_si128(
+                            _mm_castps_si128(
+                                    _mm_cmpge_ps(_mm_sub_ps(x, wholef), half)),
+                            one));
+        _mm_storeu_si128(
+                (__m128i *) (out + i),
+                _mm_sub_epi32(_mm_add_epi32(a, b), rounded));
+    }
+#elif defined(PCM_HAVE_NEON) && defined(__aarch64__)
+    /* ARMv7 NEON has neither the division nor the floor. */
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float32x4_t max_ = vdupq_n_f32(max);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        int32x4_t a = vld1q_s32(in + i);
+        int32x4_t b = vld1q_s32(out + i);
+        float32x4_t x
+            = vmulq_f32(vcvtq_f32_s32(a), vdivq_f32(vcvtq_f32_s32(b), max_));
+        float32x4_t wholef = vrndmq_f32(x);
+        /* The comparison yields -1 where the fraction is at least 0.5. */
+        uint32x4_t up = vcgeq_f32(vsubq_f32(x, wholef), half);
+        int32x4_t rounded
+            = vsubq_s32(vcvtq_s32_f32(wholef), vreinterpretq_s32_u32(up));
+
+        vst1q_s32(out + i, vsubq_s32(vaddq_s32(a, b), rounded));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float x = in[i] * (out[i] / max);
+        float wholef = (float) (int32_t) x;
+        int32_t rounded;
+
+        if (wholef > x)
+            wholef -= 1;
+        rounded = (int32_t) wholef;
+        if (x - wholef >= 0.5f)
+            rounded++;
+        out[i] = in[i] + out[i] - rounded;
+    }
+}
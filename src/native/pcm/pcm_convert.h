@@ -0,0 +1,40 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNMEDIA_PCM_CONVERT_H_
+#define _JNMEDIA_PCM_CONVERT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Bulk conversions of 16-bit PCM. The byte arrays hold little-endian samples,
+ * as the Java media stack does. The arrays need not be aligned. Counts are in
+ * samples (of all channels).
+ */
+
+/** Widens samples to int32. */
+void PCM_int16ToInt32(const uint8_t *in, int32_t *out, size_t count);
+
+/** Narrows int32 samples, saturating those out of the int16 range. */
+void PCM_int32ToInt16(const int32_t *in, uint8_t *out, size_t count);
+
+/** Gets the sum of the squares of samples, e.g. to compute their RMS. */
+uint64_t PCM_int16SumOfSquares(const uint8_t *in, size_t count);
+
+/**
+ * Mixes int32 samples into others as the Java audio mixer does, i.e. each out
+ * sample becomes <tt>in + out - round(in * (out / (float) maxSample))</tt>
+ * with the rounding of <tt>Math.round(float)</tt>. The samples and the mixes
+ * must be within +/-2^23 for the SIMD loops to round as Java does.
+ */
+void PCM_int32Mix(
+        const int32_t *in, int32_t *out, size_t count,
+        int32_t maxSample);
+
+#endif /* #ifndef _JNMEDIA_PCM_CONVERT_H_ */
@@ -0,0 +1,266 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "pcm_fifo.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PCM_FIFO_CACHE_LINE 64
+
+/*
+ * The positions count bytes since the creation of the FIFO so they never wrap
+ * in practice and an unchanged readPosition means that no bytes have been
+ * consumed or dropped in the meantime.
+ *
+ * The producer owns writePosition. readPosition is advanced by the consumer
+ * after it has copied the bytes out and by the producer when it drops the
+ * oldest bytes, both with a compare-and-swap. The producer advances it before
+ * it overwrites the dropped bytes so a consumer which has copied bytes that
+ * were being overwritten fails its compare-and-swap and reads again.
+ */
+struct PcmFifo
+{
+    uint8_t *data;
+    size_t capacity;
+    size_t frameSize;
+
+    uint64_t writePosition;
+    /* Written by the producer only. */
+    uint64_t bytesWritten;
+    uint64_t bytesDropped;
+    uint64_t overflows;
+    uint64_t maxFill;
+
+    char pad0[PCM_FIFO_CACHE_LINE];
+
+    uint64_t readPosition;
+    /* Written by the consumer only. */
+    uint64_t bytesRead;
+    uint64_t underruns;
+
+    char pad1[PCM_FIFO_CACHE_LINE];
+};
+
+static void
+PcmFifo_add(uint64_t *counter, uint64_t value)
+{
+    __atomic_store_n(
+            counter,
+            __atomic_load_n(counter, __ATOMIC_RELAXED) + value,
+            __ATOMIC_RELAXED);
+}
+
+PcmFifo *
+PcmFifo_create(size_t capacity, size_t frameSize)
+{
+    PcmFifo *fifo;
+
+    if (frameSize < 1)
+        return NULL;
+    capacity -= capacity % frameSize;
+    if (capacity < 1)
+        return NULL;
+
+    fifo = calloc(1, sizeof(PcmFifo));
+    if (fifo)
+    {
+        fifo->data = malloc(capacity);
+        if (fifo->data)
+        {
+            fifo->capacity = capacity;
+            fifo->frameSize = frameSize;
+        }
+        else
+        {
+            free(fifo);
+            fifo = NULL;
+        }
+    }
+    return fifo;
+}
+
+void
+PcmFifo_destroy(PcmFifo *fifo)
+{
+    free(fifo->data);
+    free(fifo);
+}
+
+size_t
+PcmFifo_getFill(PcmFifo *fifo)
+{
+    uint64_t readPosition
+        = __atomic_load_n(&(fifo->readPosition), __ATOMIC_ACQUIRE);
+    uint64_t writePosition
+        = __atomic_load_n(&(fifo->writePosition), __ATOMIC_ACQUIRE);
+
+    /* The producer may have dropped bytes between the two loads. */
+    if (writePosition <= readPosition)
+        return 0;
+    writePosition -= readPosition;
+    return
+        (writePosition > fifo->capacity)
+            ? fifo->capacity
+            : (size_t) writePosition;
+}
+
+void
+PcmFifo_getStats(PcmFifo *fifo, PcmFifoStats *stats)
+{
+    stats->bytesWritten
+        = __atomic_load_n(&(fifo->bytesWritten), __ATOMIC_RELAXED);
+    stats->bytesRead = __atomic_load_n(&(fifo->bytesRead), __ATOMIC_RELAXED);
+    stats->bytesDropped
+        = __atomic_load_n(&(fifo->bytesDropped), __ATOMIC_RELAXED);
+    stats->overflows = __atomic_load_n(&(fifo->overflows), __ATOMIC_RELAXED);
+    stats->underruns = __atomic_load_n(&(fifo->underruns), __ATOMIC_RELAXED);
+    stats->maxFill = __atomic_load_n(&(fifo->maxFill), __ATOMIC_RELAXED);
+}
+
+size_t
+PcmFifo_read(
+        PcmFifo *fifo,
+        uint8_t *out, size_t length,
+        uint64_t *position)
+{
+    length -= length % fifo->frameSize;
+
+    while (1)
+    {
+        uint64_t readPosition
+            = __atomic_load_n(&(fifo->readPosition), __ATOMIC_ACQUIRE);
+        uint64_t writePosition
+            = __atomic_load_n(&(fifo->writePosition), __ATOMIC_ACQUIRE);
+        size_t available, index, tail;
+
+        if (writePosition <= readPosition)
+        {
+            available = 0;
+        }
+        else
+        {
+            writePosition -= readPosition;
+            available
+                = (writePosition > fifo->capacity)
+                    ? fifo->capacity
+                    : (size_t) writePosition;
+        }
+        if (available > length)
+            available = length;
+        if (available < 1)
+        {
+            if (length > 0)
+                PcmFifo_add(&(fifo->underruns), 1);
+            return 0;
+        }
+
+        index = (size_t) (readPosition % fifo->capacity);
+        tail = fifo->capacity - index;
+        if (tail >= available)
+        {
+            memcpy(out, fifo->data + index, available);
+        }
+        else
+        {
+            memcpy(out, fifo->data + index, tail);
+            memcpy(out + tail, fifo->data, available - tail);
+        }
+
+        if (__atomic_compare_exchange_n(
+                &(fifo->readPosition),
+                &readPosition,
+                readPosition + available,
+                0,
+                __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE))
+        {
+            PcmFifo_add(&(fifo->bytesRead), available);
+            if (position)
+                *position = readPosition;
+            return available;
+        }
+        /*
+         * The producer has dropped the oldest bytes, possibly while they were
+         * being copied, so read what is the oldest now.
+         */
+    }
+}
+
+size_t
+PcmFifo_write(
+        PcmFifo *fifo,
+        const uint8_t *in, size_t length,
+        size_t limit)
+{
+    uint64_t writePosition = fifo->writePosition;
+    uint64_t readPosition, fill;
+    size_t dropped = 0, index, tail;
+
+    length -= length % fifo->frameSize;
+    if (length < 1)
+        return 0;
+    if ((limit < fifo->frameSize) || (limit > fifo->capacity))
+        limit = fifo->capacity;
+    limit -= limit % fifo->frameSize;
+
+    /* Nothing older is kept if the write alone exceeds the limit. */
+    if (length > limit)
+    {
+        dropped = length - limit;
+        in += dropped;
+        length = limit;
+    }
+
+    readPosition = __atomic_load_n(&(fifo->readPosition), __ATOMIC_ACQUIRE);
+    while (writePosition - readPosition + length > limit)
+    {
+        /* Drop the oldest frames, unless the consumer has read them. */
+        uint64_t newReadPosition = writePosition + length - limit;
+
+        if (__atomic_compare_exchange_n(
+                &(fifo->readPosition),
+                &readPosition,
+                newReadPosition,
+                0,
+                __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE))
+        {
+            dropped += (size_t) (newReadPosition - readPosition);
+            readPosition = newReadPosition;
+            break;
+        }
+    }
+    if (dropped)
+    {
+        PcmFifo_add(&(fifo->bytesDropped), dropped);
+        PcmFifo_add(&(fifo->overflows), 1);
+    }
+
+    index = (size_t) (writePosition % fifo->capacity);
+    tail = fifo->capacity - index;
+    if (tail >= length)
+    {
+        memcpy(fifo->data + index, in, length);
+    }
+    else
+    {
+        memcpy(fifo->data + index, in, tail);
+        memcpy(fifo->data, in + tail, length - tail);
+    }
+    __atomic_store_n(
+            &(fifo->writePosition),
+            writePosition + length,
+            __ATOMIC_RELEASE);
+
+    PcmFifo_add(&(fifo->bytesWritten), length);
+    fill = writePosition + length - readPosition;
+    if (fill > fifo->maxFill)
+        __atomic_store_n(&(fifo->maxFill), fill, __ATOMIC_RELAXED);
+    return dropped;
+}
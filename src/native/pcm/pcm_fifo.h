@@ -0,0 +1,82 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNMEDIA_PCM_FIFO_H_
+#define _JNMEDIA_PCM_FIFO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A FIFO of PCM bytes between a single producer and a single consumer thread
+ * which neither blocks nor takes locks. When a write would exceed the fill
+ * limit, the oldest frames are dropped to make room for it so that the
+ * latency through the FIFO stays bounded.
+ */
+
+typedef struct PcmFifo PcmFifo;
+
+/** The statistics of a PcmFifo. */
+typedef struct
+{
+    uint64_t bytesWritten;
+    uint64_t bytesRead;
+    uint64_t bytesDropped;
+    uint64_t overflows;
+    uint64_t underruns;
+    uint64_t maxFill;
+} PcmFifoStats;
+
+/**
+ * Creates a new FIFO.
+ *
+ * @param capacity the capacity in bytes, rounded down to whole frames
+ * @param frameSize the size in bytes of a frame (a sample of all channels)
+ * @return the new FIFO or NULL on failure
+ */
+PcmFifo *PcmFifo_create(size_t capacity, size_t frameSize);
+
+/** Destroys a FIFO which neither thread uses anymore. */
+void PcmFifo_destroy(PcmFifo *fifo);
+
+/** Gets the number of bytes which may be read. Callable from any thread. */
+size_t PcmFifo_getFill(PcmFifo *fifo);
+
+/** Gets the statistics of a FIFO. Callable from any thread. */
+void PcmFifo_getStats(PcmFifo *fifo, PcmFifoStats *stats);
+
+/**
+ * Reads whole frames from a FIFO. Called by the consumer thread only.
+ *
+ * @param out the array to read into
+ * @param length the maximum number of bytes to read
+ * @param position if not NULL, receives the position of the first byte read
+ * in the stream of the bytes written into the FIFO
+ * @return the number of bytes read, 0 if the FIFO is empty
+ */
+size_t PcmFifo_read(
+        PcmFifo *fifo,
+        uint8_t *out, size_t length,
+        uint64_t *position);
+
+/**
+ * Writes whole frames into a FIFO, dropping the oldest frames in it if the
+ * fill would otherwise exceed a specific limit. Called by the producer thread
+ * only.
+ *
+ * @param in the frames to write
+ * @param length the number of bytes to write, rounded down to whole frames
+ * @param limit the maximum fill in bytes, at most the capacity
+ * @return the number of bytes dropped
+ */
+size_t PcmFifo_write(
+        PcmFifo *fifo,
+        const uint8_t *in, size_t length,
+        size_t limit);
+
+#endif /* #ifndef _JNMEDIA_PCM_FIFO_H_ */
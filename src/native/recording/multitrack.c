@@ -0,0 +1,563 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "multitrack.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/** The size by which the index file of a track is preallocated. */
+#define MULTITRACK_INDEX_EXTENT_SIZE (64 * 1024)
+
+/*
+ * The address space reserved for the mapping of a file, beyond its allocated
+ * size, so that growing the file does not remap it in the common case.
+ */
+#define MULTITRACK_DATA_MAP_SIZE \
+    ((sizeof(void *) >= 8) ? (16ULL << 30) : (256ULL << 20))
+#define MULTITRACK_INDEX_MAP_SIZE (16 << 20)
+
+/** The interval at which the grower thread checks the files. */
+#define MULTITRACK_GROW_INTERVAL_NANOS 100000000L
+
+/**
+ * A file which is preallocated in extents by the grower thread of its
+ * recorder, ahead of the writes, and mapped once with room to grow.
+ */
+typedef struct
+{
+    int fd;
+    uint8_t *map;
+    /** The size of the mapping, which may exceed that of the file. */
+    size_t mapSize;
+    /** The allocated size of the file. Read and written atomically. */
+    uint64_t size;
+    /** The length written so far. Read and written atomically. */
+    uint64_t used;
+    size_t extentSize;
+    /** Serializes the growing by the grower thread and by the writer. */
+    pthread_mutex_t growMutex;
+} MultitrackFile;
+
+struct MultitrackTrack
+{
+    MultitrackRecorder *recorder;
+    pthread_mutex_t mutex;
+    MultitrackFile data;
+    MultitrackFile index;
+    int64_t lastIndexTimeNanos;
+    /** The offset up to which the writeback of the data has been started. */
+    uint64_t writebackOffset;
+    /** The offset up to which the data has been unmapped. */
+    uint64_t droppedOffset;
+    int closed;
+};
+
+struct MultitrackRecorder
+{
+    char *dir;
+    int64_t startNanos;
+    int64_t startTimeMillis;
+    pthread_mutex_t mutex;
+    MultitrackTrack **tracks;
+    int trackCount;
+    /** Signaled to stop the grower thread. Guarded by mutex. */
+    pthread_cond_t cond;
+    pthread_t grower;
+    int stopping;
+};
+
+static int64_t
+Multitrack_nanoTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static void
+MultitrackFile_close(MultitrackFile *file, uint64_t length)
+{
+    if (file->map)
+    {
+        munmap(file->map, file->mapSize);
+        file->map = NULL;
+    }
+    if (file->fd >= 0)
+    {
+        if (ftruncate(file->fd, (off_t) length) != 0)
+        {
+            /* The file keeps its preallocated tail. */
+        }
+        close(file->fd);
+        file->fd = -1;
+    }
+}
+
+/**
+ * Makes sure that a file is allocated up to a specific size, growing it by
+ * whole extents. Called by the grower thread ahead of the writes and by the
+ * writer only if the grower thread has fallen behind.
+ */
+static int
+MultitrackFile_grow(MultitrackFile *file, uint64_t size)
+{
+    uint64_t oldSize, newSize;
+    int ret = 0;
+
+    pthread_mutex_lock(&(file->growMutex));
+    oldSize = __atomic_load_n(&(file->size), __ATOMIC_ACQUIRE);
+    if (size > oldSize)
+    {
+        newSize
+            = ((size + file->extentSize - 1) / file->extentSize)
+                * file->extentSize;
+
+        /*
+         * Allocates the blocks up front so that the page faults of the
+         * writes do not allocate them one by one.
+         */
+        if (posix_fallocate(
+                    file->fd,
+                    (off_t) oldSize, (off_t) (newSize - oldSize))
+                && (ftruncate(file->fd, (off_t) newSize) != 0))
+            ret = -1;
+        else
+            __atomic_store_n(&(file->size), newSize, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&(file->growMutex));
+    return ret;
+}
+
+/**
+ * Makes sure that a file is allocated and mapped up to a specific size. Only
+ * the writer of the file calls it, with the mutex of the track held.
+ */
+static int
+MultitrackFile_reserve(MultitrackFile *file, uint64_t size)
+{
+    if ((size > __atomic_load_n(&(file->size), __ATOMIC_ACQUIRE))
+            && (MultitrackFile_grow(file, size) != 0))
+        return -1;
+
+    if (size > file->mapSize)
+    {
+        /* Only a recording longer than the reserved address space gets here. */
+        size_t newSize = file->mapSize * 2;
+        void *map;
+
+        while (newSize < size)
+            newSize *= 2;
+        map = mremap(file->map, file->mapSize, newSize, MREMAP_MAYMOVE);
+        if (map == MAP_FAILED)
+            return -1;
+        file->map = map;
+        file->mapSize = newSize;
+        madvise(file->map, file->mapSize, MADV_SEQUENTIAL);
+    }
+    return 0;
+}
+
+static int
+MultitrackFile_open(
+        MultitrackFile *file,
+        const char *path,
+        size_t extentSize, size_t mapSize)
+{
+    void *map;
+
+    file->map = NULL;
+    file->mapSize = 0;
+    file->size = 0;
+    file->used = 0;
+    file->extentSize = extentSize;
+    file->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file->fd < 0)
+        goto fail;
+    if (MultitrackFile_grow(file, extentSize) != 0)
+        goto fail;
+
+    /* The pages past the end of the file are never touched. */
+    map = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+    if (map == MAP_FAILED)
+        goto fail;
+    file->map = map;
+    file->mapSize = mapSize;
+    madvise(file->map, file->mapSize, MADV_SEQUENTIAL);
+    return 0;
+
+fail:
+    {
+        int err = errno;
+
+        MultitrackFile_close(file, 0);
+        errno = err;
+    }
+    return -1;
+}
+
+/**
+ * Keeps at least an extent allocated past what has been written into a file
+ * so that the writer does not have to grow it.
+ */
+static void
+MultitrackFile_growAhead(MultitrackFile *file)
+{
+    uint64_t used = __atomic_load_n(&(file->used), __ATOMIC_ACQUIRE);
+
+    if (used + file->extentSize
+            > __atomic_load_n(&(file->size), __ATOMIC_ACQUIRE))
+        MultitrackFile_grow(file, used + 2 * file->extentSize);
+}
+
+/**
+ * Grows the files of the tracks of a recorder ahead of their writes until the
+ * recorder is closed.
+ */
+static void *
+MultitrackRecorder_runGrower(void *arg)
+{
+    MultitrackRecorder *recorder = arg;
+
+    pthread_mutex_lock(&(recorder->mutex));
+    while (!recorder->stopping)
+    {
+        struct timespec deadline;
+        int i;
+
+        for (i = 0; i < recorder->trackCount; i++)
+        {
+            MultitrackTrack *track = recorder->tracks[i];
+
+            /*
+             * The tracks are only freed after this thread is joined, so the
+             * mutex is released while their files are grown.
+             */
+            pthread_mutex_unlock(&(recorder->mutex));
+            MultitrackFile_growAhead(&(track->data));
+            MultitrackFile_growAhead(&(track->index));
+            pthread_mutex_lock(&(recorder->mutex));
+        }
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += MULTITRACK_GROW_INTERVAL_NANOS;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if (!recorder->stopping)
+        {
+            pthread_cond_timedwait(
+                    &(recorder->cond), &(recorder->mutex),
+                    &deadline);
+        }
+    }
+    pthread_mutex_unlock(&(recorder->mutex));
+    return NULL;
+}
+
+static MultitrackHeader *
+MultitrackTrack_header(MultitrackTrack *track)
+{
+    return (MultitrackHeader *) track->data.map;
+}
+
+/**
+ * Starts the writeback of the data written since the previous call and
+ * unmaps the data of the call before, which has had the time to be written,
+ * so that a long recording keeps a small resident size.
+ */
+static void
+MultitrackTrack_writeback(MultitrackTrack *track, uint64_t end)
+{
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uint64_t from, to;
+
+    if (end - track->writebackOffset < MULTITRACK_WRITEBACK_SIZE)
+        return;
+
+    to = end & ~((uint64_t) pageSize - 1);
+    from = track->droppedOffset;
+    if (track->writebackOffset > from)
+    {
+        madvise(
+                track->data.map + from,
+                (size_t) (track->writebackOffset - from),
+                MADV_DONTNEED);
+        track->droppedOffset = track->writebackOffset;
+    }
+    sync_file_range(
+            track->data.fd,
+            (off_t) track->writebackOffset,
+            (off_t) (to - track->writebackOffset),
+            SYNC_FILE_RANGE_WRITE);
+    track->writebackOffset = to;
+}
+
+MultitrackRecorder *
+MultitrackRecorder_open(const char *dir)
+{
+    MultitrackRecorder *recorder;
+    struct timespec ts;
+
+    if ((mkdir(dir, 0755) != 0) && (errno != EEXIST))
+        return NULL;
+
+    recorder = calloc(1, sizeof(MultitrackRecorder));
+    if (!recorder)
+        return NULL;
+    recorder->dir = strdup(dir);
+    if (!recorder->dir)
+    {
+        free(recorder);
+        return NULL;
+    }
+    pthread_mutex_init(&(recorder->mutex), NULL);
+    pthread_cond_init(&(recorder->cond), NULL);
+    if (pthread_create(
+                &(recorder->grower), NULL,
+                MultitrackRecorder_runGrower, recorder)
+            != 0)
+    {
+        pthread_cond_destroy(&(recorder->cond));
+        pthread_mutex_destroy(&(recorder->mutex));
+        free(recorder->dir);
+        free(recorder);
+        return NULL;
+    }
+    recorder->startNanos = Multitrack_nanoTime();
+    clock_gettime(CLOCK_REALTIME, &ts);
+    recorder->startTimeMillis
+        = ((int64_t) ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    return recorder;
+}
+
+MultitrackTrack *
+MultitrackRecorder_addTrack(
+        MultitrackRecorder *recorder,
+        int type,
+        const char *label,
+        uint32_t ssrc,
+        uint32_t rate, int channels, int format)
+{
+    MultitrackTrack *track = calloc(1, sizeof(MultitrackTrack));
+    MultitrackTrack **tracks;
+    MultitrackHeader *header;
+    char path[PATH_MAX];
+    int id;
+
+    if (!track)
+        return NULL;
+    track->recorder = recorder;
+    track->data.fd = -1;
+    track->index.fd = -1;
+    pthread_mutex_init(&(track->data.growMutex), NULL);
+    pthread_mutex_init(&(track->index.growMutex), NULL);
+    track->writebackOffset = MULTITRACK_HEADER_SIZE;
+    track->droppedOffset = MULTITRACK_HEADER_SIZE;
+    pthread_mutex_init(&(track->mutex), NULL);
+
+    pthread_mutex_lock(&(recorder->mutex));
+    tracks
+        = realloc(
+                recorder->tracks,
+                (recorder->trackCount + 1) * sizeof(MultitrackTrack *));
+    if (!tracks)
+        goto fail;
+    recorder->tracks = tracks;
+    id = recorder->trackCount;
+
+    snprintf(path, sizeof(path), "%s/track-%03d.mtr", recorder->dir, id);
+    if (MultitrackFile_open(
+                &(track->data),
+                path,
+                MULTITRACK_EXTENT_SIZE, MULTITRACK_DATA_MAP_SIZE)
+            != 0)
+    {
+        goto fail;
+    }
+    snprintf(path, sizeof(path), "%s/track-%03d.mti", recorder->dir, id);
+    if (MultitrackFile_open(
+                &(track->index),
+                path,
+                MULTITRACK_INDEX_EXTENT_SIZE, MULTITRACK_INDEX_MAP_SIZE)
+            != 0)
+    {
+        goto fail;
+    }
+
+    header = MultitrackTrack_header(track);
+    memset(header, 0, MULTITRACK_HEADER_SIZE);
+    header->magic = MULTITRACK_MAGIC;
+    header->version = MULTITRACK_VERSION;
+    header->type = (uint16_t) type;
+    header->rate = rate;
+    header->channels = (uint16_t) channels;
+    header->format = (uint16_t) format;
+    header->ssrc = ssrc;
+    header->headerSize = MULTITRACK_HEADER_SIZE;
+    header->startTimeMillis = recorder->startTimeMillis;
+    if (label)
+        strncpy(header->label, label, MULTITRACK_LABEL_LENGTH - 1);
+
+    recorder->tracks[recorder->trackCount++] = track;
+    pthread_mutex_unlock(&(recorder->mutex));
+    return track;
+
+fail:
+    pthread_mutex_unlock(&(recorder->mutex));
+    {
+        int err = errno;
+
+        MultitrackFile_close(&(track->index), 0);
+        MultitrackFile_close(&(track->data), 0);
+        pthread_mutex_destroy(&(track->index.growMutex));
+        pthread_mutex_destroy(&(track->data.growMutex));
+        pthread_mutex_destroy(&(track->mutex));
+        free(track);
+        errno = err;
+    }
+    return NULL;
+}
+
+void
+MultitrackRecorder_close(MultitrackRecorder *recorder)
+{
+    int i;
+
+    pthread_mutex_lock(&(recorder->mutex));
+    recorder->stopping = 1;
+    pthread_cond_signal(&(recorder->cond));
+    pthread_mutex_unlock(&(recorder->mutex));
+    pthread_join(recorder->grower, NULL);
+
+    for (i = 0; i < recorder->trackCount; i++)
+    {
+        MultitrackTrack *track = recorder->tracks[i];
+        MultitrackHeader *header;
+        uint64_t dataLength, indexCount;
+
+        pthread_mutex_lock(&(track->mutex));
+        header = MultitrackTrack_header(track);
+        dataLength = header->dataLength;
+        indexCount = header->indexCount;
+        header->closed = 1;
+        track->closed = 1;
+        MultitrackFile_close(
+                &(track->data),
+                MULTITRACK_HEADER_SIZE + dataLength);
+        MultitrackFile_close(
+                &(track->index),
+                indexCount * sizeof(MultitrackIndexEntry));
+        pthread_mutex_unlock(&(track->mutex));
+
+        pthread_mutex_destroy(&(track->index.growMutex));
+        pthread_mutex_destroy(&(track->data.growMutex));
+        pthread_mutex_destroy(&(track->mutex));
+        free(track);
+    }
+    pthread_cond_destroy(&(recorder->cond));
+    pthread_mutex_destroy(&(recorder->mutex));
+    free(recorder->tracks);
+    free(recorder->dir);
+    free(recorder);
+}
+
+int
+MultitrackTrack_write(
+        MultitrackTrack *track,
+        const uint8_t *data, uint32_t length,
+        uint32_t flags)
+{
+    int64_t timeNanos = Multitrack_nanoTime() - track->recorder->startNanos;
+    uint64_t recordLength
+        = sizeof(MultitrackRecordHeader) + ((length + 7) & ~7u);
+    MultitrackHeader *header;
+    MultitrackRecordHeader *record;
+    uint64_t offset;
+    int ret = -1;
+
+    pthread_mutex_lock(&(track->mutex));
+    if (track->closed)
+    {
+        errno = EBADF;
+        goto out;
+    }
+
+    offset = MULTITRACK_HEADER_SIZE + MultitrackTrack_header(track)->dataLength;
+    if (MultitrackFile_reserve(&(track->data), offset + recordLength) != 0)
+        goto out;
+    header = MultitrackTrack_header(track);
+
+    if ((header->indexCount == 0)
+            || (timeNanos - track->lastIndexTimeNanos
+                    >= MULTITRACK_INDEX_INTERVAL_NANOS))
+    {
+        uint64_t indexOffset
+            = header->indexCount * sizeof(MultitrackIndexEntry);
+        MultitrackIndexEntry *entry;
+
+        if (MultitrackFile_reserve(
+                    &(track->index),
+                    indexOffset + sizeof(MultitrackIndexEntry))
+                != 0)
+        {
+            goto out;
+        }
+        entry = (MultitrackIndexEntry *) (track->index.map + indexOffset);
+        entry->timeNanos = timeNanos;
+        entry->offset = offset;
+        track->lastIndexTimeNanos = timeNanos;
+        __atomic_store_n(
+                &(track->index.used),
+                indexOffset + sizeof(MultitrackIndexEntry),
+                __ATOMIC_RELEASE);
+        __atomic_store_n(
+                &(header->indexCount), header->indexCount + 1,
+                __ATOMIC_RELEASE);
+    }
+
+    record = (MultitrackRecordHeader *) (track->data.map + offset);
+    record->timeNanos = timeNanos;
+    record->length = length;
+    record->flags = flags;
+    memcpy(record + 1, data, length);
+    memset(
+            ((uint8_t *) (record + 1)) + length,
+            0,
+            recordLength - sizeof(MultitrackRecordHeader) - length);
+
+    header->recordCount++;
+    /* Publishes the record to the readers of the mapping. */
+    __atomic_store_n(
+            &(header->dataLength), header->dataLength + recordLength,
+            __ATOMIC_RELEASE);
+    __atomic_store_n(
+            &(track->data.used), offset + recordLength,
+            __ATOMIC_RELEASE);
+
+    MultitrackTrack_writeback(track, offset + recordLength);
+    ret = 0;
+
+out:
+    pthread_mutex_unlock(&(track->mutex));
+    return ret;
+}
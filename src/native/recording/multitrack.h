@@ -0,0 +1,145 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNMEDIA_MULTITRACK_H_
+#define _JNMEDIA_MULTITRACK_H_
+
+#include <stdint.h>
+
+/*
+ * Records one track per participant into a directory, each track being a
+ * pair of files which are memory-mapped and written sequentially. A thread of
+ * the recorder preallocates the files in large extents ahead of the writes,
+ * so that the writers, e.g. the mixer, neither allocate blocks nor remap:
+ *
+ * track-NNN.mtr: a MultitrackHeader in the first page followed by the
+ * records, each a MultitrackRecordHeader followed by the data of a frame
+ * (PCM or an RTP payload) padded to 8 bytes.
+ *
+ * track-NNN.mti: the time index, an array of MultitrackIndexEntry, one for
+ * the first record of every MULTITRACK_INDEX_INTERVAL_NANOS.
+ *
+ * All the integers are in the byte order of the host, which the header
+ * identifies through its magic. The header is updated after every record so
+ * that a track is readable while recorded and after a crash. The times of all
+ * the tracks of a recording are relative to the same start.
+ */
+
+/** The magic of a track, "MTRK" when read in the byte order of the host. */
+#define MULTITRACK_MAGIC 0x4B52544D
+
+#define MULTITRACK_VERSION 1
+
+/** The size of the header, after which the records start. */
+#define MULTITRACK_HEADER_SIZE 4096
+
+/** The size by which the data file of a track is preallocated. */
+#define MULTITRACK_EXTENT_SIZE (8 * 1024 * 1024)
+
+/** The interval of the entries of the time index. */
+#define MULTITRACK_INDEX_INTERVAL_NANOS 1000000000LL
+
+/**
+ * The amount of data written after which its writeback is started and it is
+ * unmapped from the address space.
+ */
+#define MULTITRACK_WRITEBACK_SIZE (1024 * 1024)
+
+#define MULTITRACK_LABEL_LENGTH 128
+
+/** The types of tracks. */
+enum
+{
+    /** Decoded linear PCM. */
+    MULTITRACK_TYPE_PCM = 0,
+    /** RTP payloads as received, before decoding. */
+    MULTITRACK_TYPE_RTP_PAYLOAD
+};
+
+/** The header of a track. */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    /** The sample rate of PCM or the RTP clock rate. */
+    uint32_t rate;
+    uint16_t channels;
+    /** The bits per sample of PCM or the RTP payload type. */
+    uint16_t format;
+    uint32_t ssrc;
+    uint32_t headerSize;
+    /** The wall clock time in milliseconds of the start of the recording. */
+    int64_t startTimeMillis;
+    /** The length of the records following the header. */
+    uint64_t dataLength;
+    uint64_t recordCount;
+    uint64_t indexCount;
+    /** 1 once the track is closed and its files truncated. */
+    uint32_t closed;
+    uint32_t reserved;
+    char label[MULTITRACK_LABEL_LENGTH];
+} MultitrackHeader;
+
+/** The header of a record. */
+typedef struct
+{
+    /** The time of the record since the start of the recording. */
+    int64_t timeNanos;
+    /** The length of the data, excluding the padding. */
+    uint32_t length;
+    uint32_t flags;
+} MultitrackRecordHeader;
+
+/** An entry of the time index. */
+typedef struct
+{
+    int64_t timeNanos;
+    /** The offset in the track file of the record. */
+    uint64_t offset;
+} MultitrackIndexEntry;
+
+typedef struct MultitrackRecorder MultitrackRecorder;
+typedef struct MultitrackTrack MultitrackTrack;
+
+/**
+ * Starts a recording in a specific directory, which is created if needed.
+ *
+ * @return the new recorder or NULL with errno set
+ */
+MultitrackRecorder *MultitrackRecorder_open(const char *dir);
+
+/**
+ * Adds a track to a recording. The track is owned by the recorder.
+ *
+ * @return the new track or NULL with errno set
+ */
+MultitrackTrack *MultitrackRecorder_addTrack(
+        MultitrackRecorder *recorder,
+        int type,
+        const char *label,
+        uint32_t ssrc,
+        uint32_t rate, int channels, int format);
+
+/**
+ * Closes a recording, truncating the files of its tracks to their lengths.
+ */
+void MultitrackRecorder_close(MultitrackRecorder *recorder);
+
+/**
+ * Appends a record to a track, stamped with the time elapsed since the start
+ * of the recording. The data is copied once, into the mapping of the track.
+ *
+ * @return 0 or -1 with errno set if the files could not be grown
+ */
+int MultitrackTrack_write(
+        MultitrackTrack *track,
+        const uint8_t *data, uint32_t length,
+        uint32_t flags);
+
+#endif /* #ifndef _JNMEDIA_MULTITRACK_H_ */
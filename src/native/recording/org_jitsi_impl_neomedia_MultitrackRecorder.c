@@ -0,0 +1,74 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_impl_neomedia_MultitrackRecorder.h"
+
+#include <stdint.h>
+
+#include "multitrack.h"
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_MultitrackRecorder_addTrack
+    (JNIEnv *env, jclass clazz, jlong recorder, jint type, jstring label,
+        jlong ssrc, jint rate, jint channels, jint format)
+{
+    const char *label_ = (*env)->GetStringUTFChars(env, label, NULL);
+    MultitrackTrack *track;
+
+    if (!label_)
+        return 0;
+    track
+        = MultitrackRecorder_addTrack(
+                (MultitrackRecorder *) (intptr_t) recorder,
+                type,
+                label_,
+                (uint32_t) ssrc,
+                (uint32_t) rate, channels, format);
+    (*env)->ReleaseStringUTFChars(env, label, label_);
+    return (jlong) (intptr_t) track;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_MultitrackRecorder_close
+    (JNIEnv *env, jclass clazz, jlong recorder)
+{
+    MultitrackRecorder_close((MultitrackRecorder *) (intptr_t) recorder);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_MultitrackRecorder_open
+    (JNIEnv *env, jclass clazz, jstring dir)
+{
+    const char *dir_ = (*env)->GetStringUTFChars(env, dir, NULL);
+    MultitrackRecorder *recorder;
+
+    if (!dir_)
+        return 0;
+    recorder = MultitrackRecorder_open(dir_);
+    (*env)->ReleaseStringUTFChars(env, dir, dir_);
+    return (jlong) (intptr_t) recorder;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_impl_neomedia_MultitrackRecorder_write
+    (JNIEnv *env, jclass clazz, jlong track, jbyteArray buf, jint offset,
+        jint length)
+{
+    jbyte *buf_ = (*env)->GetPrimitiveArrayCritical(env, buf, NULL);
+    int ret;
+
+    if (!buf_)
+        return JNI_FALSE;
+    ret
+        = MultitrackTrack_write(
+                (MultitrackTrack *) (intptr_t) track,
+                (const uint8_t *) (buf_ + offset), (uint32_t) length,
+                0);
+    (*env)->ReleasePrimitiveArrayCritical(env, buf, buf_, JNI_ABORT);
+    return (ret == 0) ? JNI_TRUE : JNI_FALSE;
+}
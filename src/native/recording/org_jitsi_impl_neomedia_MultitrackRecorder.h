@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_MultitrackRecorder */
+
+#ifndef _Included_org_jitsi_impl_neomedia_MultitrackRecorder
+#define _Included_org_jitsi_impl_neomedia_MultitrackRecorder
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_impl_neomedia_MultitrackRecorder
+ * Method:    addTrack
+ * Signature: (JILjava/lang/String;JIII)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_MultitrackRecorder_addTrack
+  (JNIEnv *, jclass, jlong, jint, jstring, jlong, jint, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_MultitrackRecorder
+ * Method:    close
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_MultitrackRecorder_close
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_MultitrackRecorder
+ * Method:    open
+ * Signature: (Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_MultitrackRecorder_open
+  (JNIEnv *, jclass, jstring);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_MultitrackRecorder
+ * Method:    write
+ * Signature: (J[BII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_impl_neomedia_MultitrackRecorder_write
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,1188 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "io_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/io_uring.h>
+
+#define IO_RING_QUEUE_MASK (IO_RING_QUEUE_SIZE - 1)
+
+/** The time a closing stream waits for its queued packets to be sent. */
+#define IO_RING_CLOSE_LINGER_MILLIS 1000
+
+enum
+{
+    IO_RING_OP_STOP = 0,
+    IO_RING_OP_FILE_WRITE,
+    IO_RING_OP_RECV,
+    IO_RING_OP_SEND,
+    IO_RING_OP_CANCEL
+};
+
+/** The user_data of a submission. */
+typedef struct
+{
+    int type;
+    void *owner;
+} IoRingOp;
+
+typedef struct IoRingBuffer
+{
+    IoRingOp op;
+    int index;
+    uint8_t *data;
+    IoRingFile *file;
+    uint64_t fileOffset;
+    uint32_t length;
+    uint32_t written;
+    struct IoRingBuffer *nextFree;
+} IoRingBuffer;
+
+struct IoRingFile
+{
+    int fd;
+    int64_t position;
+    /** The buffer being filled or NULL. */
+    IoRingBuffer *current;
+    /** The number of buffers being written. */
+    int pending;
+    int error;
+    pthread_cond_t cond;
+};
+
+struct IoRingStream
+{
+    int fd;
+    IoRingOp recvOp;
+    IoRingOp sendOp;
+    IoRingOp cancelOp;
+
+    int receiving;
+    /** Receiving is paused until the receive queue is drained. */
+    int rxPaused;
+
+    /**
+     * The bytes received, as they were received: the complete frames up to
+     * rqParsed, each preceded by its 16-bit length, and then the start of a
+     * partial frame.
+     */
+    uint8_t *rq;
+    uint32_t rqHead;
+    uint32_t rqParsed;
+    uint32_t rqTail;
+
+    /** The frames to send. */
+    uint8_t *tq;
+    uint32_t tqHead;
+    uint32_t tqTail;
+    int sending;
+
+    int closing;
+    /** The connection was closed by the peer or has failed. */
+    int failed;
+    int receivers;
+    pthread_cond_t cond;
+
+    IoRingStreamStats stats;
+};
+
+typedef struct
+{
+    int fd;
+
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned *sqArray;
+    struct io_uring_sqe *sqes;
+    unsigned toSubmit;
+
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe *cqes;
+
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+
+    uint8_t *bufferMemory;
+    IoRingBuffer buffers[IO_RING_BUFFER_COUNT];
+    IoRingBuffer *freeBuffers;
+    pthread_cond_t bufferCond;
+
+    /** The number of submissions whose completions are awaited. */
+    int inFlight;
+    IoRingOp stopOp;
+    pthread_t thread;
+} IoRing;
+
+/** Serializes the creation and destruction of the ring. */
+static pthread_mutex_t IoRing_lifecycleMutex = PTHREAD_MUTEX_INITIALIZER;
+static int IoRing_users = 0;
+static int IoRing_supported = -1;
+
+/** Protects the submission queue and the state of all files and streams. */
+static pthread_mutex_t IoRing_mutex = PTHREAD_MUTEX_INITIALIZER;
+static IoRing *IoRing_ring = NULL;
+
+static int
+IoRing_setup(unsigned entries, struct io_uring_params *params)
+{
+#ifdef __NR_io_uring_setup
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static int
+IoRing_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+#ifdef __NR_io_uring_enter
+    return
+        (int)
+            syscall(
+                    __NR_io_uring_enter,
+                    fd, toSubmit, minComplete, flags,
+                    NULL, 0);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static int
+IoRing_register(int fd, unsigned opcode, void *arg, unsigned count)
+{
+#ifdef __NR_io_uring_register
+    return (int) syscall(__NR_io_uring_register, fd, opcode, arg, count);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static void
+IoRing_deadline(struct timespec *ts, int millis)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += millis / 1000;
+    ts->tv_nsec += (millis % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/** Submits the queued entries. Called with IoRing_mutex held. */
+static void
+IoRing_submit(IoRing *ring)
+{
+    while (ring->toSubmit)
+    {
+        int ret = IoRing_enter(ring->fd, ring->toSubmit, 0, 0);
+
+        if (ret > 0)
+            ring->toSubmit -= ret;
+        else if ((ret < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+            continue;
+        else
+            break;
+    }
+}
+
+/**
+ * Gets a free submission queue entry, submitting the queued ones if the
+ * queue is full. Called with IoRing_mutex held.
+ */
+static struct io_uring_sqe *
+IoRing_getSqe(IoRing *ring, IoRingOp *op)
+{
+    int attempt;
+
+    for (attempt = 0; attempt < 2; attempt++)
+    {
+        unsigned tail = *(ring->sqTail);
+        unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+
+        if (tail - head < ring->sqEntries)
+        {
+            unsigned index = tail & ring->sqMask;
+            struct io_uring_sqe *sqe = ring->sqes + index;
+
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->user_data = (uint64_t) (uintptr_t) op;
+            ring->sqArray[index] = index;
+            return sqe;
+        }
+        IoRing_submit(ring);
+    }
+    return NULL;
+}
+
+/** Queues the entry got from IoRing_getSqe. */
+static void
+IoRing_commitSqe(IoRing *ring)
+{
+    __atomic_store_n(ring->sqTail, *(ring->sqTail) + 1, __ATOMIC_RELEASE);
+    ring->toSubmit++;
+    ring->inFlight++;
+}
+
+static void
+IoRing_releaseBuffer(IoRing *ring, IoRingBuffer *buffer)
+{
+    buffer->file = NULL;
+    buffer->nextFree = ring->freeBuffers;
+    ring->freeBuffers = buffer;
+    pthread_cond_broadcast(&(ring->bufferCond));
+}
+
+/** Submits the write of the rest of a buffer. */
+static int
+IoRing_submitBuffer(IoRing *ring, IoRingBuffer *buffer)
+{
+    struct io_uring_sqe *sqe = IoRing_getSqe(ring, &(buffer->op));
+
+    if (!sqe)
+        return -1;
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = buffer->file->fd;
+    sqe->addr = (uint64_t) (uintptr_t) (buffer->data + buffer->written);
+    sqe->len = buffer->length - buffer->written;
+    sqe->off = buffer->fileOffset + buffer->written;
+    sqe->buf_index = (uint16_t) buffer->index;
+    IoRing_commitSqe(ring);
+    return 0;
+}
+
+/**
+ * Receives as much as the receive queue has room for straight into the queue,
+ * so that a single completion may carry many frames.
+ */
+static void
+IoRingStream_submitRecv(IoRing *ring, IoRingStream *stream)
+{
+    struct io_uring_sqe *sqe;
+    uint32_t room;
+
+    if (stream->receiving || stream->rxPaused || stream->closing
+            || stream->failed)
+        return;
+    room = IO_RING_QUEUE_SIZE - (stream->rqTail - stream->rqHead);
+    if (room == 0)
+    {
+        /* Resumed by IoRingStream_receiveBatch. */
+        stream->rxPaused = 1;
+        stream->stats.receivePauses++;
+        return;
+    }
+    sqe = IoRing_getSqe(ring, &(stream->recvOp));
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = stream->fd;
+    sqe->addr
+        = (uint64_t) (uintptr_t)
+            (stream->rq + (stream->rqTail & IO_RING_QUEUE_MASK));
+    sqe->len = room;
+    IoRing_commitSqe(ring);
+    stream->receiving = 1;
+}
+
+static void
+IoRingStream_submitSend(IoRing *ring, IoRingStream *stream)
+{
+    struct io_uring_sqe *sqe;
+    uint32_t start, length;
+
+    if (stream->sending || stream->failed
+            || (stream->tqHead == stream->tqTail))
+        return;
+    sqe = IoRing_getSqe(ring, &(stream->sendOp));
+    if (!sqe)
+        return;
+
+    /*
+     * All the frames queued since the previous send completed go out in one
+     * send, the mirror of the queue making them contiguous.
+     */
+    start = stream->tqHead & IO_RING_QUEUE_MASK;
+    length = stream->tqTail - stream->tqHead;
+
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = stream->fd;
+    sqe->addr = (uint64_t) (uintptr_t) (stream->tq + start);
+    sqe->len = length;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    IoRing_commitSqe(ring);
+    stream->sending = 1;
+}
+
+/**
+ * Allocates a queue of IO_RING_QUEUE_SIZE bytes which is mapped twice in a
+ * row, so that any range of up to its size starting in the first mapping is
+ * contiguous in memory whether or not it wraps around the end of the queue.
+ *
+ * @return the queue or NULL with errno set
+ */
+static uint8_t *
+IoRing_allocQueue(void)
+{
+    uint8_t *queue;
+    int fd = memfd_create("jnrtp-io-ring", MFD_CLOEXEC);
+    int err;
+
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, IO_RING_QUEUE_SIZE) != 0)
+        goto fail;
+    queue
+        = mmap(
+                NULL, 2 * IO_RING_QUEUE_SIZE,
+                PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                -1, 0);
+    if (queue == MAP_FAILED)
+        goto fail;
+    if ((mmap(
+                    queue, IO_RING_QUEUE_SIZE,
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                    fd, 0)
+                == MAP_FAILED)
+            || (mmap(
+                    queue + IO_RING_QUEUE_SIZE, IO_RING_QUEUE_SIZE,
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                    fd, 0)
+                == MAP_FAILED))
+    {
+        err = errno;
+        munmap(queue, 2 * IO_RING_QUEUE_SIZE);
+        errno = err;
+        goto fail;
+    }
+    close(fd);
+    return queue;
+
+fail:
+    err = errno;
+    close(fd);
+    errno = err;
+    return NULL;
+}
+
+static void
+IoRing_freeQueue(uint8_t *queue)
+{
+    if (queue)
+        munmap(queue, 2 * IO_RING_QUEUE_SIZE);
+}
+
+/**
+ * Finds the complete frames among the bytes received, in place, leaving a
+ * partial frame at the end of the receive queue to be completed by the next
+ * receive.
+ */
+static void
+IoRingStream_parse(IoRingStream *stream)
+{
+    while (stream->rqTail - stream->rqParsed >= 2)
+    {
+        const uint8_t *frame
+            = stream->rq + (stream->rqParsed & IO_RING_QUEUE_MASK);
+        uint32_t frameLength = (frame[0] << 8) | frame[1];
+
+        if (stream->rqTail - stream->rqParsed < 2 + frameLength)
+            break;
+        stream->rqParsed += 2 + frameLength;
+        stream->stats.packetsReceived++;
+        stream->stats.bytesReceived += frameLength;
+    }
+}
+
+/** Handles a completion. Called with IoRing_mutex held. */
+static void
+IoRing_complete(IoRing *ring, IoRingOp *op, int res)
+{
+    ring->inFlight--;
+
+    switch (op->type)
+    {
+    case IO_RING_OP_FILE_WRITE:
+    {
+        IoRingBuffer *buffer = op->owner;
+        IoRingFile *file = buffer->file;
+
+        if ((res == -EINTR) || (res == -EAGAIN))
+            res = 0;
+        if (res < 0)
+        {
+            if (!file->error)
+                file->error = -res;
+        }
+        else
+        {
+            buffer->written += res;
+            /* A short write is continued unless nothing was written. */
+            if ((buffer->written < buffer->length)
+                    && ((res > 0) || (buffer->written == 0))
+                    && (IoRing_submitBuffer(ring, buffer) == 0))
+            {
+                break;
+            }
+            if ((buffer->written < buffer->length) && !file->error)
+                file->error = EIO;
+        }
+        file->pending--;
+        IoRing_releaseBuffer(ring, buffer);
+        pthread_cond_broadcast(&(file->cond));
+        break;
+    }
+    case IO_RING_OP_RECV:
+    {
+        IoRingStream *stream = op->owner;
+
+        stream->receiving = 0;
+        if ((res == -EINTR) || (res == -EAGAIN))
+        {
+            IoRingStream_submitRecv(ring, stream);
+        }
+        else if (res <= 0)
+        {
+            /* Closed by the peer, failed or canceled. */
+            stream->failed = 1;
+        }
+        else
+        {
+            uint32_t parsed = stream->rqParsed;
+
+            stream->rqTail += res;
+            IoRingStream_parse(stream);
+            IoRingStream_submitRecv(ring, stream);
+            /* The receivers only wait for complete frames. */
+            if (stream->rqParsed == parsed)
+                break;
+        }
+        pthread_cond_broadcast(&(stream->cond));
+        break;
+    }
+    case IO_RING_OP_SEND:
+    {
+        IoRingStream *stream = op->owner;
+
+        stream->sending = 0;
+        if (res > 0)
+            stream->tqHead += res;
+        else if ((res != -EINTR) && (res != -EAGAIN))
+            stream->failed = 1;
+        IoRingStream_submitSend(ring, stream);
+        pthread_cond_broadcast(&(stream->cond));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void *
+IoRing_run(void *arg)
+{
+    IoRing *ring = arg;
+    int stopping = 0;
+
+    while (!stopping)
+    {
+        unsigned head, tail;
+
+        if ((IoRing_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0)
+                && (errno != EINTR))
+        {
+            break;
+        }
+
+        pthread_mutex_lock(&IoRing_mutex);
+        head = *(ring->cqHead);
+        tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail)
+        {
+            struct io_uring_cqe *cqe = ring->cqes + (head & ring->cqMask);
+            IoRingOp *op = (IoRingOp *) (uintptr_t) cqe->user_data;
+
+            if (op->type == IO_RING_OP_STOP)
+            {
+                ring->inFlight--;
+                stopping = 1;
+            }
+            else
+                IoRing_complete(ring, op, cqe->res);
+            head++;
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+        IoRing_submit(ring);
+        pthread_mutex_unlock(&IoRing_mutex);
+    }
+    return NULL;
+}
+
+static void
+IoRing_destroy(IoRing *ring)
+{
+    if (ring->sqes)
+        munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    if (ring->sqRing)
+        munmap(ring->sqRing, ring->sqRingSize);
+    if (ring->fd >= 0)
+        close(ring->fd);
+    free(ring->bufferMemory);
+    pthread_cond_destroy(&(ring->bufferCond));
+    free(ring);
+}
+
+static IoRing *
+IoRing_create(void)
+{
+    IoRing *ring = calloc(1, sizeof(IoRing));
+    struct io_uring_params params;
+    struct iovec iovecs[IO_RING_BUFFER_COUNT];
+    int i;
+
+    if (!ring)
+        return NULL;
+    ring->fd = -1;
+    pthread_cond_init(&(ring->bufferCond), NULL);
+
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = IO_RING_CQ_ENTRIES;
+    ring->fd = IoRing_setup(IO_RING_ENTRIES, &params);
+    if ((ring->fd < 0) && (errno == EINVAL))
+    {
+        /* IORING_SETUP_CQSIZE needs Linux 5.5. */
+        memset(&params, 0, sizeof(params));
+        ring->fd = IoRing_setup(IO_RING_ENTRIES, &params);
+    }
+    if (ring->fd < 0)
+        goto fail;
+
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->sqRing
+        = mmap(
+                NULL, ring->sqRingSize,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqRing == MAP_FAILED)
+    {
+        ring->sqRing = NULL;
+        goto fail;
+    }
+    ring->cqRingSize
+        = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->cqRing
+        = mmap(
+                NULL, ring->cqRingSize,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring->fd, IORING_OFF_CQ_RING);
+    if (ring->cqRing == MAP_FAILED)
+    {
+        ring->cqRing = NULL;
+        goto fail;
+    }
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes
+        = mmap(
+                NULL, ring->sqesSize,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        ring->sqes = NULL;
+        goto fail;
+    }
+
+    ring->sqHead = (unsigned *) ((uint8_t *) ring->sqRing + params.sq_off.head);
+    ring->sqTail = (unsigned *) ((uint8_t *) ring->sqRing + params.sq_off.tail);
+    ring->sqMask
+        = *(unsigned *) ((uint8_t *) ring->sqRing + params.sq_off.ring_mask);
+    ring->sqEntries
+        = *(unsigned *) ((uint8_t *) ring->sqRing + params.sq_off.ring_entries);
+    ring->sqArray
+        = (unsigned *) ((uint8_t *) ring->sqRing + params.sq_off.array);
+    ring->cqHead = (unsigned *) ((uint8_t *) ring->cqRing + params.cq_off.head);
+    ring->cqTail = (unsigned *) ((uint8_t *) ring->cqRing + params.cq_off.tail);
+    ring->cqMask
+        = *(unsigned *) ((uint8_t *) ring->cqRing + params.cq_off.ring_mask);
+    ring->cqes
+        = (struct io_uring_cqe *)
+            ((uint8_t *) ring->cqRing + params.cq_off.cqes);
+
+    /* Registers the buffers into which the writes to files are coalesced. */
+    if (posix_memalign(
+                (void **) &(ring->bufferMemory),
+                4096,
+                (size_t) IO_RING_BUFFER_COUNT * IO_RING_BUFFER_SIZE))
+    {
+        ring->bufferMemory = NULL;
+        goto fail;
+    }
+    for (i = 0; i < IO_RING_BUFFER_COUNT; i++)
+    {
+        IoRingBuffer *buffer = ring->buffers + i;
+
+        buffer->op.type = IO_RING_OP_FILE_WRITE;
+        buffer->op.owner = buffer;
+        buffer->index = i;
+        buffer->data
+            = ring->bufferMemory + (size_t) i * IO_RING_BUFFER_SIZE;
+        buffer->nextFree = ring->freeBuffers;
+        ring->freeBuffers = buffer;
+        iovecs[i].iov_base = buffer->data;
+        iovecs[i].iov_len = IO_RING_BUFFER_SIZE;
+    }
+    if (IoRing_register(
+                ring->fd,
+                IORING_REGISTER_BUFFERS,
+                iovecs, IO_RING_BUFFER_COUNT)
+            < 0)
+    {
+        goto fail;
+    }
+
+    ring->stopOp.type = IO_RING_OP_STOP;
+    if (pthread_create(&(ring->thread), NULL, IoRing_run, ring) != 0)
+        goto fail;
+    return ring;
+
+fail:
+    IoRing_destroy(ring);
+    return NULL;
+}
+
+/** Gets the ring, creating it for the first user. */
+static IoRing *
+IoRing_acquire(void)
+{
+    IoRing *ring;
+
+    pthread_mutex_lock(&IoRing_lifecycleMutex);
+    if (!IoRing_ring)
+        IoRing_ring = IoRing_create();
+    ring = IoRing_ring;
+    if (ring)
+        IoRing_users++;
+    pthread_mutex_unlock(&IoRing_lifecycleMutex);
+    return ring;
+}
+
+/** Destroys the ring when its last user has released it. */
+static void
+IoRing_release(void)
+{
+    IoRing *ring = NULL;
+
+    pthread_mutex_lock(&IoRing_lifecycleMutex);
+    if (--IoRing_users == 0)
+    {
+        ring = IoRing_ring;
+
+        /*
+         * The worker only stops on the completion of the stop operation so
+         * it has to be queued even if the submission queue is full, which it
+         * may be while the completion queue is, until the worker has reaped
+         * some completions.
+         */
+        for (;;)
+        {
+            struct io_uring_sqe *sqe;
+
+            pthread_mutex_lock(&IoRing_mutex);
+            sqe = IoRing_getSqe(ring, &(ring->stopOp));
+            if (sqe)
+            {
+                sqe->opcode = IORING_OP_NOP;
+                IoRing_commitSqe(ring);
+                IoRing_submit(ring);
+            }
+            pthread_mutex_unlock(&IoRing_mutex);
+            if (sqe)
+                break;
+            else
+            {
+                struct timespec delay = { 0, 1000000L };
+
+                nanosleep(&delay, NULL);
+            }
+        }
+        pthread_join(ring->thread, NULL);
+        IoRing_ring = NULL;
+    }
+    pthread_mutex_unlock(&IoRing_lifecycleMutex);
+    if (ring)
+        IoRing_destroy(ring);
+}
+
+/**
+ * Determines whether the kernel supports all the operations submitted to the
+ * ring. IORING_OP_RECV and IORING_OP_SEND need Linux 5.6, which is also the
+ * first to support IORING_REGISTER_PROBE, so a kernel which fails the probe
+ * is not supported.
+ */
+static int
+IoRing_probe(int fd)
+{
+    static const uint8_t opcodes[]
+        = {
+            IORING_OP_NOP,
+            IORING_OP_WRITE_FIXED,
+            IORING_OP_RECV,
+            IORING_OP_SEND,
+            IORING_OP_ASYNC_CANCEL
+        };
+    size_t size
+        = sizeof(struct io_uring_probe)
+            + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, size);
+    int supported = 0;
+
+    if (!probe)
+        return 0;
+    if (IoRing_register(fd, IORING_REGISTER_PROBE, probe, 256) == 0)
+    {
+        size_t i;
+
+        supported = 1;
+        for (i = 0; i < sizeof(opcodes) / sizeof(opcodes[0]); i++)
+        {
+            uint8_t opcode = opcodes[i];
+
+            if ((opcode > probe->last_op)
+                    || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED))
+            {
+                supported = 0;
+                break;
+            }
+        }
+    }
+    free(probe);
+    return supported;
+}
+
+int
+IoRing_isSupported(void)
+{
+    pthread_mutex_lock(&IoRing_lifecycleMutex);
+    if (IoRing_supported < 0)
+    {
+        struct io_uring_params params;
+        int fd;
+
+        memset(&params, 0, sizeof(params));
+        fd = IoRing_setup(1, &params);
+        IoRing_supported = (fd >= 0) && IoRing_probe(fd);
+        if (fd >= 0)
+            close(fd);
+    }
+    pthread_mutex_unlock(&IoRing_lifecycleMutex);
+    return IoRing_supported;
+}
+
+IoRingFile *
+IoRingFile_open(const char *path)
+{
+    IoRingFile *file = calloc(1, sizeof(IoRingFile));
+
+    if (!file)
+        return NULL;
+    file->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file->fd < 0)
+    {
+        free(file);
+        return NULL;
+    }
+    if (!IoRing_acquire())
+    {
+        int err = errno;
+
+        close(file->fd);
+        free(file);
+        errno = err;
+        return NULL;
+    }
+    pthread_cond_init(&(file->cond), NULL);
+    return file;
+}
+
+/** Submits the buffer being filled. Called with IoRing_mutex held. */
+static void
+IoRingFile_submitCurrent(IoRing *ring, IoRingFile *file)
+{
+    IoRingBuffer *buffer = file->current;
+
+    if (!buffer)
+        return;
+    file->current = NULL;
+    if (buffer->length == 0)
+    {
+        IoRing_releaseBuffer(ring, buffer);
+    }
+    else if (IoRing_submitBuffer(ring, buffer) == 0)
+    {
+        file->pending++;
+    }
+    else
+    {
+        if (!file->error)
+            file->error = EBUSY;
+        IoRing_releaseBuffer(ring, buffer);
+    }
+}
+
+int
+IoRingFile_write(IoRingFile *file, const uint8_t *data, int length)
+{
+    IoRing *ring = IoRing_ring;
+    int ret;
+
+    pthread_mutex_lock(&IoRing_mutex);
+    while ((length > 0) && !file->error)
+    {
+        IoRingBuffer *buffer = file->current;
+        uint32_t n;
+
+        if (buffer
+                && ((buffer->fileOffset + buffer->length
+                            != (uint64_t) file->position)
+                        || (buffer->length == IO_RING_BUFFER_SIZE)))
+        {
+            IoRingFile_submitCurrent(ring, file);
+            buffer = NULL;
+        }
+        if (!buffer)
+        {
+            while (!ring->freeBuffers)
+            {
+                /* The buffers of other files may be waiting to be sent. */
+                IoRing_submit(ring);
+                pthread_cond_wait(&(ring->bufferCond), &IoRing_mutex);
+            }
+            buffer = ring->freeBuffers;
+            ring->freeBuffers = buffer->nextFree;
+            buffer->file = file;
+            buffer->fileOffset = file->position;
+            buffer->length = 0;
+            buffer->written = 0;
+            file->current = buffer;
+        }
+
+        n = IO_RING_BUFFER_SIZE - buffer->length;
+        if (n > (uint32_t) length)
+            n = length;
+        memcpy(buffer->data + buffer->length, data, n);
+        buffer->length += n;
+        file->position += n;
+        data += n;
+        length -= n;
+    }
+    IoRing_submit(ring);
+    ret = -(file->error);
+    pthread_mutex_unlock(&IoRing_mutex);
+    return ret;
+}
+
+/** Waits for the writes of a file to complete. Called with IoRing_mutex held. */
+static int
+IoRingFile_drain(IoRing *ring, IoRingFile *file)
+{
+    IoRingFile_submitCurrent(ring, file);
+    IoRing_submit(ring);
+    while (file->pending)
+        pthread_cond_wait(&(file->cond), &IoRing_mutex);
+    return -(file->error);
+}
+
+int
+IoRingFile_seek(IoRingFile *file, int64_t position)
+{
+    int ret;
+
+    pthread_mutex_lock(&IoRing_mutex);
+    ret = IoRingFile_drain(IoRing_ring, file);
+    file->position = position;
+    pthread_mutex_unlock(&IoRing_mutex);
+    return ret;
+}
+
+int64_t
+IoRingFile_tell(IoRingFile *file)
+{
+    int64_t position;
+
+    pthread_mutex_lock(&IoRing_mutex);
+    position = file->position;
+    pthread_mutex_unlock(&IoRing_mutex);
+    return position;
+}
+
+int
+IoRingFile_flush(IoRingFile *file)
+{
+    int ret;
+
+    pthread_mutex_lock(&IoRing_mutex);
+    ret = IoRingFile_drain(IoRing_ring, file);
+    pthread_mutex_unlock(&IoRing_mutex);
+    return ret;
+}
+
+int
+IoRingFile_close(IoRingFile *file)
+{
+    int ret = IoRingFile_flush(file);
+
+    if ((close(file->fd) != 0) && !ret)
+        ret = -errno;
+    pthread_cond_destroy(&(file->cond));
+    free(file);
+    IoRing_release();
+    return ret;
+}
+
+IoRingStream *
+IoRingStream_open(int fd)
+{
+    IoRingStream *stream = calloc(1, sizeof(IoRingStream));
+    IoRing *ring;
+
+    if (!stream)
+        return NULL;
+    stream->rq = IoRing_allocQueue();
+    stream->tq = stream->rq ? IoRing_allocQueue() : NULL;
+    ring = stream->tq ? IoRing_acquire() : NULL;
+    if (!ring)
+    {
+        int err = errno;
+
+        IoRing_freeQueue(stream->rq);
+        IoRing_freeQueue(stream->tq);
+        free(stream);
+        errno = err;
+        return NULL;
+    }
+
+    stream->fd = fd;
+    stream->recvOp.type = IO_RING_OP_RECV;
+    stream->recvOp.owner = stream;
+    stream->sendOp.type = IO_RING_OP_SEND;
+    stream->sendOp.owner = stream;
+    stream->cancelOp.type = IO_RING_OP_CANCEL;
+    stream->cancelOp.owner = stream;
+    pthread_cond_init(&(stream->cond), NULL);
+
+    pthread_mutex_lock(&IoRing_mutex);
+    IoRingStream_submitRecv(ring, stream);
+    IoRing_submit(ring);
+    pthread_mutex_unlock(&IoRing_mutex);
+    return stream;
+}
+
+int
+IoRingStream_send(IoRingStream *stream, const uint8_t *data, int length)
+{
+    IoRing *ring = IoRing_ring;
+    uint8_t header[2];
+    int ret = -1;
+
+    if ((length < 0) || (length > IO_RING_MAX_PACKET_SIZE))
+        return -1;
+    header[0] = (uint8_t) (length >> 8);
+    header[1] = (uint8_t) length;
+
+    pthread_mutex_lock(&IoRing_mutex);
+    if (stream->closing || stream->failed)
+    {
+        /* Fails. */
+    }
+    else if (IO_RING_QUEUE_SIZE - (stream->tqTail - stream->tqHead)
+            < (uint32_t) (2 + length))
+    {
+        stream->stats.sendOverflows++;
+    }
+    else
+    {
+        uint8_t *frame = stream->tq + (stream->tqTail & IO_RING_QUEUE_MASK);
+
+        memcpy(frame, header, 2);
+        memcpy(frame + 2, data, length);
+        stream->tqTail += 2 + length;
+        stream->stats.packetsSent++;
+        stream->stats.bytesSent += length;
+        IoRingStream_submitSend(ring, stream);
+        IoRing_submit(ring);
+        ret = 0;
+    }
+    pthread_mutex_unlock(&IoRing_mutex);
+    return ret;
+}
+
+int
+IoRingStream_wait(IoRingStream *stream, int timeoutMillis)
+{
+    struct timespec deadline;
+    int ret;
+
+    IoRing_deadline(&deadline, timeoutMillis);
+
+    pthread_mutex_lock(&IoRing_mutex);
+    stream->receivers++;
+    while ((stream->rqHead == stream->rqParsed)
+            && !stream->closing
+            && !stream->failed)
+    {
+        if (pthread_cond_timedwait(&(stream->cond), &IoRing_mutex, &deadline)
+                == ETIMEDOUT)
+            break;
+    }
+    if (stream->rqHead != stream->rqParsed)
+        ret = 1;
+    else if (stream->closing || stream->failed)
+        ret = -1;
+    else
+        ret = 0;
+    stream->receivers--;
+    if (stream->closing)
+        pthread_cond_broadcast(&(stream->cond));
+    pthread_mutex_unlock(&IoRing_mutex);
+    return ret;
+}
+
+int
+IoRingStream_receiveBatch(
+        IoRingStream *stream,
+        uint8_t *buf, int length,
+        int *lengths, int maxPackets)
+{
+    IoRing *ring = IoRing_ring;
+    int count = 0, offset = 0;
+
+    pthread_mutex_lock(&IoRing_mutex);
+    while ((count < maxPackets) && (stream->rqHead != stream->rqParsed))
+    {
+        const uint8_t *frame
+            = stream->rq + (stream->rqHead & IO_RING_QUEUE_MASK);
+        int frameLength = (frame[0] << 8) | frame[1];
+        int n = frameLength;
+
+        if (n > length - offset)
+        {
+            /* Only a packet longer than the whole buffer is truncated. */
+            if (count)
+                break;
+            n = length;
+        }
+        memcpy(buf + offset, frame + 2, n);
+        lengths[count++] = n;
+        offset += n;
+        stream->rqHead += 2 + frameLength;
+    }
+    if (count == 0)
+    {
+        if (stream->closing || stream->failed)
+            count = -1;
+    }
+    else if (stream->rxPaused)
+    {
+        /* Resumes receiving now that there is room. */
+        stream->rxPaused = 0;
+        IoRingStream_submitRecv(ring, stream);
+        IoRing_submit(ring);
+    }
+    pthread_mutex_unlock(&IoRing_mutex);
+    return count;
+}
+
+void
+IoRingStream_getStats(IoRingStream *stream, IoRingStreamStats *stats)
+{
+    pthread_mutex_lock(&IoRing_mutex);
+    *stats = stream->stats;
+    pthread_mutex_unlock(&IoRing_mutex);
+}
+
+/** Cancels a submission of a stream. Called with IoRing_mutex held. */
+static void
+IoRingStream_cancel(IoRing *ring, IoRingStream *stream, IoRingOp *op)
+{
+    struct io_uring_sqe *sqe = IoRing_getSqe(ring, &(stream->cancelOp));
+
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = (uint64_t) (uintptr_t) op;
+    IoRing_commitSqe(ring);
+    IoRing_submit(ring);
+}
+
+void
+IoRingStream_close(IoRingStream *stream)
+{
+    IoRing *ring = IoRing_ring;
+    struct timespec deadline;
+    int canceledSend = 0;
+
+    IoRing_deadline(&deadline, IO_RING_CLOSE_LINGER_MILLIS);
+
+    pthread_mutex_lock(&IoRing_mutex);
+    stream->closing = 1;
+    pthread_cond_broadcast(&(stream->cond));
+    if (stream->receiving)
+        IoRingStream_cancel(ring, stream, &(stream->recvOp));
+
+    /*
+     * Lingers for the queued frames to be sent and waits for the cancellation
+     * of the receive, whose completion is the last use of the stream by the
+     * ring, and for the threads waiting to receive to leave.
+     */
+    while (stream->receiving || stream->sending || stream->receivers)
+    {
+        if ((pthread_cond_timedwait(&(stream->cond), &IoRing_mutex, &deadline)
+                    == ETIMEDOUT)
+                && stream->sending
+                && !canceledSend)
+        {
+            IoRingStream_cancel(ring, stream, &(stream->sendOp));
+            canceledSend = 1;
+        }
+    }
+    pthread_mutex_unlock(&IoRing_mutex);
+
+    pthread_cond_destroy(&(stream->cond));
+    IoRing_freeQueue(stream->rq);
+    IoRing_freeQueue(stream->tq);
+    free(stream);
+    IoRing_release();
+}
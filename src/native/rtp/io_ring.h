@@ -0,0 +1,163 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNRTP_IO_RING_H_
+#define _JNRTP_IO_RING_H_
+
+#include <stdint.h>
+
+/*
+ * Asynchronous file and TCP I/O through a single io_uring shared by all the
+ * recordings and TCP media connections of the process. The ring and its
+ * completion thread are created with the first file or stream and destroyed
+ * with the last.
+ */
+
+/** The number of submission queue entries of the ring. */
+#define IO_RING_ENTRIES 256
+
+/** The number of completion queue entries requested for the ring. */
+#define IO_RING_CQ_ENTRIES 4096
+
+/**
+ * The size of each of the buffers registered with the ring, into which the
+ * writes to files are coalesced.
+ */
+#define IO_RING_BUFFER_SIZE 65536
+
+/** The number of registered buffers, shared by all the files. */
+#define IO_RING_BUFFER_COUNT 32
+
+/** The largest payload of an RFC 4571 frame. */
+#define IO_RING_MAX_PACKET_SIZE 65535
+
+/**
+ * The size of the queues of a stream of the packets received and of the
+ * frames to send (power of 2).
+ */
+#define IO_RING_QUEUE_SIZE 262144
+
+/** The largest number of packets taken by an IoRingStream_receiveBatch. */
+#define IO_RING_MAX_BATCH 256
+
+typedef struct IoRingFile IoRingFile;
+typedef struct IoRingStream IoRingStream;
+
+/** The statistics of an IoRingStream. */
+typedef struct
+{
+    uint64_t packetsReceived;
+    uint64_t packetsSent;
+    uint64_t bytesReceived;
+    uint64_t bytesSent;
+    /** The packets not sent because the send queue was full. */
+    uint64_t sendOverflows;
+    /** The times receiving paused because the receive queue was full. */
+    uint64_t receivePauses;
+} IoRingStreamStats;
+
+/**
+ * Tells if the kernel supports io_uring and the operations used by the ring,
+ * probing it the first time.
+ *
+ * @return 1 if supported, 0 otherwise
+ */
+int IoRing_isSupported(void);
+
+/**
+ * Opens a file for writing, truncating it.
+ *
+ * @return the new file or NULL with errno set
+ */
+IoRingFile *IoRingFile_open(const char *path);
+
+/**
+ * Writes at the current position of a file, which is advanced. The data is
+ * copied into a registered buffer and written asynchronously once the buffer
+ * is full or the file is flushed. Blocks only while all the registered
+ * buffers are being written.
+ *
+ * @return 0 or the negated errno of a failed earlier write
+ */
+int IoRingFile_write(IoRingFile *file, const uint8_t *data, int length);
+
+/**
+ * Sets the position of the next write of a file, after waiting for the
+ * writes before it to complete so that they are not reordered.
+ *
+ * @return 0 or the negated errno of a failed write
+ */
+int IoRingFile_seek(IoRingFile *file, int64_t position);
+
+/** Gets the position of the next write of a file. */
+int64_t IoRingFile_tell(IoRingFile *file);
+
+/**
+ * Writes whatever is buffered and waits for the writes of a file to complete.
+ *
+ * @return 0 or the negated errno of a failed write
+ */
+int IoRingFile_flush(IoRingFile *file);
+
+/**
+ * Flushes and closes a file.
+ *
+ * @return 0 or the negated errno of a failed write
+ */
+int IoRingFile_close(IoRingFile *file);
+
+/**
+ * Opens a stream of RFC 4571 framed packets over a connected TCP socket. The
+ * socket remains owned by the caller and must stay open until the stream is
+ * closed.
+ *
+ * @return the new stream or NULL with errno set
+ */
+IoRingStream *IoRingStream_open(int fd);
+
+/**
+ * Queues a packet to be framed and sent. Never blocks.
+ *
+ * @return 0 or -1 if the packet is too large, the send queue is full or the
+ * connection has failed
+ */
+int IoRingStream_send(IoRingStream *stream, const uint8_t *data, int length);
+
+/**
+ * Waits for up to a specific time for packets to be received.
+ *
+ * @return 1 if packets are queued, 0 on timeout or -1 if the connection has
+ * been closed or has failed and no more packets are queued
+ */
+int IoRingStream_wait(IoRingStream *stream, int timeoutMillis);
+
+/**
+ * Takes the queued packets, without waiting, copying them back to back into a
+ * buffer. Packets are read from the socket in large chunks and framed in
+ * place, so the cost of a packet is this single copy. A packet longer than the
+ * whole buffer is truncated.
+ *
+ * @param lengths receives the lengths of the packets
+ * @param maxPackets the largest number of packets to take
+ * @return the number of packets taken, 0 if none are queued or -1 if the
+ * connection has been closed or has failed and no more packets are queued
+ */
+int IoRingStream_receiveBatch(
+        IoRingStream *stream,
+        uint8_t *buf, int length,
+        int *lengths, int maxPackets);
+
+void IoRingStream_getStats(IoRingStream *stream, IoRingStreamStats *stats);
+
+/**
+ * Closes a stream, waiting briefly for the queued packets to be sent and
+ * waking up the threads waiting to receive.
+ */
+void IoRingStream_close(IoRingStream *stream);
+
+#endif /* _JNRTP_IO_RING_H_ */
@@ -0,0 +1,176 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_impl_neomedia_transport_NativeIoRing.h"
+
+#include <stdint.h>
+
+#include "io_ring.h"
+#include "rtp_socket.h"
+
+#define STATS_LENGTH 6
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileClose
+    (JNIEnv *env, jclass clazz, jlong file)
+{
+    return IoRingFile_close((IoRingFile *) (intptr_t) file);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileFlush
+    (JNIEnv *env, jclass clazz, jlong file)
+{
+    return IoRingFile_flush((IoRingFile *) (intptr_t) file);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileOpen
+    (JNIEnv *env, jclass clazz, jstring path)
+{
+    const char *path_ = (*env)->GetStringUTFChars(env, path, NULL);
+    IoRingFile *file;
+
+    if (!path_)
+        return 0;
+    file = IoRingFile_open(path_);
+    (*env)->ReleaseStringUTFChars(env, path, path_);
+    return (jlong) (intptr_t) file;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileSeek
+    (JNIEnv *env, jclass clazz, jlong file, jlong position)
+{
+    return IoRingFile_seek((IoRingFile *) (intptr_t) file, position);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileTell
+    (JNIEnv *env, jclass clazz, jlong file)
+{
+    return IoRingFile_tell((IoRingFile *) (intptr_t) file);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileWrite
+    (JNIEnv *env, jclass clazz, jlong file, jbyteArray buf, jint offset,
+        jint length)
+{
+    /*
+     * The write may block until a registered buffer is free so the array is
+     * not accessed critically.
+     */
+    jbyte *buf_ = (*env)->GetByteArrayElements(env, buf, NULL);
+    int ret;
+
+    if (!buf_)
+        return -1;
+    ret
+        = IoRingFile_write(
+                (IoRingFile *) (intptr_t) file,
+                (const uint8_t *) (buf_ + offset), length);
+    (*env)->ReleaseByteArrayElements(env, buf, buf_, JNI_ABORT);
+    return ret;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_isSupported
+    (JNIEnv *env, jclass clazz)
+{
+    return IoRing_isSupported() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamClose
+    (JNIEnv *env, jclass clazz, jlong stream)
+{
+    IoRingStream_close((IoRingStream *) (intptr_t) stream);
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamGetStats
+    (JNIEnv *env, jclass clazz, jlong stream, jlongArray stats)
+{
+    IoRingStreamStats s;
+    jlong stats_[STATS_LENGTH];
+
+    IoRingStream_getStats((IoRingStream *) (intptr_t) stream, &s);
+    stats_[0] = s.packetsReceived;
+    stats_[1] = s.packetsSent;
+    stats_[2] = s.bytesReceived;
+    stats_[3] = s.bytesSent;
+    stats_[4] = s.sendOverflows;
+    stats_[5] = s.receivePauses;
+    (*env)->SetLongArrayRegion(env, stats, 0, STATS_LENGTH, stats_);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamOpen
+    (JNIEnv *env, jclass clazz, jobject socket)
+{
+    int fd = RTPSocket_getFd(env, socket);
+
+    if (fd < 0)
+        return 0;
+    return (jlong) (intptr_t) IoRingStream_open(fd);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamReceiveBatch
+    (JNIEnv *env, jclass clazz, jlong stream, jbyteArray buf,
+        jintArray lengths, jint timeout)
+{
+    IoRingStream *stream_ = (IoRingStream *) (intptr_t) stream;
+    jint lengths_[IO_RING_MAX_BATCH];
+    jint length = (*env)->GetArrayLength(env, buf);
+    jint maxPackets = (*env)->GetArrayLength(env, lengths);
+    jbyte *buf_;
+    int ret;
+
+    /*
+     * The wait blocks so it happens before the array is pinned, the packets
+     * then being copied straight into the array.
+     */
+    ret = IoRingStream_wait(stream_, timeout);
+    if (ret <= 0)
+        return ret;
+
+    if (maxPackets > IO_RING_MAX_BATCH)
+        maxPackets = IO_RING_MAX_BATCH;
+    buf_ = (*env)->GetPrimitiveArrayCritical(env, buf, NULL);
+    if (!buf_)
+        return 0;
+    ret
+        = IoRingStream_receiveBatch(
+                stream_,
+                (uint8_t *) buf_, length,
+                (int *) lengths_, maxPackets);
+    (*env)->ReleasePrimitiveArrayCritical(env, buf, buf_, 0);
+    if (ret > 0)
+        (*env)->SetIntArrayRegion(env, lengths, 0, ret, lengths_);
+    return ret;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamSend
+    (JNIEnv *env, jclass clazz, jlong stream, jbyteArray buf, jint offset,
+        jint length)
+{
+    jbyte *buf_ = (*env)->GetPrimitiveArrayCritical(env, buf, NULL);
+    int ret;
+
+    if (!buf_)
+        return JNI_FALSE;
+    ret
+        = IoRingStream_send(
+                (IoRingStream *) (intptr_t) stream,
+                (const uint8_t *) (buf_ + offset), length);
+    (*env)->ReleasePrimitiveArrayCritical(env, buf, buf_, JNI_ABORT);
+    return (ret == 0) ? JNI_TRUE : JNI_FALSE;
+}
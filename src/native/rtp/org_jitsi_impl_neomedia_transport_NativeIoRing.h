@@ -0,0 +1,109 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_transport_NativeIoRing */
+
+#ifndef _Included_org_jitsi_impl_neomedia_transport_NativeIoRing
+#define _Included_org_jitsi_impl_neomedia_transport_NativeIoRing
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    fileClose
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileClose
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    fileFlush
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileFlush
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    fileOpen
+ * Signature: (Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileOpen
+  (JNIEnv *, jclass, jstring);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    fileSeek
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileSeek
+  (JNIEnv *, jclass, jlong, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    fileTell
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileTell
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    fileWrite
+ * Signature: (J[BII)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_fileWrite
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    isSupported
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_isSupported
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    streamClose
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamClose
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    streamGetStats
+ * Signature: (J[J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamGetStats
+  (JNIEnv *, jclass, jlong, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    streamOpen
+ * Signature: (Ljava/net/Socket;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamOpen
+  (JNIEnv *, jclass, jobject);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    streamReceiveBatch
+ * Signature: (J[B[II)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamReceiveBatch
+  (JNIEnv *, jclass, jlong, jbyteArray, jintArray, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativeIoRing
+ * Method:    streamSend
+ * Signature: (J[BII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_impl_neomedia_transport_NativeIoRing_streamSend
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
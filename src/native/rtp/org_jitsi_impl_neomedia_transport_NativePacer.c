@@ -0,0 +1,89 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_impl_neomedia_transport_NativePacer.h"
+
+#include <stdint.h>
+
+#include "pacer.h"
+#include "rtp_socket.h"
+
+#define STATS_LENGTH 7
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacer_closeStream
+    (JNIEnv *env, jclass clazz, jlong stream)
+{
+    Pacer_closeStream((PacerStream *) (intptr_t) stream);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacer_enqueue
+    (JNIEnv *env, jclass clazz, jlong stream, jbyteArray buf, jint offset,
+        jint length, jbyteArray addr, jint port)
+{
+    jbyte addr_[16];
+    jint addrLength = (*env)->GetArrayLength(env, addr);
+    struct sockaddr_storage sa;
+    socklen_t saLength;
+    jbyte *buf_;
+    int ret;
+
+    if ((addrLength != 4) && (addrLength != 16))
+        return JNI_FALSE;
+    (*env)->GetByteArrayRegion(env, addr, 0, addrLength, addr_);
+    if (RTPSocket_toSockaddr(addr_, addrLength, port, &sa, &saLength))
+        return JNI_FALSE;
+
+    buf_ = (*env)->GetPrimitiveArrayCritical(env, buf, NULL);
+    if (!buf_)
+        return JNI_FALSE;
+    ret
+        = Pacer_enqueue(
+                (PacerStream *) (intptr_t) stream,
+                (const uint8_t *) (buf_ + offset), length,
+                (const struct sockaddr *) &sa, saLength);
+    (*env)->ReleasePrimitiveArrayCritical(env, buf, buf_, JNI_ABORT);
+    return (ret == 0) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacer_getStats
+    (JNIEnv *env, jclass clazz, jlong stream, jlongArray stats)
+{
+    PacerStats s;
+    jlong stats_[STATS_LENGTH];
+
+    Pacer_getStats((PacerStream *) (intptr_t) stream, &s);
+    stats_[0] = s.packetsSent;
+    stats_[1] = s.bytesSent;
+    stats_[2] = s.packetsQueued;
+    stats_[3] = s.overflows;
+    stats_[4] = s.sendErrors;
+    stats_[5] = s.queueDelayAvgNanos;
+    stats_[6] = s.queueDelayMaxNanos;
+    (*env)->SetLongArrayRegion(env, stats, 0, STATS_LENGTH, stats_);
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacer_openStream
+    (JNIEnv *env, jclass clazz, jobject socket, jlong bitrate)
+{
+    int fd = RTPSocket_getFd(env, socket);
+
+    if (fd < 0)
+        return 0;
+    return (jlong) (intptr_t) Pacer_openStream(fd, bitrate);
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacer_setBitrate
+    (JNIEnv *env, jclass clazz, jlong stream, jlong bitrate)
+{
+    Pacer_setBitrate((PacerStream *) (intptr_t) stream, bitrate);
+}
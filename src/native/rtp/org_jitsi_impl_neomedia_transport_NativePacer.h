@@ -0,0 +1,53 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_transport_NativePacer */
+
+#ifndef _Included_org_jitsi_impl_neomedia_transport_NativePacer
+#define _Included_org_jitsi_impl_neomedia_transport_NativePacer
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacer
+ * Method:    closeStream
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacer_closeStream
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacer
+ * Method:    enqueue
+ * Signature: (J[BII[BI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacer_enqueue
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jbyteArray, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacer
+ * Method:    getStats
+ * Signature: (J[J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacer_getStats
+  (JNIEnv *, jclass, jlong, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacer
+ * Method:    openStream
+ * Signature: (Ljava/net/DatagramSocket;J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacer_openStream
+  (JNIEnv *, jclass, jobject, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacer
+ * Method:    setBitrate
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacer_setBitrate
+  (JNIEnv *, jclass, jlong, jlong);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
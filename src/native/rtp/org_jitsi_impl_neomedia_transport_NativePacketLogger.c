@@ -0,0 +1,90 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_impl_neomedia_transport_NativePacketLogger.h"
+
+#include <stdint.h>
+
+#include "pcap_ring.h"
+
+#define STATS_LENGTH 6
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_capture
+    (JNIEnv *env, jclass clazz, jbyteArray buf, jint offset, jint length,
+        jbyteArray srcAddr, jint srcPort, jbyteArray dstAddr, jint dstPort,
+        jboolean tcp)
+{
+    jbyte srcAddr_[16];
+    jbyte dstAddr_[16];
+    jint srcAddrLength = (*env)->GetArrayLength(env, srcAddr);
+    jint dstAddrLength = (*env)->GetArrayLength(env, dstAddr);
+    jbyte *buf_;
+    int ret;
+
+    /* PcapRing_capture counts the packets with invalid addresses as dropped. */
+    if ((srcAddrLength == 4) || (srcAddrLength == 16))
+        (*env)->GetByteArrayRegion(env, srcAddr, 0, srcAddrLength, srcAddr_);
+    else
+        srcAddrLength = 0;
+    if ((dstAddrLength == 4) || (dstAddrLength == 16))
+        (*env)->GetByteArrayRegion(env, dstAddr, 0, dstAddrLength, dstAddr_);
+    else
+        dstAddrLength = 0;
+
+    buf_ = (*env)->GetPrimitiveArrayCritical(env, buf, NULL);
+    if (!buf_)
+        return JNI_FALSE;
+    ret
+        = PcapRing_capture(
+                (const uint8_t *) (buf_ + offset), length,
+                (const uint8_t *) srcAddr_, srcAddrLength, srcPort,
+                (const uint8_t *) dstAddr_, dstAddrLength, dstPort,
+                (tcp == JNI_TRUE));
+    (*env)->ReleasePrimitiveArrayCritical(env, buf, buf_, JNI_ABORT);
+    return (ret == 0) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_getStats
+    (JNIEnv *env, jclass clazz, jlongArray stats)
+{
+    PcapRingStats s;
+    jlong stats_[STATS_LENGTH];
+
+    PcapRing_getStats(&s);
+    stats_[0] = s.packetsCaptured;
+    stats_[1] = s.packetsDropped;
+    stats_[2] = s.packetsWritten;
+    stats_[3] = s.bytesWritten;
+    stats_[4] = s.filesRotated;
+    stats_[5] = s.writeErrors;
+    (*env)->SetLongArrayRegion(env, stats, 0, STATS_LENGTH, stats_);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_start
+    (JNIEnv *env, jclass clazz, jstring pathPrefix, jlong fileLimit,
+        jint fileCount, jint snapLength)
+{
+    const char *pathPrefix_ = (*env)->GetStringUTFChars(env, pathPrefix, NULL);
+    int ret;
+
+    if (!pathPrefix_)
+        return JNI_FALSE;
+    ret = PcapRing_start(pathPrefix_, fileLimit, fileCount, snapLength);
+    (*env)->ReleaseStringUTFChars(env, pathPrefix, pathPrefix_);
+    return (ret == 0) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_stop
+    (JNIEnv *env, jclass clazz)
+{
+    PcapRing_stop();
+}
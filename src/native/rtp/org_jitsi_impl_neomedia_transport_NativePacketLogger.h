@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_transport_NativePacketLogger */
+
+#ifndef _Included_org_jitsi_impl_neomedia_transport_NativePacketLogger
+#define _Included_org_jitsi_impl_neomedia_transport_NativePacketLogger
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacketLogger
+ * Method:    capture
+ * Signature: ([BII[BI[BIZ)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_capture
+  (JNIEnv *, jclass, jbyteArray, jint, jint, jbyteArray, jint, jbyteArray, jint, jboolean);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacketLogger
+ * Method:    getStats
+ * Signature: ([J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_getStats
+  (JNIEnv *, jclass, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacketLogger
+ * Method:    start
+ * Signature: (Ljava/lang/String;JII)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_start
+  (JNIEnv *, jclass, jstring, jlong, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_NativePacketLogger
+ * Method:    stop
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_NativePacketLogger_stop
+  (JNIEnv *, jclass);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#include "org_jitsi_impl_neomedia_transport_RetransmissionHistory.h"
+
+#include <stdint.h>
+
+#include "rtp_socket.h"
+#include "rtx_history.h"
+
+#define STATS_LENGTH 5
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_create
+    (JNIEnv *env, jclass clazz, jobject socket, jint capacity)
+{
+    int fd = RTPSocket_getFd(env, socket);
+
+    if (fd < 0)
+        return 0;
+    return (jlong) (intptr_t) RtxHistory_create(fd, capacity);
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_destroy
+    (JNIEnv *env, jclass clazz, jlong history)
+{
+    RtxHistory_destroy((RtxHistory *) (intptr_t) history);
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_getStats
+    (JNIEnv *env, jclass clazz, jlong history, jlongArray stats)
+{
+    RtxStats s;
+    jlong stats_[STATS_LENGTH];
+
+    RtxHistory_getStats((RtxHistory *) (intptr_t) history, &s);
+    stats_[0] = s.packetsStored;
+    stats_[1] = s.nacksReceived;
+    stats_[2] = s.packetsRequested;
+    stats_[3] = s.packetsResent;
+    stats_[4] = s.packetsMissed;
+    (*env)->SetLongArrayRegion(env, stats, 0, STATS_LENGTH, stats_);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_handleRtcp
+    (JNIEnv *env, jclass clazz, jlong history, jlong pacer, jbyteArray buf,
+        jint offset, jint length)
+{
+    jbyte *buf_ = (*env)->GetPrimitiveArrayCritical(env, buf, NULL);
+    int ret;
+
+    if (!buf_)
+        return 0;
+    ret
+        = RtxHistory_handleRtcp(
+                (RtxHistory *) (intptr_t) history,
+                (PacerStream *) (intptr_t) pacer,
+                (const uint8_t *) (buf_ + offset), length);
+    (*env)->ReleasePrimitiveArrayCritical(env, buf, buf_, JNI_ABORT);
+    return ret;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_store
+    (JNIEnv *env, jclass clazz, jlong history, jbyteArray buf, jint offset,
+        jint length, jbyteArray addr, jint port)
+{
+    jbyte addr_[16];
+    jint addrLength = (*env)->GetArrayLength(env, addr);
+    struct sockaddr_storage sa;
+    socklen_t saLength;
+    jbyte *buf_;
+
+    if ((addrLength != 4) && (addrLength != 16))
+        return;
+    (*env)->GetByteArrayRegion(env, addr, 0, addrLength, addr_);
+    if (RTPSocket_toSockaddr(addr_, addrLength, port, &sa, &saLength))
+        return;
+
+    buf_ = (*env)->GetPrimitiveArrayCritical(env, buf, NULL);
+    if (!buf_)
+        return;
+    RtxHistory_store(
+            (RtxHistory *) (intptr_t) history,
+            (const uint8_t *) (buf_ + offset), length,
+            (const struct sockaddr *) &sa, saLength);
+    (*env)->ReleasePrimitiveArrayCritical(env, buf, buf_, JNI_ABORT);
+}
@@ -0,0 +1,53 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_transport_RetransmissionHistory */
+
+#ifndef _Included_org_jitsi_impl_neomedia_transport_RetransmissionHistory
+#define _Included_org_jitsi_impl_neomedia_transport_RetransmissionHistory
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_RetransmissionHistory
+ * Method:    create
+ * Signature: (Ljava/net/DatagramSocket;I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_create
+  (JNIEnv *, jclass, jobject, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_RetransmissionHistory
+ * Method:    destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_destroy
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_RetransmissionHistory
+ * Method:    getStats
+ * Signature: (J[J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_getStats
+  (JNIEnv *, jclass, jlong, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_RetransmissionHistory
+ * Method:    handleRtcp
+ * Signature: (JJ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_handleRtcp
+  (JNIEnv *, jclass, jlong, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_transport_RetransmissionHistory
+ * Method:    store
+ * Signature: (J[BII[BI)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_transport_RetransmissionHistory_store
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jbyteArray, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
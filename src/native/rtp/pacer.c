@@ -0,0 +1,468 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "pacer.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+    uint64_t enqueueNanos;
+    struct sockaddr_storage addr;
+    socklen_t addrLength;
+    int length;
+    uint8_t data[PACER_MAX_PACKET_SIZE];
+} PacerSlot;
+
+struct PacerStream
+{
+    int fd;
+    int64_t bitrate;
+    double tokens;
+    uint64_t lastRefillNanos;
+
+    PacerSlot *slots;
+    /* Written by the pacer thread only. */
+    uint32_t head;
+    /* Written by the producers with producerMutex held. */
+    uint32_t tail;
+    pthread_mutex_t producerMutex;
+
+    /* Protected by Pacer_mutex. */
+    uint64_t packetsSent;
+    uint64_t bytesSent;
+    uint64_t sendErrors;
+    uint64_t queueDelaySumNanos;
+    uint64_t queueDelayCount;
+    uint64_t queueDelayMaxNanos;
+    /* Written by the producers with producerMutex held. */
+    uint64_t overflows;
+
+    struct PacerStream *next;
+};
+
+/** Serializes the starting and stopping of the pacer thread. */
+static pthread_mutex_t Pacer_lifecycleMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** Protects Pacer_streams and the statistics of the streams. */
+static pthread_mutex_t Pacer_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static PacerStream *Pacer_streams = NULL;
+static int Pacer_eventFd = -1;
+static int Pacer_idle = 0;
+static int Pacer_running = 0;
+static pthread_t Pacer_thread;
+static int Pacer_timerFd = -1;
+
+static uint64_t
+Pacer_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+Pacer_armTimer(int arm)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    if (arm)
+    {
+        its.it_value.tv_nsec = PACER_TICK_NANOS;
+        its.it_interval.tv_nsec = PACER_TICK_NANOS;
+    }
+    timerfd_settime(Pacer_timerFd, 0, &its, NULL);
+}
+
+/**
+ * Sends as many queued packets of a specific stream as its token bucket
+ * allows. Must be called with Pacer_mutex held.
+ *
+ * @return non-zero if the stream still has packets queued
+ */
+static int
+Pacer_drainStream(PacerStream *stream, uint64_t now, int flush)
+{
+    struct mmsghdr msgs[PACER_MAX_BATCH];
+    struct iovec iovs[PACER_MAX_BATCH];
+    int64_t bitrate = __atomic_load_n(&(stream->bitrate), __ATOMIC_RELAXED);
+    uint32_t head = stream->head;
+    uint32_t tail = __atomic_load_n(&(stream->tail), __ATOMIC_ACQUIRE);
+
+    if (bitrate > 0)
+    {
+        double burst = (bitrate / 8.0) * (PACER_BURST_NANOS / 1e9);
+
+        if (burst < 2 * 1500)
+            burst = 2 * 1500;
+        stream->tokens
+            += (bitrate / 8.0) * ((now - stream->lastRefillNanos) / 1e9);
+        if (stream->tokens > burst)
+            stream->tokens = burst;
+    }
+    stream->lastRefillNanos = now;
+
+    while (head != tail)
+    {
+        int count = 0;
+        int dropped = 0;
+        int sent;
+        int i;
+
+        while ((head + count != tail)
+                && (count < PACER_MAX_BATCH)
+                && (flush || (bitrate <= 0) || (stream->tokens > 0)))
+        {
+            PacerSlot *slot
+                = stream->slots + ((head + count) & (PACER_QUEUE_CAPACITY - 1));
+
+            iovs[count].iov_base = slot->data;
+            iovs[count].iov_len = slot->length;
+            memset(&(msgs[count]), 0, sizeof(struct mmsghdr));
+            msgs[count].msg_hdr.msg_name = &(slot->addr);
+            msgs[count].msg_hdr.msg_namelen = slot->addrLength;
+            msgs[count].msg_hdr.msg_iov = &(iovs[count]);
+            msgs[count].msg_hdr.msg_iovlen = 1;
+            stream->tokens -= slot->length;
+            count++;
+        }
+        if (!count)
+            break;
+
+        sent = sendmmsg(stream->fd, msgs, count, flush ? 0 : MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (!flush
+                    && ((errno == EAGAIN)
+                        || (errno == EWOULDBLOCK)
+                        || (errno == ENOBUFS)
+                        || (errno == EINTR)))
+                sent = 0;
+            else
+            {
+                /*
+                 * Only the first packet is known to have failed. Drop it so
+                 * that it does not hold up the ones behind it.
+                 */
+                stream->sendErrors++;
+                sent = 0;
+                dropped = 1;
+            }
+        }
+        for (i = 0; i < sent; i++)
+        {
+            PacerSlot *slot
+                = stream->slots + ((head + i) & (PACER_QUEUE_CAPACITY - 1));
+            uint64_t delay = now - slot->enqueueNanos;
+
+            stream->packetsSent++;
+            stream->bytesSent += slot->length;
+            stream->queueDelaySumNanos += delay;
+            stream->queueDelayCount++;
+            if (delay > stream->queueDelayMaxNanos)
+                stream->queueDelayMaxNanos = delay;
+        }
+        /*
+         * The packets which were not sent stay queued, in order, and are
+         * retried on the next tick with the tokens they were charged.
+         */
+        for (i = sent + dropped; i < count; i++)
+        {
+            PacerSlot *slot
+                = stream->slots + ((head + i) & (PACER_QUEUE_CAPACITY - 1));
+
+            stream->tokens += slot->length;
+        }
+        head += sent + dropped;
+        __atomic_store_n(&(stream->head), head, __ATOMIC_RELEASE);
+        /* A flush blocks and drops what fails so it always makes progress. */
+        if (!flush && (sent < count))
+            break;
+    }
+    return head != tail;
+}
+
+static int
+Pacer_drainAll(uint64_t now)
+{
+    PacerStream *stream;
+    int pending = 0;
+
+    pthread_mutex_lock(&Pacer_mutex);
+    for (stream = Pacer_streams; stream; stream = stream->next)
+        pending |= Pacer_drainStream(stream, now, 0);
+    pthread_mutex_unlock(&Pacer_mutex);
+    return pending;
+}
+
+static int
+Pacer_hasPending()
+{
+    PacerStream *stream;
+    int pending = 0;
+
+    pthread_mutex_lock(&Pacer_mutex);
+    for (stream = Pacer_streams; stream && !pending; stream = stream->next)
+    {
+        pending
+            = stream->head
+                != __atomic_load_n(&(stream->tail), __ATOMIC_ACQUIRE);
+    }
+    pthread_mutex_unlock(&Pacer_mutex);
+    return pending;
+}
+
+static void *
+Pacer_run(void *arg)
+{
+    struct pollfd fds[2];
+    int armed = 0;
+
+    fds[0].fd = Pacer_timerFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = Pacer_eventFd;
+    fds[1].events = POLLIN;
+
+    while (__atomic_load_n(&Pacer_running, __ATOMIC_ACQUIRE))
+    {
+        uint64_t value;
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            if (read(Pacer_timerFd, &value, sizeof(value)) < 0)
+                value = 0;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            if (read(Pacer_eventFd, &value, sizeof(value)) < 0)
+                value = 0;
+        }
+
+        if (Pacer_drainAll(Pacer_now()))
+        {
+            if (!armed)
+            {
+                Pacer_armTimer(1);
+                armed = 1;
+            }
+        }
+        else
+        {
+            /*
+             * Announce the idleness before checking the queues once more so
+             * that a producer either sees it and wakes us up or has its
+             * packet seen by the check.
+             */
+            __atomic_store_n(&Pacer_idle, 1, __ATOMIC_SEQ_CST);
+            if (Pacer_hasPending())
+            {
+                __atomic_store_n(&Pacer_idle, 0, __ATOMIC_SEQ_CST);
+            }
+            else if (armed)
+            {
+                Pacer_armTimer(0);
+                armed = 0;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void
+Pacer_wakeUp()
+{
+    uint64_t one = 1;
+
+    if (write(Pacer_eventFd, &one, sizeof(one)) < 0)
+        one = 0;
+}
+
+static int
+Pacer_startThread()
+{
+    Pacer_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (Pacer_timerFd < 0)
+        return -1;
+    Pacer_eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (Pacer_eventFd < 0)
+    {
+        close(Pacer_timerFd);
+        Pacer_timerFd = -1;
+        return -1;
+    }
+    Pacer_idle = 1;
+    Pacer_running = 1;
+    if (pthread_create(&Pacer_thread, NULL, Pacer_run, NULL))
+    {
+        Pacer_running = 0;
+        close(Pacer_eventFd);
+        close(Pacer_timerFd);
+        Pacer_eventFd = Pacer_timerFd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void
+Pacer_stopThread()
+{
+    __atomic_store_n(&Pacer_running, 0, __ATOMIC_RELEASE);
+    Pacer_wakeUp();
+    pthread_join(Pacer_thread, NULL);
+    close(Pacer_eventFd);
+    close(Pacer_timerFd);
+    Pacer_eventFd = Pacer_timerFd = -1;
+}
+
+PacerStream *
+Pacer_openStream(int fd, int64_t bitrate)
+{
+    PacerStream *stream = calloc(1, sizeof(PacerStream));
+
+    if (!stream)
+        return NULL;
+    stream->slots = malloc(PACER_QUEUE_CAPACITY * sizeof(PacerSlot));
+    if (!stream->slots)
+    {
+        free(stream);
+        return NULL;
+    }
+    pthread_mutex_init(&(stream->producerMutex), NULL);
+    stream->fd = fd;
+    stream->bitrate = bitrate;
+    stream->lastRefillNanos = Pacer_now();
+
+    pthread_mutex_lock(&Pacer_lifecycleMutex);
+    if (!Pacer_running && Pacer_startThread())
+    {
+        pthread_mutex_unlock(&Pacer_lifecycleMutex);
+        pthread_mutex_destroy(&(stream->producerMutex));
+        free(stream->slots);
+        free(stream);
+        return NULL;
+    }
+    pthread_mutex_lock(&Pacer_mutex);
+    stream->next = Pacer_streams;
+    Pacer_streams = stream;
+    pthread_mutex_unlock(&Pacer_mutex);
+    pthread_mutex_unlock(&Pacer_lifecycleMutex);
+    return stream;
+}
+
+void
+Pacer_closeStream(PacerStream *stream)
+{
+    PacerStream **prev;
+    int last;
+
+    pthread_mutex_lock(&Pacer_lifecycleMutex);
+    pthread_mutex_lock(&Pacer_mutex);
+    for (prev = &Pacer_streams; *prev; prev = &((*prev)->next))
+    {
+        if (*prev == stream)
+        {
+            *prev = stream->next;
+            break;
+        }
+    }
+    /* Whatever is still queued was accepted for sending so send it now. */
+    Pacer_drainStream(stream, Pacer_now(), 1);
+    last = (Pacer_streams == NULL);
+    pthread_mutex_unlock(&Pacer_mutex);
+    if (last && Pacer_running)
+        Pacer_stopThread();
+    pthread_mutex_unlock(&Pacer_lifecycleMutex);
+
+    pthread_mutex_destroy(&(stream->producerMutex));
+    free(stream->slots);
+    free(stream);
+}
+
+void
+Pacer_setBitrate(PacerStream *stream, int64_t bitrate)
+{
+    __atomic_store_n(&(stream->bitrate), bitrate, __ATOMIC_RELAXED);
+}
+
+int
+Pacer_enqueue(
+        PacerStream *stream,
+        const uint8_t *data, int length,
+        const struct sockaddr *addr, socklen_t addrLength)
+{
+    uint32_t tail;
+    uint32_t head;
+    PacerSlot *slot;
+
+    if ((length > PACER_MAX_PACKET_SIZE)
+            || (addrLength > sizeof(struct sockaddr_storage)))
+        return -1;
+
+    pthread_mutex_lock(&(stream->producerMutex));
+    tail = stream->tail;
+    head = __atomic_load_n(&(stream->head), __ATOMIC_ACQUIRE);
+    if (tail - head >= PACER_QUEUE_CAPACITY)
+    {
+        stream->overflows++;
+        pthread_mutex_unlock(&(stream->producerMutex));
+        return -1;
+    }
+
+    slot = stream->slots + (tail & (PACER_QUEUE_CAPACITY - 1));
+    memcpy(slot->data, data, length);
+    slot->length = length;
+    memcpy(&(slot->addr), addr, addrLength);
+    slot->addrLength = addrLength;
+    slot->enqueueNanos = Pacer_now();
+    __atomic_store_n(&(stream->tail), tail + 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&(stream->producerMutex));
+
+    if (__atomic_exchange_n(&Pacer_idle, 0, __ATOMIC_SEQ_CST))
+        Pacer_wakeUp();
+    return 0;
+}
+
+void
+Pacer_getStats(PacerStream *stream, PacerStats *stats)
+{
+    pthread_mutex_lock(&Pacer_mutex);
+    stats->packetsSent = stream->packetsSent;
+    stats->bytesSent = stream->bytesSent;
+    stats->packetsQueued
+        = __atomic_load_n(&(stream->tail), __ATOMIC_ACQUIRE) - stream->head;
+    stats->overflows = stream->overflows;
+    stats->sendErrors = stream->sendErrors;
+    stats->queueDelayAvgNanos
+        = stream->queueDelayCount
+            ? (stream->queueDelaySumNanos / stream->queueDelayCount)
+            : 0;
+    stats->queueDelayMaxNanos = stream->queueDelayMaxNanos;
+    stream->queueDelaySumNanos = 0;
+    stream->queueDelayCount = 0;
+    stream->queueDelayMaxNanos = 0;
+    pthread_mutex_unlock(&Pacer_mutex);
+}
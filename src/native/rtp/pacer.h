@@ -0,0 +1,78 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNRTP_PACER_H_
+#define _JNRTP_PACER_H_
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+/** The largest datagram which may be queued for paced sending. */
+#define PACER_MAX_PACKET_SIZE 2048
+
+/** The number of packets which may be queued per stream (power of 2). */
+#define PACER_QUEUE_CAPACITY 512
+
+/** The interval at which the pacer thread refills the token buckets. */
+#define PACER_TICK_NANOS 1000000
+
+/** The maximum number of datagrams handed to a single sendmmsg call. */
+#define PACER_MAX_BATCH 32
+
+/**
+ * The time worth of tokens which a stream may accumulate while idle i.e. the
+ * size of the burst allowed after a quiet period.
+ */
+#define PACER_BURST_NANOS 5000000
+
+typedef struct PacerStream PacerStream;
+
+/** The statistics of a PacerStream. Delays are reset on every read. */
+typedef struct
+{
+    uint64_t packetsSent;
+    uint64_t bytesSent;
+    uint64_t packetsQueued;
+    uint64_t overflows;
+    uint64_t sendErrors;
+    uint64_t queueDelayAvgNanos;
+    uint64_t queueDelayMaxNanos;
+} PacerStats;
+
+/**
+ * Opens a new paced stream sending through a specific UDP socket. The shared
+ * pacer thread is started with the first stream.
+ *
+ * @param fd the file descriptor of the UDP socket to send through
+ * @param bitrate the pacing rate in bits per second; 0 disables pacing
+ * @return the new stream or NULL on failure
+ */
+PacerStream *Pacer_openStream(int fd, int64_t bitrate);
+
+/**
+ * Closes a specific paced stream, flushing any queued packets. The shared
+ * pacer thread is stopped with the last stream.
+ */
+void Pacer_closeStream(PacerStream *stream);
+
+void Pacer_setBitrate(PacerStream *stream, int64_t bitrate);
+
+/**
+ * Queues a datagram for paced sending. May be called from multiple threads.
+ *
+ * @return 0 if the datagram was queued or -1 if the queue is full or the
+ * datagram is too large
+ */
+int Pacer_enqueue(
+        PacerStream *stream,
+        const uint8_t *data, int length,
+        const struct sockaddr *addr, socklen_t addrLength);
+
+void Pacer_getStats(PacerStream *stream, PacerStats *stats);
+
+#endif /* _JNRTP_PACER_H_ */
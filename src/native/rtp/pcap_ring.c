@@ -0,0 +1,544 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "pcap_ring.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** The pcapng block types (draft-ietf-opsawg-pcapng). */
+#define PCAPNG_SECTION_HEADER_BLOCK 0x0A0D0D0A
+#define PCAPNG_INTERFACE_DESCRIPTION_BLOCK 0x00000001
+#define PCAPNG_ENHANCED_PACKET_BLOCK 0x00000006
+
+/** The link type of raw IPv4 and IPv6 packets. */
+#define PCAPNG_LINKTYPE_RAW 101
+
+/** The size of the IP and transport headers synthesized for each packet. */
+#define PCAP_RING_MAX_HEADERS_LENGTH (40 + 20)
+
+/**
+ * A slot of the ring. A producer owns the slot when its sequence equals the
+ * position it reserved; the writer thread owns it when the sequence is one
+ * past that position (the bounded MPMC queue of Dmitry Vyukov, with a single
+ * consumer).
+ */
+typedef struct
+{
+    uint64_t sequence;
+    uint64_t timestampNanos;
+    uint8_t srcAddr[16];
+    uint8_t dstAddr[16];
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint8_t addrLength;
+    uint8_t tcp;
+    uint16_t capturedLength;
+    uint32_t length;
+    uint8_t data[PCAP_RING_MAX_SNAP_LENGTH];
+} PcapSlot;
+
+/** Serializes the starting and stopping of the writer thread. */
+static pthread_mutex_t PcapRing_lifecycleMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static PcapSlot *PcapRing_slots = NULL;
+/* Reserved by the producers with an atomic compare-and-swap. */
+static uint64_t PcapRing_head = 0;
+/* Written by the writer thread only. */
+static uint64_t PcapRing_tail = 0;
+
+static int PcapRing_running = 0;
+/* The number of threads in PcapRing_capture, updated atomically. */
+static int PcapRing_producers = 0;
+static int PcapRing_snapLength = PCAP_RING_SNAP_RTP_HEADER;
+static pthread_t PcapRing_thread;
+
+static char *PcapRing_pathPrefix = NULL;
+static int64_t PcapRing_fileLimit = 0;
+static int PcapRing_fileCount = 1;
+static int PcapRing_fileIndex = 0;
+static int64_t PcapRing_fileSize = 0;
+static FILE *PcapRing_file = NULL;
+
+/* Updated atomically. */
+static uint64_t PcapRing_packetsCaptured = 0;
+static uint64_t PcapRing_packetsDropped = 0;
+/* Written by the writer thread only. */
+static uint64_t PcapRing_packetsWritten = 0;
+static uint64_t PcapRing_bytesWritten = 0;
+static uint64_t PcapRing_filesRotated = 0;
+static uint64_t PcapRing_writeErrors = 0;
+
+static uint64_t
+PcapRing_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ((uint64_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Gets the length of the RTP header of a specific packet including CSRCs and
+ * the header extension, or the whole packet if it does not look like RTP.
+ */
+static int
+PcapRing_getRtpHeaderLength(const uint8_t *data, int length)
+{
+    int headerLength;
+
+    if ((length < 12) || ((data[0] & 0xC0) != 0x80))
+        return length;
+    headerLength = 12 + 4 * (data[0] & 0x0F);
+    if ((data[0] & 0x10) && (headerLength + 4 <= length))
+        headerLength += 4 + 4 * ((data[headerLength + 2] << 8) | data[headerLength + 3]);
+    return (headerLength < length) ? headerLength : length;
+}
+
+static void
+PcapRing_write(const void *data, size_t length)
+{
+    if (!PcapRing_file)
+        return;
+    if (fwrite(data, 1, length, PcapRing_file) != length)
+        PcapRing_writeErrors++;
+    PcapRing_fileSize += length;
+}
+
+static void
+PcapRing_writeUint32(uint32_t value)
+{
+    PcapRing_write(&value, 4);
+}
+
+/** Opens the next file and writes the section and interface headers. */
+static void
+PcapRing_openFile()
+{
+    char path[4096];
+    uint32_t u32;
+    uint16_t u16;
+    int64_t s64;
+
+    if (PcapRing_file)
+    {
+        fclose(PcapRing_file);
+        PcapRing_file = NULL;
+        PcapRing_fileIndex = (PcapRing_fileIndex + 1) % PcapRing_fileCount;
+        PcapRing_filesRotated++;
+    }
+    snprintf(
+            path, sizeof(path),
+            "%s%d.pcapng",
+            PcapRing_pathPrefix, PcapRing_fileIndex);
+    PcapRing_file = fopen(path, "wb");
+    PcapRing_fileSize = 0;
+    if (!PcapRing_file)
+    {
+        PcapRing_writeErrors++;
+        return;
+    }
+    setvbuf(PcapRing_file, NULL, _IOFBF, 64 * 1024);
+
+    /* Section Header Block in host byte order. */
+    PcapRing_writeUint32(PCAPNG_SECTION_HEADER_BLOCK);
+    PcapRing_writeUint32(28);
+    PcapRing_writeUint32(0x1A2B3C4D);
+    u16 = 1;
+    PcapRing_write(&u16, 2);
+    u16 = 0;
+    PcapRing_write(&u16, 2);
+    s64 = -1;
+    PcapRing_write(&s64, 8);
+    PcapRing_writeUint32(28);
+
+    /* Interface Description Block with nanosecond timestamps. */
+    PcapRing_writeUint32(PCAPNG_INTERFACE_DESCRIPTION_BLOCK);
+    PcapRing_writeUint32(32);
+    u16 = PCAPNG_LINKTYPE_RAW;
+    PcapRing_write(&u16, 2);
+    u16 = 0;
+    PcapRing_write(&u16, 2);
+    u32 = PCAP_RING_MAX_SNAP_LENGTH + PCAP_RING_MAX_HEADERS_LENGTH;
+    PcapRing_write(&u32, 4);
+    /* if_tsresol = 9 */
+    u16 = 9;
+    PcapRing_write(&u16, 2);
+    u16 = 1;
+    PcapRing_write(&u16, 2);
+    u32 = 9;
+    PcapRing_write(&u32, 4);
+    /* opt_endofopt */
+    PcapRing_writeUint32(0);
+    PcapRing_writeUint32(32);
+}
+
+static uint16_t
+PcapRing_ipChecksum(const uint8_t *header, int length)
+{
+    uint32_t sum = 0;
+    int i;
+
+    for (i = 0; i < length; i += 2)
+        sum += (header[i] << 8) | header[i + 1];
+    while (sum >> 16)
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    return (uint16_t) ~sum;
+}
+
+/**
+ * Synthesizes the IP and UDP or TCP headers of a captured packet so that
+ * Wireshark can dissect it.
+ *
+ * @return the length of the synthesized headers
+ */
+static int
+PcapRing_writeHeaders(const PcapSlot *slot, uint8_t *headers)
+{
+    int transportLength = slot->tcp ? 20 : 8;
+    uint32_t payloadLength = transportLength + slot->length;
+    int ipLength;
+    uint8_t *t;
+
+    if (slot->addrLength == 4)
+    {
+        uint32_t totalLength = 20 + payloadLength;
+
+        ipLength = 20;
+        memset(headers, 0, 20);
+        headers[0] = 0x45;
+        headers[2] = (uint8_t) (totalLength >> 8);
+        headers[3] = (uint8_t) totalLength;
+        headers[8] = 64;
+        headers[9] = slot->tcp ? 6 : 17;
+        memcpy(headers + 12, slot->srcAddr, 4);
+        memcpy(headers + 16, slot->dstAddr, 4);
+        {
+            uint16_t checksum = PcapRing_ipChecksum(headers, 20);
+
+            headers[10] = (uint8_t) (checksum >> 8);
+            headers[11] = (uint8_t) checksum;
+        }
+    }
+    else
+    {
+        ipLength = 40;
+        memset(headers, 0, 40);
+        headers[0] = 0x60;
+        headers[4] = (uint8_t) (payloadLength >> 8);
+        headers[5] = (uint8_t) payloadLength;
+        headers[6] = slot->tcp ? 6 : 17;
+        headers[7] = 64;
+        memcpy(headers + 8, slot->srcAddr, 16);
+        memcpy(headers + 24, slot->dstAddr, 16);
+    }
+
+    t = headers + ipLength;
+    memset(t, 0, transportLength);
+    t[0] = (uint8_t) (slot->srcPort >> 8);
+    t[1] = (uint8_t) slot->srcPort;
+    t[2] = (uint8_t) (slot->dstPort >> 8);
+    t[3] = (uint8_t) slot->dstPort;
+    if (slot->tcp)
+    {
+        /* Data offset 5, PSH and ACK. */
+        t[12] = 0x50;
+        t[13] = 0x18;
+        t[14] = 0xFF;
+        t[15] = 0xFF;
+    }
+    else
+    {
+        t[4] = (uint8_t) (payloadLength >> 8);
+        t[5] = (uint8_t) payloadLength;
+    }
+    return ipLength + transportLength;
+}
+
+/** Writes a captured packet as an Enhanced Packet Block. */
+static void
+PcapRing_writePacket(const PcapSlot *slot)
+{
+    uint8_t headers[PCAP_RING_MAX_HEADERS_LENGTH];
+    static const uint8_t padding[4] = { 0, 0, 0, 0 };
+    int headersLength;
+    uint32_t capturedLength;
+    uint32_t paddedLength;
+    uint32_t blockLength;
+
+    if ((PcapRing_fileLimit > 0) && (PcapRing_fileSize >= PcapRing_fileLimit))
+        PcapRing_openFile();
+    if (!PcapRing_file)
+        return;
+
+    headersLength = PcapRing_writeHeaders(slot, headers);
+    capturedLength = headersLength + slot->capturedLength;
+    paddedLength = (capturedLength + 3) & ~3;
+    blockLength = 32 + paddedLength;
+
+    PcapRing_writeUint32(PCAPNG_ENHANCED_PACKET_BLOCK);
+    PcapRing_writeUint32(blockLength);
+    PcapRing_writeUint32(0);
+    PcapRing_writeUint32((uint32_t) (slot->timestampNanos >> 32));
+    PcapRing_writeUint32((uint32_t) slot->timestampNanos);
+    PcapRing_writeUint32(capturedLength);
+    PcapRing_writeUint32(headersLength + slot->length);
+    PcapRing_write(headers, headersLength);
+    PcapRing_write(slot->data, slot->capturedLength);
+    PcapRing_write(padding, paddedLength - capturedLength);
+    PcapRing_writeUint32(blockLength);
+
+    PcapRing_packetsWritten++;
+    PcapRing_bytesWritten += blockLength;
+}
+
+/**
+ * Writes out whatever the producers have published so far.
+ *
+ * @return the number of packets written
+ */
+static int
+PcapRing_drain()
+{
+    int count = 0;
+
+    for (;;)
+    {
+        PcapSlot *slot
+            = PcapRing_slots + (PcapRing_tail & (PCAP_RING_SLOTS - 1));
+        uint64_t sequence = __atomic_load_n(&(slot->sequence), __ATOMIC_ACQUIRE);
+
+        if (sequence != PcapRing_tail + 1)
+            break;
+        PcapRing_writePacket(slot);
+        __atomic_store_n(
+                &(slot->sequence),
+                PcapRing_tail + PCAP_RING_SLOTS,
+                __ATOMIC_RELEASE);
+        PcapRing_tail++;
+        count++;
+    }
+    return count;
+}
+
+static void *
+PcapRing_run(void *arg)
+{
+    struct timespec interval
+        = { 0, PCAP_RING_DRAIN_INTERVAL_NANOS };
+
+    PcapRing_openFile();
+    while (__atomic_load_n(&PcapRing_running, __ATOMIC_ACQUIRE))
+    {
+        if (!PcapRing_drain())
+        {
+            if (PcapRing_file)
+                fflush(PcapRing_file);
+            nanosleep(&interval, NULL);
+        }
+    }
+    PcapRing_drain();
+    if (PcapRing_file)
+    {
+        fclose(PcapRing_file);
+        PcapRing_file = NULL;
+    }
+    return NULL;
+}
+
+int
+PcapRing_start(
+        const char *pathPrefix,
+        int64_t fileLimit, int fileCount,
+        int snapLength)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&PcapRing_lifecycleMutex);
+    if (!PcapRing_running)
+    {
+        uint64_t i;
+
+        if (!PcapRing_slots)
+        {
+            PcapRing_slots = calloc(PCAP_RING_SLOTS, sizeof(PcapSlot));
+            if (!PcapRing_slots)
+                ret = -1;
+        }
+        free(PcapRing_pathPrefix);
+        PcapRing_pathPrefix = strdup(pathPrefix);
+        if (!PcapRing_pathPrefix)
+            ret = -1;
+
+        if (!ret)
+        {
+            /*
+             * A producer which saw the writer thread running before it was
+             * stopped may still be filling a slot. Any producer arriving from
+             * now on sees it stopped and leaves the ring alone.
+             */
+            while (__atomic_load_n(&PcapRing_producers, __ATOMIC_SEQ_CST))
+                sched_yield();
+            PcapRing_head = PcapRing_tail = 0;
+            for (i = 0; i < PCAP_RING_SLOTS; i++)
+                PcapRing_slots[i].sequence = i;
+
+            PcapRing_fileLimit = fileLimit;
+            PcapRing_fileCount = (fileCount > 0) ? fileCount : 1;
+            PcapRing_fileIndex = 0;
+            PcapRing_snapLength
+                = (snapLength > PCAP_RING_MAX_SNAP_LENGTH)
+                    ? PCAP_RING_MAX_SNAP_LENGTH
+                    : snapLength;
+
+            __atomic_store_n(&PcapRing_running, 1, __ATOMIC_RELEASE);
+            if (pthread_create(&PcapRing_thread, NULL, PcapRing_run, NULL))
+            {
+                PcapRing_running = 0;
+                ret = -1;
+            }
+        }
+    }
+    pthread_mutex_unlock(&PcapRing_lifecycleMutex);
+    return ret;
+}
+
+void
+PcapRing_stop()
+{
+    pthread_mutex_lock(&PcapRing_lifecycleMutex);
+    if (PcapRing_running)
+    {
+        __atomic_store_n(&PcapRing_running, 0, __ATOMIC_RELEASE);
+        pthread_join(PcapRing_thread, NULL);
+    }
+    pthread_mutex_unlock(&PcapRing_lifecycleMutex);
+}
+
+/**
+ * Copies an address into a slot, in its IPv4-mapped IPv6 form if the slot
+ * holds IPv6 addresses.
+ */
+static void
+PcapRing_setAddr(uint8_t *slotAddr, int slotAddrLength,
+        const uint8_t *addr, int addrLength)
+{
+    if (addrLength == slotAddrLength)
+    {
+        memcpy(slotAddr, addr, addrLength);
+    }
+    else
+    {
+        memset(slotAddr, 0, 10);
+        slotAddr[10] = slotAddr[11] = 0xFF;
+        memcpy(slotAddr + 12, addr, 4);
+    }
+}
+
+int
+PcapRing_capture(
+        const uint8_t *data, int length,
+        const uint8_t *srcAddr, int srcAddrLength, int srcPort,
+        const uint8_t *dstAddr, int dstAddrLength, int dstPort,
+        int tcp)
+{
+    uint64_t position;
+    PcapSlot *slot;
+    int addrLength;
+    int capturedLength;
+
+    /* Announce this producer before looking at the state of the ring. */
+    __atomic_add_fetch(&PcapRing_producers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&PcapRing_running, __ATOMIC_SEQ_CST))
+    {
+        __atomic_sub_fetch(&PcapRing_producers, 1, __ATOMIC_RELEASE);
+        return -1;
+    }
+    if ((length < 0)
+            || ((srcAddrLength != 4) && (srcAddrLength != 16))
+            || ((dstAddrLength != 4) && (dstAddrLength != 16)))
+    {
+        __atomic_add_fetch(&PcapRing_packetsDropped, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&PcapRing_producers, 1, __ATOMIC_RELEASE);
+        return -1;
+    }
+    addrLength = (srcAddrLength > dstAddrLength) ? srcAddrLength : dstAddrLength;
+
+    position = __atomic_load_n(&PcapRing_head, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        int64_t diff;
+
+        slot = PcapRing_slots + (position & (PCAP_RING_SLOTS - 1));
+        diff
+            = (int64_t)
+                (__atomic_load_n(&(slot->sequence), __ATOMIC_ACQUIRE)
+                    - position);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(
+                    &PcapRing_head, &position, position + 1,
+                    1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            __atomic_add_fetch(&PcapRing_packetsDropped, 1, __ATOMIC_RELAXED);
+            __atomic_sub_fetch(&PcapRing_producers, 1, __ATOMIC_RELEASE);
+            return -1;
+        }
+        else
+            position = __atomic_load_n(&PcapRing_head, __ATOMIC_RELAXED);
+    }
+
+    capturedLength
+        = (PcapRing_snapLength == PCAP_RING_SNAP_RTP_HEADER)
+            ? PcapRing_getRtpHeaderLength(data, length)
+            : ((length < PcapRing_snapLength) ? length : PcapRing_snapLength);
+    if (capturedLength > PCAP_RING_MAX_SNAP_LENGTH)
+        capturedLength = PCAP_RING_MAX_SNAP_LENGTH;
+
+    slot->timestampNanos = PcapRing_now();
+    PcapRing_setAddr(slot->srcAddr, addrLength, srcAddr, srcAddrLength);
+    PcapRing_setAddr(slot->dstAddr, addrLength, dstAddr, dstAddrLength);
+    slot->srcPort = (uint16_t) srcPort;
+    slot->dstPort = (uint16_t) dstPort;
+    slot->addrLength = (uint8_t) addrLength;
+    slot->tcp = tcp ? 1 : 0;
+    slot->capturedLength = (uint16_t) capturedLength;
+    slot->length = (uint32_t) length;
+    memcpy(slot->data, data, capturedLength);
+    __atomic_store_n(&(slot->sequence), position + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&PcapRing_packetsCaptured, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&PcapRing_producers, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void
+PcapRing_getStats(PcapRingStats *stats)
+{
+    stats->packetsCaptured
+        = __atomic_load_n(&PcapRing_packetsCaptured, __ATOMIC_RELAXED);
+    stats->packetsDropped
+        = __atomic_load_n(&PcapRing_packetsDropped, __ATOMIC_RELAXED);
+    stats->packetsWritten
+        = __atomic_load_n(&PcapRing_packetsWritten, __ATOMIC_RELAXED);
+    stats->bytesWritten
+        = __atomic_load_n(&PcapRing_bytesWritten, __ATOMIC_RELAXED);
+    stats->filesRotated
+        = __atomic_load_n(&PcapRing_filesRotated, __ATOMIC_RELAXED);
+    stats->writeErrors
+        = __atomic_load_n(&PcapRing_writeErrors, __ATOMIC_RELAXED);
+}
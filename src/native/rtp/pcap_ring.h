@@ -0,0 +1,79 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNRTP_PCAP_RING_H_
+#define _JNRTP_PCAP_RING_H_
+
+#include <stdint.h>
+
+/** The number of slots in the capture ring (power of 2). */
+#define PCAP_RING_SLOTS 2048
+
+/** The largest number of bytes of a packet which are captured. */
+#define PCAP_RING_MAX_SNAP_LENGTH 1536
+
+/**
+ * The snap length which captures the RTP header (including CSRCs and the
+ * header extension) of each packet rather than a fixed number of bytes.
+ */
+#define PCAP_RING_SNAP_RTP_HEADER 0
+
+/** The interval at which the writer thread polls an empty ring. */
+#define PCAP_RING_DRAIN_INTERVAL_NANOS 10000000
+
+/** The statistics of the capture ring. */
+typedef struct
+{
+    uint64_t packetsCaptured;
+    uint64_t packetsDropped;
+    uint64_t packetsWritten;
+    uint64_t bytesWritten;
+    uint64_t filesRotated;
+    uint64_t writeErrors;
+} PcapRingStats;
+
+/**
+ * Starts the writer thread which drains the capture ring into pcapng files.
+ * Does nothing if it has been started already.
+ *
+ * @param pathPrefix the path of the files without the index and extension
+ * @param fileLimit the size in bytes at which to rotate to the next file; 0
+ * for no limit
+ * @param fileCount the number of files to rotate through
+ * @param snapLength the number of bytes to capture of each packet or
+ * PCAP_RING_SNAP_RTP_HEADER
+ * @return 0 on success or -1 on failure
+ */
+int PcapRing_start(
+        const char *pathPrefix,
+        int64_t fileLimit, int fileCount,
+        int snapLength);
+
+/** Stops the writer thread after it has written what is in the ring. */
+void PcapRing_stop();
+
+/**
+ * Captures a packet into the ring. May be called from multiple threads and
+ * never blocks; the packet is dropped and counted if the ring is full. An
+ * IPv4 address is logged in its IPv4-mapped IPv6 form if the other address
+ * is IPv6, as with a dual-stack socket.
+ *
+ * @param srcAddrLength the length of srcAddr, 4 or 16
+ * @param dstAddrLength the length of dstAddr, 4 or 16
+ * @param tcp non-zero if the packet has been carried over TCP
+ * @return 0 if the packet was captured or -1 if it was dropped
+ */
+int PcapRing_capture(
+        const uint8_t *data, int length,
+        const uint8_t *srcAddr, int srcAddrLength, int srcPort,
+        const uint8_t *dstAddr, int dstAddrLength, int dstPort,
+        int tcp);
+
+void PcapRing_getStats(PcapRingStats *stats);
+
+#endif /* _JNRTP_PCAP_RING_H_ */
@@ -0,0 +1,255 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "rtp_socket.h"
+
+#include <dirent.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** The address and port of either end of a socket as seen by Java. */
+typedef struct
+{
+    jbyte addr[16];
+    jint addrLength;
+    jint port;
+} RTPSocketEndpoint;
+
+/**
+ * Gets an end of a java.net.DatagramSocket or java.net.Socket through its
+ * public getters, e.g. getLocalAddress and getLocalPort.
+ *
+ * @return 0 on success or -1 if the end is not bound or connected
+ */
+static int
+RTPSocket_getEndpoint
+    (JNIEnv *env, jobject socket, const char *addrName, const char *portName,
+        RTPSocketEndpoint *endpoint)
+{
+    jclass clazz = (*env)->GetObjectClass(env, socket);
+    jmethodID addrMid
+        = (*env)->GetMethodID(
+                env, clazz,
+                addrName, "()Ljava/net/InetAddress;");
+    jmethodID portMid
+        = addrMid ? (*env)->GetMethodID(env, clazz, portName, "()I") : NULL;
+    jobject inetAddress = NULL;
+    jbyteArray addr = NULL;
+    int ret = -1;
+
+    if (portMid)
+    {
+        endpoint->port = (*env)->CallIntMethod(env, socket, portMid);
+        inetAddress = (*env)->CallObjectMethod(env, socket, addrMid);
+    }
+    if (inetAddress && !(*env)->ExceptionCheck(env) && (endpoint->port > 0))
+    {
+        jclass inetAddressClass = (*env)->GetObjectClass(env, inetAddress);
+        jmethodID getAddress
+            = (*env)->GetMethodID(env, inetAddressClass, "getAddress", "()[B");
+
+        if (getAddress)
+            addr = (*env)->CallObjectMethod(env, inetAddress, getAddress);
+        if (addr && !(*env)->ExceptionCheck(env))
+        {
+            endpoint->addrLength = (*env)->GetArrayLength(env, addr);
+            if ((endpoint->addrLength == 4) || (endpoint->addrLength == 16))
+            {
+                (*env)->GetByteArrayRegion(
+                        env, addr,
+                        0, endpoint->addrLength,
+                        endpoint->addr);
+                ret = 0;
+            }
+        }
+        (*env)->DeleteLocalRef(env, addr);
+        (*env)->DeleteLocalRef(env, inetAddressClass);
+    }
+    if ((*env)->ExceptionCheck(env))
+    {
+        (*env)->ExceptionClear(env);
+        ret = -1;
+    }
+    (*env)->DeleteLocalRef(env, inetAddress);
+    (*env)->DeleteLocalRef(env, clazz);
+    return ret;
+}
+
+/**
+ * Determines whether a sockaddr is of a specific endpoint. An IPv4 address
+ * matches its IPv4-mapped IPv6 form and a wildcard matches any address of
+ * the same port because dual-stack sockets are bound to ::.
+ */
+static int
+RTPSocket_isEndpoint
+    (const struct sockaddr_storage *sa, const RTPSocketEndpoint *endpoint)
+{
+    static const jbyte v4Mapped[12]
+        = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, (jbyte) 0xff, (jbyte) 0xff };
+    const jbyte *addr;
+    int addrLength, port, i, wildcard = 1;
+
+    if (sa->ss_family == AF_INET)
+    {
+        const struct sockaddr_in *sin = (const struct sockaddr_in *) sa;
+
+        addr = (const jbyte *) &(sin->sin_addr);
+        addrLength = 4;
+        port = ntohs(sin->sin_port);
+    }
+    else if (sa->ss_family == AF_INET6)
+    {
+        const struct sockaddr_in6 *sin6 = (const struct sockaddr_in6 *) sa;
+
+        addr = (const jbyte *) &(sin6->sin6_addr);
+        addrLength = 16;
+        port = ntohs(sin6->sin6_port);
+        if (!memcmp(addr, v4Mapped, sizeof(v4Mapped)))
+        {
+            addr += sizeof(v4Mapped);
+            addrLength = 4;
+        }
+    }
+    else
+        return 0;
+
+    if (port != endpoint->port)
+        return 0;
+    for (i = 0; i < endpoint->addrLength; i++)
+    {
+        if (endpoint->addr[i])
+        {
+            wildcard = 0;
+            break;
+        }
+    }
+    if (wildcard)
+        return 1;
+    for (i = 0; (i < addrLength) && !addr[i]; i++);
+    if (i == addrLength)
+        return 1;
+    if (endpoint->addrLength == addrLength)
+        return !memcmp(endpoint->addr, addr, addrLength);
+    return
+        (endpoint->addrLength == 16)
+            && (addrLength == 4)
+            && !memcmp(endpoint->addr, v4Mapped, sizeof(v4Mapped))
+            && !memcmp(endpoint->addr + sizeof(v4Mapped), addr, 4);
+}
+
+int
+RTPSocket_getFd(JNIEnv *env, jobject socket)
+{
+    RTPSocketEndpoint local, remote;
+    int hasRemote, type;
+    jclass datagramSocketClass;
+    DIR *dir;
+    struct dirent *entry;
+    int fd = -1, matches = 0;
+
+    if (!socket)
+        return -1;
+    datagramSocketClass = (*env)->FindClass(env, "java/net/DatagramSocket");
+    if (!datagramSocketClass)
+    {
+        (*env)->ExceptionClear(env);
+        return -1;
+    }
+    type
+        = (*env)->IsInstanceOf(env, socket, datagramSocketClass)
+            ? SOCK_DGRAM
+            : SOCK_STREAM;
+    (*env)->DeleteLocalRef(env, datagramSocketClass);
+
+    if (RTPSocket_getEndpoint(
+                env, socket,
+                "getLocalAddress", "getLocalPort",
+                &local))
+        return -1;
+    hasRemote
+        = !RTPSocket_getEndpoint(
+                env, socket,
+                "getInetAddress", "getPort",
+                &remote);
+
+    /*
+     * The descriptor is not exposed by any supported Java API, so look for
+     * the one socket of the process which has the same type and ends.
+     */
+    dir = opendir("/proc/self/fd");
+    if (!dir)
+        return -1;
+    while ((entry = readdir(dir)))
+    {
+        char *end;
+        long candidate = strtol(entry->d_name, &end, 10);
+        struct sockaddr_storage sa;
+        socklen_t saLength = sizeof(sa);
+        int candidateType;
+        socklen_t typeLength = sizeof(candidateType);
+
+        if ((end == entry->d_name) || *end || (candidate == dirfd(dir)))
+            continue;
+        if (getsockopt(
+                    (int) candidate,
+                    SOL_SOCKET, SO_TYPE,
+                    &candidateType, &typeLength)
+                || (candidateType != type))
+            continue;
+        if (getsockname((int) candidate, (struct sockaddr *) &sa, &saLength)
+                || !RTPSocket_isEndpoint(&sa, &local))
+            continue;
+        saLength = sizeof(sa);
+        if (getpeername((int) candidate, (struct sockaddr *) &sa, &saLength))
+        {
+            if (hasRemote)
+                continue;
+        }
+        else if (!hasRemote || !RTPSocket_isEndpoint(&sa, &remote))
+            continue;
+
+        fd = (int) candidate;
+        matches++;
+    }
+    closedir(dir);
+
+    /* Rather not use a descriptor which is not certainly that of socket. */
+    return (matches == 1) ? fd : -1;
+}
+
+int
+RTPSocket_toSockaddr(
+        const jbyte *addr, jint addrLength, jint port,
+        struct sockaddr_storage *sa, socklen_t *saLength)
+{
+    memset(sa, 0, sizeof(struct sockaddr_storage));
+    if (addrLength == 4)
+    {
+        struct sockaddr_in *sin = (struct sockaddr_in *) sa;
+
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons((uint16_t) port);
+        memcpy(&(sin->sin_addr), addr, 4);
+        *saLength = sizeof(struct sockaddr_in);
+    }
+    else if (addrLength == 16)
+    {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) sa;
+
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons((uint16_t) port);
+        memcpy(&(sin6->sin6_addr), addr, 16);
+        *saLength = sizeof(struct sockaddr_in6);
+    }
+    else
+        return -1;
+    return 0;
+}
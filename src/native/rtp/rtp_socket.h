@@ -0,0 +1,35 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNRTP_RTP_SOCKET_H_
+#define _JNRTP_RTP_SOCKET_H_
+
+#include <jni.h>
+#include <sys/socket.h>
+
+/**
+ * Gets the file descriptor of a java.net.DatagramSocket or java.net.Socket.
+ * Only the public getters of the socket are called, the descriptor being the
+ * one socket of the process in /proc/self/fd with the same type, local
+ * address and port and, if connected, remote address and port.
+ *
+ * @return the file descriptor or -1 if it could not be determined uniquely
+ */
+int RTPSocket_getFd(JNIEnv *env, jobject socket);
+
+/**
+ * Fills in a sockaddr from the raw bytes of an InetAddress (4 or 16 bytes)
+ * and a port.
+ *
+ * @return 0 on success or -1 if the address length is not supported
+ */
+int RTPSocket_toSockaddr(
+        const jbyte *addr, jint addrLength, jint port,
+        struct sockaddr_storage *sa, socklen_t *saLength);
+
+#endif /* _JNRTP_RTP_SOCKET_H_ */
@@ -0,0 +1,352 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "rtx_history.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** The RTCP packet type of transport layer feedback (RFC 4585). */
+#define RTCP_RTPFB 205
+
+/** The feedback message type of a generic NACK. */
+#define RTCP_RTPFB_FMT_NACK 1
+
+/** The maximum number of retransmissions handed to one sendmmsg call. */
+#define RTX_MAX_BATCH 32
+
+typedef struct
+{
+    uint64_t storedNanos;
+    uint64_t resentNanos;
+    uint16_t seq;
+    uint16_t length;
+    int valid;
+} RtxSlot;
+
+typedef struct
+{
+    uint32_t ssrc;
+    int used;
+    uint64_t lastStoredNanos;
+    struct sockaddr_storage addr;
+    socklen_t addrLength;
+    RtxSlot *slots;
+    uint8_t *data;
+} RtxSsrcHistory;
+
+struct RtxHistory
+{
+    pthread_mutex_t mutex;
+    int fd;
+    uint32_t capacity;
+    RtxSsrcHistory ssrcs[RTX_MAX_SSRCS];
+    RtxStats stats;
+};
+
+static uint64_t
+RtxHistory_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t
+RtxHistory_readUint32(const uint8_t *p)
+{
+    return
+        (((uint32_t) p[0]) << 24)
+            | (((uint32_t) p[1]) << 16)
+            | (((uint32_t) p[2]) << 8)
+            | p[3];
+}
+
+/**
+ * Finds the history of a specific SSRC, optionally taking over the least
+ * recently used one if there is none yet.
+ */
+static RtxSsrcHistory *
+RtxHistory_findSsrc(RtxHistory *history, uint32_t ssrc, int create)
+{
+    RtxSsrcHistory *lru = NULL;
+    int i;
+
+    for (i = 0; i < RTX_MAX_SSRCS; i++)
+    {
+        RtxSsrcHistory *h = history->ssrcs + i;
+
+        if (h->used && (h->ssrc == ssrc))
+            return h;
+        if (!lru
+                || !h->used
+                || (lru->used && (h->lastStoredNanos < lru->lastStoredNanos)))
+            lru = h;
+    }
+    if (!create)
+        return NULL;
+
+    if (!lru->slots)
+    {
+        lru->slots = calloc(history->capacity, sizeof(RtxSlot));
+        lru->data = malloc(history->capacity * RTX_MAX_PACKET_SIZE);
+        if (!lru->slots || !lru->data)
+        {
+            free(lru->slots);
+            free(lru->data);
+            lru->slots = NULL;
+            lru->data = NULL;
+            return NULL;
+        }
+    }
+    else
+        memset(lru->slots, 0, history->capacity * sizeof(RtxSlot));
+    lru->ssrc = ssrc;
+    lru->used = 1;
+    return lru;
+}
+
+RtxHistory *
+RtxHistory_create(int fd, int capacity)
+{
+    RtxHistory *history = calloc(1, sizeof(RtxHistory));
+    uint32_t c = 1;
+
+    if (!history)
+        return NULL;
+    while ((c < (uint32_t) capacity) && (c < 32768))
+        c <<= 1;
+    pthread_mutex_init(&(history->mutex), NULL);
+    history->fd = fd;
+    history->capacity = c;
+    return history;
+}
+
+void
+RtxHistory_destroy(RtxHistory *history)
+{
+    int i;
+
+    for (i = 0; i < RTX_MAX_SSRCS; i++)
+    {
+        free(history->ssrcs[i].slots);
+        free(history->ssrcs[i].data);
+    }
+    pthread_mutex_destroy(&(history->mutex));
+    free(history);
+}
+
+void
+RtxHistory_store(
+        RtxHistory *history,
+        const uint8_t *data, int length,
+        const struct sockaddr *addr, socklen_t addrLength)
+{
+    RtxSsrcHistory *h;
+    uint16_t seq;
+    uint32_t index;
+    uint8_t pt;
+
+    /* Version 2 RTP only; skip RTCP multiplexed on the same socket. */
+    if ((length < 12)
+            || (length > RTX_MAX_PACKET_SIZE)
+            || ((data[0] & 0xC0) != 0x80)
+            || (addrLength > sizeof(struct sockaddr_storage)))
+        return;
+    pt = data[1] & 0x7F;
+    if ((pt >= 72) && (pt <= 76))
+        return;
+
+    seq = (uint16_t) ((data[2] << 8) | data[3]);
+
+    pthread_mutex_lock(&(history->mutex));
+    h = RtxHistory_findSsrc(history, RtxHistory_readUint32(data + 8), 1);
+    if (h)
+    {
+        index = seq & (history->capacity - 1);
+        memcpy(h->data + index * RTX_MAX_PACKET_SIZE, data, length);
+        h->slots[index].seq = seq;
+        h->slots[index].length = (uint16_t) length;
+        h->slots[index].storedNanos = RtxHistory_now();
+        h->slots[index].resentNanos = 0;
+        h->slots[index].valid = 1;
+        h->lastStoredNanos = h->slots[index].storedNanos;
+        memcpy(&(h->addr), addr, addrLength);
+        h->addrLength = addrLength;
+        history->stats.packetsStored++;
+    }
+    pthread_mutex_unlock(&(history->mutex));
+}
+
+/**
+ * Sends out the retransmissions collected so far. Must be called with the
+ * mutex of history held.
+ */
+static int
+RtxHistory_flush(
+        RtxHistory *history,
+        PacerStream *pacer,
+        RtxSsrcHistory *h,
+        const uint32_t *indexes, int count)
+{
+    struct mmsghdr msgs[RTX_MAX_BATCH];
+    struct iovec iovs[RTX_MAX_BATCH];
+    int sent = 0;
+    int i;
+
+    if (!count)
+        return 0;
+
+    for (i = 0; i < count; i++)
+    {
+        uint8_t *data = h->data + indexes[i] * RTX_MAX_PACKET_SIZE;
+        int length = h->slots[indexes[i]].length;
+
+        if (pacer)
+        {
+            if (!Pacer_enqueue(
+                    pacer,
+                    data, length,
+                    (const struct sockaddr *) &(h->addr), h->addrLength))
+                sent++;
+        }
+        else
+        {
+            iovs[i].iov_base = data;
+            iovs[i].iov_len = length;
+            memset(&(msgs[i]), 0, sizeof(struct mmsghdr));
+            msgs[i].msg_hdr.msg_name = &(h->addr);
+            msgs[i].msg_hdr.msg_namelen = h->addrLength;
+            msgs[i].msg_hdr.msg_iov = &(iovs[i]);
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+    if (!pacer)
+    {
+        sent = sendmmsg(history->fd, msgs, count, MSG_DONTWAIT);
+        if (sent < 0)
+            sent = 0;
+    }
+    history->stats.packetsResent += sent;
+    return sent;
+}
+
+/**
+ * Retransmits the packets requested by the FCI entries of one generic NACK.
+ * Must be called with the mutex of history held.
+ */
+static int
+RtxHistory_handleNack(
+        RtxHistory *history,
+        PacerStream *pacer,
+        uint32_t ssrc,
+        const uint8_t *fci, int fciLength,
+        uint64_t now)
+{
+    RtxSsrcHistory *h = RtxHistory_findSsrc(history, ssrc, 0);
+    uint32_t indexes[RTX_MAX_BATCH];
+    int count = 0;
+    int resent = 0;
+    int i;
+
+    history->stats.nacksReceived++;
+    for (i = 0; i + 4 <= fciLength; i += 4)
+    {
+        uint16_t pid = (uint16_t) ((fci[i] << 8) | fci[i + 1]);
+        uint16_t blp = (uint16_t) ((fci[i + 2] << 8) | fci[i + 3]);
+        int bit;
+
+        for (bit = -1; bit < 16; bit++)
+        {
+            uint16_t seq;
+            uint32_t index;
+            RtxSlot *slot;
+
+            if ((bit >= 0) && !(blp & (1 << bit)))
+                continue;
+            seq = (uint16_t) (pid + bit + 1);
+            history->stats.packetsRequested++;
+            if (!h)
+            {
+                history->stats.packetsMissed++;
+                continue;
+            }
+
+            index = seq & (history->capacity - 1);
+            slot = h->slots + index;
+            if (!slot->valid
+                    || (slot->seq != seq)
+                    || (now - slot->storedNanos > RTX_MAX_AGE_NANOS))
+            {
+                history->stats.packetsMissed++;
+                continue;
+            }
+            if (now - slot->resentNanos < RTX_MIN_RESEND_INTERVAL_NANOS)
+                continue;
+            slot->resentNanos = now;
+
+            indexes[count++] = index;
+            if (count == RTX_MAX_BATCH)
+            {
+                resent += RtxHistory_flush(history, pacer, h, indexes, count);
+                count = 0;
+            }
+        }
+    }
+    if (h)
+        resent += RtxHistory_flush(history, pacer, h, indexes, count);
+    return resent;
+}
+
+int
+RtxHistory_handleRtcp(
+        RtxHistory *history,
+        PacerStream *pacer,
+        const uint8_t *data, int length)
+{
+    uint64_t now = RtxHistory_now();
+    int offset = 0;
+    int resent = 0;
+
+    pthread_mutex_lock(&(history->mutex));
+    while (offset + 4 <= length)
+    {
+        const uint8_t *p = data + offset;
+        int packetLength = (((p[2] << 8) | p[3]) + 1) * 4;
+
+        if (((p[0] & 0xC0) != 0x80) || (offset + packetLength > length))
+            break;
+        if ((p[1] == RTCP_RTPFB)
+                && ((p[0] & 0x1F) == RTCP_RTPFB_FMT_NACK)
+                && (packetLength >= 16))
+        {
+            resent
+                += RtxHistory_handleNack(
+                        history, pacer,
+                        RtxHistory_readUint32(p + 8),
+                        p + 12, packetLength - 12,
+                        now);
+        }
+        offset += packetLength;
+    }
+    pthread_mutex_unlock(&(history->mutex));
+    return resent;
+}
+
+void
+RtxHistory_getStats(RtxHistory *history, RtxStats *stats)
+{
+    pthread_mutex_lock(&(history->mutex));
+    *stats = history->stats;
+    pthread_mutex_unlock(&(history->mutex));
+}
@@ -0,0 +1,82 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNRTP_RTX_HISTORY_H_
+#define _JNRTP_RTX_HISTORY_H_
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+#include "pacer.h"
+
+/** The number of SSRCs of which a history keeps packets. */
+#define RTX_MAX_SSRCS 4
+
+/** The largest RTP packet which is kept for retransmission. */
+#define RTX_MAX_PACKET_SIZE 1500
+
+/** Packets older than this are not retransmitted any more. */
+#define RTX_MAX_AGE_NANOS 1000000000ULL
+
+/**
+ * The minimum interval between two retransmissions of one packet so that the
+ * NACKs repeated by a receiver before the first retransmission arrives do not
+ * cause duplicates.
+ */
+#define RTX_MIN_RESEND_INTERVAL_NANOS 20000000ULL
+
+typedef struct RtxHistory RtxHistory;
+
+/** The statistics of an RtxHistory. */
+typedef struct
+{
+    uint64_t packetsStored;
+    uint64_t nacksReceived;
+    uint64_t packetsRequested;
+    uint64_t packetsResent;
+    uint64_t packetsMissed;
+} RtxStats;
+
+/**
+ * Creates a new retransmission history.
+ *
+ * @param fd the file descriptor of the UDP socket to retransmit through
+ * @param capacity the number of packets kept per SSRC, rounded up to a power
+ * of 2. The memory used is at most RTX_MAX_SSRCS * capacity *
+ * RTX_MAX_PACKET_SIZE bytes.
+ * @return the new history or NULL on failure
+ */
+RtxHistory *RtxHistory_create(int fd, int capacity);
+
+void RtxHistory_destroy(RtxHistory *history);
+
+/**
+ * Keeps a copy of a sent RTP packet, indexed by its SSRC and sequence number.
+ * Packets which are not RTP or too large are ignored.
+ */
+void RtxHistory_store(
+        RtxHistory *history,
+        const uint8_t *data, int length,
+        const struct sockaddr *addr, socklen_t addrLength);
+
+/**
+ * Parses a (compound) RTCP packet and retransmits the packets requested by
+ * the generic NACKs (RFC 4585) in it.
+ *
+ * @param pacer the PacerStream to queue the retransmissions on or NULL to
+ * send them right away
+ * @return the number of packets retransmitted
+ */
+int RtxHistory_handleRtcp(
+        RtxHistory *history,
+        PacerStream *pacer,
+        const uint8_t *data, int length);
+
+void RtxHistory_getStats(RtxHistory *history, RtxStats *stats);
+
+#endif /* _JNRTP_RTX_HISTORY_H_ */
@@ -0,0 +1,1253 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "audio_io.h"
+
+#include <errno.h>
+#include <opus.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "../g722/telephony.h"
+#include "../g722/g722.h"
+#include "transcode.h"
+
+/** The duration of an Opus frame encoded. */
+#define AUDIO_IO_OPUS_FRAME_MILLIS 20
+
+/** The largest number of frames of 48 kHz of an Opus packet. */
+#define AUDIO_IO_OPUS_MAX_FRAMES 5760
+
+#define AUDIO_IO_OPUS_MAX_PACKET 4000
+
+/** The number of Opus packets per Ogg page written. */
+#define AUDIO_IO_OGG_PACKETS_PER_PAGE 50
+
+#define AUDIO_IO_OGG_MAX_SEGMENTS 255
+
+#define WAVE_FORMAT_PCM 0x0001
+#define WAVE_FORMAT_ALAW 0x0006
+#define WAVE_FORMAT_MULAW 0x0007
+#define WAVE_FORMAT_G722_ADPCM 0x0065
+
+/** The codecs of the audio read. */
+enum
+{
+    CODEC_PCM16 = 0,
+    CODEC_ULAW,
+    CODEC_ALAW,
+    CODEC_G722,
+    CODEC_OPUS
+};
+
+/* G.711 */
+
+static pthread_once_t AudioIO_tablesOnce = PTHREAD_ONCE_INIT;
+
+static int16_t AudioIO_ulawToLinear[256];
+static int16_t AudioIO_alawToLinear[256];
+static uint8_t AudioIO_linearToUlaw[65536];
+static uint8_t AudioIO_linearToAlaw[65536];
+static uint32_t AudioIO_oggCrcTable[256];
+
+static uint8_t
+AudioIO_encodeUlaw(int16_t sample)
+{
+    static const int16_t segEnd[8]
+        = { 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF, 0x1FFF };
+    int pcm = sample >> 2;
+    int mask, seg;
+
+    if (pcm < 0)
+    {
+        pcm = -pcm;
+        mask = 0x7F;
+    }
+    else
+        mask = 0xFF;
+    if (pcm > 8159)
+        pcm = 8159;
+    pcm += 0x84 >> 2;
+    for (seg = 0; (seg < 8) && (pcm > segEnd[seg]); seg++);
+    if (seg >= 8)
+        return (uint8_t) (0x7F ^ mask);
+    return (uint8_t) (((seg << 4) | ((pcm >> (seg + 1)) & 0xF)) ^ mask);
+}
+
+static int16_t
+AudioIO_decodeUlaw(uint8_t ulaw)
+{
+    int t;
+
+    ulaw = ~ulaw;
+    t = ((ulaw & 0xF) << 3) + 0x84;
+    t <<= (ulaw & 0x70) >> 4;
+    return (int16_t) ((ulaw & 0x80) ? (0x84 - t) : (t - 0x84));
+}
+
+static uint8_t
+AudioIO_encodeAlaw(int16_t sample)
+{
+    static const int16_t segEnd[8]
+        = { 0x1F, 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF };
+    int pcm = sample >> 3;
+    int mask, seg, alaw;
+
+    if (pcm >= 0)
+        mask = 0xD5;
+    else
+    {
+        mask = 0x55;
+        pcm = -pcm - 1;
+    }
+    for (seg = 0; (seg < 8) && (pcm > segEnd[seg]); seg++);
+    if (seg >= 8)
+        return (uint8_t) (0x7F ^ mask);
+    alaw = seg << 4;
+    alaw |= (seg < 2) ? ((pcm >> 1) & 0xF) : ((pcm >> seg) & 0xF);
+    return (uint8_t) (alaw ^ mask);
+}
+
+static int16_t
+AudioIO_decodeAlaw(uint8_t alaw)
+{
+    int t, seg;
+
+    alaw ^= 0x55;
+    t = (alaw & 0xF) << 4;
+    seg = (alaw & 0x70) >> 4;
+    if (seg == 0)
+        t += 8;
+    else
+    {
+        t += 0x108;
+        if (seg > 1)
+            t <<= seg - 1;
+    }
+    return (int16_t) ((alaw & 0x80) ? t : -t);
+}
+
+static void
+AudioIO_initTables(void)
+{
+    int i;
+
+    for (i = 0; i < 256; i++)
+    {
+        uint32_t crc = ((uint32_t) i) << 24;
+        int bit;
+
+        AudioIO_ulawToLinear[i] = AudioIO_decodeUlaw((uint8_t) i);
+        AudioIO_alawToLinear[i] = AudioIO_decodeAlaw((uint8_t) i);
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80000000) ? ((crc << 1) ^ 0x04C11DB7) : (crc << 1);
+        AudioIO_oggCrcTable[i] = crc;
+    }
+    for (i = 0; i < 65536; i++)
+    {
+        AudioIO_linearToUlaw[i] = AudioIO_encodeUlaw((int16_t) i);
+        AudioIO_linearToAlaw[i] = AudioIO_encodeAlaw((int16_t) i);
+    }
+}
+
+static uint32_t
+AudioIO_oggCrc(uint32_t crc, const uint8_t *data, size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        crc = (crc << 8) ^ AudioIO_oggCrcTable[(crc >> 24) ^ data[i]];
+    return crc;
+}
+
+static uint16_t
+AudioIO_readLE16(const uint8_t *p)
+{
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t
+AudioIO_readLE32(const uint8_t *p)
+{
+    return
+        ((uint32_t) p[0])
+            | (((uint32_t) p[1]) << 8)
+            | (((uint32_t) p[2]) << 16)
+            | (((uint32_t) p[3]) << 24);
+}
+
+static void
+AudioIO_writeLE16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static void
+AudioIO_writeLE32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+    p[2] = (uint8_t) (v >> 16);
+    p[3] = (uint8_t) (v >> 24);
+}
+
+static void
+AudioIO_writeLE64(uint8_t *p, uint64_t v)
+{
+    AudioIO_writeLE32(p, (uint32_t) v);
+    AudioIO_writeLE32(p + 4, (uint32_t) (v >> 32));
+}
+
+static int
+AudioIO_isOpusRate(int rate)
+{
+    return
+        (rate == 8000)
+            || (rate == 12000)
+            || (rate == 16000)
+            || (rate == 24000)
+            || (rate == 48000);
+}
+
+static int
+AudioIO_hasExtension(const char *path, const char *extension)
+{
+    const char *dot = strrchr(path, '.');
+
+    return dot && !strcasecmp(dot + 1, extension);
+}
+
+/* Reading */
+
+struct AudioReader
+{
+    FILE *file;
+    char *fileBuffer;
+    int codec;
+    int rate;
+    int channels;
+    /** The bytes of audio data left in the file, -1 if unknown. */
+    int64_t remaining;
+    int64_t bytesRead;
+    uint8_t *coded;
+    size_t codedSize;
+
+    g722_decode_state_t *g722;
+
+    /* Ogg Opus */
+    OpusDecoder *opus;
+    uint8_t pageHeader[27 + AUDIO_IO_OGG_MAX_SEGMENTS];
+    int segmentCount;
+    int segmentIndex;
+    int64_t pageGranule;
+    int pageEos;
+    uint8_t *packet;
+    size_t packetLength;
+    size_t packetCapacity;
+    /** The frames of 48 kHz yet to be skipped at the start. */
+    int preSkip;
+    /** The frames of 48 kHz decoded so far, including those skipped. */
+    int64_t decodedFrames48;
+    int16_t *decoded;
+    int decodedOffset;
+    int decodedCount;
+    int ended;
+};
+
+static size_t
+AudioReader_fread(AudioReader *reader, void *buf, size_t length)
+{
+    size_t n;
+
+    if ((reader->remaining >= 0) && ((int64_t) length > reader->remaining))
+        length = (size_t) reader->remaining;
+    n = fread(buf, 1, length, reader->file);
+    reader->bytesRead += n;
+    if (reader->remaining >= 0)
+        reader->remaining -= n;
+    return n;
+}
+
+static int
+AudioReader_ensureCoded(AudioReader *reader, size_t size)
+{
+    if (reader->codedSize < size)
+    {
+        uint8_t *coded = realloc(reader->coded, size);
+
+        if (!coded)
+            return -1;
+        reader->coded = coded;
+        reader->codedSize = size;
+    }
+    return 0;
+}
+
+/**
+ * Parses the chunks of a RIFF/WAVE file up to its data chunk.
+ */
+static int
+AudioReader_openWave(AudioReader *reader, char *error, size_t errorLength)
+{
+    uint8_t chunk[8];
+    int haveFormat = 0;
+
+    while (fread(chunk, 1, 8, reader->file) == 8)
+    {
+        uint32_t size = AudioIO_readLE32(chunk + 4);
+
+        reader->bytesRead += 8;
+        if (!memcmp(chunk, "fmt ", 4))
+        {
+            uint8_t fmt[16];
+            uint16_t tag, bits;
+
+            if ((size < 16) || (fread(fmt, 1, 16, reader->file) != 16))
+                break;
+            reader->bytesRead += 16;
+            tag = AudioIO_readLE16(fmt);
+            reader->channels = AudioIO_readLE16(fmt + 2);
+            reader->rate = (int) AudioIO_readLE32(fmt + 4);
+            bits = AudioIO_readLE16(fmt + 14);
+            if ((tag == WAVE_FORMAT_PCM) && (bits == 16))
+                reader->codec = CODEC_PCM16;
+            else if (tag == WAVE_FORMAT_MULAW)
+                reader->codec = CODEC_ULAW;
+            else if (tag == WAVE_FORMAT_ALAW)
+                reader->codec = CODEC_ALAW;
+            else if ((tag == WAVE_FORMAT_G722_ADPCM)
+                    && (reader->channels == 1))
+                reader->codec = CODEC_G722;
+            else
+            {
+                snprintf(
+                        error, errorLength,
+                        "unsupported WAVE format 0x%04x with %d bits",
+                        tag, bits);
+                return -1;
+            }
+            haveFormat = 1;
+            size -= 16;
+        }
+        else if (!memcmp(chunk, "data", 4))
+        {
+            if (!haveFormat)
+                break;
+            /* A streamed file may have a size of 0 or -1. */
+            reader->remaining
+                = ((size == 0) || (size == 0xFFFFFFFF)) ? -1 : (int64_t) size;
+            return 0;
+        }
+        if (fseeko(reader->file, (off_t) (size + (size & 1)), SEEK_CUR) != 0)
+            break;
+        reader->bytesRead += size + (size & 1);
+    }
+    snprintf(error, errorLength, "malformed WAVE file");
+    return -1;
+}
+
+/**
+ * Reads the next page header of an Ogg stream.
+ *
+ * @return 1, 0 at the end of the stream or -1 on error
+ */
+static int
+AudioReader_readOggPage(AudioReader *reader)
+{
+    uint8_t *header = reader->pageHeader;
+    size_t n = fread(header, 1, 27, reader->file);
+
+    if (n == 0)
+        return 0;
+    if ((n != 27) || memcmp(header, "OggS", 4))
+        return -1;
+    reader->segmentCount = header[26];
+    if (fread(header + 27, 1, reader->segmentCount, reader->file)
+            != (size_t) reader->segmentCount)
+        return -1;
+    reader->bytesRead += 27 + reader->segmentCount;
+    reader->segmentIndex = 0;
+    reader->pageGranule
+        = (int64_t)
+            (((uint64_t) AudioIO_readLE32(header + 6))
+                | (((uint64_t) AudioIO_readLE32(header + 10)) << 32));
+    reader->pageEos = (header[5] & 0x04) != 0;
+    return 1;
+}
+
+/**
+ * Reads the next packet of an Ogg stream, which may span pages.
+ *
+ * @return 1, 0 at the end of the stream or -1 on error
+ */
+static int
+AudioReader_readOggPacket(AudioReader *reader)
+{
+    reader->packetLength = 0;
+    for (;;)
+    {
+        uint8_t lacing;
+
+        if (reader->segmentIndex >= reader->segmentCount)
+        {
+            int ret = AudioReader_readOggPage(reader);
+
+            if (ret <= 0)
+                return (ret < 0) ? -1 : ((reader->packetLength > 0) ? 1 : 0);
+            continue;
+        }
+        lacing = reader->pageHeader[27 + reader->segmentIndex++];
+        if (reader->packetLength + lacing > reader->packetCapacity)
+        {
+            size_t capacity = (reader->packetLength + lacing) * 2;
+            uint8_t *packet = realloc(reader->packet, capacity);
+
+            if (!packet)
+                return -1;
+            reader->packet = packet;
+            reader->packetCapacity = capacity;
+        }
+        if (fread(reader->packet + reader->packetLength, 1, lacing, reader->file)
+                != lacing)
+            return -1;
+        reader->bytesRead += lacing;
+        reader->packetLength += lacing;
+        if (lacing < 255)
+            return 1;
+    }
+}
+
+static int
+AudioReader_openOpus(
+        AudioReader *reader,
+        int preferredRate,
+        char *error, size_t errorLength)
+{
+    int err, inputRate;
+
+    if ((AudioReader_readOggPacket(reader) != 1)
+            || (reader->packetLength < 19)
+            || memcmp(reader->packet, "OpusHead", 8))
+    {
+        snprintf(error, errorLength, "not an Ogg Opus file");
+        return -1;
+    }
+    reader->channels = reader->packet[9];
+    reader->preSkip = AudioIO_readLE16(reader->packet + 10);
+    inputRate = (int) AudioIO_readLE32(reader->packet + 12);
+    if ((reader->channels < 1) || (reader->channels > 2)
+            || (reader->packet[18] != 0))
+    {
+        snprintf(error, errorLength, "unsupported Opus channel mapping");
+        return -1;
+    }
+    /* OpusTags */
+    if (AudioReader_readOggPacket(reader) != 1)
+    {
+        snprintf(error, errorLength, "truncated Ogg Opus file");
+        return -1;
+    }
+
+    /*
+     * Decodes at the rate asked for or else at the rate of the original input
+     * if Opus may decode at them, sparing a resampling.
+     */
+    if (AudioIO_isOpusRate(preferredRate))
+        reader->rate = preferredRate;
+    else
+        reader->rate = AudioIO_isOpusRate(inputRate) ? inputRate : 48000;
+    reader->opus = opus_decoder_create(reader->rate, reader->channels, &err);
+    reader->decoded
+        = malloc(
+                AUDIO_IO_OPUS_MAX_FRAMES * reader->channels * sizeof(int16_t));
+    if (!reader->opus || !reader->decoded)
+    {
+        snprintf(error, errorLength, "failed to create Opus decoder");
+        return -1;
+    }
+    return 0;
+}
+
+AudioReader *
+AudioReader_open(
+        const char *path,
+        int rawRate, int rawChannels,
+        int preferredRate,
+        char *error, size_t errorLength)
+{
+    AudioReader *reader = calloc(1, sizeof(AudioReader));
+    uint8_t magic[12];
+    size_t n;
+
+    pthread_once(&AudioIO_tablesOnce, AudioIO_initTables);
+    if (!reader)
+    {
+        snprintf(error, errorLength, "out of memory");
+        return NULL;
+    }
+    reader->remaining = -1;
+    reader->file = fopen(path, "rb");
+    if (!reader->file)
+    {
+        snprintf(error, errorLength, "%s", strerror(errno));
+        free(reader);
+        return NULL;
+    }
+    reader->fileBuffer = malloc(AUDIO_IO_FILE_BUFFER_SIZE);
+    if (reader->fileBuffer)
+    {
+        setvbuf(
+                reader->file,
+                reader->fileBuffer, _IOFBF, AUDIO_IO_FILE_BUFFER_SIZE);
+    }
+
+    n = fread(magic, 1, sizeof(magic), reader->file);
+    if ((n == 12) && !memcmp(magic, "RIFF", 4) && !memcmp(magic + 8, "WAVE", 4))
+    {
+        reader->bytesRead = 12;
+        if (AudioReader_openWave(reader, error, errorLength) != 0)
+            goto fail;
+    }
+    else
+    {
+        rewind(reader->file);
+        if ((n >= 4) && !memcmp(magic, "OggS", 4))
+        {
+            reader->codec = CODEC_OPUS;
+            if (AudioReader_openOpus(
+                        reader,
+                        preferredRate,
+                        error, errorLength)
+                    != 0)
+                goto fail;
+        }
+        else if (AudioIO_hasExtension(path, "g722"))
+        {
+            reader->codec = CODEC_G722;
+            reader->rate = 16000;
+            reader->channels = 1;
+        }
+        else if (AudioIO_hasExtension(path, "ul")
+                || AudioIO_hasExtension(path, "ulaw")
+                || AudioIO_hasExtension(path, "pcmu"))
+        {
+            reader->codec = CODEC_ULAW;
+            reader->rate = 8000;
+            reader->channels = 1;
+        }
+        else if (AudioIO_hasExtension(path, "al")
+                || AudioIO_hasExtension(path, "alaw")
+                || AudioIO_hasExtension(path, "pcma"))
+        {
+            reader->codec = CODEC_ALAW;
+            reader->rate = 8000;
+            reader->channels = 1;
+        }
+        else
+        {
+            reader->codec = CODEC_PCM16;
+            reader->rate = (rawRate > 0) ? rawRate : 8000;
+            reader->channels = (rawChannels > 0) ? rawChannels : 1;
+        }
+    }
+
+    if ((reader->rate <= 0) || (reader->channels <= 0))
+    {
+        snprintf(error, errorLength, "invalid rate or channels");
+        goto fail;
+    }
+    if (reader->codec == CODEC_G722)
+    {
+        /* G.722 at 8 kHz is the pseudo rate of some WAVE files. */
+        reader->rate = 16000;
+        reader->g722 = g722_decode_init(NULL, 64000, 0);
+        if (!reader->g722)
+        {
+            snprintf(error, errorLength, "failed to create G.722 decoder");
+            goto fail;
+        }
+    }
+    return reader;
+
+fail:
+    AudioReader_close(reader);
+    return NULL;
+}
+
+int
+AudioReader_getChannels(const AudioReader *reader)
+{
+    return reader->channels;
+}
+
+int
+AudioReader_getRate(const AudioReader *reader)
+{
+    return reader->rate;
+}
+
+int64_t
+AudioReader_getBytesRead(const AudioReader *reader)
+{
+    return reader->bytesRead;
+}
+
+/**
+ * Decodes the next Opus packet, trimming the pre-skip at the start and the
+ * padding at the end of the stream.
+ *
+ * @return 1, 0 at the end of the stream or -1 on error
+ */
+static int
+AudioReader_decodeOpus(AudioReader *reader)
+{
+    int scale = 48000 / reader->rate;
+
+    while (!reader->ended)
+    {
+        int ret = AudioReader_readOggPacket(reader);
+        int frames, skip, keep;
+        int64_t end;
+
+        if (ret <= 0)
+            return ret;
+        frames
+            = opus_decode(
+                    reader->opus,
+                    reader->packet, (opus_int32) reader->packetLength,
+                    reader->decoded,
+                    AUDIO_IO_OPUS_MAX_FRAMES / scale,
+                    0);
+        if (frames < 0)
+            return -1;
+
+        end = reader->decodedFrames48 + (int64_t) frames * scale;
+        keep = frames;
+        /* The granule of the last page is the end of the stream. */
+        if (reader->pageEos
+                && (reader->segmentIndex >= reader->segmentCount))
+        {
+            reader->ended = 1;
+            if (end > reader->pageGranule)
+            {
+                keep
+                    = (int)
+                        ((reader->pageGranule - reader->decodedFrames48)
+                            / scale);
+                if (keep < 0)
+                    keep = 0;
+            }
+        }
+        skip = 0;
+        if (reader->decodedFrames48 < reader->preSkip)
+        {
+            skip
+                = (int)
+                    ((reader->preSkip - reader->decodedFrames48 + scale - 1)
+                        / scale);
+            if (skip > keep)
+                skip = keep;
+        }
+        reader->decodedFrames48 = end;
+        if (keep > skip)
+        {
+            reader->decodedOffset = skip;
+            reader->decodedCount = keep - skip;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int
+AudioReader_read(AudioReader *reader, int16_t *pcm, int maxFrames)
+{
+    int samples = maxFrames * reader->channels;
+    int i, n;
+
+    switch (reader->codec)
+    {
+    case CODEC_PCM16:
+    {
+        uint8_t *bytes;
+
+        if (AudioReader_ensureCoded(reader, samples * 2) != 0)
+            return -1;
+        bytes = reader->coded;
+        n = (int) AudioReader_fread(reader, bytes, samples * 2) / 2;
+        for (i = 0; i < n; i++)
+            pcm[i] = (int16_t) AudioIO_readLE16(bytes + 2 * i);
+        break;
+    }
+    case CODEC_ULAW:
+    case CODEC_ALAW:
+    {
+        const int16_t *table
+            = (reader->codec == CODEC_ULAW)
+                ? AudioIO_ulawToLinear
+                : AudioIO_alawToLinear;
+
+        if (AudioReader_ensureCoded(reader, samples) != 0)
+            return -1;
+        n = (int) AudioReader_fread(reader, reader->coded, samples);
+        for (i = 0; i < n; i++)
+            pcm[i] = table[reader->coded[i]];
+        break;
+    }
+    case CODEC_G722:
+        /* A byte codes two samples at 64 kbit/s. */
+        if (AudioReader_ensureCoded(reader, samples / 2) != 0)
+            return -1;
+        n = (int) AudioReader_fread(reader, reader->coded, samples / 2);
+        n = (n > 0) ? g722_decode(reader->g722, pcm, reader->coded, n) : 0;
+        break;
+    case CODEC_OPUS:
+        n = 0;
+        while (n < samples)
+        {
+            int count;
+
+            if (reader->decodedCount == 0)
+            {
+                int ret = AudioReader_decodeOpus(reader);
+
+                if (ret < 0)
+                    return -1;
+                if (ret == 0)
+                    break;
+            }
+            count = reader->decodedCount;
+            if (count > maxFrames - n / reader->channels)
+                count = maxFrames - n / reader->channels;
+            memcpy(
+                    pcm + n,
+                    reader->decoded + reader->decodedOffset * reader->channels,
+                    count * reader->channels * sizeof(int16_t));
+            n += count * reader->channels;
+            reader->decodedOffset += count;
+            reader->decodedCount -= count;
+        }
+        break;
+    default:
+        return -1;
+    }
+
+    if ((n == 0) && ferror(reader->file))
+        return -1;
+    return n / reader->channels;
+}
+
+void
+AudioReader_close(AudioReader *reader)
+{
+    if (reader->file)
+        fclose(reader->file);
+    if (reader->g722)
+        g722_decode_free(reader->g722);
+    if (reader->opus)
+        opus_decoder_destroy(reader->opus);
+    free(reader->fileBuffer);
+    free(reader->coded);
+    free(reader->packet);
+    free(reader->decoded);
+    free(reader);
+}
+
+/* Writing */
+
+struct AudioWriter
+{
+    FILE *file;
+    char *fileBuffer;
+    int format;
+    int rate;
+    int channels;
+    int64_t bytesWritten;
+    /** The number of frames given to the writer. */
+    int64_t frames;
+    int error;
+    uint8_t *coded;
+    size_t codedSize;
+
+    g722_encode_state_t *g722;
+
+    /* The frames accumulated into a whole frame of the encoder. */
+    int16_t *frame;
+    int frameSize;
+    int frameFill;
+
+    /* Ogg Opus */
+    OpusEncoder *opus;
+    int preSkip;
+    uint32_t serial;
+    uint32_t pageSequence;
+    int64_t granule;
+    uint8_t segments[AUDIO_IO_OGG_MAX_SEGMENTS];
+    int segmentCount;
+    int pagePackets;
+    uint8_t *pageData;
+    size_t pageLength;
+};
+
+static void
+AudioWriter_fwrite(AudioWriter *writer, const void *data, size_t length)
+{
+    if (writer->file
+            && !writer->error
+            && (fwrite(data, 1, length, writer->file) != length))
+        writer->error = 1;
+    writer->bytesWritten += length;
+}
+
+static int
+AudioWriter_ensureCoded(AudioWriter *writer, size_t size)
+{
+    if (writer->codedSize < size)
+    {
+        uint8_t *coded = realloc(writer->coded, size);
+
+        if (!coded)
+            return -1;
+        writer->coded = coded;
+        writer->codedSize = size;
+    }
+    return 0;
+}
+
+/**
+ * Writes the header of a WAVE file, with its sizes filled in once the file is
+ * closed.
+ */
+static void
+AudioWriter_writeWaveHeader(AudioWriter *writer, uint32_t dataSize)
+{
+    uint8_t header[58];
+    int pcm = (writer->format == TRANSCODE_WAV);
+    int bytesPerSample = pcm ? 2 : 1;
+    uint32_t fmtSize = pcm ? 16 : 18;
+    size_t length = 0;
+
+    memcpy(header, "RIFF", 4);
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    AudioIO_writeLE32(header + 16, fmtSize);
+    AudioIO_writeLE16(
+            header + 20,
+            pcm
+                ? WAVE_FORMAT_PCM
+                : ((writer->format == TRANSCODE_PCMU)
+                    ? WAVE_FORMAT_MULAW
+                    : WAVE_FORMAT_ALAW));
+    AudioIO_writeLE16(header + 22, (uint16_t) writer->channels);
+    AudioIO_writeLE32(header + 24, (uint32_t) writer->rate);
+    AudioIO_writeLE32(
+            header + 28,
+            (uint32_t) (writer->rate * writer->channels * bytesPerSample));
+    AudioIO_writeLE16(
+            header + 32,
+            (uint16_t) (writer->channels * bytesPerSample));
+    AudioIO_writeLE16(header + 34, (uint16_t) (8 * bytesPerSample));
+    length = 36;
+    if (!pcm)
+    {
+        /* cbSize and the fact chunk required by compressed formats */
+        AudioIO_writeLE16(header + 36, 0);
+        memcpy(header + 38, "fact", 4);
+        AudioIO_writeLE32(header + 42, 4);
+        AudioIO_writeLE32(header + 46, dataSize / writer->channels);
+        length = 50;
+    }
+    memcpy(header + length, "data", 4);
+    AudioIO_writeLE32(header + length + 4, dataSize);
+    length += 8;
+    AudioIO_writeLE32(header + 4, (uint32_t) (length - 8 + dataSize));
+    AudioWriter_fwrite(writer, header, length);
+}
+
+/** Writes the current Ogg page. */
+static void
+AudioWriter_flushOggPage(AudioWriter *writer, int flags)
+{
+    uint8_t header[27];
+    uint32_t crc;
+
+    memcpy(header, "OggS", 4);
+    header[4] = 0;
+    header[5] = (uint8_t) flags;
+    AudioIO_writeLE64(header + 6, (uint64_t) writer->granule);
+    AudioIO_writeLE32(header + 14, writer->serial);
+    AudioIO_writeLE32(header + 18, writer->pageSequence++);
+    AudioIO_writeLE32(header + 22, 0);
+    header[26] = (uint8_t) writer->segmentCount;
+
+    crc = AudioIO_oggCrc(0, header, sizeof(header));
+    crc = AudioIO_oggCrc(crc, writer->segments, writer->segmentCount);
+    crc = AudioIO_oggCrc(crc, writer->pageData, writer->pageLength);
+    AudioIO_writeLE32(header + 22, crc);
+
+    AudioWriter_fwrite(writer, header, sizeof(header));
+    AudioWriter_fwrite(writer, writer->segments, writer->segmentCount);
+    AudioWriter_fwrite(writer, writer->pageData, writer->pageLength);
+    writer->segmentCount = 0;
+    writer->pageLength = 0;
+    writer->pagePackets = 0;
+}
+
+/**
+ * Adds a packet to the current Ogg page, flushing the page first if the
+ * packet does not fit in its lacing table.
+ */
+static void
+AudioWriter_addOggPacket(
+        AudioWriter *writer,
+        const uint8_t *packet, size_t length)
+{
+    int segments = (int) (length / 255) + 1;
+    int i;
+
+    if (writer->segmentCount + segments > AUDIO_IO_OGG_MAX_SEGMENTS)
+        AudioWriter_flushOggPage(writer, 0);
+    for (i = 0; i < segments - 1; i++)
+        writer->segments[writer->segmentCount++] = 255;
+    writer->segments[writer->segmentCount++] = (uint8_t) (length % 255);
+    memcpy(writer->pageData + writer->pageLength, packet, length);
+    writer->pageLength += length;
+    writer->pagePackets++;
+}
+
+static int
+AudioWriter_openOpus(
+        AudioWriter *writer,
+        int bitrate,
+        char *error, size_t errorLength)
+{
+    uint8_t head[19];
+    static const char vendor[] = "libjitsi";
+    uint8_t tags[8 + 4 + sizeof(vendor) - 1 + 4];
+    opus_int32 lookahead = 0;
+    int err;
+
+    writer->opus
+        = opus_encoder_create(
+                writer->rate, writer->channels,
+                OPUS_APPLICATION_AUDIO,
+                &err);
+    writer->pageData
+        = malloc(AUDIO_IO_OGG_MAX_SEGMENTS * 255);
+    if (!writer->opus || !writer->pageData)
+    {
+        snprintf(error, errorLength, "failed to create Opus encoder");
+        return -1;
+    }
+    if (bitrate > 0)
+        opus_encoder_ctl(writer->opus, OPUS_SET_BITRATE(bitrate));
+    opus_encoder_ctl(writer->opus, OPUS_GET_LOOKAHEAD(&lookahead));
+    writer->preSkip = lookahead * (48000 / writer->rate);
+    writer->serial = (uint32_t) (time(NULL) ^ (uintptr_t) writer);
+
+    memcpy(head, "OpusHead", 8);
+    head[8] = 1;
+    head[9] = (uint8_t) writer->channels;
+    AudioIO_writeLE16(head + 10, (uint16_t) writer->preSkip);
+    AudioIO_writeLE32(head + 12, (uint32_t) writer->rate);
+    AudioIO_writeLE16(head + 16, 0);
+    head[18] = 0;
+    AudioWriter_addOggPacket(writer, head, sizeof(head));
+    AudioWriter_flushOggPage(writer, 0x02);
+
+    memcpy(tags, "OpusTags", 8);
+    AudioIO_writeLE32(tags + 8, sizeof(vendor) - 1);
+    memcpy(tags + 12, vendor, sizeof(vendor) - 1);
+    AudioIO_writeLE32(tags + 12 + sizeof(vendor) - 1, 0);
+    AudioWriter_addOggPacket(writer, tags, sizeof(tags));
+    AudioWriter_flushOggPage(writer, 0);
+
+    writer->granule = writer->preSkip;
+    return 0;
+}
+
+AudioWriter *
+AudioWriter_open(
+        const char *path,
+        int format,
+        int rate, int channels,
+        int bitrate,
+        char *error, size_t errorLength)
+{
+    AudioWriter *writer = calloc(1, sizeof(AudioWriter));
+
+    pthread_once(&AudioIO_tablesOnce, AudioIO_initTables);
+    if (!writer)
+    {
+        snprintf(error, errorLength, "out of memory");
+        return NULL;
+    }
+    writer->format = format;
+    writer->rate = rate;
+    writer->channels = channels;
+    if (path)
+    {
+        writer->file = fopen(path, "wb");
+        if (!writer->file)
+        {
+            snprintf(error, errorLength, "%s", strerror(errno));
+            free(writer);
+            return NULL;
+        }
+        writer->fileBuffer = malloc(AUDIO_IO_FILE_BUFFER_SIZE);
+        if (writer->fileBuffer)
+        {
+            setvbuf(
+                    writer->file,
+                    writer->fileBuffer, _IOFBF, AUDIO_IO_FILE_BUFFER_SIZE);
+        }
+    }
+
+    switch (format)
+    {
+    case TRANSCODE_WAV:
+    case TRANSCODE_PCMU:
+    case TRANSCODE_PCMA:
+        AudioWriter_writeWaveHeader(writer, 0);
+        break;
+    case TRANSCODE_RAW:
+        break;
+    case TRANSCODE_G722:
+        writer->g722 = g722_encode_init(NULL, 64000, 0);
+        if (!writer->g722)
+        {
+            snprintf(error, errorLength, "failed to create G.722 encoder");
+            goto fail;
+        }
+        /* g722_encode codes the samples in pairs. */
+        writer->frameSize = rate * AUDIO_IO_OPUS_FRAME_MILLIS / 1000;
+        break;
+    case TRANSCODE_OPUS:
+        if (AudioWriter_openOpus(writer, bitrate, error, errorLength) != 0)
+            goto fail;
+        writer->frameSize = rate * AUDIO_IO_OPUS_FRAME_MILLIS / 1000;
+        break;
+    default:
+        snprintf(error, errorLength, "unsupported format %d", format);
+        goto fail;
+    }
+    if (writer->frameSize)
+    {
+        writer->frame = malloc(writer->frameSize * channels * sizeof(int16_t));
+        if (!writer->frame
+                || (AudioWriter_ensureCoded(
+                            writer,
+                            (writer->frameSize * channels)
+                                + AUDIO_IO_OPUS_MAX_PACKET)
+                        != 0))
+        {
+            snprintf(error, errorLength, "out of memory");
+            goto fail;
+        }
+    }
+    return writer;
+
+fail:
+    if (writer->file)
+    {
+        fclose(writer->file);
+        writer->file = NULL;
+        remove(path);
+    }
+    AudioWriter_close(writer, NULL);
+    return NULL;
+}
+
+/** Encodes a whole frame of the encoder. */
+static void
+AudioWriter_encodeFrame(AudioWriter *writer, const int16_t *pcm)
+{
+    if (writer->format == TRANSCODE_G722)
+    {
+        int n = g722_encode(writer->g722, writer->coded, pcm, writer->frameSize);
+
+        AudioWriter_fwrite(writer, writer->coded, n);
+    }
+    else
+    {
+        opus_int32 n
+            = opus_encode(
+                    writer->opus,
+                    pcm, writer->frameSize,
+                    writer->coded, AUDIO_IO_OPUS_MAX_PACKET);
+
+        if (n < 0)
+        {
+            writer->error = 1;
+            return;
+        }
+        writer->granule += writer->frameSize * (48000 / writer->rate);
+        AudioWriter_addOggPacket(writer, writer->coded, n);
+        if (writer->pagePackets >= AUDIO_IO_OGG_PACKETS_PER_PAGE)
+            AudioWriter_flushOggPage(writer, 0);
+    }
+}
+
+int
+AudioWriter_write(AudioWriter *writer, const int16_t *pcm, int frames)
+{
+    int channels = writer->channels;
+    int samples = frames * channels;
+    int i;
+
+    writer->frames += frames;
+    switch (writer->format)
+    {
+    case TRANSCODE_WAV:
+    case TRANSCODE_RAW:
+        if (AudioWriter_ensureCoded(writer, samples * 2) != 0)
+            return -1;
+        for (i = 0; i < samples; i++)
+            AudioIO_writeLE16(writer->coded + 2 * i, (uint16_t) pcm[i]);
+        AudioWriter_fwrite(writer, writer->coded, samples * 2);
+        break;
+    case TRANSCODE_PCMU:
+    case TRANSCODE_PCMA:
+    {
+        const uint8_t *table
+            = (writer->format == TRANSCODE_PCMU)
+                ? AudioIO_linearToUlaw
+                : AudioIO_linearToAlaw;
+
+        if (AudioWriter_ensureCoded(writer, samples) != 0)
+            return -1;
+        for (i = 0; i < samples; i++)
+            writer->coded[i] = table[(uint16_t) pcm[i]];
+        AudioWriter_fwrite(writer, writer->coded, samples);
+        break;
+    }
+    default:
+        while (frames > 0)
+        {
+            int n = writer->frameSize - writer->frameFill;
+
+            if (n > frames)
+                n = frames;
+            if ((writer->frameFill == 0) && (n == writer->frameSize))
+            {
+                /* Encodes in place whole frames of the input. */
+                AudioWriter_encodeFrame(writer, pcm);
+            }
+            else
+            {
+                memcpy(
+                        writer->frame + writer->frameFill * channels,
+                        pcm,
+                        n * channels * sizeof(int16_t));
+                writer->frameFill += n;
+                if (writer->frameFill == writer->frameSize)
+                {
+                    AudioWriter_encodeFrame(writer, writer->frame);
+                    writer->frameFill = 0;
+                }
+            }
+            pcm += n * channels;
+            frames -= n;
+        }
+        break;
+    }
+    return writer->error ? -1 : 0;
+}
+
+int
+AudioWriter_close(AudioWriter *writer, int64_t *bytesWritten)
+{
+    int ret;
+
+    /*
+     * Flushes the lookahead of Opus with silence so that the decoder outputs
+     * the end of the audio delayed by the pre-skip.
+     */
+    if (writer->opus)
+    {
+        int pad = writer->preSkip / (48000 / writer->rate);
+
+        while (pad > 0)
+        {
+            int n = writer->frameSize - writer->frameFill;
+
+            if (n > pad)
+                n = pad;
+            memset(
+                    writer->frame + writer->frameFill * writer->channels,
+                    0,
+                    n * writer->channels * sizeof(int16_t));
+            writer->frameFill += n;
+            pad -= n;
+            if (writer->frameFill == writer->frameSize)
+            {
+                AudioWriter_encodeFrame(writer, writer->frame);
+                writer->frameFill = 0;
+            }
+        }
+    }
+
+    /* Pads the last frame with silence. */
+    if (writer->frameFill > 0)
+    {
+        memset(
+                writer->frame + writer->frameFill * writer->channels,
+                0,
+                (writer->frameSize - writer->frameFill)
+                    * writer->channels * sizeof(int16_t));
+        AudioWriter_encodeFrame(writer, writer->frame);
+        writer->frameFill = 0;
+    }
+
+    if (writer->opus && writer->pageData && !writer->error)
+    {
+        /* The granule of the last page trims the padding. */
+        writer->granule
+            = writer->preSkip + writer->frames * (48000 / writer->rate);
+        AudioWriter_flushOggPage(writer, 0x04);
+    }
+    else if (writer->file
+            && ((writer->format == TRANSCODE_WAV)
+                || (writer->format == TRANSCODE_PCMU)
+                || (writer->format == TRANSCODE_PCMA))
+            && (fseeko(writer->file, 0, SEEK_SET) == 0))
+    {
+        int64_t bytes = writer->bytesWritten;
+        int bytesPerSample = (writer->format == TRANSCODE_WAV) ? 2 : 1;
+
+        AudioWriter_writeWaveHeader(
+                writer,
+                (uint32_t)
+                    (writer->frames * writer->channels * bytesPerSample));
+        writer->bytesWritten = bytes;
+    }
+
+    if (writer->file && (fclose(writer->file) != 0))
+        writer->error = 1;
+    ret = writer->error ? -1 : 0;
+    if (bytesWritten)
+        *bytesWritten = writer->bytesWritten;
+
+    if (writer->g722)
+        g722_encode_free(writer->g722);
+    if (writer->opus)
+        opus_encoder_destroy(writer->opus);
+    free(writer->fileBuffer);
+    free(writer->coded);
+    free(writer->frame);
+    free(writer->pageData);
+    free(writer);
+    return ret;
+}
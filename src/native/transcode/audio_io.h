@@ -0,0 +1,90 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNTRANSCODE_AUDIO_IO_H_
+#define _JNTRANSCODE_AUDIO_IO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Streaming readers and writers of audio files which decode to and encode
+ * from interleaved 16-bit PCM, combining the demuxer/muxer of a container
+ * with the decoder/encoder of its codec.
+ */
+
+/** The size of the stdio buffers of the files. */
+#define AUDIO_IO_FILE_BUFFER_SIZE (256 * 1024)
+
+typedef struct AudioReader AudioReader;
+typedef struct AudioWriter AudioWriter;
+
+/**
+ * Opens an audio file for reading.
+ *
+ * @param rawRate the sample rate of raw PCM, 0 for 8000 Hz
+ * @param rawChannels the channels of raw PCM, 0 for mono
+ * @param preferredRate the rate to decode at if the codec may decode at
+ * several rates (Opus), 0 for the default
+ * @return the new reader or NULL with the reason in error
+ */
+AudioReader *AudioReader_open(
+        const char *path,
+        int rawRate, int rawChannels,
+        int preferredRate,
+        char *error, size_t errorLength);
+
+int AudioReader_getChannels(const AudioReader *reader);
+
+int AudioReader_getRate(const AudioReader *reader);
+
+/** Gets the number of bytes read from the file so far. */
+int64_t AudioReader_getBytesRead(const AudioReader *reader);
+
+/**
+ * Reads and decodes up to a specific number of frames (samples of all the
+ * channels) of interleaved PCM.
+ *
+ * @param maxFrames the largest number of frames to read, which must be even
+ * @return the number of frames read, 0 at the end of the file or -1 on error
+ */
+int AudioReader_read(AudioReader *reader, int16_t *pcm, int maxFrames);
+
+void AudioReader_close(AudioReader *reader);
+
+/**
+ * Opens an audio file for writing in a specific format.
+ *
+ * @param path the file or NULL to encode without writing
+ * @param format a TRANSCODE_ format
+ * @param bitrate the bitrate of Opus, 0 for the default
+ * @return the new writer or NULL with the reason in error
+ */
+AudioWriter *AudioWriter_open(
+        const char *path,
+        int format,
+        int rate, int channels,
+        int bitrate,
+        char *error, size_t errorLength);
+
+/**
+ * Encodes and writes frames of interleaved PCM.
+ *
+ * @return 0 or -1 on error
+ */
+int AudioWriter_write(AudioWriter *writer, const int16_t *pcm, int frames);
+
+/**
+ * Encodes what is buffered, finalizes the container and closes the file.
+ *
+ * @param bytesWritten receives the size of the file
+ * @return 0 or -1 on error
+ */
+int AudioWriter_close(AudioWriter *writer, int64_t *bytesWritten);
+
+#endif /* #ifndef _JNTRANSCODE_AUDIO_IO_H_ */
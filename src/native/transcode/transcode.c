@@ -0,0 +1,504 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "transcode.h"
+
+#include <pthread.h>
+#include <speex/speex_resampler.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "audio_io.h"
+#include "work_queue.h"
+
+/** The number of frames decoded at once, which AudioReader_read wants even. */
+#define TRANSCODE_BLOCK_FRAMES 4096
+
+/** The largest number of channels of the input. */
+#define TRANSCODE_MAX_CHANNELS 8
+
+/** The state of the transcoding of a file. */
+typedef struct
+{
+    AudioReader *reader;
+    AudioWriter *writer;
+    SpeexResamplerState *resampler;
+    int inputRate;
+    int inputChannels;
+    int rate;
+    int channels;
+    /** The frames read from the input. */
+    int64_t inputFrames;
+    /** The frames given to the writer. */
+    int64_t outputFrames;
+    int16_t *input;
+    int16_t *converted;
+    int16_t *resampled;
+    int resampledFrames;
+} Transcoder;
+
+typedef struct
+{
+    const TranscodeJob *jobs;
+    WorkQueue *queue;
+    int worker;
+    pthread_mutex_t *mutex;
+    TranscodeStats *stats;
+} TranscodeWorker;
+
+static int64_t
+Transcode_clock(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static int
+Transcode_isOpusRate(int rate)
+{
+    switch (rate)
+    {
+    case 8000:
+    case 12000:
+    case 16000:
+    case 24000:
+    case 48000:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Gets the rate which the output of a job is fixed at by its format or which
+ * has been asked for, 0 for the rate of the input.
+ */
+static int
+Transcode_getFixedRate(const TranscodeJob *job)
+{
+    switch (job->format)
+    {
+    case TRANSCODE_PCMU:
+    case TRANSCODE_PCMA:
+        return 8000;
+    case TRANSCODE_G722:
+        return 16000;
+    default:
+        return job->rate;
+    }
+}
+
+static void
+Transcoder_destroy(Transcoder *transcoder)
+{
+    if (transcoder->reader)
+        AudioReader_close(transcoder->reader);
+    if (transcoder->writer)
+        AudioWriter_close(transcoder->writer, NULL);
+    if (transcoder->resampler)
+        speex_resampler_destroy(transcoder->resampler);
+    free(transcoder->input);
+    free(transcoder->converted);
+    free(transcoder->resampled);
+}
+
+/**
+ * Converts frames of the input to the channels of the output, downmixing to
+ * mono by averaging and otherwise mapping the extra channels of the output to
+ * the last channel of the input.
+ */
+static const int16_t *
+Transcoder_convertChannels(Transcoder *transcoder, int frames)
+{
+    int inputChannels = transcoder->inputChannels;
+    int channels = transcoder->channels;
+    const int16_t *in = transcoder->input;
+    int16_t *out = transcoder->converted;
+    int i, c;
+
+    if (inputChannels == channels)
+        return in;
+    if (channels == 1)
+    {
+        for (i = 0; i < frames; i++, in += inputChannels)
+        {
+            int32_t sum = 0;
+
+            for (c = 0; c < inputChannels; c++)
+                sum += in[c];
+            out[i] = (int16_t) (sum / inputChannels);
+        }
+    }
+    else
+    {
+        for (i = 0; i < frames; i++, in += inputChannels, out += channels)
+        {
+            for (c = 0; c < channels; c++)
+                out[c] = in[(c < inputChannels) ? c : (inputChannels - 1)];
+        }
+    }
+    return transcoder->converted;
+}
+
+/**
+ * Writes frames at the rate of the output, stopping at the number of frames
+ * which the input makes so that the drain of the resampler adds no tail.
+ */
+static int
+Transcoder_write(Transcoder *transcoder, const int16_t *pcm, int frames)
+{
+    int64_t expected
+        = transcoder->inputFrames * transcoder->rate / transcoder->inputRate;
+
+    if (transcoder->outputFrames + frames > expected)
+        frames = (int) (expected - transcoder->outputFrames);
+    if (frames <= 0)
+        return 0;
+    transcoder->outputFrames += frames;
+    return AudioWriter_write(transcoder->writer, pcm, frames);
+}
+
+/** Resamples frames of the output channels and writes them. */
+static int
+Transcoder_resample(Transcoder *transcoder, const int16_t *pcm, int frames)
+{
+    if (!transcoder->resampler)
+        return Transcoder_write(transcoder, pcm, frames);
+
+    while (frames > 0)
+    {
+        spx_uint32_t inLength = frames;
+        spx_uint32_t outLength = transcoder->resampledFrames;
+
+        speex_resampler_process_interleaved_int(
+                transcoder->resampler,
+                pcm, &inLength,
+                transcoder->resampled, &outLength);
+        if ((outLength > 0)
+                && (Transcoder_write(
+                            transcoder,
+                            transcoder->resampled, outLength)
+                        != 0))
+            return -1;
+        if ((inLength == 0) && (outLength == 0))
+            return -1;
+        pcm += inLength * transcoder->channels;
+        frames -= inLength;
+    }
+    return 0;
+}
+
+int
+Transcode_file(
+        const TranscodeJob *job,
+        TranscodeStats *stats,
+        char *error, size_t errorLength)
+{
+    Transcoder transcoder;
+    int64_t cpuNanos = Transcode_clock(CLOCK_THREAD_CPUTIME_ID);
+    int64_t outputBytes = 0;
+    int frames, ret = -1;
+
+    memset(&transcoder, 0, sizeof(transcoder));
+    transcoder.reader
+        = AudioReader_open(
+                job->input,
+                job->inputRate, job->inputChannels,
+                Transcode_getFixedRate(job),
+                error, errorLength);
+    if (!transcoder.reader)
+        goto out;
+    transcoder.inputRate = AudioReader_getRate(transcoder.reader);
+    transcoder.inputChannels = AudioReader_getChannels(transcoder.reader);
+    if (transcoder.inputChannels > TRANSCODE_MAX_CHANNELS)
+    {
+        snprintf(
+                error, errorLength,
+                "too many channels (%d)", transcoder.inputChannels);
+        goto out;
+    }
+
+    transcoder.rate = Transcode_getFixedRate(job);
+    transcoder.channels = job->channels;
+    switch (job->format)
+    {
+    case TRANSCODE_PCMU:
+    case TRANSCODE_PCMA:
+    case TRANSCODE_G722:
+        transcoder.channels = 1;
+        break;
+    case TRANSCODE_OPUS:
+        if (!Transcode_isOpusRate(transcoder.rate))
+        {
+            transcoder.rate
+                = Transcode_isOpusRate(transcoder.inputRate)
+                    ? transcoder.inputRate
+                    : 48000;
+        }
+        if ((transcoder.channels <= 0) || (transcoder.channels > 2))
+            transcoder.channels = (transcoder.inputChannels > 1) ? 2 : 1;
+        break;
+    default:
+        break;
+    }
+    if (transcoder.rate <= 0)
+        transcoder.rate = transcoder.inputRate;
+    if ((transcoder.channels <= 0)
+            || (transcoder.channels > TRANSCODE_MAX_CHANNELS))
+        transcoder.channels = transcoder.inputChannels;
+
+    transcoder.input
+        = malloc(
+                TRANSCODE_BLOCK_FRAMES * transcoder.inputChannels
+                    * sizeof(int16_t));
+    transcoder.converted
+        = malloc(
+                TRANSCODE_BLOCK_FRAMES * transcoder.channels
+                    * sizeof(int16_t));
+    if (!transcoder.input || !transcoder.converted)
+    {
+        snprintf(error, errorLength, "out of memory");
+        goto out;
+    }
+    if (transcoder.rate != transcoder.inputRate)
+    {
+        int err = 0;
+
+        transcoder.resampler
+            = speex_resampler_init(
+                    transcoder.channels,
+                    transcoder.inputRate, transcoder.rate,
+                    job->resampleQuality,
+                    &err);
+        transcoder.resampledFrames
+            = (int)
+                (((int64_t) TRANSCODE_BLOCK_FRAMES) * transcoder.rate
+                        / transcoder.inputRate
+                    + 16);
+        transcoder.resampled
+            = malloc(
+                    transcoder.resampledFrames * transcoder.channels
+                        * sizeof(int16_t));
+        if (!transcoder.resampler || !transcoder.resampled)
+        {
+            snprintf(
+                    error, errorLength,
+                    "failed to create resampler from %d to %d Hz",
+                    transcoder.inputRate, transcoder.rate);
+            goto out;
+        }
+        /* Leaves out the delay of the filter at the start. */
+        speex_resampler_skip_zeros(transcoder.resampler);
+    }
+
+    transcoder.writer
+        = AudioWriter_open(
+                job->output,
+                job->format,
+                transcoder.rate, transcoder.channels,
+                job->bitrate,
+                error, errorLength);
+    if (!transcoder.writer)
+        goto out;
+
+    while ((frames
+                = AudioReader_read(
+                        transcoder.reader,
+                        transcoder.input,
+                        TRANSCODE_BLOCK_FRAMES))
+            > 0)
+    {
+        transcoder.inputFrames += frames;
+        if (Transcoder_resample(
+                    &transcoder,
+                    Transcoder_convertChannels(&transcoder, frames),
+                    frames)
+                != 0)
+        {
+            snprintf(error, errorLength, "failed to encode");
+            goto out;
+        }
+    }
+    if (frames < 0)
+    {
+        snprintf(error, errorLength, "failed to read or decode");
+        goto out;
+    }
+
+    if (transcoder.resampler)
+    {
+        /* Drains the samples delayed by the filter with silence. */
+        int latency = speex_resampler_get_input_latency(transcoder.resampler);
+
+        memset(
+                transcoder.converted,
+                0,
+                TRANSCODE_BLOCK_FRAMES * transcoder.channels * sizeof(int16_t));
+        while (latency > 0)
+        {
+            int n
+                = (latency > TRANSCODE_BLOCK_FRAMES)
+                    ? TRANSCODE_BLOCK_FRAMES
+                    : latency;
+
+            if (Transcoder_resample(&transcoder, transcoder.converted, n) != 0)
+            {
+                snprintf(error, errorLength, "failed to encode");
+                goto out;
+            }
+            latency -= n;
+        }
+    }
+
+    ret = AudioWriter_close(transcoder.writer, &outputBytes);
+    transcoder.writer = NULL;
+    if (ret != 0)
+        snprintf(error, errorLength, "failed to write");
+
+out:
+    if (stats)
+    {
+        stats->files++;
+        if (ret != 0)
+            stats->failures++;
+        else
+        {
+            stats->inputBytes += AudioReader_getBytesRead(transcoder.reader);
+            stats->outputBytes += outputBytes;
+            stats->audioNanos
+                += transcoder.inputFrames * 1000000000LL
+                    / transcoder.inputRate;
+        }
+    }
+    Transcoder_destroy(&transcoder);
+    if ((ret != 0) && job->output)
+        remove(job->output);
+    if (stats)
+    {
+        stats->cpuNanos
+            += Transcode_clock(CLOCK_THREAD_CPUTIME_ID) - cpuNanos;
+    }
+    return ret;
+}
+
+static void *
+Transcode_runWorker(void *arg)
+{
+    TranscodeWorker *worker = arg;
+    TranscodeStats stats;
+    int job;
+
+    memset(&stats, 0, sizeof(stats));
+    while ((job = WorkQueue_take(worker->queue, worker->worker)) >= 0)
+    {
+        char error[256];
+
+        if (Transcode_file(
+                    worker->jobs + job,
+                    &stats,
+                    error, sizeof(error))
+                != 0)
+        {
+            fprintf(
+                    stderr,
+                    "jntranscode: %s: %s\n",
+                    worker->jobs[job].input, error);
+        }
+    }
+
+    pthread_mutex_lock(worker->mutex);
+    worker->stats->files += stats.files;
+    worker->stats->failures += stats.failures;
+    worker->stats->inputBytes += stats.inputBytes;
+    worker->stats->outputBytes += stats.outputBytes;
+    worker->stats->audioNanos += stats.audioNanos;
+    worker->stats->cpuNanos += stats.cpuNanos;
+    pthread_mutex_unlock(worker->mutex);
+    return NULL;
+}
+
+int
+Transcode_run(
+        const TranscodeJob *jobs, int jobCount,
+        int threadCount,
+        TranscodeStats *stats)
+{
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    TranscodeWorker *workers;
+    pthread_t *threads;
+    WorkQueue *queue;
+    int i, started;
+
+    memset(stats, 0, sizeof(TranscodeStats));
+    if (jobCount <= 0)
+        return 0;
+    if (threadCount <= 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        threadCount = (cpus > 0) ? (int) cpus : 1;
+    }
+    if (threadCount > jobCount)
+        threadCount = jobCount;
+
+    queue = WorkQueue_new(threadCount, (jobCount + threadCount - 1) / threadCount);
+    workers = calloc(threadCount, sizeof(TranscodeWorker));
+    threads = calloc(threadCount, sizeof(pthread_t));
+    if (!queue || !workers || !threads)
+    {
+        if (queue)
+            WorkQueue_free(queue);
+        free(workers);
+        free(threads);
+        stats->files = stats->failures = jobCount;
+        return jobCount;
+    }
+
+    /*
+     * Deals the jobs out in turn. The workers pop their newest jobs and steal
+     * the oldest jobs of the others, so that the long files are balanced.
+     */
+    for (i = 0; i < jobCount; i++)
+        WorkQueue_push(queue, i % threadCount, i);
+
+    for (i = 0, started = 0; i < threadCount; i++)
+    {
+        workers[i].jobs = jobs;
+        workers[i].queue = queue;
+        workers[i].worker = i;
+        workers[i].mutex = &mutex;
+        workers[i].stats = stats;
+        if ((i == 0)
+                || (pthread_create(
+                            threads + i, NULL,
+                            Transcode_runWorker, workers + i)
+                        == 0))
+        {
+            started = i + 1;
+        }
+        else
+            break;
+    }
+    /* The calling thread is the first worker and steals from the others. */
+    Transcode_runWorker(workers);
+    for (i = 1; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    WorkQueue_free(queue);
+    free(workers);
+    free(threads);
+    pthread_mutex_destroy(&mutex);
+    return (int) stats->failures;
+}
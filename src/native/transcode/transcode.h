@@ -0,0 +1,105 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNTRANSCODE_TRANSCODE_H_
+#define _JNTRANSCODE_TRANSCODE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Offline transcoding of audio files between linear PCM, G.711, G.722 and
+ * Opus with the native codecs of libjitsi. Each file is streamed through a
+ * chain of decoder, channel conversion, resampler and encoder in blocks, and
+ * the files of a batch are spread across threads by a work-stealing
+ * scheduler.
+ *
+ * The inputs are recognised by their content (RIFF/WAVE with PCM, A-law,
+ * mu-law or G.722, Ogg Opus) or else by their extension (.g722, .ul/.ulaw/
+ * .pcmu, .al/.alaw/.pcma, anything else being raw signed 16-bit little endian
+ * PCM).
+ */
+
+/** The output formats. */
+enum
+{
+    /** RIFF/WAVE of 16-bit linear PCM. */
+    TRANSCODE_WAV = 0,
+    /** Raw signed 16-bit little endian PCM. */
+    TRANSCODE_RAW,
+    /** RIFF/WAVE of 8 kHz mono mu-law. */
+    TRANSCODE_PCMU,
+    /** RIFF/WAVE of 8 kHz mono A-law. */
+    TRANSCODE_PCMA,
+    /** Raw 64 kbit/s G.722 of 16 kHz mono. */
+    TRANSCODE_G722,
+    /** Ogg Opus. */
+    TRANSCODE_OPUS
+};
+
+/** A file to transcode. */
+typedef struct
+{
+    const char *input;
+    /** The output file or NULL to only decode and encode (benchmark). */
+    const char *output;
+    int format;
+    /**
+     * The sample rate of raw PCM input, 0 for 8000 Hz, and of linear PCM
+     * output, 0 for the rate of the input.
+     */
+    int inputRate;
+    int rate;
+    /** The channels of raw PCM input and of the output, 0 for the default. */
+    int inputChannels;
+    int channels;
+    /** The bitrate of Opus, 0 for the default of the encoder. */
+    int bitrate;
+    /** The quality of the resampler, 0 to 10. */
+    int resampleQuality;
+} TranscodeJob;
+
+/** The statistics of the transcoding of a file or of a batch. */
+typedef struct
+{
+    int64_t files;
+    int64_t failures;
+    int64_t inputBytes;
+    int64_t outputBytes;
+    /** The duration of the audio decoded. */
+    int64_t audioNanos;
+    /** The time spent transcoding, summed over the threads. */
+    int64_t cpuNanos;
+} TranscodeStats;
+
+/**
+ * Transcodes a file on the calling thread.
+ *
+ * @param stats the statistics to add to
+ * @param error receives the reason of a failure
+ * @return 0 or -1 on failure
+ */
+int Transcode_file(
+        const TranscodeJob *job,
+        TranscodeStats *stats,
+        char *error, size_t errorLength);
+
+/**
+ * Transcodes a batch of files on a specific number of threads, logging the
+ * failures to stderr.
+ *
+ * @param threadCount the number of threads, 0 for one per online CPU
+ * @param stats receives the statistics of the batch
+ * @return the number of files which failed
+ */
+int Transcode_run(
+        const TranscodeJob *jobs, int jobCount,
+        int threadCount,
+        TranscodeStats *stats);
+
+#endif /* #ifndef _JNTRANSCODE_TRANSCODE_H_ */
@@ -0,0 +1,291 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "transcode.h"
+
+/*
+ * jntranscode transcodes audio files in bulk on all the cores, for example to
+ * convert archives of voicemail and recordings, and doubles as a benchmark of
+ * the throughput of the native codecs with -n. The report starts with the
+ * machine so that the reports of the x86 and ARM64 builds may be told apart.
+ */
+
+typedef struct
+{
+    const char *name;
+    const char *extension;
+    int format;
+} TranscodeFormat;
+
+static const TranscodeFormat TRANSCODE_FORMATS[]
+    = {
+        { "wav", ".wav", TRANSCODE_WAV },
+        { "raw", ".raw", TRANSCODE_RAW },
+        { "pcmu", ".wav", TRANSCODE_PCMU },
+        { "pcma", ".wav", TRANSCODE_PCMA },
+        { "g722", ".g722", TRANSCODE_G722 },
+        { "opus", ".opus", TRANSCODE_OPUS }
+    };
+
+static void
+Transcode_usage(FILE *out)
+{
+    fprintf(
+            out,
+            "Usage: jntranscode [options] -o DIR FILE...\n"
+            "       jntranscode [options] -n FILE...\n"
+            "\n"
+            "Transcodes audio files in parallel, reporting the throughput.\n"
+            "\n"
+            "  -o DIR    write the output files into DIR\n"
+            "  -n        decode and encode without writing (benchmark)\n"
+            "  -l COUNT  transcode the files COUNT times (benchmark)\n"
+            "  -f FORMAT wav, raw, pcmu, pcma, g722 or opus (default wav)\n"
+            "  -r RATE   the sample rate of wav, raw and opus output\n"
+            "  -c COUNT  the channels of wav, raw and opus output\n"
+            "  -b BPS    the bitrate of opus output\n"
+            "  -q 0-10   the quality of the resampler (default 3)\n"
+            "  -R RATE   the sample rate of raw input (default 8000)\n"
+            "  -C COUNT  the channels of raw input (default 1)\n"
+            "  -j COUNT  the number of threads (default one per CPU)\n"
+            "  -h        print this help\n"
+            "\n"
+            "Inputs are recognised by content (WAVE of PCM, A-law, mu-law or\n"
+            "G.722, Ogg Opus) or by extension (.g722, .ul, .ulaw, .pcmu, .al,\n"
+            ".alaw, .pcma); other files are raw signed 16-bit little endian.\n");
+}
+
+static int
+Transcode_parseInt(const char *s, int min, int max, int *value)
+{
+    char *end;
+    long l;
+
+    errno = 0;
+    l = strtol(s, &end, 10);
+    if (errno || (end == s) || *end || (l < min) || (l > max))
+        return -1;
+    *value = (int) l;
+    return 0;
+}
+
+/**
+ * Makes the path of the output of an input by replacing the directory and
+ * extension of the input.
+ */
+static char *
+Transcode_outputPath(
+        const char *dir,
+        const char *input,
+        const char *extension)
+{
+    const char *name = strrchr(input, '/');
+    const char *dot;
+    size_t nameLength;
+    char *path;
+
+    name = name ? (name + 1) : input;
+    dot = strrchr(name, '.');
+    nameLength = (dot && (dot != name)) ? (size_t) (dot - name) : strlen(name);
+    if (asprintf(
+                &path,
+                "%s/%.*s%s",
+                dir, (int) nameLength, name, extension)
+            < 0)
+        return NULL;
+    return path;
+}
+
+int
+main(int argc, char **argv)
+{
+    TranscodeJob defaults;
+    TranscodeJob *jobs;
+    TranscodeStats stats;
+    const TranscodeFormat *format = TRANSCODE_FORMATS;
+    const char *dir = NULL;
+    int benchmark = 0, loops = 1, threadCount = 0;
+    int inputCount, jobCount, i, opt;
+    struct timespec start, end;
+    struct utsname machine;
+    double seconds;
+
+    memset(&defaults, 0, sizeof(defaults));
+    defaults.resampleQuality = 3;
+    while ((opt = getopt(argc, argv, "o:nl:f:r:c:b:q:R:C:j:h")) != -1)
+    {
+        int ok = 0;
+
+        switch (opt)
+        {
+        case 'o':
+            dir = optarg;
+            ok = 1;
+            break;
+        case 'n':
+            benchmark = 1;
+            ok = 1;
+            break;
+        case 'l':
+            ok = !Transcode_parseInt(optarg, 1, 1000000, &loops);
+            break;
+        case 'f':
+            for (i = 0;
+                    i < (int) (sizeof(TRANSCODE_FORMATS)
+                            / sizeof(TRANSCODE_FORMATS[0]));
+                    i++)
+            {
+                if (!strcmp(optarg, TRANSCODE_FORMATS[i].name))
+                {
+                    format = TRANSCODE_FORMATS + i;
+                    ok = 1;
+                }
+            }
+            break;
+        case 'r':
+            ok = !Transcode_parseInt(optarg, 1000, 384000, &(defaults.rate));
+            break;
+        case 'c':
+            ok = !Transcode_parseInt(optarg, 1, 8, &(defaults.channels));
+            break;
+        case 'b':
+            ok
+                = !Transcode_parseInt(
+                        optarg,
+                        500, 512000,
+                        &(defaults.bitrate));
+            break;
+        case 'q':
+            ok
+                = !Transcode_parseInt(
+                        optarg,
+                        0, 10,
+                        &(defaults.resampleQuality));
+            break;
+        case 'R':
+            ok
+                = !Transcode_parseInt(
+                        optarg,
+                        1000, 384000,
+                        &(defaults.inputRate));
+            break;
+        case 'C':
+            ok
+                = !Transcode_parseInt(
+                        optarg,
+                        1, 8,
+                        &(defaults.inputChannels));
+            break;
+        case 'j':
+            ok = !Transcode_parseInt(optarg, 1, 4096, &threadCount);
+            break;
+        case 'h':
+            Transcode_usage(stdout);
+            return 0;
+        default:
+            break;
+        }
+        if (!ok)
+        {
+            if (opt != '?')
+                fprintf(stderr, "jntranscode: invalid -%c %s\n", opt, optarg);
+            Transcode_usage(stderr);
+            return 2;
+        }
+    }
+    inputCount = argc - optind;
+    if ((inputCount <= 0) || (!dir == !benchmark))
+    {
+        Transcode_usage(stderr);
+        return 2;
+    }
+    if (!benchmark)
+    {
+        loops = 1;
+        if ((mkdir(dir, 0755) != 0) && (errno != EEXIST))
+        {
+            fprintf(stderr, "jntranscode: %s: %s\n", dir, strerror(errno));
+            return 1;
+        }
+    }
+    if (inputCount > INT_MAX / loops)
+    {
+        fprintf(stderr, "jntranscode: too many files\n");
+        return 2;
+    }
+
+    jobCount = inputCount * loops;
+    jobs = calloc(jobCount, sizeof(TranscodeJob));
+    if (!jobs)
+    {
+        fprintf(stderr, "jntranscode: out of memory\n");
+        return 1;
+    }
+    defaults.format = format->format;
+    for (i = 0; i < jobCount; i++)
+    {
+        TranscodeJob *job = jobs + i;
+
+        *job = defaults;
+        job->input = argv[optind + (i % inputCount)];
+        if (!benchmark)
+        {
+            job->output
+                = Transcode_outputPath(dir, job->input, format->extension);
+            if (!job->output)
+            {
+                fprintf(stderr, "jntranscode: out of memory\n");
+                return 1;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Transcode_run(jobs, jobCount, threadCount, &stats);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds
+        = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    if (seconds <= 0)
+        seconds = 1e-9;
+
+    if (uname(&machine) == 0)
+        printf("%s %s\n", machine.sysname, machine.machine);
+    printf(
+            "%lld files (%lld failed) in %.3f s: %.1f files/s\n",
+            (long long) stats.files, (long long) stats.failures,
+            seconds,
+            (stats.files - stats.failures) / seconds);
+    printf(
+            "%.1f s of audio: %.1fx realtime, %.1fx realtime per CPU second\n",
+            stats.audioNanos / 1e9,
+            stats.audioNanos / 1e9 / seconds,
+            (stats.cpuNanos > 0) ? ((double) stats.audioNanos / stats.cpuNanos) : 0);
+    printf(
+            "%.1f MB read, %.1f MB %s: %.1f MB/s in\n",
+            stats.inputBytes / 1e6,
+            stats.outputBytes / 1e6,
+            benchmark ? "encoded" : "written",
+            stats.inputBytes / 1e6 / seconds);
+
+    for (i = 0; i < jobCount; i++)
+        free((char *) jobs[i].output);
+    free(jobs);
+    return stats.failures ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#define _GNU_SOURCE
+
+#include "work_queue.h"
+
+#include <stdlib.h>
+
+/** The assumed size of a cache line. */
+#define WORK_QUEUE_CACHE_LINE 64
+
+/**
+ * A Chase-Lev deque of a fixed capacity, which is a power of two. The owner
+ * works at bottom and the thieves at top.
+ */
+typedef struct
+{
+    int64_t top;
+    char topPadding[WORK_QUEUE_CACHE_LINE - sizeof(int64_t)];
+    int64_t bottom;
+    int64_t steals;
+    int *jobs;
+    int64_t mask;
+    char padding[WORK_QUEUE_CACHE_LINE - 3 * sizeof(int64_t) - sizeof(int *)];
+} WorkDeque;
+
+struct WorkQueue
+{
+    WorkDeque *deques;
+    int workerCount;
+};
+
+WorkQueue *
+WorkQueue_new(int workerCount, int capacity)
+{
+    WorkQueue *queue = calloc(1, sizeof(WorkQueue));
+    int64_t size = 1;
+    int i;
+
+    if (!queue)
+        return NULL;
+    while (size < capacity)
+        size <<= 1;
+    if (posix_memalign(
+                (void **) &(queue->deques),
+                WORK_QUEUE_CACHE_LINE,
+                workerCount * sizeof(WorkDeque))
+            != 0)
+    {
+        free(queue);
+        return NULL;
+    }
+    queue->workerCount = workerCount;
+    for (i = 0; i < workerCount; i++)
+    {
+        WorkDeque *deque = queue->deques + i;
+
+        deque->top = 0;
+        deque->bottom = 0;
+        deque->steals = 0;
+        deque->mask = size - 1;
+        deque->jobs = malloc(size * sizeof(int));
+        if (!deque->jobs)
+        {
+            queue->workerCount = i;
+            WorkQueue_free(queue);
+            return NULL;
+        }
+    }
+    return queue;
+}
+
+void
+WorkQueue_free(WorkQueue *queue)
+{
+    int i;
+
+    for (i = 0; i < queue->workerCount; i++)
+        free(queue->deques[i].jobs);
+    free(queue->deques);
+    free(queue);
+}
+
+int
+WorkQueue_push(WorkQueue *queue, int worker, int job)
+{
+    WorkDeque *deque = queue->deques + worker;
+    int64_t bottom = __atomic_load_n(&(deque->bottom), __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&(deque->top), __ATOMIC_ACQUIRE);
+
+    if (bottom - top > deque->mask)
+        return -1;
+    __atomic_store_n(&(deque->jobs[bottom & deque->mask]), job, __ATOMIC_RELAXED);
+    __atomic_store_n(&(deque->bottom), bottom + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/** Pops the newest job of the deque of its owner. */
+static int
+WorkDeque_pop(WorkDeque *deque)
+{
+    int64_t bottom = __atomic_load_n(&(deque->bottom), __ATOMIC_RELAXED) - 1;
+    int64_t top;
+    int job = -1;
+
+    __atomic_store_n(&(deque->bottom), bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    top = __atomic_load_n(&(deque->top), __ATOMIC_RELAXED);
+    if (top <= bottom)
+    {
+        job
+            = __atomic_load_n(
+                    &(deque->jobs[bottom & deque->mask]),
+                    __ATOMIC_RELAXED);
+        if (top == bottom)
+        {
+            /* The last job races with the thieves. */
+            if (!__atomic_compare_exchange_n(
+                        &(deque->top), &top, top + 1,
+                        0,
+                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                job = -1;
+            __atomic_store_n(&(deque->bottom), bottom + 1, __ATOMIC_RELAXED);
+        }
+    }
+    else
+        __atomic_store_n(&(deque->bottom), bottom + 1, __ATOMIC_RELAXED);
+    return job;
+}
+
+/**
+ * Steals the oldest job of a deque.
+ *
+ * @return the job, -1 if the deque is empty or -2 if another thread won the
+ * race for the job
+ */
+static int
+WorkDeque_steal(WorkDeque *deque)
+{
+    int64_t top = __atomic_load_n(&(deque->top), __ATOMIC_ACQUIRE);
+    int64_t bottom;
+    int job;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n(&(deque->bottom), __ATOMIC_ACQUIRE);
+    if (top >= bottom)
+        return -1;
+    job = __atomic_load_n(&(deque->jobs[top & deque->mask]), __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(
+                &(deque->top), &top, top + 1,
+                0,
+                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return -2;
+    return job;
+}
+
+int
+WorkQueue_take(WorkQueue *queue, int worker)
+{
+    int job = WorkDeque_pop(queue->deques + worker);
+    int contended;
+
+    if (job >= 0)
+        return job;
+
+    /*
+     * Visits the other deques starting with the next worker so that the
+     * thieves spread over the victims.
+     */
+    do
+    {
+        int i;
+
+        contended = 0;
+        for (i = 1; i < queue->workerCount; i++)
+        {
+            WorkDeque *victim
+                = queue->deques + ((worker + i) % queue->workerCount);
+
+            job = WorkDeque_steal(victim);
+            if (job >= 0)
+            {
+                queue->deques[worker].steals++;
+                return job;
+            }
+            if (job == -2)
+                contended = 1;
+        }
+    }
+    while (contended);
+    return -1;
+}
+
+int64_t
+WorkQueue_getSteals(const WorkQueue *queue, int worker)
+{
+    return queue->deques[worker].steals;
+}
@@ -0,0 +1,50 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+
+#ifndef _JNTRANSCODE_WORK_QUEUE_H_
+#define _JNTRANSCODE_WORK_QUEUE_H_
+
+#include <stdint.h>
+
+/*
+ * A work-stealing scheduler of the indices of jobs. Each worker owns a
+ * Chase-Lev deque: it pushes and pops its jobs at the bottom without
+ * contention, and an idle worker steals the oldest job at the top of the
+ * deque of another worker with a single compare-and-swap.
+ */
+
+typedef struct WorkQueue WorkQueue;
+
+/**
+ * Creates the deques of a specific number of workers, each holding up to a
+ * specific number of jobs.
+ */
+WorkQueue *WorkQueue_new(int workerCount, int capacity);
+
+void WorkQueue_free(WorkQueue *queue);
+
+/**
+ * Pushes a job to the deque of a worker. Only the worker itself or the thread
+ * which fills the deques before the workers start may push.
+ *
+ * @return 0 or -1 if the deque is full
+ */
+int WorkQueue_push(WorkQueue *queue, int worker, int job);
+
+/**
+ * Takes the next job of a worker, popping its own deque first and then
+ * stealing from the others.
+ *
+ * @return the job or -1 if no job is left
+ */
+int WorkQueue_take(WorkQueue *queue, int worker);
+
+/** Gets the number of jobs which a worker has stolen from the others. */
+int64_t WorkQueue_getSteals(const WorkQueue *queue, int worker);
+
+#endif /* #ifndef _JNTRANSCODE_WORK_QUEUE_H_ */
@@ -20,9 +20,11 @@
 #include <mmreg.h> /* WAVEFORMATEX */
 #include <objbase.h>
 #include <stdint.h> /* intptr_t */
+#include <stdlib.h> /* calloc, free */
 #include <string.h>
 #include <windows.h> /* LoadLibrary, GetProcAddress */
 
+#include "audio_io_health.h"
 #include "HResultException.h"
 #include "Typecasting.h"
 
@@ -53,6 +55,7 @@ ULONG STDMETHODCALLTYPE MMNotificationClient_Release
 static UINT32 WASAPI_audiocopy
     (void *src, jint srcSampleSize, jint srcChannels, void *dst,
         jint dstSampleSize, jint dstChannels, UINT32 numFramesRequested);
+static uint64_t WASAPI_nanoTime();
 
 #ifdef _MSC_VER
     DEFINE_GUID(IID_IMMDeviceEnumerator,0xa95664d2,0x9614,0x4f35,0xa7,0x46,0xde,0x8d,0xb6,0x36,0x17,0xe6);
@@ -92,6 +95,20 @@ static IMMNotificationClientVtbl *WASAPI_iMMNotificationClient
 static LPPSPropertyKeyFromString WASAPI_pPSPropertyKeyFromString = NULL;
 static JavaVM *WASAPI_vm = NULL;
 
+/*
+ * The IO health of a capture or render stream, allocated by IOHealth_alloc
+ * and passed to IAudioCaptureClient_Read and IAudioRenderClient_Write. WASAPI
+ * is polled from Java so each Read or Write which exchanges audio counts as a
+ * callback, and the device period is set from Java.
+ */
+typedef struct
+{
+    AudioIOHealth health;
+    uint64_t periodNanos;
+    /* The padding last reported by IOHealth_setPadding. */
+    UINT32 numPaddingFrames;
+} WASAPI_IOHealth;
+
 JNIEXPORT void JNICALL
 Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_CloseHandle
     (JNIEnv *env, jclass clazz, jlong hObject)
@@ -316,17 +333,19 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioCaptureCl
 
 JNIEXPORT jint JNICALL
 Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioCaptureClient_1Read
-    (JNIEnv *env, jclass clazz, jlong thiz, jbyteArray data, jint offset,
-        jint length, jint srcSampleSize, jint srcChannels, jint dstSampleSize,
-        jint dstChannels)
+    (JNIEnv *env, jclass clazz, jlong thiz, jlong ioHealth, jbyteArray data,
+        jint offset, jint length, jint srcSampleSize, jint srcChannels,
+        jint dstSampleSize, jint dstChannels)
 {
     HRESULT hr;
     IAudioCaptureClient *iAudioCaptureClient
         = (IAudioCaptureClient *) (intptr_t) thiz;
+    WASAPI_IOHealth *health = (WASAPI_IOHealth *) (intptr_t) ioHealth;
     BYTE *pData;
     UINT32 numFramesToRead;
     DWORD dwFlags;
     jint read;
+    uint64_t startNanos = 0;
 
     hr
         = IAudioCaptureClient_GetBuffer(
@@ -345,6 +364,21 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioCaptureCl
             numFramesRead = 0;
         else
         {
+            if (health)
+            {
+                startNanos = WASAPI_nanoTime();
+                AudioIOHealth_beginCallback(
+                        &(health->health),
+                        startNanos,
+                        health->periodNanos);
+                if (dwFlags & AUDCLNT_BUFFERFLAGS_DATA_DISCONTINUITY)
+                {
+                    AudioIOHealth_add(
+                            &(health->health),
+                            AUDIO_IO_HEALTH_OVERRUNS,
+                            1);
+                }
+            }
             if (length < numFramesToRead * dstFrameSize)
             {
                 numFramesRead = 0;
@@ -360,11 +394,19 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioCaptureCl
 
                 if (data_)
                 {
+                    uint64_t copyNanos = health ? WASAPI_nanoTime() : 0;
+
                     numFramesRead
                         = WASAPI_audiocopy(
                                 pData, srcSampleSize, srcChannels,
                                 data_ + offset, dstSampleSize, dstChannels,
                                 numFramesToRead);
+                    if (health)
+                    {
+                        AudioIOHealth_addConversion(
+                                &(health->health),
+                                WASAPI_nanoTime() - copyNanos);
+                    }
                     (*env)->ReleasePrimitiveArrayCritical(env, data, data_, 0);
                 }
                 else
@@ -376,6 +418,14 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioCaptureCl
                     iAudioCaptureClient,
                     numFramesRead);
         read = numFramesRead * dstFrameSize;
+        if (startNanos)
+        {
+            AudioIOHealth_endCallback(
+                    &(health->health),
+                    startNanos,
+                    WASAPI_nanoTime(),
+                    health->periodNanos);
+        }
         if (FAILED(hr))
             WASAPI_throwNewHResultException(env, hr, __func__, __LINE__);
     }
@@ -613,20 +663,30 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioRenderCli
 
 JNIEXPORT jint JNICALL
 Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioRenderClient_1Write
-    (JNIEnv *env, jclass clazz, jlong thiz, jbyteArray data, jint offset,
-        jint length, jint srcSampleSize, jint srcChannels, jint dstSampleSize,
-        jint dstChannels)
+    (JNIEnv *env, jclass clazz, jlong thiz, jlong ioHealth, jbyteArray data,
+        jint offset, jint length, jint srcSampleSize, jint srcChannels,
+        jint dstSampleSize, jint dstChannels)
 {
     jint srcFrameSize;
     UINT32 numFramesRequested;
     HRESULT hr;
     IAudioRenderClient *iAudioRenderClient
         = (IAudioRenderClient *) (intptr_t) thiz;
+    WASAPI_IOHealth *health = (WASAPI_IOHealth *) (intptr_t) ioHealth;
     BYTE *pData;
     jint written;
+    uint64_t startNanos = 0;
 
     srcFrameSize = srcSampleSize * srcChannels;
     numFramesRequested = length / srcFrameSize;
+    if (health && numFramesRequested)
+    {
+        startNanos = WASAPI_nanoTime();
+        AudioIOHealth_beginCallback(
+                &(health->health),
+                startNanos,
+                health->periodNanos);
+    }
     hr
         = IAudioRenderClient_GetBuffer(
                 iAudioRenderClient,
@@ -640,11 +700,19 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioRenderCli
         data_ = (*env)->GetPrimitiveArrayCritical(env, data, NULL);
         if (data_)
         {
+            uint64_t copyNanos = startNanos ? WASAPI_nanoTime() : 0;
+
             numFramesWritten
                 = WASAPI_audiocopy(
                         data_ + offset, srcSampleSize, srcChannels,
                         pData, dstSampleSize, dstChannels,
                         numFramesRequested);
+            if (startNanos)
+            {
+                AudioIOHealth_addConversion(
+                        &(health->health),
+                        WASAPI_nanoTime() - copyNanos);
+            }
             (*env)->ReleasePrimitiveArrayCritical(env, data, data_, JNI_ABORT);
         }
         else
@@ -663,6 +731,14 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioRenderCli
         written = 0;
         WASAPI_throwNewHResultException(env, hr, __func__, __LINE__);
     }
+    if (startNanos)
+    {
+        AudioIOHealth_endCallback(
+                &(health->health),
+                startNanos,
+                WASAPI_nanoTime(),
+                health->periodNanos);
+    }
     return written;
 }
 
@@ -933,6 +1009,67 @@ Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IMMEndpoint_1Re
     IMMEndpoint_Release((IMMEndpoint *) (intptr_t) thiz);
 }
 
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1alloc
+    (JNIEnv *env, jclass clazz)
+{
+    return (jlong) (intptr_t) calloc(1, sizeof(WASAPI_IOHealth));
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1free
+    (JNIEnv *env, jclass clazz, jlong ioHealth)
+{
+    free((WASAPI_IOHealth *) (intptr_t) ioHealth);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1get
+    (JNIEnv *env, jclass clazz, jlong ioHealth, jlongArray values)
+{
+    jint length = (*env)->GetArrayLength(env, values);
+    jlong *values_ = (*env)->GetLongArrayElements(env, values, NULL);
+    jint copied;
+
+    if (!values_)
+        return 0; /* An OutOfMemoryError has been thrown. */
+
+    copied
+        = AudioIOHealth_snapshot(
+                &(((WASAPI_IOHealth *) (intptr_t) ioHealth)->health),
+                (int64_t *) values_,
+                length);
+    (*env)->ReleaseLongArrayElements(env, values, values_, 0);
+    return copied;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1setPadding
+    (JNIEnv *env, jclass clazz, jlong ioHealth, jint numPaddingFrames)
+{
+    WASAPI_IOHealth *health = (WASAPI_IOHealth *) (intptr_t) ioHealth;
+
+    /*
+     * The audio engine plays silence once it has consumed all of the audio
+     * queued in the rendering endpoint buffer, so the padding falling to 0
+     * from a positive value is an underrun.
+     */
+    if ((numPaddingFrames == 0) && (health->numPaddingFrames != 0))
+        AudioIOHealth_add(&(health->health), AUDIO_IO_HEALTH_UNDERRUNS, 1);
+    health->numPaddingFrames = (UINT32) numPaddingFrames;
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1setPeriod
+    (JNIEnv *env, jclass clazz, jlong ioHealth, jlong periodNanos)
+{
+    WASAPI_IOHealth *health = (WASAPI_IOHealth *) (intptr_t) ioHealth;
+
+    /* Invoked while the stream is stopped so no Read or Write is racing. */
+    memset(health, 0, sizeof(WASAPI_IOHealth));
+    health->periodNanos = (uint64_t) periodNanos;
+}
+
 JNIEXPORT jstring JNICALL
 Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IPropertyStore_1GetString
     (JNIEnv *env, jclass clazz, jlong thiz, jlong key)
@@ -1599,3 +1736,23 @@ WASAPI_audiocopy
     }
     return numFramesWritten;
 }
+
+static uint64_t
+WASAPI_nanoTime()
+{
+    static LONGLONG frequency = 0;
+    LARGE_INTEGER counter;
+
+    if (!frequency)
+    {
+        LARGE_INTEGER frequency_;
+
+        QueryPerformanceFrequency(&frequency_);
+        frequency = frequency_.QuadPart;
+    }
+    QueryPerformanceCounter(&counter);
+    return
+        (uint64_t) (counter.QuadPart / frequency) * 1000000000
+            + (uint64_t) (counter.QuadPart % frequency) * 1000000000
+                / frequency;
+}
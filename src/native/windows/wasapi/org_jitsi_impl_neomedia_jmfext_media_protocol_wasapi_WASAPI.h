@@ -74,10 +74,10 @@ JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi
 /*
  * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
  * Method:    IAudioCaptureClient_Read
- * Signature: (J[BIIIIII)I
+ * Signature: (JJ[BIIIIII)I
  */
 JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioCaptureClient_1Read
-  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jint, jint, jint, jint);
+  (JNIEnv *, jclass, jlong, jlong, jbyteArray, jint, jint, jint, jint, jint, jint);
 
 /*
  * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
@@ -186,10 +186,10 @@ JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi
 /*
  * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
  * Method:    IAudioRenderClient_Write
- * Signature: (J[BIIIIII)I
+ * Signature: (JJ[BIIIIII)I
  */
 JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IAudioRenderClient_1Write
-  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jint, jint, jint, jint);
+  (JNIEnv *, jclass, jlong, jlong, jbyteArray, jint, jint, jint, jint, jint, jint);
 
 /*
  * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
@@ -303,6 +303,46 @@ JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi
 JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IMMEndpoint_1Release
   (JNIEnv *, jclass, jlong);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
+ * Method:    IOHealth_alloc
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1alloc
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
+ * Method:    IOHealth_free
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1free
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
+ * Method:    IOHealth_get
+ * Signature: (J[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1get
+  (JNIEnv *, jclass, jlong, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
+ * Method:    IOHealth_setPadding
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1setPadding
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
+ * Method:    IOHealth_setPeriod
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI_IOHealth_1setPeriod
+  (JNIEnv *, jclass, jlong, jlong);
+
 /*
  * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_wasapi_WASAPI
  * Method:    IPropertyStore_GetString
@@ -13,6 +13,7 @@ import net.sf.fmj.media.Log;
 
 import org.jitsi.impl.neomedia.codec.*;
 import org.jitsi.service.neomedia.codec.*;
+import org.jitsi.util.*;
 
 /**
  *
@@ -48,7 +49,7 @@ public class JNIDecoder
 
     static
     {
-        System.loadLibrary("jng722");
+        NativeLibraryLoader.loadLibrary("jng722", JNIDecoder.class);
     }
 
     private static native void g722_decoder_close(long decoder);
@@ -12,6 +12,7 @@ import javax.media.format.*;
 import net.sf.fmj.media.Log;
 
 import org.jitsi.impl.neomedia.codec.*;
+import org.jitsi.util.*;
 
 /**
  * @author Lyubomir Marinov
@@ -21,7 +22,7 @@ public class JNIEncoder
 {
     static
     {
-        System.loadLibrary("jng722");
+        NativeLibraryLoader.loadLibrary("jng722", JNIEncoder.class);
     }
 
     private static native void g722_encoder_close(long encoder);
@@ -6,6 +6,8 @@
  */
 package net.java.sip.communicator.impl.neomedia.codec.audio.speex;
 
+import org.jitsi.util.*;
+
 /**
  * Provides the interface to the native Speex library (just the renderer, not
  * encoding and decoding).
@@ -20,7 +22,7 @@ public final class Speex
 
     static
     {
-        System.loadLibrary("jnspeex");
+        NativeLibraryLoader.loadLibrary("jnspeex", Speex.class);
     }
 
     public static void assertSpeexIsFunctional()
@@ -4,11 +4,17 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia;
 
 /**
  * Implements functionality aiding the reading and writing in little endian of
  * <tt>byte</tt> arrays and primitive types such as <tt>short</tt>.
+ * <p>
+ * The bulk conversions of arrays of 16-bit samples are done by the SIMD
+ * kernels of {@link NativeArrayIOUtils} when the jnpcm library is available
+ * and the arrays are large enough, and by equivalent loops otherwise.
+ * </p>
  *
  * @author Lyubomir Marinov
  */
@@ -106,4 +112,163 @@ public class ArrayIOUtils
         out[outOffset + 1] = (byte) (in >> 8);
     }
 
+    /**
+     * Checks that a range of an array is within its bounds.
+     *
+     * @param arrayLength the length of the array
+     * @param offset the offset of the range in the array
+     * @param length the length of the range
+     * @throws ArrayIndexOutOfBoundsException if the range is not within the
+     * bounds of the array
+     */
+    private static void checkBounds(int arrayLength, int offset, int length)
+    {
+        if ((offset < 0) || (length < 0) || (offset > arrayLength - length))
+        {
+            throw new ArrayIndexOutOfBoundsException(
+                    "offset " + offset + ", length " + length
+                        + ", array length " + arrayLength);
+        }
+    }
+
+    /**
+     * Mixes a series of samples into another as the audio mixer does, i.e.
+     * each output sample becomes
+     * <tt>in + out - round(in * (out / (float) maxSample))</tt>.
+     *
+     * @param in the samples to mix in
+     * @param inOffset the offset in <tt>in</tt> of the first sample
+     * @param out the samples to mix into
+     * @param outOffset the offset in <tt>out</tt> of the first sample
+     * @param count the number of samples to mix
+     * @param maxSample the maximum value of a sample in the output format
+     */
+    public static void mixIntArray(
+            int[] in, int inOffset,
+            int[] out, int outOffset,
+            int count,
+            int maxSample)
+    {
+        checkBounds(in.length, inOffset, count);
+        checkBounds(out.length, outOffset, count);
+
+        /*
+         * The native kernel rounds as Math.round(float) only while the
+         * products are within 2^23, which 16-bit and narrower samples are.
+         */
+        if (NativeArrayIOUtils.isLoaded
+                && (count >= NativeArrayIOUtils.MIN_NATIVE_COUNT)
+                && (maxSample <= Short.MAX_VALUE))
+        {
+            NativeArrayIOUtils.int32Mix(
+                    in, inOffset,
+                    out, outOffset,
+                    count,
+                    maxSample);
+            return;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            int inSample = in[inOffset + i];
+            int outSample = out[outOffset + i];
+
+            out[outOffset + i]
+                = inSample
+                    + outSample
+                    - Math.round(inSample * (outSample / (float) maxSample));
+        }
+    }
+
+    /**
+     * Reads a series of 16-bit samples into an array of integers.
+     *
+     * @param in the samples to read
+     * @param inOffset the offset in <tt>in</tt> of the first sample
+     * @param out the output of the samples
+     * @param outOffset the offset in <tt>out</tt> of the first sample
+     * @param count the number of samples to read
+     */
+    public static void readInt16Array(
+            byte[] in, int inOffset,
+            int[] out, int outOffset,
+            int count)
+    {
+        checkBounds(in.length, inOffset, count * 2);
+        checkBounds(out.length, outOffset, count);
+
+        if (NativeArrayIOUtils.isLoaded
+                && (count >= NativeArrayIOUtils.MIN_NATIVE_COUNT))
+        {
+            NativeArrayIOUtils.int16ToInt32(in, inOffset, out, outOffset, count);
+            return;
+        }
+        for (int i = 0; i < count; i++, inOffset += 2)
+            out[outOffset + i] = readInt16(in, inOffset);
+    }
+
+    /**
+     * Gets the sum of the squares of a series of 16-bit samples, such as to
+     * compute their RMS.
+     *
+     * @param in the samples
+     * @param inOffset the offset in <tt>in</tt> of the first sample
+     * @param count the number of samples
+     * @return the sum of the squares of the samples
+     */
+    public static long sumOfSquaresInt16(byte[] in, int inOffset, int count)
+    {
+        checkBounds(in.length, inOffset, count * 2);
+
+        if (NativeArrayIOUtils.isLoaded
+                && (count >= NativeArrayIOUtils.MIN_NATIVE_COUNT))
+        {
+            return NativeArrayIOUtils.int16SumOfSquares(in, inOffset, count);
+        }
+
+        long sum = 0;
+
+        for (int i = 0; i < count; i++, inOffset += 2)
+        {
+            int sample = readInt16(in, inOffset);
+
+            sum += sample * sample;
+        }
+        return sum;
+    }
+
+    /**
+     * Writes a series of integers as 16-bit samples, saturating those out of
+     * the range of a <tt>short</tt>.
+     *
+     * @param in the samples to write
+     * @param inOffset the offset in <tt>in</tt> of the first sample
+     * @param out the output of the samples
+     * @param outOffset the offset in <tt>out</tt> of the first sample
+     * @param count the number of samples to write
+     */
+    public static void writeInt16Array(
+            int[] in, int inOffset,
+            byte[] out, int outOffset,
+            int count)
+    {
+        checkBounds(in.length, inOffset, count);
+        checkBounds(out.length, outOffset, count * 2);
+
+        if (NativeArrayIOUtils.isLoaded
+                && (count >= NativeArrayIOUtils.MIN_NATIVE_COUNT))
+        {
+            NativeArrayIOUtils.int32ToInt16(in, inOffset, out, outOffset, count);
+            return;
+        }
+        for (int i = 0; i < count; i++, outOffset += 2)
+        {
+            int sample = in[inOffset + i];
+
+            if (sample > Short.MAX_VALUE)
+                sample = Short.MAX_VALUE;
+            else if (sample < Short.MIN_VALUE)
+                sample = Short.MIN_VALUE;
+            writeInt16(sample, out, outOffset);
+        }
+    }
 }
@@ -13,6 +13,7 @@ import java.util.*;
 import javax.media.*;
 import javax.media.control.*;
 import javax.media.format.*;
+import javax.media.rtp.*;
 
 import org.jitsi.impl.neomedia.device.*;
 import org.jitsi.impl.neomedia.transform.dtmf.*;
@@ -72,6 +73,25 @@ public class AudioMediaStreamImpl
     private static final Logger logger
         = Logger.getLogger(AudioMediaStreamImpl.class);
 
+    /**
+     * The interval in milliseconds at which the arrival times of the packets
+     * of this stream are handed to the decoders newly created for it.
+     */
+    private static final long ARRIVAL_TIMES_BIND_INTERVAL = 1000;
+
+    /**
+     * The arrival times of the RTP packets received by this stream, which let
+     * its decoders trace the time the packets spend in the jitter buffer.
+     */
+    private final LatencyTracer.ArrivalTimes arrivalTimes
+        = new LatencyTracer.ArrivalTimes();
+
+    /**
+     * The time in milliseconds at which {@link #arrivalTimes} was last handed
+     * to the decoders of this stream.
+     */
+    private long arrivalTimesBindTime;
+
     /**
      * A <tt>PropertyChangeNotifier<tt> which will inform this
      * <tt>AudioStream</tt> if a selected audio device (capture, playback or
@@ -176,6 +196,9 @@ public class AudioMediaStreamImpl
     @Override
     public void close()
     {
+        // The codecs go away with the device session.
+        logLatency();
+
         super.close();
 
         if(dtmfTransfrmEngine != null)
@@ -188,6 +211,87 @@ public class AudioMediaStreamImpl
             audioSystemChangeNotifier.removePropertyChangeListener(this);
     }
 
+    /**
+     * Hands the arrival times of the packets of this stream to its decoders,
+     * at most once per {@link #ARRIVAL_TIMES_BIND_INTERVAL} since the decoders
+     * are created when the first packets of a <tt>ReceiveStream</tt> have
+     * been received.
+     *
+     * @param pkt the received RTP packet
+     */
+    @Override
+    public void rtpPacketReceived(RawPacket pkt)
+    {
+        arrivalTimes.record(pkt.getSequenceNumber(), System.nanoTime());
+
+        long now = System.currentTimeMillis();
+
+        if (now - arrivalTimesBindTime < ARRIVAL_TIMES_BIND_INTERVAL)
+            return;
+        arrivalTimesBindTime = now;
+
+        MediaDeviceSession deviceSession = getDeviceSession();
+
+        if (deviceSession == null)
+            return;
+
+        for (ReceiveStream receiveStream : deviceSession.getReceiveStreams())
+        {
+            for (LatencyTracer latencyTracer
+                    : deviceSession.getDecoderControls(
+                            receiveStream,
+                            LatencyTracer.class))
+            {
+                latencyTracer.setArrivalTimes(arrivalTimes);
+            }
+        }
+    }
+
+    /**
+     * Logs the latency traced by the encoders and decoders of this stream and,
+     * in a conference, by the mixer which captures for it.
+     */
+    private void logLatency()
+    {
+        MediaDeviceSession deviceSession = getDeviceSession();
+
+        if (deviceSession == null)
+            return;
+
+        long[] snapshot = new long[LatencyTracer.LENGTH];
+        Set<LatencyTracer> encoderLatencyTracers
+            = deviceSession.getEncoderControls(LatencyTracer.class);
+
+        for (LatencyTracer latencyTracer : encoderLatencyTracers)
+            LatencyTracer.merge(snapshot, latencyTracer.getSnapshot(false));
+        // The capture device exists once there are encoders.
+        if (!encoderLatencyTracers.isEmpty())
+        {
+            Object mixerLatencyTracer
+                = deviceSession.getCaptureDevice().getControl(
+                        LatencyTracer.class.getName());
+
+            if (mixerLatencyTracer instanceof LatencyTracer)
+            {
+                LatencyTracer.merge(
+                        snapshot,
+                        ((LatencyTracer) mixerLatencyTracer).getSnapshot(
+                                false));
+            }
+        }
+        for (ReceiveStream receiveStream : deviceSession.getReceiveStreams())
+        {
+            for (LatencyTracer latencyTracer
+                    : deviceSession.getDecoderControls(
+                            receiveStream,
+                            LatencyTracer.class))
+            {
+                LatencyTracer.merge(snapshot, latencyTracer.getSnapshot(false));
+            }
+        }
+        LatencyTracer.log(logger, "stream " + hashCode(), snapshot);
+    }
+
     /**
      * Performs any optional configuration on the <tt>BufferControl</tt> of the
      * specified <tt>RTPManager</tt> which is to be used as the
@@ -0,0 +1,310 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia;
+
+import java.io.*;
+import java.util.*;
+
+import javax.media.*;
+import javax.media.datasink.*;
+import javax.media.protocol.*;
+
+import org.jitsi.impl.neomedia.transport.*;
+import org.jitsi.util.*;
+
+/**
+ * Implements a <tt>DataSink</tt> which writes the output of a
+ * <tt>PushDataSource</tt> into a file through the io_uring of
+ * <tt>NativeIoRing</tt> so that the thread pushing the media does not block
+ * on the disk. Implements <tt>Seekable</tt> on its
+ * <tt>SourceTransferHandler</tt> so that a multiplexer may go back and
+ * rewrite the header of the file when it stops.
+ */
+class IoRingDataSink
+    implements DataSink,
+               Seekable,
+               SourceTransferHandler
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>IoRingDataSink</tt> class and its
+     * instances for logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(IoRingDataSink.class);
+
+    /**
+     * The buffer into which the data of the streams is read.
+     */
+    private byte[] buffer = new byte[8192];
+
+    /**
+     * The <tt>NativeIoRing.File</tt> written to between {@link #open()} and
+     * {@link #close()}.
+     */
+    private NativeIoRing.File file;
+
+    private final List<DataSinkListener> listeners
+        = new ArrayList<DataSinkListener>();
+
+    private MediaLocator locator;
+
+    private PushDataSource source;
+
+    private boolean started;
+
+    public void addDataSinkListener(DataSinkListener listener)
+    {
+        synchronized (listeners)
+        {
+            if (!listeners.contains(listener))
+                listeners.add(listener);
+        }
+    }
+
+    /**
+     * Stops this <tt>DataSink</tt>, disconnects its source and closes its
+     * file once everything written to it has reached the disk.
+     */
+    public void close()
+    {
+        try
+        {
+            stop();
+        }
+        catch (IOException ioe)
+        {
+            logger.warn("Failed to stop " + this, ioe);
+        }
+
+        NativeIoRing.File file;
+
+        synchronized (this)
+        {
+            file = this.file;
+            this.file = null;
+        }
+        if (source != null)
+        {
+            for (PushSourceStream stream : source.getStreams())
+                stream.setTransferHandler(null);
+            source.disconnect();
+        }
+        if (file != null)
+        {
+            try
+            {
+                file.close();
+            }
+            catch (IOException ioe)
+            {
+                logger.error("Failed to write " + locator, ioe);
+                fireDataSinkEvent(
+                        new DataSinkErrorEvent(this, ioe.getMessage()));
+            }
+        }
+    }
+
+    private void fireDataSinkEvent(DataSinkEvent event)
+    {
+        DataSinkListener[] listeners;
+
+        synchronized (this.listeners)
+        {
+            listeners
+                = this.listeners.toArray(
+                        new DataSinkListener[this.listeners.size()]);
+        }
+        for (DataSinkListener listener : listeners)
+            listener.dataSinkUpdate(event);
+    }
+
+    public String getContentType()
+    {
+        return (source == null) ? null : source.getContentType();
+    }
+
+    public Object getControl(String controlType)
+    {
+        return null;
+    }
+
+    public Object[] getControls()
+    {
+        return new Object[0];
+    }
+
+    public MediaLocator getOutputLocator()
+    {
+        return locator;
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * Writes are positional so this <tt>DataSink</tt> is random access.
+     */
+    public boolean isRandomAccess()
+    {
+        return true;
+    }
+
+    /**
+     * Opens the file of the output locator of this <tt>DataSink</tt> and
+     * becomes the <tt>SourceTransferHandler</tt> of the streams of its source.
+     *
+     * @throws IOException if the file could not be opened
+     */
+    public void open()
+        throws IOException
+    {
+        if (source == null)
+            throw new IOException("No source");
+        if ((locator == null) || !"file".equals(locator.getProtocol()))
+            throw new IOException("Not a file locator: " + locator);
+
+        NativeIoRing.File file = NativeIoRing.openFile(locator.getRemainder());
+
+        synchronized (this)
+        {
+            this.file = file;
+        }
+        source.connect();
+        for (PushSourceStream stream : source.getStreams())
+            stream.setTransferHandler(this);
+    }
+
+    public void removeDataSinkListener(DataSinkListener listener)
+    {
+        synchronized (listeners)
+        {
+            listeners.remove(listener);
+        }
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * Waits for the writes before the new position to complete so that they
+     * are not reordered with the writes after it.
+     */
+    public synchronized long seek(long where)
+    {
+        if (file != null)
+        {
+            try
+            {
+                file.seek(where);
+            }
+            catch (IOException ioe)
+            {
+                logger.error("Failed to seek in " + locator, ioe);
+                return tell();
+            }
+        }
+        return where;
+    }
+
+    public void setOutputLocator(MediaLocator locator)
+    {
+        this.locator = locator;
+    }
+
+    public void setSource(DataSource source)
+        throws IncompatibleSourceException
+    {
+        if (!(source instanceof PushDataSource))
+        {
+            throw new IncompatibleSourceException(
+                    "Not a PushDataSource: " + source);
+        }
+        this.source = (PushDataSource) source;
+    }
+
+    public void start()
+        throws IOException
+    {
+        if (!started)
+        {
+            source.start();
+            started = true;
+        }
+    }
+
+    public void stop()
+        throws IOException
+    {
+        if (started)
+        {
+            started = false;
+            source.stop();
+
+            NativeIoRing.File file;
+
+            synchronized (this)
+            {
+                file = this.file;
+            }
+            if (file != null)
+                file.flush();
+        }
+    }
+
+    public synchronized long tell()
+    {
+        return (file == null) ? 0 : file.tell();
+    }
+
+    /**
+     * Reads the data available in a specific stream and queues it for writing
+     * into the file of this <tt>DataSink</tt>.
+     *
+     * @param stream the <tt>PushSourceStream</tt> which has data available
+     */
+    public void transferData(PushSourceStream stream)
+    {
+        IOException exception = null;
+        boolean endOfStream = false;
+
+        synchronized (this)
+        {
+            if (file == null)
+                return;
+
+            int minimum = stream.getMinimumTransferSize();
+
+            if (buffer.length < minimum)
+                buffer = new byte[minimum];
+            try
+            {
+                int length = stream.read(buffer, 0, buffer.length);
+
+                if (length > 0)
+                    file.write(buffer, 0, length);
+                else if (length < 0)
+                    endOfStream = true;
+            }
+            catch (IOException ioe)
+            {
+                exception = ioe;
+            }
+            if (!endOfStream)
+                endOfStream = stream.endOfStream();
+        }
+
+        if (exception != null)
+        {
+            logger.error("Failed to write " + locator, exception);
+            fireDataSinkEvent(
+                    new DataSinkErrorEvent(this, exception.getMessage()));
+        }
+        else if (endOfStream)
+        {
+            fireDataSinkEvent(new EndOfStreamEvent(this));
+        }
+    }
+}
@@ -0,0 +1,368 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia;
+
+import java.awt.*;
+import java.util.concurrent.atomic.*;
+
+import javax.media.*;
+
+import org.jitsi.util.*;
+
+/**
+ * Traces the time audio frames spend in each stage between the microphone
+ * and the speaker in lock-free histograms, so that a latency regression can
+ * be pinned to a stage of a specific stream. The stages of the device
+ * callbacks are traced per device stream in the native audio library and
+ * fetched with a single JNI call per snapshot; the stages which run in Java
+ * are traced by an instance per codec, which is exposed as a <tt>Control</tt>
+ * of the codec so that the <tt>MediaStream</tt> it belongs to may find it.
+ * <p>
+ * A snapshot holds {@link #STAGE_LENGTH} values per {@link Stage}, in the
+ * order of the stages: the number of frames, the sum and the maximum of their
+ * times in microseconds and {@link #BUCKETS} buckets, bucket <tt>i</tt>
+ * counting the times in <tt>[2^i, 2^(i+1))</tt> microseconds.
+ * </p>
+ */
+public class LatencyTracer
+    implements Control
+{
+    /**
+     * The stages of the audio path. The native stages come first, in the
+     * order of the <tt>LATENCY_STAGE_</tt> constants of the native library.
+     */
+    public enum Stage
+    {
+        /** From the capture by the device to the input callback. */
+        CAPTURE_DEVICE(true),
+        /** From the input callback to Java, i.e. conversion and AEC. */
+        CAPTURE_PROCESS(true),
+        /** Handing captured data over to Java. */
+        CAPTURE_JAVA(true),
+        /** Getting the data to render from Java. */
+        RENDER_JAVA(true),
+        /** From the output callback to the playback by the device. */
+        RENDER_DEVICE(true),
+        /**
+         * From the arrival of a frame in Java, as carried by the time stamp
+         * of its <tt>Buffer</tt>, to the start of its encoding, i.e. the
+         * capture queue and the mixer.
+         */
+        CAPTURE_TO_ENCODE(false),
+        /**
+         * From the start of the reading of the inputs of the conference mixer
+         * to the mix of a participant being read out of it, i.e. reading and
+         * mixing the inputs.
+         */
+        MIX(false),
+        /** Encoding a frame. */
+        ENCODE(false),
+        /**
+         * From the arrival of an RTP packet to the start of its decoding, i.e.
+         * the jitter buffer.
+         */
+        JITTER_BUFFER(false),
+        /** Decoding a packet, including FEC and PLC. */
+        DECODE(false);
+
+        /**
+         * Whether the stage is traced in the native audio library.
+         */
+        public final boolean isNative;
+
+        Stage(boolean isNative)
+        {
+            this.isNative = isNative;
+        }
+    }
+
+    /**
+     * The arrival times of the last RTP packets of a stream, indexed by their
+     * sequence numbers, so that the decoders of the stream may trace the
+     * time the packets spend in the jitter buffer. Written by the thread
+     * which receives the packets only.
+     */
+    public static class ArrivalTimes
+    {
+        /**
+         * The number of packets kept, a power of 2.
+         */
+        private static final int LENGTH = 512;
+
+        /**
+         * The sequence numbers plus one of the packets in {@link #nanos}, 0
+         * for none.
+         */
+        private final AtomicIntegerArray seqNos
+            = new AtomicIntegerArray(LENGTH);
+
+        /**
+         * The arrival times in nanoseconds of the packets.
+         */
+        private final AtomicLongArray nanos = new AtomicLongArray(LENGTH);
+
+        /**
+         * Gets the arrival time of the packet with a specific sequence number.
+         *
+         * @param seqNo the RTP sequence number of the packet
+         * @return the arrival time of the packet in the time base of
+         * <tt>System.nanoTime()</tt> or <tt>Buffer.TIME_UNKNOWN</tt> if it is
+         * no longer known
+         */
+        public long get(int seqNo)
+        {
+            int index = seqNo & (LENGTH - 1);
+            int key = (seqNo & 0xFFFF) + 1;
+
+            if (seqNos.get(index) != key)
+                return Buffer.TIME_UNKNOWN;
+
+            long arrivalNanos = nanos.get(index);
+
+            // The entry may have been reused while it was being read.
+            return
+                (seqNos.get(index) == key)
+                    ? arrivalNanos
+                    : Buffer.TIME_UNKNOWN;
+        }
+
+        /**
+         * Records the arrival time of a packet.
+         *
+         * @param seqNo the RTP sequence number of the packet
+         * @param arrivalNanos the arrival time of the packet in the time base
+         * of <tt>System.nanoTime()</tt>
+         */
+        public void record(int seqNo, long arrivalNanos)
+        {
+            int index = seqNo & (LENGTH - 1);
+
+            seqNos.set(index, 0);
+            nanos.set(index, arrivalNanos);
+            seqNos.set(index, (seqNo & 0xFFFF) + 1);
+        }
+    }
+
+    /**
+     * The number of log2 microsecond buckets of a histogram.
+     */
+    public static final int BUCKETS = 24;
+
+    /**
+     * The number of values per stage in a snapshot.
+     */
+    public static final int STAGE_LENGTH = 3 + BUCKETS;
+
+    private static final int COUNT = 0;
+    private static final int SUM_MICROS = 1;
+    private static final int MAX_MICROS = 2;
+
+    private static final Stage[] STAGES = Stage.values();
+
+    /**
+     * The length of a snapshot.
+     */
+    public static final int LENGTH = STAGES.length * STAGE_LENGTH;
+
+    /**
+     * Gets the capture time carried by a specific <tt>Buffer</tt>, i.e. its
+     * time stamp if it is in the time base of <tt>System.nanoTime()</tt>.
+     *
+     * @param buffer the <tt>Buffer</tt>
+     * @return the capture time of <tt>buffer</tt> in nanoseconds or
+     * <tt>Buffer.TIME_UNKNOWN</tt>
+     */
+    public static long getCaptureNanos(Buffer buffer)
+    {
+        return
+            ((buffer.getFlags() & Buffer.FLAG_SYSTEM_TIME) == 0)
+                ? Buffer.TIME_UNKNOWN
+                : buffer.getTimeStamp();
+    }
+
+    /**
+     * Estimates a percentile of the times of a stage in a snapshot.
+     *
+     * @param snapshot a snapshot returned by {@link #getSnapshot(boolean)}
+     * @param stage the stage
+     * @param percentile the percentile between 0 and 100
+     * @return the upper bound in microseconds of the bucket containing
+     * <tt>percentile</tt>, or 0 if no frame has been traced
+     */
+    public static long getPercentileMicros(
+            long[] snapshot,
+            Stage stage,
+            double percentile)
+    {
+        int base = stage.ordinal() * STAGE_LENGTH;
+        long count = snapshot[base + COUNT];
+
+        if (count == 0)
+            return 0;
+
+        long target = (long) Math.ceil(count * percentile / 100);
+        long seen = 0;
+
+        for (int bucket = 0; bucket < BUCKETS; bucket++)
+        {
+            seen += snapshot[base + 3 + bucket];
+            if (seen >= target)
+                return Math.min(1L << (bucket + 1), snapshot[base + MAX_MICROS]);
+        }
+        return snapshot[base + MAX_MICROS];
+    }
+
+    /**
+     * Logs the mean, 99th percentile and maximum of each stage in a specific
+     * snapshot.
+     *
+     * @param logger the <tt>Logger</tt> to log with
+     * @param name the name of the stream the snapshot is of
+     * @param snapshot a snapshot returned by {@link #getSnapshot(boolean)}
+     */
+    public static void log(Logger logger, String name, long[] snapshot)
+    {
+        StringBuilder s
+            = new StringBuilder("Audio latency of ").append(name)
+                .append(" (mean/p99/max us):");
+        boolean traced = false;
+
+        for (Stage stage : STAGES)
+        {
+            int base = stage.ordinal() * STAGE_LENGTH;
+            long count = snapshot[base + COUNT];
+
+            if (count == 0)
+                continue;
+            s.append(' ').append(stage).append('=')
+                .append(snapshot[base + SUM_MICROS] / count).append('/')
+                .append(getPercentileMicros(snapshot, stage, 99)).append('/')
+                .append(snapshot[base + MAX_MICROS]);
+            traced = true;
+        }
+        if (traced)
+            logger.info(s);
+    }
+
+    /**
+     * Adds the histograms of a snapshot to those of another.
+     *
+     * @param snapshot the snapshot to add to
+     * @param other the snapshot to add
+     */
+    public static void merge(long[] snapshot, long[] other)
+    {
+        for (Stage stage : STAGES)
+        {
+            int base = stage.ordinal() * STAGE_LENGTH;
+
+            for (int i = base; i < base + STAGE_LENGTH; i++)
+            {
+                if (i == base + MAX_MICROS)
+                    snapshot[i] = Math.max(snapshot[i], other[i]);
+                else
+                    snapshot[i] += other[i];
+            }
+        }
+    }
+
+    /**
+     * The arrival times of the packets of the stream whose decoder traces
+     * into this instance or <tt>null</tt> if they are not known.
+     */
+    private volatile ArrivalTimes arrivalTimes;
+
+    /**
+     * The histograms of the Java stages traced by this instance.
+     */
+    private final AtomicLongArray histograms = new AtomicLongArray(LENGTH);
+
+    /**
+     * Implements {@link Control#getControlComponent()}.
+     *
+     * @return <tt>null</tt> because this instance has no UI
+     */
+    @Override
+    public Component getControlComponent()
+    {
+        return null;
+    }
+
+    /**
+     * Gets the histograms of the stages traced by this instance.
+     *
+     * @param reset whether to reset the histograms after reading them
+     * @return the histograms laid out as documented for this class
+     */
+    public long[] getSnapshot(boolean reset)
+    {
+        long[] snapshot = new long[LENGTH];
+
+        for (int i = 0; i < LENGTH; i++)
+            snapshot[i] = reset ? histograms.getAndSet(i, 0) : histograms.get(i);
+        return snapshot;
+    }
+
+    /**
+     * Records the time a frame has spent in a specific Java stage.
+     *
+     * @param stage the stage
+     * @param nanos the time spent in <tt>stage</tt> in nanoseconds
+     */
+    public void record(Stage stage, long nanos)
+    {
+        long micros = Math.max(0, nanos / 1000);
+        int bucket
+            = Math.min(BUCKETS - 1, 63 - Long.numberOfLeadingZeros(micros | 1));
+        int base = stage.ordinal() * STAGE_LENGTH;
+
+        histograms.incrementAndGet(base + COUNT);
+        histograms.addAndGet(base + SUM_MICROS, micros);
+        histograms.incrementAndGet(base + 3 + bucket);
+
+        long max;
+
+        while (micros > (max = histograms.get(base + MAX_MICROS))
+                && !histograms.compareAndSet(base + MAX_MICROS, max, micros));
+    }
+
+    /**
+     * Records the time a packet has spent in the jitter buffer, i.e. since its
+     * arrival, if the arrival time of the packet is known.
+     *
+     * @param seqNo the RTP sequence number of the packet or
+     * <tt>Buffer.SEQUENCE_UNKNOWN</tt>
+     * @param decodeNanos the time in the time base of
+     * <tt>System.nanoTime()</tt> at which the decoding of the packet starts
+     */
+    public void recordJitterBuffer(long seqNo, long decodeNanos)
+    {
+        ArrivalTimes arrivalTimes = this.arrivalTimes;
+
+        if ((arrivalTimes == null) || (seqNo == Buffer.SEQUENCE_UNKNOWN))
+            return;
+
+        long arrivalNanos = arrivalTimes.get((int) seqNo);
+
+        if ((arrivalNanos != Buffer.TIME_UNKNOWN)
+                && (decodeNanos >= arrivalNanos))
+            record(Stage.JITTER_BUFFER, decodeNanos - arrivalNanos);
+    }
+
+    /**
+     * Sets the arrival times of the packets decoded by the codec which traces
+     * into this instance.
+     *
+     * @param arrivalTimes the arrival times of the packets of the stream of
+     * the codec
+     */
+    public void setArrivalTimes(ArrivalTimes arrivalTimes)
+    {
+        this.arrivalTimes = arrivalTimes;
+    }
+}
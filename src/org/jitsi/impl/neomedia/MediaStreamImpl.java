@@ -115,6 +115,14 @@ public class MediaStreamImpl
     private final Map<Byte, MediaFormat> dynamicRTPPayloadTypes
         = new HashMap<>();
 
+    /**
+     * The (dynamic) RTP payload types of {@link #dynamicRTPPayloadTypes} by
+     * encoding, built on demand and dropped when a payload type is added, so
+     * that {@link #getDynamicRTPPayloadType(String)} may be called per packet
+     * without locking.
+     */
+    private volatile Map<String, Byte> dynamicRTPPayloadTypesByEncoding;
+
     /**
      * The <tt>ReceiveStream</tt>s this instance plays back on its associated
      * <tt>MediaDevice</tt>. The (read and write) accesses to the field are to
@@ -429,6 +437,7 @@ public class MediaStreamImpl
         synchronized (dynamicRTPPayloadTypes)
         {
             dynamicRTPPayloadTypes.put(Byte.valueOf(rtpPayloadType), format);
+            dynamicRTPPayloadTypesByEncoding = null;
 
             if (rtpManager != null)
                 rtpManager.addFormat(
@@ -1003,16 +1012,27 @@ public class MediaStreamImpl
      */
     public byte getDynamicRTPPayloadType(String encoding)
     {
-        synchronized (dynamicRTPPayloadTypes)
+        Map<String, Byte> byEncoding = dynamicRTPPayloadTypesByEncoding;
+
+        if (byEncoding == null)
         {
-            for (Map.Entry<Byte, MediaFormat> entry
-                                        : dynamicRTPPayloadTypes.entrySet())
+            synchronized (dynamicRTPPayloadTypes)
             {
-                if (entry.getValue().getEncoding().equals(encoding))
-                    return entry.getKey();
+                byEncoding = new HashMap<>();
+                for (Map.Entry<Byte, MediaFormat> entry
+                                        : dynamicRTPPayloadTypes.entrySet())
+                {
+                    byEncoding.putIfAbsent(
+                            entry.getValue().getEncoding(),
+                            entry.getKey());
+                }
+                dynamicRTPPayloadTypesByEncoding = byEncoding;
             }
-            return -1;
         }
+
+        Byte rtpPayloadType = byEncoding.get(encoding);
+
+        return (rtpPayloadType == null) ? -1 : rtpPayloadType;
     }
 
     /**
@@ -2280,6 +2300,17 @@ public class MediaStreamImpl
         return sendStreams;
     }
 
+    /**
+     * Notifies this instance that an RTP packet has been received and has
+     * passed the statistics of this instance, i.e. that it is about to enter
+     * the jitter buffer. Called on the thread which receives the packets.
+     *
+     * @param pkt the received RTP packet
+     */
+    public void rtpPacketReceived(RawPacket pkt)
+    {
+    }
+
     /**
      * Gets a <tt>ReceiveStream</tt> which this instance plays back on its
      * associated <tt>MediaDevice</tt> and which has a specific synchronization
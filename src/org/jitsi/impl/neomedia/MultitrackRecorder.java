@@ -0,0 +1,289 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia;
+
+import java.io.*;
+import java.util.*;
+
+import javax.media.*;
+import javax.media.format.*;
+import javax.media.rtp.*;
+
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.util.*;
+
+/**
+ * Records the decoded audio of each participant of a call, including the
+ * local user, into its own track alongside the mixed recording of
+ * <tt>RecorderImpl</tt>. A track is a memory-mapped file which is
+ * preallocated in large extents and written sequentially by the native
+ * jnmedia library, with a time index in a second file, so that recording
+ * costs a single copy per frame and tools may seek in or map any track
+ * without parsing it. The format is described in
+ * <tt>src/native/recording/multitrack.h</tt>.
+ */
+public class MultitrackRecorder
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>MultitrackRecorder</tt> class and
+     * its instances for logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(MultitrackRecorder.class);
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which enables
+     * recording a track per participant next to the mixed recording.
+     */
+    public static final String ENABLED_PNAME
+        = "org.jitsi.impl.neomedia.MultitrackRecorder.enabled";
+
+    /**
+     * The suffix appended to the name of the mixed recording to name the
+     * directory of the tracks.
+     */
+    public static final String DIRECTORY_SUFFIX = ".tracks";
+
+    /**
+     * The type of a track of decoded linear PCM.
+     */
+    private static final int TYPE_PCM = 0;
+
+    /**
+     * Tells if the jnmedia library is correctly loaded.
+     */
+    public static final boolean isLoaded;
+
+    static
+    {
+        boolean loaded = false;
+
+        if (OSUtils.IS_LINUX)
+        {
+            try
+            {
+                NativeLibraryLoader.loadLibrary(
+                        "jnmedia",
+                        MultitrackRecorder.class);
+                loaded = true;
+            }
+            catch (NullPointerException | UnsatisfiedLinkError | SecurityException e)
+            {
+                logger.warn("Failed to load jnmedia library: ", e);
+            }
+        }
+        isLoaded = loaded;
+    }
+
+    private static native long addTrack(
+            long recorder,
+            int type,
+            String label,
+            long ssrc,
+            int rate, int channels, int format);
+
+    private static native void close(long recorder);
+
+    private static native long open(String dir);
+
+    private static native boolean write(
+            long track,
+            byte[] buf, int offset, int length);
+
+    /**
+     * Determines whether multitrack recording is available and enabled.
+     *
+     * @return <tt>true</tt> if a track per participant is to be recorded
+     */
+    public static boolean isEnabled()
+    {
+        if (!isLoaded)
+            return false;
+
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+
+        return (cfg != null) && cfg.global().getBoolean(ENABLED_PNAME, false);
+    }
+
+    /**
+     * Starts a multitrack recording into a specific directory.
+     *
+     * @param dir the directory of the tracks, which is created if needed
+     * @return the new <tt>MultitrackRecorder</tt>
+     * @throws IOException if the recording could not be started
+     */
+    public static MultitrackRecorder open(File dir)
+        throws IOException
+    {
+        if (!isLoaded)
+            throw new IOException("jnmedia is not available");
+
+        long recorder = open(dir.getPath());
+
+        if (recorder == 0)
+            throw new IOException("Failed to open " + dir);
+        return new MultitrackRecorder(recorder);
+    }
+
+    /**
+     * Whether the audio of the local user is not recorded.
+     */
+    private boolean localMuted;
+
+    /**
+     * The native <tt>MultitrackRecorder</tt>.
+     */
+    private long recorder;
+
+    /**
+     * The native tracks by the <tt>ReceiveStream</tt>s, or this instance for
+     * the local user, they record. A track which could not be added is
+     * <tt>0</tt>.
+     */
+    private final Map<Object, Long> tracks = new HashMap<Object, Long>();
+
+    private MultitrackRecorder(long recorder)
+    {
+        this.recorder = recorder;
+    }
+
+    /**
+     * Stops this recording, truncating its tracks to their lengths.
+     */
+    public synchronized void close()
+    {
+        if (recorder != 0)
+        {
+            close(recorder);
+            recorder = 0;
+            logger.info("Closed multitrack recording of " + tracks.size()
+                    + " tracks");
+            tracks.clear();
+        }
+    }
+
+    /**
+     * Adds the track of a specific source for its first buffer.
+     *
+     * @return the native track or <tt>0</tt>
+     */
+    private long addTrack(Object source, String label, long ssrc, Buffer buffer)
+    {
+        Format format = buffer.getFormat();
+        long track = 0;
+
+        if ((format instanceof AudioFormat)
+                && AudioFormat.LINEAR.equals(format.getEncoding()))
+        {
+            AudioFormat audioFormat = (AudioFormat) format;
+
+            track
+                = addTrack(
+                        recorder,
+                        TYPE_PCM,
+                        label,
+                        ssrc,
+                        (int) audioFormat.getSampleRate(),
+                        audioFormat.getChannels(),
+                        audioFormat.getSampleSizeInBits());
+        }
+        if (track == 0)
+            logger.warn("Failed to add track " + label + " in " + format);
+        else
+            logger.info("Added track " + label);
+        tracks.put(source, track);
+        return track;
+    }
+
+    /**
+     * Determines whether a specific <tt>Buffer</tt> is to be recorded.
+     */
+    private boolean isRecordable(Buffer buffer)
+    {
+        return
+            (recorder != 0)
+                && !buffer.isDiscard()
+                && (buffer.getLength() > 0)
+                && (buffer.getData() instanceof byte[]);
+    }
+
+    /**
+     * Sets whether the audio of the local user is not to be recorded.
+     *
+     * @param localMuted <tt>true</tt> to not record the audio of the local
+     * user
+     */
+    public synchronized void setLocalMuted(boolean localMuted)
+    {
+        this.localMuted = localMuted;
+    }
+
+    /**
+     * Records a <tt>Buffer</tt> into a specific track.
+     */
+    private void write(long track, Buffer buffer)
+    {
+        byte[] data = (byte[]) buffer.getData();
+        int offset = buffer.getOffset();
+        int length = buffer.getLength();
+
+        if ((track != 0)
+                && (offset >= 0)
+                && (length <= data.length - offset))
+        {
+            write(track, data, offset, length);
+        }
+    }
+
+    /**
+     * Records a <tt>Buffer</tt> of decoded audio received from a remote
+     * participant.
+     *
+     * @param receiveStream the <tt>ReceiveStream</tt> of the participant
+     * @param buffer the decoded audio
+     */
+    public synchronized void write(ReceiveStream receiveStream, Buffer buffer)
+    {
+        if (!isRecordable(buffer))
+            return;
+
+        Long track = tracks.get(receiveStream);
+
+        if (track == null)
+        {
+            long ssrc = receiveStream.getSSRC() & 0xFFFFFFFFL;
+            Participant participant = receiveStream.getParticipant();
+            String label
+                = ((participant == null) || (participant.getCNAME() == null))
+                    ? ("ssrc-" + ssrc)
+                    : participant.getCNAME();
+
+            track = addTrack(receiveStream, label, ssrc, buffer);
+        }
+        write(track, buffer);
+    }
+
+    /**
+     * Records a <tt>Buffer</tt> of audio captured from the local user unless
+     * the local user is muted.
+     *
+     * @param buffer the captured audio
+     */
+    public synchronized void writeLocal(Buffer buffer)
+    {
+        if (localMuted || !isRecordable(buffer))
+            return;
+
+        Long track = tracks.get(this);
+
+        if (track == null)
+            track = addTrack(this, "local", 0, buffer);
+        write(track, buffer);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia;
+
+import org.jitsi.util.*;
+
+/**
+ * Declares the native PCM conversion and mixing kernels of the jnpcm library
+ * which {@link ArrayIOUtils} uses for the bulk operations on large enough
+ * arrays. The kernels use SSE2 on x86 and NEON on ARM and give the same
+ * results as the Java loops, with the same byte order, saturation and
+ * rounding. The offsets and
+ * counts are not checked and must be valid.
+ */
+class NativeArrayIOUtils
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>NativeArrayIOUtils</tt> class for
+     * logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(NativeArrayIOUtils.class);
+
+    /**
+     * The smallest number of samples for which a bulk conversion is done
+     * natively. Fewer samples are faster to convert in Java than to pass
+     * through JNI.
+     */
+    static final int MIN_NATIVE_COUNT = 64;
+
+    /**
+     * Tells if the jnpcm library is correctly loaded.
+     */
+    static final boolean isLoaded;
+
+    static
+    {
+        boolean loaded = false;
+
+        try
+        {
+            NativeLibraryLoader.loadLibrary(
+                    "jnpcm",
+                    NativeArrayIOUtils.class);
+            loaded = true;
+        }
+        catch (NullPointerException | UnsatisfiedLinkError | SecurityException e)
+        {
+            logger.info(
+                    "Not using the native PCM conversions: " + e.getMessage());
+        }
+        isLoaded = loaded;
+    }
+
+    static native long int16SumOfSquares(byte[] in, int inOffset, int count);
+
+    static native void int16ToInt32(
+            byte[] in, int inOffset,
+            int[] out, int outOffset,
+            int count);
+
+    static native void int32Mix(
+            int[] in, int inOffset,
+            int[] out, int outOffset,
+            int count,
+            int maxSample);
+
+    static native void int32ToInt16(
+            int[] in, int inOffset,
+            byte[] out, int outOffset,
+            int count);
+
+    private NativeArrayIOUtils()
+    {
+    }
+}
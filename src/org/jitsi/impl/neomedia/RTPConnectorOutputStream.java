@@ -302,6 +302,46 @@ public abstract class RTPConnectorOutputStream
         }
     }
 
+    /**
+     * Paces the packets sent by this <tt>OutputDataStream</tt> at a specific
+     * rate using a native pacer, if the transport supports one.
+     *
+     * @param bitrate the pacing rate in bits per second
+     * @return <tt>true</tt> if the packets sent by this
+     * <tt>OutputDataStream</tt> are paced natively; otherwise, <tt>false</tt>
+     */
+    public boolean setPacingBitrate(long bitrate)
+    {
+        return false;
+    }
+
+    /**
+     * Keeps the packets sent by this <tt>OutputDataStream</tt> so that they
+     * can be resent on request by {@link #retransmit(byte[], int, int)}, if
+     * the transport supports it.
+     *
+     * @return <tt>true</tt> if the packets sent by this
+     * <tt>OutputDataStream</tt> are kept for retransmission; otherwise,
+     * <tt>false</tt>
+     */
+    public boolean enableRetransmissions()
+    {
+        return false;
+    }
+
+    /**
+     * Resends the packets requested by the generic NACKs in a specific
+     * received and decrypted (compound) RTCP packet. Does nothing unless
+     * {@link #enableRetransmissions()} has succeeded.
+     *
+     * @param buffer the buffer which contains the RTCP packet
+     * @param offset the offset in <tt>buffer</tt> at which the packet starts
+     * @param length the length in bytes of the packet
+     */
+    public void retransmit(byte[] buffer, int offset, int length)
+    {
+    }
+
     /**
      * Implements {@link OutputDataStream#write(byte[], int, int)}.
      *
@@ -4,12 +4,14 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia;
 
 import java.io.IOException;
 import java.net.DatagramPacket;
 import java.net.Socket;
 
+import org.jitsi.impl.neomedia.transport.NativeIoRing;
 import org.jitsi.service.libjitsi.LibJitsi;
 import org.jitsi.service.packetlogging.PacketLoggingService;
 import org.jitsi.util.Logger;
@@ -34,6 +36,12 @@ public class RTPConnectorTCPInputStream
      */
     private final Socket socket;
 
+    /**
+     * The native stream of {@link #socket} if the packets are received through
+     * the io_uring of <tt>NativeIoRing</tt>; otherwise, <tt>null</tt>.
+     */
+    private NativeIoRing.Stream ioRingStream;
+
     /**
      * Initializes a new <tt>RTPConnectorInputStream</tt> which is to receive
      * packet data from a specific TCP socket.
@@ -54,6 +62,9 @@ public class RTPConnectorTCPInputStream
             {
             }
 
+            if (NativeIoRing.isTcpEnabled())
+                ioRingStream = NativeIoRing.acquireStream(socket);
+
             closed = false;
             ThreadUtils.startThread(new Thread(this, "RTPConnectorUDPInputStreamThread"));
         }
@@ -66,6 +77,12 @@ public class RTPConnectorTCPInputStream
     public synchronized void close()
     {
         closed = true;
+
+        if (ioRingStream != null)
+        {
+            ioRingStream.release();
+            ioRingStream = null;
+        }
     }
 
     /**
@@ -116,6 +133,31 @@ public class RTPConnectorTCPInputStream
     {
         int len = -1;
         byte data[] = null;
+        NativeIoRing.Stream ioRingStream = this.ioRingStream;
+
+        if (ioRingStream != null)
+        {
+            data = p.getData();
+            try
+            {
+                /*
+                 * Throws SocketTimeoutException periodically so that the
+                 * closing of this stream is noticed.
+                 */
+                len = ioRingStream.receive(data, 0, data.length);
+            }
+            catch (IOException ioe)
+            {
+                if (closed)
+                    return false;
+                throw ioe;
+            }
+            p.setData(data);
+            p.setLength(len);
+            p.setAddress(socket.getInetAddress());
+            p.setPort(socket.getPort());
+            return true;
+        }
 
         try
         {
@@ -4,11 +4,13 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia;
 
 import java.io.*;
 import java.net.*;
 
+import org.jitsi.impl.neomedia.transport.*;
 import org.jitsi.service.libjitsi.*;
 import org.jitsi.service.packetlogging.*;
 
@@ -25,6 +27,12 @@ public class RTPConnectorTCPOutputStream
      */
     private final Socket socket;
 
+    /**
+     * The native stream of {@link #socket} if the packets are sent through the
+     * io_uring of <tt>NativeIoRing</tt>; otherwise, <tt>null</tt>.
+     */
+    private NativeIoRing.Stream ioRingStream;
+
     /**
      * Initializes a new <tt>RTPConnectorTCPOutputStream</tt>.
      *
@@ -33,6 +41,27 @@ public class RTPConnectorTCPOutputStream
     public RTPConnectorTCPOutputStream(Socket socket)
     {
         this.socket = socket;
+
+        if ((socket != null) && NativeIoRing.isTcpEnabled())
+            ioRingStream = NativeIoRing.acquireStream(socket);
+    }
+
+    /**
+     * Closes this output stream, releasing its native stream.
+     */
+    @Override
+    public void close()
+    {
+        super.close();
+
+        synchronized (this)
+        {
+            if (ioRingStream != null)
+            {
+                ioRingStream.release();
+                ioRingStream = null;
+            }
+        }
     }
 
     /**
@@ -51,6 +80,29 @@ public class RTPConnectorTCPOutputStream
     protected void sendToTarget(RawPacket packet, InetSocketAddress target)
         throws IOException
     {
+        NativeIoRing.Stream ioRingStream;
+
+        synchronized (this)
+        {
+            ioRingStream = this.ioRingStream;
+        }
+        if (ioRingStream != null)
+        {
+            /*
+             * The packet is queued without blocking. It is dropped if the
+             * queue is full, as it would be by a UDP socket.
+             */
+            if (!ioRingStream.send(
+                    packet.getBuffer(),
+                    packet.getOffset(),
+                    packet.getLength()))
+            {
+                if (socket.isClosed())
+                    throw new IOException("TCP socket closed");
+            }
+            return;
+        }
+
         socket.getOutputStream().write(
                 packet.getBuffer(),
                 packet.getOffset(),
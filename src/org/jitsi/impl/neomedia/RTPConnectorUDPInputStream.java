@@ -10,6 +10,7 @@ package org.jitsi.impl.neomedia;
 import java.io.*;
 import java.net.*;
 
+import org.jitsi.impl.neomedia.transport.*;
 import org.jitsi.util.ThreadUtils;
 import org.jitsi.service.libjitsi.*;
 import org.jitsi.service.packetlogging.*;
@@ -34,6 +35,12 @@ public class RTPConnectorUDPInputStream extends RTPConnectorInputStream
      */
     private boolean receivedSizeFlag = false;
 
+    /**
+     * The <tt>NativePacketLogger</tt> which logs the packets received through
+     * {@link #socket} if native packet logging is enabled.
+     */
+    private NativePacketLogger nativePacketLogger;
+
     /**
      * Initializes a new <tt>RTPConnectorInputStream</tt> which is to receive
      * packet data from a specific UDP socket.
@@ -77,6 +84,40 @@ public class RTPConnectorUDPInputStream extends RTPConnectorInputStream
 
         PacketLoggingService packetLogging = LibJitsi.getPacketLoggingService();
 
+        // Log natively so that the receive thread pays a single copy of the
+        // header and no allocations.
+        if (NativePacketLogger.isEnabled(packetLogging))
+        {
+            if (nativePacketLogger == null)
+            {
+                nativePacketLogger
+                    = new NativePacketLogger(
+                            socket.getLocalAddress(),
+                            socket.getLocalPort(),
+                            false);
+            }
+            nativePacketLogger.logReceived(
+                    p.getData(), p.getOffset(), p.getLength(),
+                    p.getAddress(), p.getPort());
+
+            if (packetLogging.allowedToCaptureMedia())
+            {
+                byte[] data = new byte[p.getLength()];
+                System.arraycopy(p.getData(),
+                                 p.getOffset(),
+                                 data,
+                                 0,
+                                 p.getLength());
+                packetLogging.bufferMedia(data,
+                                          System.currentTimeMillis(),
+                                          p.getAddress().getAddress(),
+                                          p.getPort(),
+                                          socket.getLocalAddress().getAddress(),
+                                          socket.getLocalPort());
+            }
+            return;
+        }
+
         //Create a RawPacket to make it easier to extract just the header
         RawPacket convertedPacket = new RawPacket(p.getData(),
                                                   p.getOffset(),
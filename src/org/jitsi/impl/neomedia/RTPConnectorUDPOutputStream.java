@@ -9,6 +9,7 @@ package org.jitsi.impl.neomedia;
 import java.io.*;
 import java.net.*;
 
+import org.jitsi.impl.neomedia.transport.*;
 import org.jitsi.service.libjitsi.*;
 import org.jitsi.service.packetlogging.*;
 
@@ -25,6 +26,25 @@ public class RTPConnectorUDPOutputStream
      */
     private final DatagramSocket socket;
 
+    /**
+     * The <tt>NativePacer</tt> which paces the packets sent through
+     * {@link #socket} or <tt>null</tt> if they are sent immediately.
+     */
+    private volatile NativePacer pacer;
+
+    /**
+     * The <tt>RetransmissionHistory</tt> which keeps the packets sent through
+     * {@link #socket} for resending on NACK or <tt>null</tt> if they are not
+     * kept.
+     */
+    private volatile RetransmissionHistory retransmissionHistory;
+
+    /**
+     * The <tt>NativePacketLogger</tt> which logs the packets sent through
+     * {@link #socket} if native packet logging is enabled.
+     */
+    private NativePacketLogger nativePacketLogger;
+
     /**
      * Initializes a new <tt>RTPConnectorUDPOutputStream</tt>.
      *
@@ -51,6 +71,20 @@ public class RTPConnectorUDPOutputStream
     protected void sendToTarget(RawPacket packet, InetSocketAddress target)
         throws IOException
     {
+        RetransmissionHistory retransmissionHistory
+            = this.retransmissionHistory;
+
+        if (retransmissionHistory != null)
+            retransmissionHistory.store(packet, target);
+
+        NativePacer pacer = this.pacer;
+
+        // A packet which the pacer queue cannot hold is dropped rather than
+        // sent ahead of those queued, so that it is recovered by NACK like any
+        // other lost packet. The pacer only declines packets once closed.
+        if ((pacer != null) && pacer.send(packet, target))
+            return;
+
         socket.send(
                 new DatagramPacket(
                         packet.getBuffer(),
@@ -60,6 +94,103 @@ public class RTPConnectorUDPOutputStream
                         target.getPort()));
     }
 
+    /**
+     * {@inheritDoc}
+     *
+     * Closes the <tt>NativePacer</tt> and the
+     * <tt>RetransmissionHistory</tt>, if any, before the socket goes away.
+     */
+    @Override
+    public void close()
+    {
+        super.close();
+
+        NativePacer pacer;
+        RetransmissionHistory retransmissionHistory;
+
+        synchronized (this)
+        {
+            pacer = this.pacer;
+            this.pacer = null;
+            retransmissionHistory = this.retransmissionHistory;
+            this.retransmissionHistory = null;
+        }
+        if (retransmissionHistory != null)
+            retransmissionHistory.close();
+        if (pacer != null)
+            pacer.close();
+    }
+
+    /**
+     * {@inheritDoc}
+     */
+    @Override
+    public synchronized boolean enableRetransmissions()
+    {
+        if (retransmissionHistory == null)
+            retransmissionHistory = RetransmissionHistory.create(socket);
+        return (retransmissionHistory != null);
+    }
+
+    /**
+     * {@inheritDoc}
+     */
+    @Override
+    public void retransmit(byte[] buffer, int offset, int length)
+    {
+        RetransmissionHistory retransmissionHistory
+            = this.retransmissionHistory;
+
+        if (retransmissionHistory != null)
+            retransmissionHistory.handleRtcp(buffer, offset, length, pacer);
+    }
+
+    /**
+     * {@inheritDoc}
+     */
+    @Override
+    public synchronized boolean setPacingBitrate(long bitrate)
+    {
+        if (pacer == null)
+            pacer = NativePacer.create(socket, bitrate);
+        else
+            pacer.setBitrate(bitrate);
+        return (pacer != null);
+    }
+
+    /**
+     * Gets the statistics of the <tt>NativePacer</tt> of this instance.
+     *
+     * @return the statistics of the <tt>NativePacer</tt> indexed by its
+     * <tt>STAT_</tt> constants or <tt>null</tt> if packets are not paced
+     * natively
+     */
+    public long[] getPacingStats()
+    {
+        NativePacer pacer = this.pacer;
+
+        return (pacer == null) ? null : pacer.getStats();
+    }
+
+    /**
+     * Gets the statistics of the <tt>RetransmissionHistory</tt> of this
+     * instance.
+     *
+     * @return the statistics of the <tt>RetransmissionHistory</tt> indexed by
+     * its <tt>STAT_</tt> constants or <tt>null</tt> if packets are not kept
+     * for retransmission
+     */
+    public long[] getRetransmissionStats()
+    {
+        RetransmissionHistory retransmissionHistory
+            = this.retransmissionHistory;
+
+        return
+            (retransmissionHistory == null)
+                ? null
+                : retransmissionHistory.getStats();
+    }
+
     /**
      * Log the packet.
      *
@@ -75,18 +206,42 @@ public class RTPConnectorUDPOutputStream
             (target != null) &&
             (packet != null))
         {
-            packetLogging.logPacket(
-                    PacketLoggingService.ProtocolName.RTP,
-                    socket.getLocalAddress().getAddress(),
-                    socket.getLocalPort(),
-                    target.getAddress().getAddress(),
-                    target.getPort(),
-                    PacketLoggingService.TransportName.UDP,
-                    true,
-                    packet.readRegion(packet.getOffset(),
-                                      packet.getHeaderLength()),
-                    packet.getOffset(),
-                    packet.getHeaderLength());
+            // Log natively so that the send path pays a single copy of the
+            // header and no allocations.
+            if (NativePacketLogger.isEnabled(packetLogging))
+            {
+                if (nativePacketLogger == null)
+                {
+                    nativePacketLogger
+                        = new NativePacketLogger(
+                                socket.getLocalAddress(),
+                                socket.getLocalPort(),
+                                false);
+                }
+                nativePacketLogger.logSent(
+                        packet.getBuffer(),
+                        packet.getOffset(),
+                        packet.getLength(),
+                        target.getAddress(),
+                        target.getPort());
+                if (!packetLogging.allowedToCaptureMedia())
+                    return;
+            }
+            else
+            {
+                packetLogging.logPacket(
+                        PacketLoggingService.ProtocolName.RTP,
+                        socket.getLocalAddress().getAddress(),
+                        socket.getLocalPort(),
+                        target.getAddress().getAddress(),
+                        target.getPort(),
+                        PacketLoggingService.TransportName.UDP,
+                        true,
+                        packet.readRegion(packet.getOffset(),
+                                          packet.getHeaderLength()),
+                        packet.getOffset(),
+                        packet.getHeaderLength());
+            }
 
             // And log to the media buffer
             byte[] data = new byte[packet.getLength()];
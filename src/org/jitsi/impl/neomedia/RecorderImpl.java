@@ -17,6 +17,7 @@ import javax.media.*;
 import javax.media.protocol.*;
 
 import org.jitsi.impl.neomedia.device.*;
+import org.jitsi.impl.neomedia.transport.*;
 import org.jitsi.service.neomedia.MediaDirection;
 import org.jitsi.service.neomedia.MediaException;
 import org.jitsi.service.neomedia.Recorder;
@@ -90,6 +91,12 @@ public class RecorderImpl
      */
     private String filename = null;
 
+    /**
+     * The <tt>MultitrackRecorder</tt> which records a track per participant
+     * next to the mixed recording, if enabled.
+     */
+    private MultitrackRecorder multitrackRecorder;
+
     /**
      * Constructs the <tt>RecorderImpl</tt> with the provided session.
      *
@@ -282,19 +289,47 @@ public class RecorderImpl
             {
                 DataSource outputDataSource
                     = deviceSession.getOutputDataSource();
-                DataSink sink
-                    = Manager.createDataSink(
-                            outputDataSource,
-                            new MediaLocator("file:" + filename));
+                MediaLocator locator = new MediaLocator("file:" + filename);
+                DataSink sink = null;
 
-                sink.open();
+                if ((outputDataSource instanceof PushDataSource)
+                        && NativeIoRing.isRecordingEnabled())
+                {
+                    /*
+                     * Write the file asynchronously through the io_uring
+                     * shared with the other recordings. The ring may fail to
+                     * be created, e.g. when RLIMIT_MEMLOCK does not allow its
+                     * buffers to be registered, in which case the file is
+                     * written by JMF as it is when the ring is disabled.
+                     */
+                    DataSink ioRingSink = new IoRingDataSink();
+
+                    ioRingSink.setSource(outputDataSource);
+                    ioRingSink.setOutputLocator(locator);
+                    try
+                    {
+                        ioRingSink.open();
+                        sink = ioRingSink;
+                    }
+                    catch (IOException ioe)
+                    {
+                        sLogger.warn(
+                                "Failed to record through io_uring, falling"
+                                    + " back to JMF: " + ioe.getMessage());
+                    }
+                }
+                if (sink == null)
+                {
+                    sink = Manager.createDataSink(outputDataSource, locator);
+                    sink.open();
+                }
                 sink.start();
 
                 this.sink = sink;
             }
-            catch (NoDataSinkException ndsex)
+            catch (NoDataSinkException | IncompatibleSourceException ex)
             {
-                exception = ndsex;
+                exception = ex;
             }
             finally
             {
@@ -309,6 +344,25 @@ public class RecorderImpl
             }
         }
 
+        if ((multitrackRecorder == null) && MultitrackRecorder.isEnabled())
+        {
+            try
+            {
+                multitrackRecorder
+                    = MultitrackRecorder.open(
+                            new File(
+                                    filename
+                                        + MultitrackRecorder.DIRECTORY_SUFFIX));
+                multitrackRecorder.setLocalMuted(mute);
+                device.setMultitrackRecorder(multitrackRecorder);
+            }
+            catch (IOException ioe)
+            {
+                // The mixed recording goes on without the tracks.
+                sLogger.error("Failed to start multitrack recording", ioe);
+            }
+        }
+
         Recorder.Listener[] listeners;
 
         synchronized (this.listeners)
@@ -345,6 +399,13 @@ public class RecorderImpl
 
         sLogger.debug("RecorderImpl " + this + " stopping");
 
+        if (multitrackRecorder != null)
+        {
+            device.setMultitrackRecorder(null);
+            multitrackRecorder.close();
+            multitrackRecorder = null;
+        }
+
         if (deviceSession != null)
         {
             deviceSession.close();
@@ -389,6 +450,9 @@ public class RecorderImpl
     {
         this.mute = mute;
 
+        if (multitrackRecorder != null)
+            multitrackRecorder.setLocalMuted(mute);
+
         if(deviceSession != null)
         {
             sLogger.info("Set mute on RecorderImpl " + this + " to " + mute);
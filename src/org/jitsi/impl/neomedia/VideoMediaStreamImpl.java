@@ -8,6 +8,7 @@
 package org.jitsi.impl.neomedia;
 
 import java.awt.*;
+import java.io.*;
 import java.util.*;
 import java.util.List;
 import java.util.regex.*;
@@ -18,6 +19,8 @@ import javax.media.format.*;
 import javax.media.protocol.*;
 
 import org.jitsi.impl.neomedia.device.*;
+import org.jitsi.impl.neomedia.transform.*;
+import org.jitsi.impl.neomedia.transport.*;
 import org.jitsi.service.neomedia.QualityControl;
 import org.jitsi.service.neomedia.QualityPreset;
 import org.jitsi.service.neomedia.SrtpControl;
@@ -403,6 +406,17 @@ public class VideoMediaStreamImpl
      */
     private final QualityControlImpl qualityControl = new QualityControlImpl();
 
+    /**
+     * The size at which the received video is displayed or <tt>null</tt> if
+     * it is unknown.
+     */
+    private Dimension remoteDisplaySize;
+
+    /**
+     * Whether the received video is of low priority.
+     */
+    private boolean remoteLowPriority;
+
     /**
      * The facility which aids this instance in managing a list of
      * <tt>VideoListener</tt>s and firing <tt>VideoEvent</tt>s to them.
@@ -488,11 +502,48 @@ public class VideoMediaStreamImpl
     {
         super.configureDataOutputStream(dataOutputStream);
 
-        int maxBandwidth
+        DeviceConfiguration deviceConfiguration
             = NeomediaServiceUtils
                 .getMediaServiceImpl()
-                    .getDeviceConfiguration()
-                        .getVideoRTPPacingThreshold();
+                    .getDeviceConfiguration();
+
+        // Resend the packets lost on the way to the remote peer as soon as it
+        // NACKs them rather than waiting for it to request a keyframe.
+        if (RetransmissionHistory.isEnabled()
+                && dataOutputStream.enableRetransmissions())
+        {
+            try
+            {
+                RTPConnectorInputStream controlInputStream
+                    = getRTPConnector().getControlInputStream();
+
+                if (controlInputStream instanceof ControlTransformInputStream)
+                {
+                    ((ControlTransformInputStream) controlInputStream)
+                        .setRetransmitter(dataOutputStream);
+                }
+            }
+            catch (IOException ioe)
+            {
+                logger.error("Failed to enable retransmissions", ioe);
+            }
+        }
+
+        // Prefer pacing at a multiple of the encoder target bitrate in native
+        // code so that keyframe bursts are spread out without a Java thread.
+        if (NativePacer.isEnabled())
+        {
+            long pacingBitrate
+                = (long)
+                    (1000L
+                        * deviceConfiguration.getVideoBitrate()
+                        * NativePacer.PACING_FACTOR);
+
+            if (dataOutputStream.setPacingBitrate(pacingBitrate))
+                return;
+        }
+
+        int maxBandwidth = deviceConfiguration.getVideoRTPPacingThreshold();
 
         // Ignore the case of maxBandwidth > 1000, because in this case
         // setMaxPacketsPerMillis fails. Effectively, this means that no
@@ -626,6 +677,9 @@ public class VideoMediaStreamImpl
                     deviceSessionVideoListener);
 
             newVideoMediaDeviceSession.setOutputSize(outputSize);
+            newVideoMediaDeviceSession.setRemoteDisplayHints(
+                    remoteDisplaySize,
+                    remoteLowPriority);
 
             AbstractRTPConnector rtpConnector = getRTPConnector();
 
@@ -1037,6 +1091,27 @@ public class VideoMediaStreamImpl
         this.outputSize = outputSize;
     }
 
+    /**
+     * {@inheritDoc}
+     */
+    @Override
+    public void setRemoteDisplayHints(
+            Dimension displaySize,
+            boolean lowPriority)
+    {
+        remoteDisplaySize = displaySize;
+        remoteLowPriority = lowPriority;
+
+        MediaDeviceSession deviceSession = getDeviceSession();
+
+        if (deviceSession instanceof VideoMediaDeviceSession)
+        {
+            ((VideoMediaDeviceSession) deviceSession).setRemoteDisplayHints(
+                    displaySize,
+                    lowPriority);
+        }
+    }
+
     /**
      * Updates the <tt>QualityControl</tt> of this <tt>VideoMediaStream</tt>.
      *
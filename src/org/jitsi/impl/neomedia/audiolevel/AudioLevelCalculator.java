@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia.audiolevel;
 
 import org.jitsi.impl.neomedia.*;
@@ -53,20 +54,22 @@ public class AudioLevelCalculator
         byte[] samples, int offset, int length,
         int minLevel, int maxLevel, int lastLevel)
     {
-        double rms = 0;
-        int sampleCount = 0;
+        int sampleCount = (length > offset) ? (length - offset) / 2 : 0;
+        double rms;
 
-        while (offset < length)
+        if (sampleCount == 0)
         {
-            double sample = ArrayIOUtils.readShort(samples, offset);
-
-            sample /= Short.MAX_VALUE;
-            rms += sample * sample;
-            sampleCount++;
+            rms = 0;
+        }
+        else
+        {
+            long sumOfSquares
+                = ArrayIOUtils.sumOfSquaresInt16(samples, offset, sampleCount);
 
-            offset += 2;
+            rms
+                = Math.sqrt(sumOfSquares / (double) sampleCount)
+                    / Short.MAX_VALUE;
         }
-        rms = (sampleCount == 0) ? 0 : Math.sqrt(rms / sampleCount);
 
         double db;
 
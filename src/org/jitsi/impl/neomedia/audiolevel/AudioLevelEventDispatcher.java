@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia.audiolevel;
 
 import javax.media.*;
@@ -11,12 +12,13 @@ import javax.media.*;
 import org.jitsi.service.neomedia.event.*;
 
 /**
- * The class implements an audio level measurement thread. The thread will
- * measure new data every time it is added through the <tt>addData()</tt> method
- * and would then deliver it to a registered listener if any. (No measurement
- * would be performed until we have a <tt>levelListener</tt>). We use a
- * separate thread so that we could compute and deliver audio levels in a way
- * that won't delay the media processing thread.
+ * The class implements audio level measurement. The level of the data last
+ * added through the <tt>addData()</tt> method is measured on the next tick of
+ * the {@link AudioLevelTicker} and is then delivered to a registered listener
+ * if any. (No measurement would be performed until we have a
+ * <tt>levelListener</tt>). The measurement runs on the thread of the ticker,
+ * which is shared by all dispatchers, so that we could compute and deliver
+ * audio levels in a way that won't delay the media processing thread.
  * <p>
  * Note that, for performance reasons this class is not 100% thread safe and you
  * should not modify add or remove audio listeners in this dispatcher in the
@@ -29,13 +31,6 @@ import org.jitsi.service.neomedia.event.*;
  */
 public class AudioLevelEventDispatcher
 {
-    /**
-     * The interval of time in milliseconds which the Thread of
-     * AudioLevelEventDispatcher is to idly wait for data to be provided for
-     * audio level calculation before it exits.
-     */
-    private static final long IDLE_TIMEOUT = 30 * 1000;
-
     /**
      * The <tt>AudioLevelMap</tt> in which the audio calculations run by this
      * <tt>AudioLevelEventDispatcher</tt> are to be cached in addition to
@@ -43,6 +38,12 @@ public class AudioLevelEventDispatcher
      */
     private AudioLevelMap cache = null;
 
+    /**
+     * The <tt>AudioLevelMap</tt> in which the level calculated on the current
+     * tick is to be cached. Accessed by the ticker thread only.
+     */
+    private AudioLevelMap cacheToFire;
+
     /**
      * The data to process.
      */
@@ -64,176 +65,165 @@ public class AudioLevelEventDispatcher
     private SimpleAudioLevelListener listener;
 
     /**
-     * The SSRC of the stream we are measuring that we should use as a key for
-     * entries of the levelMap level cache.
+     * The listener to be notified about the level calculated on the current
+     * tick. Accessed by the ticker thread only.
      */
-    private long ssrc = -1;
+    private SimpleAudioLevelListener listenerToFire;
+
+    /**
+     * The name of this dispatcher, formerly given to its own
+     * <tt>Thread</tt>.
+     */
+    private final String name;
 
     /**
-     * The <tt>Thread</tt> which runs the actual audio level calculations and
-     * dispatches to {@link #listener}.
+     * The data which has been measured on the last tick, kept to be reused
+     * by {@link #addData(Buffer)}.
      */
-    private Thread thread;
+    private byte[] spareData = null;
 
     /**
-     * The name of the <tt>Thread</tt> which is to run the actual audio level
-     * calculations and to dispatch to {@link #listener}.
+     * The SSRC of the stream we are measuring that we should use as a key for
+     * entries of the levelMap level cache.
      */
-    private final String threadName;
+    private long ssrc = -1;
 
     /**
-     * Initializes a new <tt>AudioLevelEventDispatcher</tt> instance which is to
-     * use a specific name for its <tt>Thread</tt> which is to run the actual
-     * audio level calculations and to dispatch to its
-     * <tt>SimpleAudioLevelListener</tt>
+     * The SSRC to cache the level calculated on the current tick under.
+     * Accessed by the ticker thread only.
+     */
+    private long ssrcToFire;
+
+    /**
+     * Initializes a new <tt>AudioLevelEventDispatcher</tt> instance with a
+     * specific name.
      *
-     * @param threadName
+     * @param threadName the name of the new instance
      */
     public AudioLevelEventDispatcher(String threadName)
     {
-        this.threadName = threadName;
+        this.name = threadName;
     }
 
     /**
-     * Runs the actual audio level calculations and dispatches to the
-     * {@link #listener}.
+     * Adds data to be processed.
+     *
+     * @param buffer the data that we'd like to queue for processing.
      */
-    private void run()
+    public synchronized void addData(Buffer buffer)
     {
-        long idleTimeoutStart = -1;
+        /*
+         * If no one is interested in the audio level, do not even add the
+         * Buffer data.
+         */
+        if (!isInterested())
+            return;
 
-        while (true)
-        {
-            SimpleAudioLevelListener listener;
-            AudioLevelMap cache;
-            long ssrc;
+        int length = buffer.getLength();
 
-            byte[] data;
-            int dataLength;
+        if (length > 0)
+        {
+            Object bufferData = buffer.getData();
 
-            synchronized(this)
+            if (bufferData == null)
+                return;
+            if ((data == null) || (data.length < length))
             {
-                if (!Thread.currentThread().equals(thread))
-                    break;
-
-                listener = this.listener;
-                cache = this.cache;
-                ssrc = this.ssrc;
                 /*
-                 * If no one is interested in the audio level, do not even keep
-                 * the Thread waiting.
+                 * In order to try to mitigate the issue with allocating data,
+                 * try to reuse the one which we have last calculated the audio
+                 * level of.
                  */
-                if ((listener == null) && ((cache == null) || (ssrc == -1)))
-                    break;
-
-                data = this.data;
-                dataLength = this.dataLength;
-                /*
-                 * If there is no data to calculate the audio level of, wait for
-                 * such data to be provided.
-                 */
-                if ((data == null) || (dataLength < 1))
-                {
-                    // The current thread is idle.
-                    if (idleTimeoutStart == -1)
-                        idleTimeoutStart = System.currentTimeMillis();
-                    else if ((System.currentTimeMillis() - idleTimeoutStart)
-                            >= IDLE_TIMEOUT)
-                        break;
-
-                    boolean interrupted = false;
-
-                    try
-                    {
-                        wait(IDLE_TIMEOUT);
-                    }
-                    catch (InterruptedException ie)
-                    {
-                        interrupted = true;
-                    }
-                    if (interrupted)
-                        Thread.currentThread().interrupt();
-
-                    continue;
-                }
-                // The values of data and dataLength seem valid so consume them.
-                this.data = null;
-                this.dataLength = 0;
-                // The current thread is no longer idle.
-                idleTimeoutStart = -1;
+                if ((spareData != null) && (spareData.length >= length))
+                    data = spareData;
+                else
+                    data = new byte[length];
+                spareData = null;
             }
+            System.arraycopy(bufferData, buffer.getOffset(), data, 0, length);
 
-            int newLevel
-                = AudioLevelCalculator.calculateSoundPressureLevel(
-                        data, 0, dataLength,
-                        SimpleAudioLevelListener.MIN_LEVEL,
-                        SimpleAudioLevelListener.MAX_LEVEL,
-                        lastLevel);
+            boolean schedule = (dataLength < 1);
 
-            /*
-             * In order to try to mitigate the issue with allocating data, try
-             * to return the one which we have just calculated the audio level
-             * of.
-             */
-            synchronized (this)
-            {
-                if ((this.data == null)
-                        && (this.listener == null)
-                        && ((this.cache == null) || (this.ssrc == -1)))
-                    this.data = data;
-            }
-
-            try
-            {
-                // Cache the newLevel if requested.
-                if ((cache != null) && (ssrc != -1))
-                    cache.putLevel(ssrc, newLevel);
-                // Notify the listener about the newLevel if requested.
-                if (listener != null)
-                    listener.audioLevelChanged(newLevel);
-            }
-            finally
-            {
-                lastLevel = newLevel;
-            }
+            dataLength = length;
+            if (schedule)
+                AudioLevelTicker.schedule(this);
         }
     }
 
     /**
-     * Adds data to be processed.
+     * Calculates the level of the data added since the last tick. Invoked by
+     * the {@link AudioLevelTicker} before it invokes {@link #fireLevel()}.
      *
-     * @param buffer the data that we'd like to queue for processing.
+     * @return <tt>true</tt> if there is a level to be delivered by
+     * {@link #fireLevel()}; otherwise, <tt>false</tt>
      */
-    public synchronized void addData(Buffer buffer)
+    boolean calculateLevel()
     {
-        /*
-         * If no one is interested in the audio level, do not even add the
-         * Buffer data.
-         */
-        if ((listener == null) && ((cache == null) || (ssrc == -1)))
-            return;
+        byte[] data;
+        int dataLength;
 
-        dataLength = buffer.getLength();
-        if (dataLength > 0)
+        synchronized (this)
         {
-            if((data == null) || (data.length < dataLength))
-                data = new byte[dataLength];
-
-            Object bufferData = buffer.getData();
-
-            if (bufferData != null)
+            data = this.data;
+            dataLength = this.dataLength;
+            if ((data == null) || (dataLength < 1) || !isInterested())
             {
-                System.arraycopy(
-                        bufferData, buffer.getOffset(),
-                        data, 0,
-                        dataLength);
+                this.dataLength = 0;
+                return false;
             }
+            // The values of data and dataLength seem valid so consume them.
+            this.data = null;
+            this.dataLength = 0;
+            listenerToFire = listener;
+            cacheToFire = cache;
+            ssrcToFire = ssrc;
+        }
+
+        lastLevel
+            = AudioLevelCalculator.calculateSoundPressureLevel(
+                    data, 0, dataLength,
+                    SimpleAudioLevelListener.MIN_LEVEL,
+                    SimpleAudioLevelListener.MAX_LEVEL,
+                    lastLevel);
 
-            if (thread == null)
-                startThread();
-            else
-                notify();
+        synchronized (this)
+        {
+            if (this.data == null)
+                spareData = data;
         }
+        return true;
+    }
+
+    /**
+     * Delivers the level calculated by {@link #calculateLevel()} to the
+     * listener and cache of this dispatcher.
+     */
+    void fireLevel()
+    {
+        SimpleAudioLevelListener listener = listenerToFire;
+        AudioLevelMap cache = cacheToFire;
+
+        listenerToFire = null;
+        cacheToFire = null;
+
+        // Cache the newLevel if requested.
+        if ((cache != null) && (ssrcToFire != -1))
+            cache.putLevel(ssrcToFire, lastLevel);
+        // Notify the listener about the newLevel if requested.
+        if (listener != null)
+            listener.audioLevelChanged(lastLevel);
+    }
+
+    /**
+     * Determines whether anyone is interested in the audio level measured by
+     * this dispatcher.
+     *
+     * @return <tt>true</tt> if there is a listener or a cache to deliver the
+     * audio level to
+     */
+    private boolean isInterested()
+    {
+        return (listener != null) || ((cache != null) && (ssrc != -1));
     }
 
     /**
@@ -246,11 +236,7 @@ public class AudioLevelEventDispatcher
     public synchronized void setAudioLevelListener(
             SimpleAudioLevelListener listener)
     {
-        if (this.listener != listener)
-        {
-            this.listener = listener;
-            startOrNotifyThread();
-        }
+        this.listener = listener;
     }
 
     /**
@@ -264,77 +250,16 @@ public class AudioLevelEventDispatcher
      */
     public synchronized void setAudioLevelCache(AudioLevelMap cache, long ssrc)
     {
-        if ((this.cache != cache) || (this.ssrc != ssrc))
-        {
-            this.cache = cache;
-            this.ssrc = ssrc;
-            startOrNotifyThread();
-        }
+        this.cache = cache;
+        this.ssrc = ssrc;
     }
 
     /**
-     * Starts the <tt>Thread</tt> which is to run the audio level calculations
-     * and to dispatch to {@link #listener} if necessary or notifies it about a
-     * change it the state on which it depends.
+     * {@inheritDoc}
      */
-    private synchronized void startOrNotifyThread()
+    @Override
+    public String toString()
     {
-        if ((this.listener == null) && ((cache == null) || (ssrc == -1)))
-        {
-            thread = null;
-            notify();
-        }
-        else if ((data != null) && (dataLength > 0))
-        {
-            if (thread == null)
-                startThread();
-            else
-                notify();
-        }
-    }
-
-    /**
-     * Starts the <tt>Thread</tt> which is to run the audio level calculations
-     * and to dispatch to {@link #listener}.
-     */
-    private synchronized void startThread()
-    {
-        thread
-            = new Thread("AudioLevelEventDispatcherThread")
-            {
-                @Override
-                public void run()
-                {
-                    try
-                    {
-                        AudioLevelEventDispatcher.this.run();
-                    }
-                    finally
-                    {
-                        synchronized (AudioLevelEventDispatcher.this)
-                        {
-                            if (Thread.currentThread().equals(thread))
-                                thread = null;
-                            /*
-                             * If the thread of this AudioLevelEventDispatcher
-                             * is dying yet the state suggests that it should be
-                             * running, restart it.
-                             */
-                            if ((thread == null)
-                                    && ((listener != null)
-                                            || ((cache != null)
-                                                    && (ssrc != -1)))
-                                    && (data != null)
-                                    && (dataLength > 0))
-                                startThread();
-                        }
-                    }
-                }
-            };
-        thread.setDaemon(true);
-        if (threadName != null)
-            thread.setName(threadName);
-
-        thread.start();
+        return (name == null) ? super.toString() : name;
     }
 }
@@ -0,0 +1,241 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.audiolevel;
+
+import java.util.*;
+
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.util.*;
+
+/**
+ * Runs the audio level calculations of all <tt>AudioLevelEventDispatcher</tt>s
+ * on a single daemon thread. Every tick, the levels of all the dispatchers
+ * which have been given data since the previous tick are calculated first and
+ * then delivered to their listeners in one pass, rather than each dispatcher
+ * keeping a thread of its own which wakes up for every buffer.
+ * <p>
+ * The thread exits after it has been idle for a while and is started again
+ * when data arrives.
+ * </p>
+ */
+final class AudioLevelTicker
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>AudioLevelTicker</tt> class for
+     * logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(AudioLevelTicker.class);
+
+    /**
+     * The name of the property which specifies the interval in milliseconds
+     * at which audio levels are calculated and delivered.
+     */
+    public static final String PERIOD_MILLIS_PNAME
+        = "org.jitsi.impl.neomedia.audiolevel.AudioLevelTicker.periodMillis";
+
+    /**
+     * The default of {@link #PERIOD_MILLIS_PNAME}, the duration of an audio
+     * packet.
+     */
+    private static final long DEFAULT_PERIOD_MILLIS = 20;
+
+    /**
+     * The interval of time in milliseconds for which the thread idly ticks
+     * without any data before it exits.
+     */
+    private static final long IDLE_TIMEOUT = 30 * 1000;
+
+    /**
+     * The dispatchers which have been given data since the last tick.
+     */
+    private static Set<AudioLevelEventDispatcher> pending
+        = new LinkedHashSet<>();
+
+    /**
+     * The dispatchers of the tick being run, swapped with {@link #pending} so
+     * that neither is allocated per tick.
+     */
+    private static Set<AudioLevelEventDispatcher> ticking
+        = new LinkedHashSet<>();
+
+    /**
+     * The <tt>System.nanoTime()</tt> of the last tick which had any data or
+     * at which the timer was started.
+     */
+    private static long lastActiveNanos;
+
+    /**
+     * The <tt>Timer</tt> which ticks or <tt>null</tt> if it is not running.
+     */
+    private static Timer timer;
+
+    /**
+     * Schedules a dispatcher which has been given data to have its level
+     * calculated and delivered on the next tick.
+     *
+     * @param dispatcher the dispatcher to schedule
+     */
+    static void schedule(AudioLevelEventDispatcher dispatcher)
+    {
+        synchronized (AudioLevelTicker.class)
+        {
+            pending.add(dispatcher);
+            if (timer == null)
+            {
+                long periodMillis = getPeriodMillis();
+
+                lastActiveNanos = System.nanoTime();
+                timer = new Timer("AudioLevelTicker", true);
+                timer.scheduleAtFixedRate(
+                        new TimerTask()
+                        {
+                            @Override
+                            public void run()
+                            {
+                                try
+                                {
+                                    tick(this);
+                                }
+                                catch (Throwable t)
+                                {
+                                    tickFailed(this, t);
+                                    if (t instanceof ThreadDeath)
+                                        throw (ThreadDeath) t;
+                                }
+                            }
+                        },
+                        periodMillis,
+                        periodMillis);
+            }
+        }
+    }
+
+    /**
+     * Gets the interval in milliseconds at which audio levels are calculated
+     * and delivered.
+     *
+     * @return the interval in milliseconds at which audio levels are
+     * calculated and delivered
+     */
+    private static long getPeriodMillis()
+    {
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+        long periodMillis
+            = (cfg == null)
+                ? DEFAULT_PERIOD_MILLIS
+                : cfg.global().getLong(
+                        PERIOD_MILLIS_PNAME,
+                        DEFAULT_PERIOD_MILLIS);
+
+        return (periodMillis > 0) ? periodMillis : DEFAULT_PERIOD_MILLIS;
+    }
+
+    /**
+     * Calculates the levels of the dispatchers which have been given data
+     * since the last tick and then delivers them.
+     *
+     * @param task the <tt>TimerTask</tt> which ticks, to be cancelled once
+     * idle
+     */
+    private static void tick(TimerTask task)
+    {
+        Set<AudioLevelEventDispatcher> toTick;
+
+        synchronized (AudioLevelTicker.class)
+        {
+            if (pending.isEmpty())
+            {
+                if (System.nanoTime() - lastActiveNanos
+                        >= IDLE_TIMEOUT * 1000000L)
+                {
+                    task.cancel();
+                    timer.cancel();
+                    timer = null;
+                }
+                return;
+            }
+
+            toTick = pending;
+            pending = ticking;
+            ticking = toTick;
+            lastActiveNanos = System.nanoTime();
+        }
+
+        /*
+         * Calculate all the levels first so that the listeners are notified
+         * about the same tick together.
+         */
+        try
+        {
+            for (Iterator<AudioLevelEventDispatcher> i = toTick.iterator();
+                    i.hasNext();)
+            {
+                boolean calculated;
+
+                try
+                {
+                    calculated = i.next().calculateLevel();
+                }
+                catch (RuntimeException re)
+                {
+                    logger.warn("Failed to calculate audio level", re);
+                    calculated = false;
+                }
+                if (!calculated)
+                    i.remove();
+            }
+            for (AudioLevelEventDispatcher dispatcher : toTick)
+            {
+                try
+                {
+                    dispatcher.fireLevel();
+                }
+                catch (RuntimeException re)
+                {
+                    logger.warn("Failed to deliver audio level", re);
+                }
+            }
+        }
+        finally
+        {
+            toTick.clear();
+        }
+    }
+
+    /**
+     * Stops a <tt>Timer</tt> whose thread has died of an unexpected
+     * <tt>Throwable</tt> so that the next data starts another one rather than
+     * being scheduled on a dead <tt>Timer</tt>.
+     *
+     * @param task the <tt>TimerTask</tt> which ticked
+     * @param t the <tt>Throwable</tt> which killed the thread of the
+     * <tt>Timer</tt>
+     */
+    private static void tickFailed(TimerTask task, Throwable t)
+    {
+        logger.error("Audio level ticker failed", t);
+        synchronized (AudioLevelTicker.class)
+        {
+            task.cancel();
+            if (timer != null)
+            {
+                timer.cancel();
+                timer = null;
+            }
+        }
+    }
+
+    /**
+     * Prevents the initialization of <tt>AudioLevelTicker</tt> instances.
+     */
+    private AudioLevelTicker()
+    {
+    }
+}
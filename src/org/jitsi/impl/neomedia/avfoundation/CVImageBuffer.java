@@ -6,6 +6,8 @@
  */
 package org.jitsi.impl.neomedia.avfoundation;
 
+import org.jitsi.util.*;
+
 /**
  * Represents a CoreVideo <tt>CVImageBufferRef</tt>.
  *
@@ -15,7 +17,7 @@ public class CVImageBuffer
 {
     static
     {
-        System.loadLibrary("jnavfoundation");
+        NativeLibraryLoader.loadLibrary("jnavfoundation", CVImageBuffer.class);
     }
 
     /**
@@ -6,6 +6,8 @@
  */
 package org.jitsi.impl.neomedia.avfoundation;
 
+import org.jitsi.util.*;
+
 /**
  * @author Lyubomir Marinov
  */
@@ -19,7 +21,7 @@ public final class CVPixelBufferAttributeKey
 
     static
     {
-        System.loadLibrary("jnavfoundation");
+        NativeLibraryLoader.loadLibrary("jnavfoundation", CVPixelBufferAttributeKey.class);
 
         kCVPixelBufferHeightKey = kCVPixelBufferHeightKey();
         kCVPixelBufferPixelFormatTypeKey = kCVPixelBufferPixelFormatTypeKey();
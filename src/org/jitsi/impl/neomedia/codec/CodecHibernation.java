@@ -0,0 +1,185 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.codec;
+
+import java.util.*;
+
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.util.*;
+
+/**
+ * Releases the native states of codecs and resamplers which have been idle,
+ * i.e. have received no packets or only silence, for a configurable time.
+ * In large conferences most participants stay muted, and the states of their
+ * decoders, encoders and resamplers are tens of kilobytes each. A hibernated
+ * codec keeps only the few fields it needs to recreate its state, which it
+ * does, reset, on the first packet or frame of speech.
+ * <p>
+ * Codecs register themselves when they are opened. A single daemon thread
+ * checks them and codecs are held weakly so that they are not leaked if they
+ * are not closed.
+ * </p>
+ */
+public class CodecHibernation
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>CodecHibernation</tt> class for
+     * logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(CodecHibernation.class);
+
+    /**
+     * The name of the property which specifies the time in milliseconds after
+     * which an idle codec hibernates. Zero or less disables hibernation.
+     */
+    public static final String IDLE_MILLIS_PNAME
+        = "org.jitsi.impl.neomedia.codec.CodecHibernation.idleMillis";
+
+    /**
+     * The default of {@link #IDLE_MILLIS_PNAME}.
+     */
+    private static final long DEFAULT_IDLE_MILLIS = 20000;
+
+    /**
+     * A codec whose state may be released while it is idle.
+     */
+    public interface Hibernatable
+    {
+        /**
+         * Releases the state of this codec if it has been idle since a
+         * specific time. Called by the hibernation thread, hence the codec
+         * must synchronize with its processing.
+         *
+         * @param idleSinceNanos the <tt>System.nanoTime()</tt> before which
+         * the codec must have last been active to hibernate
+         */
+        void hibernateIfIdle(long idleSinceNanos);
+    }
+
+    /**
+     * The registered codecs.
+     */
+    private static final Set<Hibernatable> codecs
+        = Collections.newSetFromMap(new WeakHashMap<Hibernatable, Boolean>());
+
+    /**
+     * The time in nanoseconds after which an idle codec hibernates or
+     * <tt>-1</tt> if it has not been read from the configuration yet.
+     */
+    private static long idleNanos = -1;
+
+    /**
+     * The <tt>Timer</tt> which checks the registered codecs.
+     */
+    private static Timer timer;
+
+    /**
+     * Checks the registered codecs and hibernates the idle ones.
+     */
+    private static void check()
+    {
+        Hibernatable[] toCheck;
+
+        synchronized (codecs)
+        {
+            toCheck = codecs.toArray(new Hibernatable[codecs.size()]);
+        }
+
+        long idleSinceNanos = System.nanoTime() - idleNanos;
+
+        for (Hibernatable codec : toCheck)
+        {
+            try
+            {
+                codec.hibernateIfIdle(idleSinceNanos);
+            }
+            catch (RuntimeException re)
+            {
+                logger.warn("Failed to hibernate " + codec, re);
+            }
+        }
+    }
+
+    /**
+     * Gets the time in nanoseconds after which an idle codec hibernates.
+     *
+     * @return the time in nanoseconds after which an idle codec hibernates or
+     * zero if hibernation is disabled
+     */
+    private static long getIdleNanos()
+    {
+        if (idleNanos < 0)
+        {
+            ConfigurationService cfg = LibJitsi.getConfigurationService();
+            long idleMillis
+                = (cfg == null)
+                    ? DEFAULT_IDLE_MILLIS
+                    : cfg.global().getLong(
+                            IDLE_MILLIS_PNAME,
+                            DEFAULT_IDLE_MILLIS);
+
+            idleNanos = (idleMillis > 0) ? idleMillis * 1000000L : 0;
+        }
+        return idleNanos;
+    }
+
+    /**
+     * Registers a codec to hibernate while it is idle. Does nothing if
+     * hibernation is disabled.
+     *
+     * @param codec the codec to register
+     */
+    public static void register(Hibernatable codec)
+    {
+        synchronized (codecs)
+        {
+            long idleNanos = getIdleNanos();
+
+            if (idleNanos == 0)
+                return;
+
+            codecs.add(codec);
+            if (timer == null)
+            {
+                long periodMillis = Math.max(1000, idleNanos / 4000000L);
+
+                timer = new Timer("Codec hibernation", true);
+                timer.schedule(
+                        new TimerTask()
+                        {
+                            @Override
+                            public void run()
+                            {
+                                check();
+                            }
+                        },
+                        periodMillis,
+                        periodMillis);
+            }
+        }
+    }
+
+    /**
+     * Unregisters a codec, such as when it is closed.
+     *
+     * @param codec the codec to unregister
+     */
+    public static void unregister(Hibernatable codec)
+    {
+        synchronized (codecs)
+        {
+            codecs.remove(codec);
+        }
+    }
+
+    private CodecHibernation()
+    {
+    }
+}
@@ -8,12 +8,14 @@
 package org.jitsi.impl.neomedia.codec.audio.opus;
 
 import java.awt.*;
+import java.util.*;
 
 import javax.media.*;
 import javax.media.format.*;
 
 import net.sf.fmj.media.*;
 
+import org.jitsi.impl.neomedia.LatencyTracer;
 import org.jitsi.impl.neomedia.codec.*;
 import org.jitsi.service.neomedia.codec.*;
 import org.jitsi.service.neomedia.control.*;
@@ -27,7 +29,8 @@ import org.jitsi.util.*;
  */
 public class JNIDecoder
     extends AbstractCodec2
-    implements FECDecoderControl
+    implements FECDecoderControl,
+               CodecHibernation.Hibernatable
 {
     /**
      * The <tt>Logger</tt> used by this <tt>JNIDecoder</tt> instance
@@ -72,6 +75,12 @@ public class JNIDecoder
         Opus.assertOpusIsFunctional();
     }
 
+    /**
+     * The length in bytes up to which a packet carries no speech, such as the
+     * packets sent by an encoder in discontinuous transmission.
+     */
+    private static final int MAX_SILENCE_PACKET_LENGTH = 2;
+
     /**
      * Number of channels to decode into.
      */
@@ -82,6 +91,17 @@ public class JNIDecoder
      */
     private long decoder = 0;
 
+    /**
+     * The <tt>System.nanoTime()</tt> at which the last packet of speech was
+     * decoded.
+     */
+    private long lastActiveNanos;
+
+    /**
+     * The <tt>LatencyTracer</tt> of the packets decoded by this instance.
+     */
+    private final LatencyTracer latencyTracer = new LatencyTracer();
+
     /**
      * The size in samples per channel of the last decoded frame in the terms of
      * the Opus library.
@@ -121,15 +141,17 @@ public class JNIDecoder
         inputFormats = SUPPORTED_INPUT_FORMATS;
 
         addControl(this);
+        addControl(latencyTracer);
     }
 
     /**
      * @see AbstractCodec2#doClose()
      */
     @Override
-    protected void doClose()
+    protected synchronized void doClose()
     {
         Log.logMediaStackObjectStopped(this);
+        CodecHibernation.unregister(this);
         if (decoder != 0)
         {
             Opus.decoder_destroy(decoder);
@@ -149,7 +171,7 @@ public class JNIDecoder
      * @see AbstractCodec2#doOpen()
      */
     @Override
-    protected void doOpen()
+    protected synchronized void doOpen()
         throws ResourceUnavailableException
     {
         Log.logMediaStackObjectStarted(this);
@@ -161,6 +183,8 @@ public class JNIDecoder
 
             lastFrameSizeInSamplesPerChannel = 0;
             lastSeqNo = Buffer.SEQUENCE_UNKNOWN;
+            lastActiveNanos = System.nanoTime();
+            CodecHibernation.register(this);
         }
     }
 
@@ -174,7 +198,7 @@ public class JNIDecoder
      * @see AbstractCodec2#doProcess(Buffer, Buffer)
      */
     @Override
-    protected int doProcess(Buffer inBuffer, Buffer outBuffer)
+    protected synchronized int doProcess(Buffer inBuffer, Buffer outBuffer)
     {
         Format inFormat = inBuffer.getFormat();
 
@@ -186,6 +210,17 @@ public class JNIDecoder
             return BUFFER_PROCESSED_FAILED;
         }
 
+        if (inBuffer.getLength() > MAX_SILENCE_PACKET_LENGTH)
+        {
+            lastActiveNanos = System.nanoTime();
+            if ((decoder == 0) && !wakeUp())
+                return BUFFER_PROCESSED_FAILED;
+        }
+        else if (decoder == 0)
+        {
+            return processHibernated(inBuffer, outBuffer);
+        }
+
         long seqNo = inBuffer.getSequenceNumber();
         int lostSeqNoCount = calculateLostSeqNoCount(lastSeqNo, seqNo);
         /*
@@ -212,6 +247,7 @@ public class JNIDecoder
         int outOffset = 0;
         int outLength = 0;
         int totalFrameSizeInSamplesPerChannel = 0;
+        long decodeStartNanos = System.nanoTime();
         Log.logReceivedBytes(this, inLength);
 
         if (decodeFEC)
@@ -255,6 +291,8 @@ public class JNIDecoder
         }
         else
         {
+            latencyTracer.recordJitterBuffer(seqNo, decodeStartNanos);
+
             int frameSizeInSamplesPerChannel
                 = Opus.decoder_get_nb_samples(decoder, in, inOffset, inLength);
             byte[] out
@@ -294,6 +332,10 @@ public class JNIDecoder
             lastSeqNo = seqNo;
         }
 
+        latencyTracer.record(
+                LatencyTracer.Stage.DECODE,
+                System.nanoTime() - decodeStartNanos);
+
         if (outLength > 0)
         {
             outBuffer.setDuration(
@@ -341,26 +383,100 @@ public class JNIDecoder
 
     /**
      * {@inheritDoc}
+     *
+     * Offers the sample rate of the input first and then the other rates at
+     * which Opus decodes natively, so that the graph which FMJ builds from
+     * this decoder to an <tt>AudioMixer</tt> running at one of them, whose
+     * <tt>TranscodingDataSource</tt> asks for its rate, needs no resampler.
      */
     @Override
     protected Format[] getMatchingOutputFormats(Format inputFormat)
     {
         AudioFormat inputAudioFormat = (AudioFormat) inputFormat;
+        double inputSampleRate = inputAudioFormat.getSampleRate();
+
+        if (!OpusSampleRates.isSupported(inputSampleRate))
+            inputSampleRate = OpusSampleRates.DEFAULT_SAMPLE_RATE;
+
+        int[] sampleRates = OpusSampleRates.getSampleRates();
+        Format[] outputFormats = new Format[sampleRates.length];
+        int i = 0;
+
+        outputFormats[i++] = createOutputFormat(inputSampleRate);
+        for (int sampleRate : sampleRates)
+        {
+            if (sampleRate != inputSampleRate)
+                outputFormats[i++] = createOutputFormat(sampleRate);
+        }
+        return outputFormats;
+    }
 
+    /**
+     * Creates an output format of this decoder at a specific sample rate.
+     *
+     * @param sampleRate the sample rate of the output format
+     * @return the new output format
+     */
+    private static AudioFormat createOutputFormat(double sampleRate)
+    {
         return
-            new Format[]
-                    {
-                        new AudioFormat(
-                                AudioFormat.LINEAR,
-                                inputAudioFormat.getSampleRate(),
-                                16,
-                                1,
-                                AudioFormat.LITTLE_ENDIAN,
-                                AudioFormat.SIGNED,
-                                /* frameSizeInBits */ Format.NOT_SPECIFIED,
-                                /* frameRate */ Format.NOT_SPECIFIED,
-                                Format.byteArray)
-                    };
+            new AudioFormat(
+                    AudioFormat.LINEAR,
+                    sampleRate,
+                    16,
+                    1,
+                    AudioFormat.LITTLE_ENDIAN,
+                    AudioFormat.SIGNED,
+                    /* frameSizeInBits */ Format.NOT_SPECIFIED,
+                    /* frameRate */ Format.NOT_SPECIFIED,
+                    Format.byteArray);
+    }
+
+    /**
+     * Destroys the native decoder if no speech has been decoded since a
+     * specific time. Packets carrying no speech are then decoded to silence
+     * without it, and it is recreated on the first packet of speech.
+     */
+    @Override
+    public synchronized void hibernateIfIdle(long idleSinceNanos)
+    {
+        if ((decoder != 0) && (lastActiveNanos - idleSinceNanos < 0))
+        {
+            Opus.decoder_destroy(decoder);
+            decoder = 0;
+            if (logger.isDebugEnabled())
+                logger.debug("Hibernated idle Opus decoder " + hashCode());
+        }
+    }
+
+    /**
+     * Outputs silence for a packet carrying no speech, or lost, while the
+     * native decoder is hibernated.
+     *
+     * @param inBuffer input <tt>Buffer</tt>
+     * @param outBuffer output <tt>Buffer</tt>
+     * @return <tt>BUFFER_PROCESSED_OK</tt>
+     */
+    private int processHibernated(Buffer inBuffer, Buffer outBuffer)
+    {
+        int frameSizeInSamplesPerChannel
+            = (lastFrameSizeInSamplesPerChannel == 0)
+                ? (outputSampleRate / 50)
+                : lastFrameSizeInSamplesPerChannel;
+        int outLength = frameSizeInSamplesPerChannel * outputFrameSize;
+        byte[] out = validateByteArraySize(outBuffer, outLength, false);
+
+        Arrays.fill(out, 0, outLength, (byte) 0);
+        outBuffer.setDuration(
+                frameSizeInSamplesPerChannel * channels * 1000L * 1000L
+                    / outputSampleRate);
+        outBuffer.setFlags(
+                outBuffer.getFlags() & ~(BUFFER_FLAG_FEC | BUFFER_FLAG_PLC));
+        outBuffer.setFormat(getOutputFormat());
+        outBuffer.setLength(outLength);
+        outBuffer.setOffset(0);
+        lastSeqNo = inBuffer.getSequenceNumber();
+        return BUFFER_PROCESSED_OK;
     }
 
     /**
@@ -378,7 +494,7 @@ public class JNIDecoder
         {
             if (outputFormat == null)
             {
-                setOutputFormat(SUPPORTED_OUTPUT_FORMATS[0]);
+                setOutputFormat(getMatchingOutputFormats(inFormat)[0]);
             }
         }
         return inFormat;
@@ -401,4 +517,26 @@ public class JNIDecoder
         }
         return setOutputFormat;
     }
+
+    /**
+     * Recreates the native decoder of this hibernated instance. Its state is
+     * reset, which goes unnoticed after the silence it hibernated during.
+     *
+     * @return <tt>true</tt> if the decoder was recreated
+     */
+    private boolean wakeUp()
+    {
+        decoder = Opus.decoder_create(outputSampleRate, channels);
+        if (decoder == 0)
+        {
+            logger.error("Failed to recreate hibernated Opus decoder");
+            return false;
+        }
+
+        // Do not conceal the packets lost during the hibernation.
+        lastSeqNo = Buffer.SEQUENCE_UNKNOWN;
+        if (logger.isDebugEnabled())
+            logger.debug("Woke up hibernated Opus decoder " + hashCode());
+        return true;
+    }
 }
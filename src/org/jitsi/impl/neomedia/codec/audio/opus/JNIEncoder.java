@@ -13,6 +13,7 @@ import java.util.*;
 import javax.media.*;
 import javax.media.format.*;
 
+import org.jitsi.impl.neomedia.LatencyTracer;
 import org.jitsi.impl.neomedia.codec.*;
 import org.jitsi.service.configuration.*;
 import org.jitsi.service.libjitsi.*;
@@ -31,7 +32,9 @@ import net.sf.fmj.media.*;
 public class JNIEncoder
     extends AbstractCodec2
     implements FormatParametersAwareCodec,
-               PacketLossAwareEncoder
+               AdvancedAttributesAwareCodec,
+               PacketLossAwareEncoder,
+               CodecHibernation.Hibernatable
 {
     /**
      * The <tt>Logger</tt> used by this <tt>JNIEncoder</tt> instance
@@ -39,6 +42,13 @@ public class JNIEncoder
      */
     private static final Logger logger = Logger.getLogger(JNIEncoder.class);
 
+    /**
+     * The durations in microseconds of the frames which Opus encodes, in
+     * ascending order.
+     */
+    private static final int[] FRAME_SIZES_IN_MICROS
+        = new int[] { 2500, 5000, 10000, 20000, 40000, 60000 };
+
     /**
      * The list of <tt>Format</tt>s of audio data supported as input by
      * <tt>JNIEncoder</tt> instances.
@@ -50,7 +60,9 @@ public class JNIEncoder
      * <tt>JNIEncoder</tt> instances.
      * <p>
      * The implementation does support 8, 12, 16, 24 and 48kHz but the lower
-     * sample rates are not listed to prevent FMJ from defaulting to them.
+     * sample rates are not listed to prevent FMJ from resampling to them. An
+     * instance created for one of the lower ones lists it ahead of them, see
+     * {@link #JNIEncoder(int)}.
      * </p>
      */
     static final double[] SUPPORTED_INPUT_SAMPLE_RATES
@@ -133,6 +145,24 @@ public class JNIEncoder
      */
     private int bandwidthConfig;
 
+    /**
+     * The pointer to the native accumulator of the frames which are input to
+     * {@link #encoder} in pieces.
+     */
+    private long accumulator = 0;
+
+    /**
+     * The number of bytes which {@link #accumulator} holds, kept in step with
+     * the native side in order to know how much of an input <tt>Buffer</tt>
+     * each call to {@link Opus#encode_accumulated} consumes.
+     */
+    private int accumulatedLength = 0;
+
+    /**
+     * Application setting, obtained from configuration.
+     */
+    private int applicationConfig = Opus.APPLICATION_VOIP;
+
     /**
      * The bitrate in bits per second obtained from the configuration and set on
      * {@link #encoder}.
@@ -154,45 +184,80 @@ public class JNIEncoder
      */
     private long encoder = 0;
 
+    /**
+     * The expected packet loss percentage last reported to this instance.
+     */
+    private int expectedPacketLoss = 0;
+
+    /**
+     * The <tt>maxaveragebitrate</tt> format parameter.
+     */
+    private int fmtpMaxAverageBitrate = Integer.MAX_VALUE;
+
+    /**
+     * The <tt>usedtx</tt> format parameter.
+     */
+    private boolean fmtpUseDtx = true;
+
+    /**
+     * The <tt>useinbandfec</tt> format parameter.
+     */
+    private boolean fmtpUseFec = true;
+
     /**
      * The size in bytes of an audio frame input by this instance. Automatically
-     * calculated, based on {@link #frameSizeInMillis} and the
+     * calculated, based on {@link #frameSizeInMicros} and the
      * <tt>inputFormat</tt> of this instance.
      */
     private int frameSizeInBytes;
 
     /**
-     * The size/duration in milliseconds of an audio frame output by this
-     * instance. The possible values are: 2.5, 5, 10, 20, 40 and 60. The default
-     * value is 20.
+     * The size/duration in microseconds of an audio frame output by this
+     * instance, the longest of {@link #FRAME_SIZES_IN_MICROS} which is within
+     * both the configuration and the <tt>ptime</tt>/<tt>maxptime</tt> of the
+     * remote peer. The default value is 20 milliseconds.
+     */
+    private int frameSizeInMicros = 20000;
+
+    /**
+     * Frame size/duration in microseconds, obtained from configuration.
      */
-    private final int frameSizeInMillis = 20;
+    private int frameSizeInMicrosConfig = 20000;
 
     /**
      * The size in samples per channel of an audio frame input by this instance.
-     * Automatically calculated, based on {@link #frameSizeInMillis} and the
+     * Automatically calculated, based on {@link #frameSizeInMicros} and the
      * <tt>inputFormat</tt> of this instance.
      */
     private int frameSizeInSamplesPerChannel;
 
     /**
-     * The minimum expected packet loss percentage to set to the encoder.
+     * The capture time carried by the <tt>Buffer</tt> which has started the
+     * frame being accumulated or <tt>Buffer.TIME_UNKNOWN</tt>.
      */
-    private int minPacketLoss = 0;
+    private long frameCaptureNanos = Buffer.TIME_UNKNOWN;
 
     /**
-     * The bytes from an input <tt>Buffer</tt> from a previous call to
-     * {@link #process(Buffer, Buffer)} that this <tt>Codec</tt> didn't process
-     * because the total number of bytes was less than {@link #inputFrameSize()}
-     * need to be prepended to a subsequent input <tt>Buffer</tt> in order to
-     * process a total of {@link #inputFrameSize()} bytes.
+     * The <tt>System.nanoTime()</tt> at which the last frame which was not
+     * digital silence was encoded.
      */
-    private byte[] prevIn = null;
+    private long lastActiveNanos;
 
     /**
-     * The length of the audio data in {@link #prevIn}.
+     * The <tt>LatencyTracer</tt> of the frames encoded by this instance.
      */
-    private int prevInLength = 0;
+    private final LatencyTracer latencyTracer = new LatencyTracer();
+
+    /**
+     * The minimum expected packet loss percentage to set to the encoder.
+     */
+    private int minPacketLoss = 0;
+
+    /**
+     * The longest frame size/duration in microseconds allowed by the
+     * <tt>ptime</tt> and <tt>maxptime</tt> attributes of the remote peer.
+     */
+    private int sdpFrameSizeInMicros = Integer.MAX_VALUE;
 
     /**
      * Whether to use DTX, obtained from configuration.
@@ -208,12 +273,49 @@ public class JNIEncoder
      * Initializes a new <tt>JNIEncoder</tt> instance.
      */
     public JNIEncoder()
+    {
+        this(OpusSampleRates.DEFAULT_SAMPLE_RATE);
+    }
+
+    /**
+     * Initializes a new <tt>JNIEncoder</tt> instance which takes its input at
+     * a specific sample rate, so that a graph whose audio is at that rate
+     * needs no resampler before the encoder.
+     *
+     * @param inputSampleRate the sample rate of the input, one at which Opus
+     * encodes natively
+     */
+    public JNIEncoder(int inputSampleRate)
     {
         super("Opus JNI Encoder", AudioFormat.class, SUPPORTED_OUTPUT_FORMATS);
 
-        inputFormats = SUPPORTED_INPUT_FORMATS;
+        if ((inputSampleRate == OpusSampleRates.DEFAULT_SAMPLE_RATE)
+                || !OpusSampleRates.isSupported(inputSampleRate))
+        {
+            inputFormats = SUPPORTED_INPUT_FORMATS;
+        }
+        else
+        {
+            inputFormats = new Format[SUPPORTED_INPUT_FORMATS.length + 1];
+            inputFormats[0]
+                = new AudioFormat(
+                        AudioFormat.LINEAR,
+                        inputSampleRate,
+                        16,
+                        1,
+                        AudioFormat.LITTLE_ENDIAN,
+                        AudioFormat.SIGNED,
+                        /* frameSizeInBits */ Format.NOT_SPECIFIED,
+                        /* frameRate */ Format.NOT_SPECIFIED,
+                        Format.byteArray);
+            System.arraycopy(
+                    SUPPORTED_INPUT_FORMATS, 0,
+                    inputFormats, 1,
+                    SUPPORTED_INPUT_FORMATS.length);
+        }
 
         addControl(this);
+        addControl(latencyTracer);
     }
 
     /**
@@ -222,14 +324,20 @@ public class JNIEncoder
      * @see AbstractCodec2#doClose()
      */
     @Override
-    protected void doClose()
+    protected synchronized void doClose()
     {
         Log.logMediaStackObjectStopped(this);
+        CodecHibernation.unregister(this);
         if (encoder != 0)
         {
            Opus.encoder_destroy(encoder);
            encoder = 0;
         }
+        if (accumulator != 0)
+        {
+            Opus.frame_accumulator_destroy(accumulator);
+            accumulator = 0;
+        }
     }
 
     /**
@@ -244,22 +352,33 @@ public class JNIEncoder
      * @see AbstractCodec2#doOpen()
      */
     @Override
-    protected void doOpen()
+    protected synchronized void doOpen()
         throws ResourceUnavailableException
     {
         Log.logMediaStackObjectStarted(this);
         AudioFormat inputFormat = (AudioFormat) getInputFormat();
-        int sampleRate = (int) inputFormat.getSampleRate();
 
         channels = inputFormat.getChannels();
-        encoder = Opus.encoder_create(sampleRate, channels);
-        if (encoder == 0)
-            throw new ResourceUnavailableException("opus_encoder_create()");
 
         //Set encoder options according to user configuration
         ConfigurationService cfg = LibJitsi.getConfigurationService();
         String str;
 
+        str = cfg.global().getString(Constants.PROP_OPUS_APPLICATION, "voip");
+        applicationConfig = Opus.APPLICATION_VOIP;
+        if ("audio".equals(str))
+            applicationConfig = Opus.APPLICATION_AUDIO;
+        else if ("lowdelay".equals(str))
+            applicationConfig = Opus.APPLICATION_RESTRICTED_LOWDELAY;
+
+        frameSizeInMicrosConfig
+            = parseFrameSizeInMicros(
+                    cfg.global().getString(
+                            Constants.PROP_OPUS_FRAME_DURATION,
+                            null),
+                    20000);
+        updateFrameSize();
+
         str = cfg.global().getString(Constants.PROP_OPUS_BANDWIDTH, "auto");
         bandwidthConfig = Opus.OPUS_AUTO;
         if("fb".equals(str))
@@ -273,28 +392,34 @@ public class JNIEncoder
         else if("nb".equals(str))
             bandwidthConfig = Opus.BANDWIDTH_NARROWBAND;
 
-        Opus.encoder_set_bandwidth(encoder, bandwidthConfig);
-
         bitrate = 1000 * //configuration is in kilobits per second
                 cfg.global().getInt(Constants.PROP_OPUS_BITRATE, 32);
         if(bitrate < 500)
             bitrate = 500;
         if(bitrate > 512000)
             bitrate = 512000;
-        Opus.encoder_set_bitrate(encoder, bitrate);
 
         complexityConfig = cfg.global().getInt(Constants.PROP_OPUS_COMPLEXITY, 10);
-        Opus.encoder_set_complexity(encoder, complexityConfig);
 
         useFecConfig = cfg.global().getBoolean(Constants.PROP_OPUS_FEC, true);
-        Opus.encoder_set_inband_fec(encoder, useFecConfig ? 1 : 0);
 
         minPacketLoss = cfg.global().getInt(
                 Constants.PROP_OPUS_MIN_EXPECTED_PACKET_LOSS, 1);
-        Opus.encoder_set_packet_loss_perc(encoder, minPacketLoss);
 
         useDtxConfig = cfg.global().getBoolean(Constants.PROP_OPUS_DTX, true);
-        Opus.encoder_set_dtx(encoder, useDtxConfig ? 1 : 0);
+
+        accumulator
+            = Opus.frame_accumulator_create(Opus.MAX_FRAME_SIZE_IN_BYTES);
+        if (accumulator == 0)
+        {
+            throw new ResourceUnavailableException(
+                    "Opus.frame_accumulator_create()");
+        }
+        accumulatedLength = 0;
+        if (!createEncoder())
+            throw new ResourceUnavailableException("opus_encoder_create()");
+        lastActiveNanos = System.nanoTime();
+        CodecHibernation.register(this);
 
         int b = Opus.encoder_get_bandwidth(encoder);
         logger.debug("Encoder settings: audio bandwidth " +
@@ -320,7 +445,7 @@ public class JNIEncoder
      * @see AbstractCodec2#doProcess(Buffer, Buffer)
      */
     @Override
-    protected int doProcess(Buffer inBuffer, Buffer outBuffer)
+    protected synchronized int doProcess(Buffer inBuffer, Buffer outBuffer)
     {
         Format inFormat = inBuffer.getFormat();
 
@@ -337,91 +462,97 @@ public class JNIEncoder
         Log.logReceivedBytes(this, inLength);
         int inOffset = inBuffer.getOffset();
 
-        if ((prevIn != null) && (prevInLength > 0))
-        {
-            if (prevInLength < frameSizeInBytes)
-            {
-                if (prevIn.length < frameSizeInBytes)
-                {
-                    byte[] newPrevInput = new byte[frameSizeInBytes];
-
-                    System.arraycopy(prevIn, 0, newPrevInput, 0, prevIn.length);
-                    prevIn = newPrevInput;
-                }
-
-                int bytesToCopyFromInToPrevInput
-                    = Math.min(frameSizeInBytes - prevInLength, inLength);
-
-                if (bytesToCopyFromInToPrevInput > 0)
-                {
-                    System.arraycopy(
-                            in, inOffset,
-                            prevIn, prevInLength,
-                            bytesToCopyFromInToPrevInput);
-                    prevInLength += bytesToCopyFromInToPrevInput;
-                    inLength -= bytesToCopyFromInToPrevInput;
-                    inBuffer.setLength(inLength);
-                    inBuffer.setOffset(inOffset + bytesToCopyFromInToPrevInput);
-                }
-            }
-
-            if (prevInLength == frameSizeInBytes)
-            {
-                in = prevIn;
-                inOffset = 0;
-                prevInLength = 0;
-            }
-            else
-            {
-                outBuffer.setLength(0);
-                discardOutputBuffer(outBuffer);
-                if (inLength < 1)
-                    return BUFFER_PROCESSED_OK;
-                else
-                    return BUFFER_PROCESSED_OK | INPUT_BUFFER_NOT_CONSUMED;
-            }
-        }
-        else if (inLength < 1)
+        if (inLength < 1)
         {
             outBuffer.setLength(0);
             discardOutputBuffer(outBuffer);
             return BUFFER_PROCESSED_OK;
         }
-        else if (inLength < frameSizeInBytes)
+
+        /*
+         * Mirror Opus.encode_accumulated: a whole frame is encoded straight
+         * from the input if nothing is accumulated, otherwise the input tops
+         * up the accumulated frame.
+         */
+        if (accumulatedLength >= frameSizeInBytes)
+            accumulatedLength = 0;
+        if (accumulatedLength == 0)
+            frameCaptureNanos = LatencyTracer.getCaptureNanos(inBuffer);
+
+        int consumed
+            = ((accumulatedLength == 0) && (inLength >= frameSizeInBytes))
+                ? frameSizeInBytes
+                : Math.min(frameSizeInBytes - accumulatedLength, inLength);
+        int outLength;
+
+        inLength -= consumed;
+        inBuffer.setLength(inLength);
+        inBuffer.setOffset(inOffset + consumed);
+
+        boolean silence = isSilence(in, inOffset, consumed);
+
+        if (!silence)
+            lastActiveNanos = System.nanoTime();
+        /*
+         * Without DTX the remote peer expects a packet for every frame, so
+         * the encoder is recreated even for silence unless DTX is on.
+         */
+        if ((encoder == 0) && (!silence || !isDtxEnabled()) && !createEncoder())
+            return BUFFER_PROCESSED_FAILED;
+        if (encoder == 0)
         {
-            if ((prevIn == null) || (prevIn.length < inLength))
-                prevIn = new byte[frameSizeInBytes];
-            System.arraycopy(in, inOffset, prevIn, 0, inLength);
-            prevInLength = inLength;
-            outBuffer.setLength(0);
-            discardOutputBuffer(outBuffer);
-            return BUFFER_PROCESSED_OK;
+            // Hibernated with DTX on: silence is not sent, as with DTX.
+            outLength = 0;
         }
         else
         {
-            inLength -= frameSizeInBytes;
-            inBuffer.setLength(inLength);
-            inBuffer.setOffset(inOffset + frameSizeInBytes);
+            // At long last, do the actual encoding.
+            byte[] out
+                = validateByteArraySize(outBuffer, Opus.MAX_PACKET, false);
+            long encodeStartNanos = System.nanoTime();
+
+            outLength
+                = Opus.encode_accumulated(
+                        encoder,
+                        accumulator,
+                        in, inOffset, consumed,
+                        frameSizeInSamplesPerChannel, channels,
+                        out, 0, out.length);
+
+            /*
+             * The native accumulator is left as it was on error so this
+             * mirror of it only advances on success.
+             */
+            if (outLength < 0)  // error from opus_encode
+                return BUFFER_PROCESSED_FAILED;
+            accumulatedLength
+                = (accumulatedLength + consumed) % frameSizeInBytes;
+            if (outLength > 0)
+            {
+                latencyTracer.record(
+                        LatencyTracer.Stage.ENCODE,
+                        System.nanoTime() - encodeStartNanos);
+                if (frameCaptureNanos != Buffer.TIME_UNKNOWN)
+                {
+                    latencyTracer.record(
+                            LatencyTracer.Stage.CAPTURE_TO_ENCODE,
+                            encodeStartNanos - frameCaptureNanos);
+                }
+            }
         }
 
-        // At long last, do the actual encoding.
-        byte[] out = validateByteArraySize(outBuffer, Opus.MAX_PACKET, false);
-        int outLength
-            = Opus.encode(
-                    encoder,
-                    in, inOffset, frameSizeInSamplesPerChannel,
-                    out, 0, out.length);
-
-        if (outLength < 0)  // error from opus_encode
-            return BUFFER_PROCESSED_FAILED;
-
         if (outLength > 0)
         {
-            outBuffer.setDuration(((long) frameSizeInMillis) * 1000 * 1000);
+            outBuffer.setDuration(((long) frameSizeInMicros) * 1000);
             outBuffer.setFormat(getOutputFormat());
             outBuffer.setLength(outLength);
             outBuffer.setOffset(0);
         }
+        else
+        {
+            outBuffer.setLength(0);
+            discardOutputBuffer(outBuffer);
+        }
 
         if (inLength < 1)
             return BUFFER_PROCESSED_OK;
@@ -429,6 +560,54 @@ public class JNIEncoder
             return BUFFER_PROCESSED_OK | INPUT_BUFFER_NOT_CONSUMED;
     }
 
+    /**
+     * Applies the format parameters to the native encoder.
+     */
+    private void applyFormatParameters()
+    {
+        Opus.encoder_set_bitrate(
+                encoder,
+                (fmtpMaxAverageBitrate < bitrate)
+                    ? fmtpMaxAverageBitrate
+                    : bitrate);
+        Opus.encoder_set_dtx(encoder, isDtxEnabled() ? 1 : 0);
+        Opus.encoder_set_inband_fec(
+                encoder,
+                (fmtpUseFec && useFecConfig) ? 1 : 0);
+    }
+
+    /**
+     * Creates the native encoder and applies the configuration and format
+     * parameters of this instance to it.
+     *
+     * @return <tt>true</tt> if the encoder was created
+     */
+    private boolean createEncoder()
+    {
+        AudioFormat inputFormat = (AudioFormat) getInputFormat();
+
+        encoder
+            = Opus.encoder_create(
+                    (int) inputFormat.getSampleRate(),
+                    channels,
+                    applicationConfig);
+        if (encoder == 0)
+        {
+            logger.error("Failed to create Opus encoder");
+            return false;
+        }
+
+        Opus.encoder_set_bandwidth(encoder, bandwidthConfig);
+        Opus.encoder_set_complexity(encoder, complexityConfig);
+        Opus.encoder_set_packet_loss_perc(
+                encoder,
+                (expectedPacketLoss > minPacketLoss)
+                    ? expectedPacketLoss
+                    : minPacketLoss);
+        applyFormatParameters();
+        return true;
+    }
+
     /**
      * Implements {@link Control#getControlComponent()}. <tt>JNIEncoder</tt>
      * does not provide user interface of its own.
@@ -477,14 +656,63 @@ public class JNIEncoder
                                     public long computeDuration(long length)
                                     {
                                         return
-                                            ((long) frameSizeInMillis)
-                                                * 1000 * 1000;
+                                            ((long) frameSizeInMicros) * 1000;
                                     }
                                 });
         }
         return f;
     }
 
+    /**
+     * Destroys the native encoder if only digital silence, such as that of a
+     * muted capture, has been input since a specific time and DTX is on. The
+     * silence is not sent while hibernated and the encoder is recreated on
+     * the first frame which is not silent. Without DTX the encoder never
+     * hibernates because the silence has to be sent.
+     */
+    @Override
+    public synchronized void hibernateIfIdle(long idleSinceNanos)
+    {
+        if ((encoder != 0)
+                && isDtxEnabled()
+                && (lastActiveNanos - idleSinceNanos < 0))
+        {
+            Opus.encoder_destroy(encoder);
+            encoder = 0;
+            if (logger.isDebugEnabled())
+                logger.debug("Hibernated idle Opus encoder " + hashCode());
+        }
+    }
+
+    /**
+     * Determines whether DTX is enabled by both the configuration and the
+     * format parameters.
+     *
+     * @return <tt>true</tt> if DTX is enabled
+     */
+    private boolean isDtxEnabled()
+    {
+        return fmtpUseDtx && useDtxConfig;
+    }
+
+    /**
+     * Determines whether a frame is digital silence.
+     *
+     * @param in the array which contains the frame
+     * @param offset the offset in <tt>in</tt> of the frame
+     * @param length the length in bytes of the frame
+     * @return <tt>true</tt> if all the samples of the frame are zero
+     */
+    private static boolean isSilence(byte[] in, int offset, int length)
+    {
+        for (int i = offset, end = offset + length; i < end; i++)
+        {
+            if (in[i] != 0)
+                return false;
+        }
+        return true;
+    }
+
     /**
      * Updates the encoder's expected packet loss percentage to the bigger of
      * <tt>percentage</tt> and <tt>this.minPacketLoss</tt>.
@@ -492,9 +720,10 @@ public class JNIEncoder
      * @param percentage the expected packet loss percentage to set
      */
     @Override
-    public void setExpectedPacketLoss(int percentage)
+    public synchronized void setExpectedPacketLoss(int percentage)
     {
-        if (opened)
+        expectedPacketLoss = percentage;
+        if (opened && (encoder != 0))
         {
             Opus.encoder_set_packet_loss_perc(
                     encoder,
@@ -511,7 +740,7 @@ public class JNIEncoder
      * @param fmtps the format parameters to set
      */
     @Override
-    public void setFormatParameters(Map<String, String> fmtps)
+    public synchronized void setFormatParameters(Map<String, String> fmtps)
     {
         logger.debug("Setting format parameters: " + fmtps);
 
@@ -532,18 +761,21 @@ public class JNIEncoder
         {
             // Ignore and fall back to the default value.
         }
-        Opus.encoder_set_bitrate(
-                encoder,
-                (maxaveragebitrate < bitrate) ? maxaveragebitrate : bitrate);
+        fmtpMaxAverageBitrate = maxaveragebitrate;
 
         // DTX is off unless specified.
-        boolean useDtx = "1".equals(fmtps.get("usedtx"));
-        Opus.encoder_set_dtx(encoder, (useDtx && useDtxConfig) ? 1 : 0);
+        fmtpUseDtx = "1".equals(fmtps.get("usedtx"));
 
         // FEC is on unless specified.
         String s = fmtps.get("useinbandfec");
-        boolean useFec = (s == null) || s.equals("1");
-        Opus.encoder_set_inband_fec(encoder, (useFec && useFecConfig) ? 1 : 0);
+        fmtpUseFec = (s == null) || s.equals("1");
+
+        /*
+         * The parameters are kept in order to be applied again if the encoder
+         * is recreated after hibernating.
+         */
+        if (encoder != 0)
+            applyFormatParameters();
     }
 
     /**
@@ -560,17 +792,95 @@ public class JNIEncoder
         Format newValue = getInputFormat();
 
         if (oldValue != newValue)
+            updateFrameSize();
+        return setInputFormat;
+    }
+
+    /**
+     * Sets the advanced attributes, of which the <tt>ptime</tt> and
+     * <tt>maxptime</tt> of the remote peer limit the frame size/duration.
+     *
+     * @param attributes the advanced attributes to set
+     */
+    @Override
+    public synchronized void setAdvancedAttributes(
+            Map<String, String> attributes)
+    {
+        int ptime
+            = parseFrameSizeInMicros(
+                    attributes.get("ptime"),
+                    Integer.MAX_VALUE);
+        int maxptime
+            = parseFrameSizeInMicros(
+                    attributes.get("maxptime"),
+                    Integer.MAX_VALUE);
+
+        sdpFrameSizeInMicros = Math.min(ptime, maxptime);
+        updateFrameSize();
+    }
+
+    /**
+     * Parses a frame size/duration in milliseconds, such as an SDP
+     * <tt>ptime</tt>, into the longest one Opus supports which does not
+     * exceed it.
+     *
+     * @param s the frame size/duration in milliseconds to parse
+     * @param defaultValue the value to return if <tt>s</tt> is not specified
+     * or invalid
+     * @return the longest of <tt>FRAME_SIZES_IN_MICROS</tt> which does not
+     * exceed <tt>s</tt>, the shortest if none, or <tt>defaultValue</tt>
+     */
+    private static int parseFrameSizeInMicros(String s, int defaultValue)
+    {
+        if ((s == null) || (s.length() == 0))
+            return defaultValue;
+
+        double millis;
+
+        try
         {
-            AudioFormat af = (AudioFormat) newValue;
-            int sampleRate = (int) af.getSampleRate();
-
-            frameSizeInSamplesPerChannel
-                = (sampleRate * frameSizeInMillis) / 1000;
-            frameSizeInBytes
-                = 2 /* sizeof(opus_int16) */
-                    * channels
-                    * frameSizeInSamplesPerChannel;
+            millis = Double.parseDouble(s.trim());
         }
-        return setInputFormat;
+        catch (NumberFormatException nfe)
+        {
+            return defaultValue;
+        }
+        if (!(millis > 0))
+            return defaultValue;
+
+        double micros = millis * 1000;
+        int frameSizeInMicros = FRAME_SIZES_IN_MICROS[0];
+
+        for (int supported : FRAME_SIZES_IN_MICROS)
+        {
+            if (supported <= micros)
+                frameSizeInMicros = supported;
+        }
+        return frameSizeInMicros;
+    }
+
+    /**
+     * Calculates {@link #frameSizeInMicros} from the configuration and the
+     * remote peer and the sizes of a frame derived from it for the
+     * <tt>inputFormat</tt> of this instance.
+     */
+    private void updateFrameSize()
+    {
+        frameSizeInMicros
+            = Math.min(frameSizeInMicrosConfig, sdpFrameSizeInMicros);
+
+        AudioFormat af = (AudioFormat) getInputFormat();
+
+        if (af == null)
+            return;
+
+        int sampleRate = (int) af.getSampleRate();
+
+        frameSizeInSamplesPerChannel
+            = (int) (((long) sampleRate * frameSizeInMicros) / 1000000);
+        frameSizeInBytes
+            = 2 /* sizeof(opus_int16) */
+                * channels
+                * frameSizeInSamplesPerChannel;
     }
 }
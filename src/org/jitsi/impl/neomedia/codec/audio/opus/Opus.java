@@ -4,8 +4,11 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia.codec.audio.opus;
 
+import org.jitsi.util.*;
+
 /**
  * Defines the API of the native opus library to be utilized by the libjitsi
  * library.
@@ -15,6 +18,23 @@ package org.jitsi.impl.neomedia.codec.audio.opus;
  */
 public class Opus
 {
+    /**
+     * Opus application constant for the best quality of general audio such as
+     * music.
+     */
+    public static final int APPLICATION_AUDIO = 2049;
+
+    /**
+     * Opus application constant for the lowest delay, which disables the
+     * speech-optimized mode.
+     */
+    public static final int APPLICATION_RESTRICTED_LOWDELAY = 2051;
+
+    /**
+     * Opus application constant for the best quality of speech.
+     */
+    public static final int APPLICATION_VOIP = 2048;
+
     /**
      * Opus fullband constant
      */
@@ -45,6 +65,12 @@ public class Opus
      */
     public static final int INVALID_PACKET = -4;
 
+    /**
+     * The maximum size in bytes of a frame of PCM input to an encoder, i.e. 60
+     * milliseconds of 16-bit stereo at 48 kHz.
+     */
+    public static final int MAX_FRAME_SIZE_IN_BYTES = 2880 * 2 * 2;
+
     /**
      * The maximum size of a packet we can create. Since we're only creating
      * packets with a single frame, that's a 1 byte TOC + the maximum frame size.
@@ -67,7 +93,7 @@ public class Opus
      */
     static
     {
-        System.loadLibrary("jnopus");
+        NativeLibraryLoader.loadLibrary("jnopus", Opus.class);
     }
 
     /**
@@ -172,17 +198,52 @@ public class Opus
             byte[] input, int inputOffset, int inputFrameSize,
             byte[] output, int outputOffset, int outputLength);
 
+    /**
+     * Encodes a frame of PCM which is accumulated from the input of this and
+     * previous calls. If nothing has been accumulated and <tt>input</tt> holds
+     * a whole frame, the frame is encoded straight from <tt>input</tt> and
+     * only its bytes are consumed. Otherwise as many bytes of <tt>input</tt>
+     * as are missing from the accumulated frame are consumed and the frame is
+     * encoded once it is complete. Whatever has been accumulated is dropped
+     * if the frame size shrinks to it or below. On error the accumulator is
+     * left as it was before the call.
+     *
+     * @param encoder The encoder to use.
+     * @param accumulator The accumulator, as returned from
+     * {@link #frame_accumulator_create(int)}.
+     * @param input Array containing PCM encoded input.
+     * @param inputOffset Offset to use into the <tt>input</tt> array
+     * @param inputLength The number of bytes available in <tt>input</tt>.
+     * @param inputFrameSize The number of samples per channel in a frame.
+     * @param channels The number of channels of the input.
+     * @param output Array where the encoded packet will be stored.
+     * @param outputOffset
+     * @param outputLength The number of available bytes in <tt>output</tt>.
+     *
+     * @return The number of bytes written in <tt>output</tt>, zero if the
+     * frame is not complete yet, or a negative on error.
+     */
+    public static native int encode_accumulated(
+            long encoder,
+            long accumulator,
+            byte[] input, int inputOffset, int inputLength,
+            int inputFrameSize, int channels,
+            byte[] output, int outputOffset, int outputLength);
+
     /**
      * Creates an OpusEncoder structure, returns a pointer to it casted to long.
-     * The native function's <tt>application</tt> parameter is always set to
-     * OPUS_APPLICATION_VOIP.
      *
      * @param Fs Sample rate of the input PCM
      * @param channels number of channels in the input (1/2)
+     * @param application the coding mode, one of <tt>APPLICATION_VOIP</tt>,
+     * <tt>APPLICATION_AUDIO</tt> and <tt>APPLICATION_RESTRICTED_LOWDELAY</tt>
      *
      * @return A pointer to the OpusEncoder structure created, 0 on error
      */
-    public static native long encoder_create(int Fs, int channels);
+    public static native long encoder_create(
+            int Fs,
+            int channels,
+            int application);
 
     /**
      * Destroys an OpusEncoder, freeing it's resources.
@@ -381,6 +442,23 @@ public class Opus
     public static native int encoder_set_vbr_constraint(long encoder,
                                                         int use_cvbr);
 
+    /**
+     * Creates a native buffer in which {@link #encode_accumulated} accumulates
+     * incomplete frames.
+     *
+     * @param capacity the size in bytes of the largest frame to accumulate
+     * @return a pointer to the accumulator, 0 on error
+     */
+    public static native long frame_accumulator_create(int capacity);
+
+    /**
+     * Destroys an accumulator, freeing its resources.
+     *
+     * @param accumulator the accumulator, as returned from
+     * {@link #frame_accumulator_create(int)}
+     */
+    public static native void frame_accumulator_destroy(long accumulator);
+
     /**
      * Returns the audio bandwidth of an Opus packet, one of
      * <tt>BANDWIDTH_FULLBAND</tt>, <tt>BANDWIDTH_MEDIUMBAND</tt>,
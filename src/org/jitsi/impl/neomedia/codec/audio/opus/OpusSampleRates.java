@@ -0,0 +1,71 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.codec.audio.opus;
+
+/**
+ * The sample rates of the PCM which the Opus <tt>JNIDecoder</tt> outputs and
+ * the <tt>JNIEncoder</tt> inputs. Opus decodes and encodes natively at 8, 12,
+ * 16, 24 and 48 kHz, so when an <tt>AudioMixer</tt> runs at one of these
+ * rates the graphs which feed it or are fed by it need no resampler. The rate
+ * is negotiated per graph: a decoder offers all the native rates and the
+ * <tt>TranscodingDataSource</tt> of the mixer it feeds selects the mix rate,
+ * and <tt>AudioMediaDeviceSession</tt> puts an encoder taking the rate of the
+ * captured track into the codec chain of its processor.
+ * <p>
+ * Kept apart from {@link Opus} so that the rates may be checked without
+ * loading the native library.
+ * </p>
+ */
+public final class OpusSampleRates
+{
+    /**
+     * The sample rate of the RTP clock of Opus, at which the codecs operate
+     * when no other rate is preferred.
+     */
+    public static final int DEFAULT_SAMPLE_RATE = 48000;
+
+    /**
+     * The sample rates at which Opus decodes and encodes natively.
+     */
+    private static final int[] SAMPLE_RATES
+        = new int[] { 48000, 24000, 16000, 12000, 8000 };
+
+    /**
+     * Gets the sample rates at which Opus decodes and encodes natively.
+     *
+     * @return the native sample rates, highest first
+     */
+    public static int[] getSampleRates()
+    {
+        return SAMPLE_RATES.clone();
+    }
+
+    /**
+     * Determines whether Opus decodes and encodes natively at a specific
+     * sample rate.
+     *
+     * @param sampleRate the sample rate
+     * @return <tt>true</tt> if no resampling is needed at <tt>sampleRate</tt>
+     */
+    public static boolean isSupported(double sampleRate)
+    {
+        for (int supported : SAMPLE_RATES)
+        {
+            if (supported == sampleRate)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Prevents the initialization of <tt>OpusSampleRates</tt> instances.
+     */
+    private OpusSampleRates()
+    {
+    }
+}
@@ -24,6 +24,7 @@ import net.java.sip.communicator.impl.neomedia.codec.audio.speex.*;
  */
 public class SpeexResampler
     extends AbstractCodec2
+    implements CodecHibernation.Hibernatable
 {
     private static final Logger sLog = Logger.getLogger(SpeexResampler.class);
 
@@ -123,6 +124,18 @@ public class SpeexResampler
      */
     private int inputSampleRate;
 
+    /**
+     * Whether {@link #resampler} has been destroyed because only silence was
+     * resampled for a while.
+     */
+    private boolean hibernated;
+
+    /**
+     * The <tt>System.nanoTime()</tt> at which audio which was not digital
+     * silence was last resampled.
+     */
+    private long lastActiveNanos;
+
     /**
      * The output sample rate configured in {@link #resampler}.
      */
@@ -149,9 +162,10 @@ public class SpeexResampler
      * @see AbstractCodec2#doClose()
      */
     @Override
-    protected void doClose()
+    protected synchronized void doClose()
     {
         sLog.info("Closing " + this);
+        CodecHibernation.unregister(this);
         if (resampler != 0)
         {
             Speex.speex_resampler_destroy(resampler);
@@ -169,9 +183,11 @@ public class SpeexResampler
      * @see AbstractCodecExt#doOpen()
      */
     @Override
-    protected void doOpen()
+    protected synchronized void doOpen()
     {
         sLog.info("Opening " + this);
+        lastActiveNanos = System.nanoTime();
+        CodecHibernation.register(this);
     }
 
     /**
@@ -185,7 +201,7 @@ public class SpeexResampler
      * @see AbstractCodecExt#doProcess(Buffer, Buffer)
      */
     @Override
-    protected int doProcess(Buffer inBuffer, Buffer outBuffer)
+    protected synchronized int doProcess(Buffer inBuffer, Buffer outBuffer)
     {
         Format inFormat = inBuffer.getFormat();
 
@@ -293,11 +309,26 @@ public class SpeexResampler
             if (outAudioFormat.getChannels() != channels)
                 return BUFFER_PROCESSED_FAILED;
 
+            /*
+             * While hibernated, silence is resampled to silence without a
+             * resampler. The resampler is recreated on the first audio which
+             * is not silent.
+             */
+            boolean silence = isSilence(inBuffer);
+
+            if (!silence)
+            {
+                lastActiveNanos = System.nanoTime();
+                hibernated = false;
+            }
+
+            boolean hibernating = hibernated && silence;
             boolean channelsHaveChanged = (this.channels != channels);
 
-            if (channelsHaveChanged
-                    || (this.inputSampleRate != inSampleRate)
-                    || (this.outputSampleRate != outSampleRate))
+            if (!hibernating
+                    && (channelsHaveChanged
+                        || (this.inputSampleRate != inSampleRate)
+                        || (this.outputSampleRate != outSampleRate)))
             {
                 if (channelsHaveChanged && (resampler != 0))
                 {
@@ -328,7 +359,7 @@ public class SpeexResampler
                     this.channels = channels;
                 }
             }
-            if (resampler == 0)
+            if (!hibernating && (resampler == 0))
                 return BUFFER_PROCESSED_FAILED;
 
             byte[] in = (byte[]) inBuffer.getData();
@@ -360,7 +391,10 @@ public class SpeexResampler
             {
                 int inOffset = inBuffer.getOffset();
 
-                outSampleCount = Speex.speex_resampler_process_interleaved_int(
+                if (hibernating)
+                    Arrays.fill(out, outOffset, newSize, (byte) 0);
+                else
+                    outSampleCount = Speex.speex_resampler_process_interleaved_int(
                                                                  resampler,
                                                                  in,
                                                                  inOffset,
@@ -495,4 +529,49 @@ public class SpeexResampler
         }
         return inFormat;
     }
+
+    /**
+     * Destroys the native resampler if only digital silence has been
+     * resampled since a specific time.
+     */
+    @Override
+    public synchronized void hibernateIfIdle(long idleSinceNanos)
+    {
+        if ((resampler != 0) && (lastActiveNanos - idleSinceNanos < 0))
+        {
+            Speex.speex_resampler_destroy(resampler);
+            resampler = 0;
+            // Have the next audio which is not silent recreate the resampler.
+            channels = 0;
+            hibernated = true;
+            if (sLog.isDebugEnabled())
+                sLog.debug("Hibernated idle " + this);
+        }
+    }
+
+    /**
+     * Determines whether the audio in a specific <tt>Buffer</tt> is digital
+     * silence.
+     *
+     * @param buffer the <tt>Buffer</tt> of <tt>byte</tt>s to check
+     * @return <tt>true</tt> if all the samples in <tt>buffer</tt> are zero
+     */
+    private static boolean isSilence(Buffer buffer)
+    {
+        Object data = buffer.getData();
+
+        if (!(data instanceof byte[]))
+            return false;
+
+        byte[] bytes = (byte[]) data;
+
+        for (int i = buffer.getOffset(), end = i + buffer.getLength();
+                i < end;
+                i++)
+        {
+            if (bytes[i] != 0)
+                return false;
+        }
+        return true;
+    }
 }
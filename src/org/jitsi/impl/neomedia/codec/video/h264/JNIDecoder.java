@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia.codec.video.h264;
 
 import static org.bytedeco.ffmpeg.avcodec.AVCodecContext.*;
@@ -45,6 +46,37 @@ public class JNIDecoder
 {
     private static final Logger logger = Logger.getLogger(JNIDecoder.class);
 
+    /**
+     * The decode level at which every frame is decoded in full.
+     */
+    private static final int DECODE_LEVEL_FULL = 0;
+
+    /**
+     * The decode level at which the deblocking filter is skipped for the
+     * frames which no other frame references, the artifacts of which do not
+     * survive the downscaling to a small tile.
+     */
+    private static final int DECODE_LEVEL_REDUCED = 1;
+
+    /**
+     * The decode level at which, in addition to {@link #DECODE_LEVEL_REDUCED},
+     * only the frames which other frames reference are decoded.
+     */
+    private static final int DECODE_LEVEL_THUMBNAIL = 2;
+
+    /**
+     * The minimum ratio of the decoded to the displayed pixels at which
+     * {@link #DECODE_LEVEL_REDUCED} is used.
+     */
+    private static final int REDUCED_PIXEL_RATIO = 4;
+
+    /**
+     * The minimum ratio of the decoded to the displayed pixels at which
+     * {@link #DECODE_LEVEL_THUMBNAIL} is used, e.g. 640x360 displayed at
+     * 160x90.
+     */
+    private static final int THUMBNAIL_PIXEL_RATIO = 16;
+
     /**
      * The default output <tt>VideoFormat</tt>.
      */
@@ -67,6 +99,18 @@ public class JNIDecoder
      */
     private AVFrameWrapper avframe;
 
+    /**
+     * The decode level, one of the <tt>DECODE_LEVEL_</tt> constants, which is
+     * applied to {@link #avctx}.
+     */
+    private int decodeLevel = DECODE_LEVEL_FULL;
+
+    /**
+     * The size at which the decoded video is displayed or <tt>null</tt> if
+     * it is unknown.
+     */
+    private Dimension displaySize;
+
     private boolean gotPictureAtLeastOnce;
 
     /**
@@ -88,6 +132,12 @@ public class JNIDecoder
      */
     private KeyFrameControl keyFrameControl;
 
+    /**
+     * Whether the decoded video is of low priority, e.g. the tile of a
+     * participant who is not speaking.
+     */
+    private boolean lowPriority;
+
     /**
      * Array of output <tt>VideoFormat</tt>s.
      */
@@ -142,6 +192,7 @@ public class JNIDecoder
             }
 
             gotPictureAtLeastOnce = false;
+            decodeLevel = DECODE_LEVEL_FULL;
         }
     }
 
@@ -244,6 +295,72 @@ public class JNIDecoder
         return emptyFrames > FLUSH_FRAME_COUNT_LIMIT;
     }
 
+    /**
+     * Determines the decode level to apply to {@link #avctx} from the size and
+     * priority of the displayed video and the size of the decoded video, and
+     * applies it if it has changed. The fields read by FFmpeg for every
+     * frame are set, so the level may change between any two packets.
+     */
+    private void updateDecodeLevel()
+    {
+        int decodeLevel = DECODE_LEVEL_FULL;
+        Dimension displaySize = this.displaySize;
+        long decodedPixels = (long) avctx.width() * avctx.height();
+
+        if ((displaySize != null) && (decodedPixels > 0))
+        {
+            long displayedPixels
+                = Math.max(1L, (long) displaySize.width * displaySize.height);
+
+            if (decodedPixels >= THUMBNAIL_PIXEL_RATIO * displayedPixels)
+                decodeLevel = DECODE_LEVEL_THUMBNAIL;
+            else if (decodedPixels >= REDUCED_PIXEL_RATIO * displayedPixels)
+                decodeLevel = DECODE_LEVEL_REDUCED;
+        }
+        if (lowPriority && (decodeLevel < DECODE_LEVEL_THUMBNAIL))
+            decodeLevel++;
+
+        if (this.decodeLevel != decodeLevel)
+        {
+            int previousDecodeLevel = this.decodeLevel;
+
+            this.decodeLevel = decodeLevel;
+            /*
+             * The loop filter is skipped for the frames which are not
+             * referenced only, so that the error of an unfiltered frame does
+             * not propagate to the frames predicted from it.
+             */
+            avctx.skip_loop_filter(
+                    (decodeLevel >= DECODE_LEVEL_REDUCED)
+                        ? AVDISCARD_NONREF
+                        : AVDISCARD_DEFAULT);
+            avctx.skip_frame(
+                    (decodeLevel >= DECODE_LEVEL_THUMBNAIL)
+                        ? AVDISCARD_NONREF
+                        : AVDISCARD_DEFAULT);
+            if (logger.isDebugEnabled())
+            {
+                logger.debug(
+                        "Decode level " + decodeLevel + " for "
+                            + avctx.width() + "x" + avctx.height()
+                            + " displayed at " + displaySize
+                            + (lowPriority ? ", low priority" : ""));
+            }
+
+            /*
+             * Refresh the picture once it is decoded in full again rather than
+             * wait for the next key frame to clear what the reduced levels
+             * left in it.
+             */
+            if ((decodeLevel == DECODE_LEVEL_FULL)
+                    && (previousDecodeLevel >= DECODE_LEVEL_REDUCED)
+                    && (keyFrameControl != null))
+            {
+                keyFrameControl.requestKeyFrame(false);
+            }
+        }
+    }
+
     /**
      * Decode a video frame.
      *
@@ -253,6 +370,8 @@ public class JNIDecoder
      */
     private synchronized int decodeVideo(byte[] src, int srcLength)
     {
+        updateDecodeLevel();
+
         // Set up packet data buffer
         final long packetBufferSize = srcLength + AV_INPUT_BUFFER_PADDING_SIZE;
         int returnCode;
@@ -392,7 +511,16 @@ public class JNIDecoder
 
         if (returnCode != 0)
         {
-            if ((in.getFlags() & Buffer.FLAG_RTP_MARKER) != 0)
+            /*
+             * No picture is expected for the frames which the thumbnail
+             * decode level skips.
+             */
+            boolean skipped
+                = (decodeLevel == DECODE_LEVEL_THUMBNAIL)
+                    && gotPictureAtLeastOnce
+                    && ((returnCode == -11) || (returnCode == -35));
+
+            if (((in.getFlags() & Buffer.FLAG_RTP_MARKER) != 0) && !skipped)
             {
                 if (keyFrameControl != null)
                     keyFrameControl.requestKeyFrame(!gotPictureAtLeastOnce);
@@ -469,6 +597,24 @@ public class JNIDecoder
         return setFormat;
     }
 
+    /**
+     * Sets the size and priority at which the decoded video is displayed, from
+     * which this decoder determines how much decoding work it may skip.
+     *
+     * @param displaySize the size at which the decoded video is displayed or
+     * <tt>null</tt> if it is unknown
+     * @param lowPriority <tt>true</tt> if the decoded video is of low
+     * priority, e.g. the tile of a participant who is not speaking
+     */
+    public synchronized void setDisplayHints(
+            Dimension displaySize,
+            boolean lowPriority)
+    {
+        this.displaySize
+            = (displaySize == null) ? null : new Dimension(displaySize);
+        this.lowPriority = lowPriority;
+    }
+
     /**
      * Sets the <tt>KeyFrameControl</tt> to be used by this
      * <tt>DePacketizer</tt> as a means of control over its key frame-related
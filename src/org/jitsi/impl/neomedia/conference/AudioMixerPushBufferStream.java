@@ -74,6 +74,13 @@ class AudioMixerPushBufferStream
          */
         private long timeStamp = Buffer.TIME_UNKNOWN;
 
+        /**
+         * Whether {@link #timeStamp} is in the time base of
+         * <tt>System.nanoTime()</tt>, as with <tt>Buffer.FLAG_SYSTEM_TIME</tt>,
+         * e.g. the time at which the audio has been captured.
+         */
+        private boolean systemTime;
+
         /**
          * Initializes a new <tt>InSampleDesc</tt> instance which is to
          * describe a specific set of audio samples read from a specific set of
@@ -130,6 +137,18 @@ class AudioMixerPushBufferStream
             return timeStamp;
         }
 
+        /**
+         * Determines whether the time stamp of <tt>inSamples</tt> is in the
+         * time base of <tt>System.nanoTime()</tt>.
+         *
+         * @return <tt>true</tt> if the time stamp of <tt>inSamples</tt> is in
+         * the time base of <tt>System.nanoTime()</tt>
+         */
+        public boolean isSystemTime()
+        {
+            return systemTime;
+        }
+
         /**
          * Sets the <tt>Buffer</tt> into which media data is to be read from the
          * input streams associated with this instance.
@@ -151,12 +170,15 @@ class AudioMixerPushBufferStream
          * @param timeStamp the time stamp of <tt>inSamples</tt> to be
          * reported in the <tt>Buffer</tt>s of the
          * <tt>AudioMixingPushBufferStream</tt>s when mixes are read from them
+         * @param systemTime whether <tt>timeStamp</tt> is in the time base of
+         * <tt>System.nanoTime()</tt>
          */
-        public void setTimeStamp(long timeStamp)
+        public void setTimeStamp(long timeStamp, boolean systemTime)
         {
             if (this.timeStamp == Buffer.TIME_UNKNOWN)
             {
                 this.timeStamp = timeStamp;
+                this.systemTime = systemTime;
             }
             else
             {
@@ -644,6 +666,8 @@ class AudioMixerPushBufferStream
         if (timeStamp != Buffer.TIME_UNKNOWN)
         {
             buffer.setTimeStamp(timeStamp);
+            if (inSampleDesc.isSystemTime())
+                buffer.setFlags(buffer.getFlags() | Buffer.FLAG_SYSTEM_TIME);
         }
     }
 
@@ -730,8 +754,13 @@ class AudioMixerPushBufferStream
                 int length
                     = sampleCount * (inStreamFormat.getSampleSizeInBits() / 8);
 
-                if (!(data instanceof byte[])
-                        || (((byte[]) data).length != length))
+                /*
+                 * Do not keep an array for an idle stream, it provides one
+                 * when it has samples again.
+                 */
+                if (!inStreamDesc.isIdle()
+                        && (!(data instanceof byte[])
+                            || (((byte[]) data).length != length)))
                 {
                     inBuffer.setData(new byte[length]);
                 }
@@ -858,26 +887,28 @@ class AudioMixerPushBufferStream
                     = audioMixer.intArrayCache.validateIntArraySize(
                             outBuffer,
                             outLength);
-                for (int i = 0; i < outLength; i++)
+                switch (outSampleSizeInBits)
                 {
-                    int sample = ArrayIOUtils.readInt16(inSamples, i * 2);
-
-                    switch (outSampleSizeInBits)
+                case 16:
+                    ArrayIOUtils.readInt16Array(
+                            inSamples, 0,
+                            outSamples, 0,
+                            outLength);
+                    break;
+                case 32:
+                    for (int i = 0; i < outLength; i++)
                     {
-                    case 16:
-                        break;
-                    case 32:
-                        sample = Math.round(sample * INT_TO_SHORT_RATIO);
-                        break;
-                    case 8:
-                    case 24:
-                    default:
-                        throw new UnsupportedFormatException(
-                                "AudioFormat.getSampleSizeInBits()",
-                                outFormat);
-                    }
+                        int sample = ArrayIOUtils.readInt16(inSamples, i * 2);
 
-                    outSamples[i] = sample;
+                        outSamples[i] = Math.round(sample * INT_TO_SHORT_RATIO);
+                    }
+                    break;
+                case 8:
+                case 24:
+                default:
+                    throw new UnsupportedFormatException(
+                            "AudioFormat.getSampleSizeInBits()",
+                            outFormat);
                 }
                 break;
             case 32:
@@ -994,6 +1025,7 @@ class AudioMixerPushBufferStream
                     }
                 }
 
+                inStreamDesc.readCompleted(sampleCount != 0);
                 if (sampleCount == 0)
                 {
                     if (TRACE_NON_CONTRIBUTING_READ_COUNT > 0)
@@ -1044,7 +1076,10 @@ class AudioMixerPushBufferStream
                      */
                     if (inSampleDesc.getTimeStamp() == Buffer.TIME_UNKNOWN)
                     {
-                        inSampleDesc.setTimeStamp(buffer.getTimeStamp());
+                        inSampleDesc.setTimeStamp(
+                                buffer.getTimeStamp(),
+                                (buffer.getFlags() & Buffer.FLAG_SYSTEM_TIME)
+                                    != 0);
                     }
 
                     continue;
@@ -1112,11 +1147,15 @@ class AudioMixerPushBufferStream
      * <tt>outStream</tt> for audio mixing
      * @param maxInSampleCount the maximum number of audio samples available
      * in <tt>inSamples</tt>
+     * @param mixStartNanos the time in the time base of
+     * <tt>System.nanoTime()</tt> at which the reading of the set of audio
+     * samples started
      */
     private void setInSamples(
             AudioMixingPushBufferStream outStream,
             InSampleDesc inSampleDesc,
-            int maxInSampleCount)
+            int maxInSampleCount,
+            long mixStartNanos)
     {
         int[][] inSamples = inSampleDesc.inSamples;
         InStreamDesc[] inStreams = inSampleDesc.inStreams;
@@ -1183,7 +1222,9 @@ class AudioMixerPushBufferStream
         outStream.setInSamples(
                 inSamples,
                 maxInSampleCount,
-                inSampleDesc.getTimeStamp());
+                inSampleDesc.getTimeStamp(),
+                inSampleDesc.isSystemTime(),
+                mixStartNanos);
     }
 
     /**
@@ -1387,6 +1428,8 @@ class AudioMixerPushBufferStream
      */
     protected void transferData(Buffer buffer)
     {
+        long mixStartNanos = System.nanoTime();
+
         try
         {
             read(buffer);
@@ -1428,7 +1471,11 @@ class AudioMixerPushBufferStream
         }
         for (AudioMixingPushBufferStream outStream : outStreams)
         {
-            setInSamples(outStream, inSampleDesc, maxInSampleCount);
+            setInSamples(
+                    outStream,
+                    inSampleDesc,
+                    maxInSampleCount,
+                    mixStartNanos);
         }
 
         /*
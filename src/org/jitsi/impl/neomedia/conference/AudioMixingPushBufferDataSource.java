@@ -14,6 +14,7 @@ import javax.media.*;
 import javax.media.control.*;
 import javax.media.protocol.*;
 
+import org.jitsi.impl.neomedia.*;
 import org.jitsi.impl.neomedia.control.*;
 import org.jitsi.impl.neomedia.protocol.*;
 import org.jitsi.service.neomedia.*;
@@ -52,6 +53,12 @@ public class AudioMixingPushBufferDataSource
      */
     private boolean connected;
 
+    /**
+     * The <tt>LatencyTracer</tt> which traces the time the audio mixed by
+     * this instance spends in the <tt>AudioMixer</tt>.
+     */
+    final LatencyTracer latencyTracer = new LatencyTracer();
+
     /**
      * The indicator which determines whether this <tt>DataSource</tt> is set
      * to transmit "silence" instead of the actual media.
@@ -230,22 +237,14 @@ public class AudioMixingPushBufferDataSource
     {
         BufferControl bufferControl = getBufferControl();
         FormatControl[] formatControls = getFormatControls();
-
-        if (bufferControl == null)
-            return formatControls;
-        else if ((formatControls == null) || (formatControls.length < 1))
-            return new Object[] { bufferControl };
-        else
-        {
-            Object[] controls = new Object[1 + formatControls.length];
-
-            controls[0] = bufferControl;
-            System.arraycopy(
-                    formatControls, 0,
-                    controls, 1,
-                    formatControls.length);
-            return controls;
-        }
+        List<Object> controls = new ArrayList<>();
+
+        controls.add(latencyTracer);
+        if (bufferControl != null)
+            controls.add(bufferControl);
+        if (formatControls != null)
+            Collections.addAll(controls, formatControls);
+        return controls.toArray();
     }
 
     /**
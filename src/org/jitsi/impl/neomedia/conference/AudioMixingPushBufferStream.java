@@ -92,6 +92,12 @@ public class AudioMixingPushBufferStream
      */
     private int maxInSampleCount;
 
+    /**
+     * The time in the time base of <tt>System.nanoTime()</tt> at which the
+     * reading of {@link #inSamples} from the inputs of the mixer started.
+     */
+    private long mixStartNanos;
+
     /**
      * The <tt>Object</tt> which synchronizes the access to the data to be read
      * from this <tt>PushBufferStream</tt> i.e. to {@link #inSamples},
@@ -105,6 +111,13 @@ public class AudioMixingPushBufferStream
      */
     private long timeStamp;
 
+    /**
+     * Whether {@link #timeStamp} is in the time base of
+     * <tt>System.nanoTime()</tt> and is to be reported with
+     * <tt>Buffer.FLAG_SYSTEM_TIME</tt>.
+     */
+    private boolean systemTime;
+
     /**
      * The <tt>BufferTransferHandler</tt> through which this
      * <tt>PushBufferStream</tt> notifies its clients that new data is available
@@ -280,18 +293,11 @@ public class AudioMixingPushBufferStream
             if (inStreamSampleCount == 0)
                 continue;
 
-            for (int i = 0; i < inStreamSampleCount; i++)
-            {
-                int inStreamSample = inStreamSamples[i];
-                int outSample = outSamples[i];
-
-                outSamples[i]
-                    = inStreamSample
-                        + outSample
-                        - Math.round(
-                                inStreamSample
-                                    * (outSample / (float) maxOutSample));
-            }
+            ArrayIOUtils.mixIntArray(
+                    inStreamSamples, 0,
+                    outSamples, 0,
+                    inStreamSampleCount,
+                    maxOutSample);
         }
         return outSamples;
     }
@@ -309,12 +315,16 @@ public class AudioMixingPushBufferStream
         int[][] inSamples;
         int maxInSampleCount;
         long timeStamp;
+        boolean systemTime;
+        long mixStartNanos;
 
         synchronized (readSyncRoot)
         {
             inSamples = this.inSamples;
             maxInSampleCount = this.maxInSampleCount;
             timeStamp = this.timeStamp;
+            systemTime = this.systemTime;
+            mixStartNanos = this.mixStartNanos;
 
             this.inSamples = null;
             this.maxInSampleCount = 0;
@@ -348,8 +358,10 @@ public class AudioMixingPushBufferStream
                 outLength = outSampleCount * 2;
                 if ((outData == null) || (outData.length < outLength))
                     outData = new byte[outLength];
-                for (int i = 0; i < outSampleCount; i++)
-                    ArrayIOUtils.writeInt16(outSamples[i], outData, i * 2);
+                ArrayIOUtils.writeInt16Array(
+                        outSamples, 0,
+                        outData, 0,
+                        outSampleCount);
                 break;
             case 32:
                 outLength = outSampleCount * 4;
@@ -370,7 +382,15 @@ public class AudioMixingPushBufferStream
             buffer.setLength(outLength);
             buffer.setOffset(0);
             buffer.setTimeStamp(timeStamp);
+            // Carry the capture time so that the encoder may trace latency.
+            if (systemTime && (timeStamp != Buffer.TIME_UNKNOWN))
+                buffer.setFlags(buffer.getFlags() | Buffer.FLAG_SYSTEM_TIME);
+            else
+                buffer.setFlags(buffer.getFlags() & ~Buffer.FLAG_SYSTEM_TIME);
             Log.logRemovedBytes(this, outLength);
+            dataSource.latencyTracer.record(
+                    LatencyTracer.Stage.MIX,
+                    System.nanoTime() - mixStartNanos);
         }
         else
         {
@@ -390,13 +410,26 @@ public class AudioMixingPushBufferStream
      * available through <tt>inSamples</tt>
      * @param timeStamp the time stamp of <tt>inSamples</tt> to be reported
      * in the specified <tt>Buffer</tt> when data is read from this instance
+     * @param systemTime whether <tt>timeStamp</tt> is in the time base of
+     * <tt>System.nanoTime()</tt>
+     * @param mixStartNanos the time in the time base of
+     * <tt>System.nanoTime()</tt> at which the reading of <tt>inSamples</tt>
+     * from the inputs of the mixer started
      */
-    void setInSamples(int[][] inSamples, int maxInSampleCount, long timeStamp)
+    void setInSamples(
+            int[][] inSamples,
+            int maxInSampleCount,
+            long timeStamp,
+            boolean systemTime,
+            long mixStartNanos)
     {
         synchronized (readSyncRoot)
         {
             this.inSamples = inSamples;
             this.maxInSampleCount = maxInSampleCount;
+            this.timeStamp = timeStamp;
+            this.systemTime = systemTime;
+            this.mixStartNanos = mixStartNanos;
         }
 
         BufferTransferHandler transferHandler = this.transferHandler;
@@ -30,12 +30,26 @@ class InStreamDesc
 {
     private static final Logger logger = Logger.getLogger(InStreamDesc.class);
 
+    /**
+     * The number of consecutive reads which did not return any samples after
+     * which the input stream is considered idle, e.g. a muted participant,
+     * and the media data array of its <tt>Buffer</tt> is released. About
+     * five seconds of 20 ms reads.
+     */
+    private static final int IDLE_READ_COUNT = 250;
+
     /**
      * The <tt>Buffer</tt> into which media data is to be read from
      * {@link #inStream}.
      */
     private SoftReference<Buffer> buffer;
 
+    /**
+     * The number of consecutive reads of the input stream which did not
+     * return any samples, up to {@link #IDLE_READ_COUNT}.
+     */
+    private int idleReadCount;
+
     /**
      * The <tt>DataSource</tt> which created the <tt>SourceStream</tt> described
      * by this instance and additional information about it.
@@ -120,6 +134,42 @@ class InStreamDesc
         return inDataSourceDesc.outDataSource;
     }
 
+    /**
+     * Determines whether the <tt>SourceStream</tt> described by this instance
+     * is idle. The media data array of the <tt>Buffer</tt> of an idle stream
+     * is not allocated in advance of reading it.
+     *
+     * @return <tt>true</tt> if the stream has not returned any samples for
+     * a while
+     */
+    public boolean isIdle()
+    {
+        return idleReadCount >= IDLE_READ_COUNT;
+    }
+
+    /**
+     * Notes whether a read of the <tt>SourceStream</tt> described by this
+     * instance returned samples, releasing the media data array of its
+     * <tt>Buffer</tt> when it becomes idle.
+     *
+     * @param contributed <tt>true</tt> if the read returned samples
+     */
+    public void readCompleted(boolean contributed)
+    {
+        if (contributed)
+        {
+            idleReadCount = 0;
+        }
+        else if ((idleReadCount < IDLE_READ_COUNT)
+                && (++idleReadCount == IDLE_READ_COUNT))
+        {
+            Buffer buffer = getBuffer(false);
+
+            if (buffer != null)
+                buffer.setData(null);
+        }
+    }
+
     /**
      * Sets the <tt>Buffer</tt> into which media data is to be read from the
      * <tt>SourceStream</tt> described by this instance.
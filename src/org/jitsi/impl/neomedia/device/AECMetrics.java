@@ -0,0 +1,88 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.device;
+
+import org.jitsi.util.*;
+
+/**
+ * Describes the quality and cost of the acoustic echo cancellation of a
+ * native capture stream as copied from the native audio libraries: whether
+ * the canceller converges (ERL/ERLE), the delay it sees and its spread, the
+ * drift between the capture and render clocks, the time spent per 10 ms block
+ * and the fill of its buffers. The values are indexed by the constants of
+ * this class.
+ */
+public class AECMetrics
+{
+    public static final int BLOCKS = 0;
+    public static final int ECHO_BLOCKS = 1;
+    public static final int STARVED_BLOCKS = 2;
+    public static final int ERL_DB = 3;
+    public static final int ERLE_DB = 4;
+    public static final int DELAY_MS = 5;
+    public static final int DELAY_MEDIAN_MS = 6;
+    public static final int DELAY_STD_MS = 7;
+    public static final int DRIFT_PPM = 8;
+    public static final int PROCESS_SUM_MICROS = 9;
+    public static final int PROCESS_MAX_MICROS = 10;
+    public static final int CAPTURE_FILL_MS = 11;
+    public static final int RENDER_FILL_MS = 12;
+    public static final int RENDER_FILL_MAX_MS = 13;
+    public static final int SUPPRESSION_LEVEL = 14;
+
+    /**
+     * The number of values of the metrics of a stream.
+     */
+    public static final int LENGTH = 15;
+
+    /**
+     * Gets the mean time spent cancelling echo per 10 ms block.
+     *
+     * @param values the metrics of a stream
+     * @return the mean in microseconds or <tt>0</tt> if no block has been
+     * processed
+     */
+    public static long getProcessMeanMicros(long[] values)
+    {
+        long processed = values[BLOCKS] - values[STARVED_BLOCKS];
+
+        return (processed > 0) ? (values[PROCESS_SUM_MICROS] / processed) : 0;
+    }
+
+    /**
+     * Logs the metrics of a stream at info level if any block has been
+     * processed.
+     *
+     * @param logger the <tt>Logger</tt> to log with
+     * @param name the name of the stream to log with the values
+     * @param values the metrics of the stream
+     */
+    public static void log(Logger logger, String name, long[] values)
+    {
+        if (values[BLOCKS] == 0)
+            return;
+
+        logger.info(
+                "AEC metrics of " + name
+                    + ": blocks=" + values[BLOCKS]
+                    + " echoBlocks=" + values[ECHO_BLOCKS]
+                    + " starvedBlocks=" + values[STARVED_BLOCKS]
+                    + " erl=" + values[ERL_DB] + "dB"
+                    + " erle=" + values[ERLE_DB] + "dB"
+                    + " delay=" + values[DELAY_MS] + "ms"
+                    + " delayMedian=" + values[DELAY_MEDIAN_MS] + "ms"
+                    + " delayStd=" + values[DELAY_STD_MS] + "ms"
+                    + " drift=" + values[DRIFT_PPM] + "ppm"
+                    + " processMean=" + getProcessMeanMicros(values) + "us"
+                    + " processMax=" + values[PROCESS_MAX_MICROS] + "us"
+                    + " captureFill=" + values[CAPTURE_FILL_MS] + "ms"
+                    + " renderFill=" + values[RENDER_FILL_MS] + "ms"
+                    + " renderFillMax=" + values[RENDER_FILL_MAX_MS] + "ms"
+                    + " suppressionLevel=" + values[SUPPRESSION_LEVEL]);
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.device;
+
+import org.jitsi.util.*;
+
+/**
+ * Describes the IO health of a native audio stream as copied from the native
+ * audio libraries: how regularly and how quickly the device callbacks run
+ * compared with the buffer period, and how often audio is lost. The values
+ * are indexed by the constants of this class, followed by {@link #BUCKETS}
+ * buckets of the jitter of the intervals between the callbacks, bucket
+ * <tt>i</tt> counting the deviations from the period in
+ * <tt>[2^i, 2^(i+1))</tt> microseconds.
+ */
+public class AudioIOHealth
+{
+    public static final int CALLBACKS = 0;
+    public static final int PERIOD_MICROS = 1;
+    public static final int JITTER_MAX_MICROS = 2;
+    public static final int DURATION_SUM_MICROS = 3;
+    public static final int DURATION_MAX_MICROS = 4;
+    public static final int DEADLINE_MISSES = 5;
+    public static final int UNDERRUNS = 6;
+    public static final int OVERRUNS = 7;
+    public static final int TRYLOCK_SKIPS = 8;
+    public static final int CONVERSION_SUM_MICROS = 9;
+    public static final int CONVERSION_MAX_MICROS = 10;
+    public static final int JITTER_BUCKETS = 11;
+
+    /**
+     * The number of log2 microsecond buckets of the jitter histogram.
+     */
+    public static final int BUCKETS = 16;
+
+    /**
+     * The number of values of the IO health of a stream.
+     */
+    public static final int LENGTH = JITTER_BUCKETS + BUCKETS;
+
+    /**
+     * Logs the IO health of a stream at info level if any callback has run.
+     *
+     * @param logger the <tt>Logger</tt> to log with
+     * @param name the name of the stream to log with the values
+     * @param values the IO health of the stream
+     */
+    public static void log(Logger logger, String name, long[] values)
+    {
+        long callbacks = values[CALLBACKS];
+
+        if (callbacks == 0)
+            return;
+
+        logger.info(
+                "Audio IO health of " + name
+                    + ": callbacks=" + callbacks
+                    + " period=" + values[PERIOD_MICROS] + "us"
+                    + " jitterMax=" + values[JITTER_MAX_MICROS] + "us"
+                    + " durationMean="
+                        + (values[DURATION_SUM_MICROS] / callbacks) + "us"
+                    + " durationMax=" + values[DURATION_MAX_MICROS] + "us"
+                    + " conversionMean="
+                        + (values[CONVERSION_SUM_MICROS] / callbacks) + "us"
+                    + " deadlineMisses=" + values[DEADLINE_MISSES]
+                    + " underruns=" + values[UNDERRUNS]
+                    + " overruns=" + values[OVERRUNS]
+                    + " trylockSkips=" + values[TRYLOCK_SKIPS]);
+    }
+}
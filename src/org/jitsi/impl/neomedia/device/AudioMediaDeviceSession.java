@@ -14,8 +14,11 @@ import javax.media.format.*;
 import javax.media.rtp.*;
 
 import org.jitsi.impl.neomedia.audiolevel.*;
+import org.jitsi.impl.neomedia.codec.audio.opus.*;
+import org.jitsi.impl.neomedia.format.*;
 import org.jitsi.impl.neomedia.jmfext.media.renderer.audio.*;
 import org.jitsi.service.neomedia.*;
+import org.jitsi.service.neomedia.codec.*;
 import org.jitsi.service.neomedia.event.*;
 import org.jitsi.util.*;
 
@@ -231,7 +234,8 @@ public class AudioMediaDeviceSession
                         logger.debug("Registering TrackControl: " + tc);
                         //we assume a single track
                         tc.setCodecChain(
-                                new Codec[] { localUserAudioLevelEffect });
+                                createCaptureCodecChain(
+                                        (AudioFormat) tc.getFormat()));
                         break;
                     }
                 }
@@ -243,6 +247,50 @@ public class AudioMediaDeviceSession
         }
     }
 
+    /**
+     * Creates the codec chain of the captured audio track: the local user
+     * audio level effect and, when the track is to be encoded to Opus at a
+     * rate Opus encodes natively other than 48 kHz, e.g. the rate of the
+     * <tt>AudioMixer</tt> of a conference, an Opus encoder taking the track
+     * at its rate so that FMJ does not resample it first. The rate is thus
+     * negotiated per graph rather than for all the encoders created.
+     *
+     * @param trackFormat the format of the captured audio track
+     * @return the codec chain of the track
+     */
+    private Codec[] createCaptureCodecChain(AudioFormat trackFormat)
+    {
+        MediaFormatImpl<? extends Format> format = getFormat();
+        int sampleRate = (int) trackFormat.getSampleRate();
+
+        if ((format != null)
+                && Constants.OPUS_RTP.equalsIgnoreCase(
+                        format.getFormat().getEncoding())
+                && (sampleRate != OpusSampleRates.DEFAULT_SAMPLE_RATE)
+                && OpusSampleRates.isSupported(sampleRate))
+        {
+            try
+            {
+                JNIEncoder encoder = new JNIEncoder(sampleRate);
+
+                if (encoder.getSupportedInputFormats()[0].matches(
+                        trackFormat))
+                {
+                    return
+                        new Codec[] { localUserAudioLevelEffect, encoder };
+                }
+            }
+            catch (Throwable t)
+            {
+                if (t instanceof ThreadDeath)
+                    throw (ThreadDeath) t;
+                logger.warn("Failed to create Opus encoder at " + sampleRate,
+                            t);
+            }
+        }
+        return new Codec[] { localUserAudioLevelEffect };
+    }
+
     /**
      * Adds an audio level effect to the tracks of the specified
      * <tt>trackControl</tt> and so that we would notify interested listeners
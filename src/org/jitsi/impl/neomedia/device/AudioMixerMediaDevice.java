@@ -16,6 +16,7 @@ import javax.media.control.*;
 import javax.media.protocol.*;
 import javax.media.rtp.*;
 
+import org.jitsi.impl.neomedia.MultitrackRecorder;
 import org.jitsi.impl.neomedia.audiolevel.*;
 import org.jitsi.impl.neomedia.conference.*;
 import org.jitsi.impl.neomedia.protocol.*;
@@ -130,6 +131,12 @@ public class AudioMixerMediaDevice
         streamAudioLevelListeners
             = new HashMap<>();
 
+    /**
+     * The <tt>MultitrackRecorder</tt> which records the audio of each
+     * participant contributed to the mix, if any.
+     */
+    private volatile MultitrackRecorder multitrackRecorder;
+
     /**
      * Initializes a new <tt>AudioMixerMediaDevice</tt> instance which is to
      * enable audio mixing on a specific <tt>AudioMediaDeviceImpl</tt>.
@@ -316,6 +323,24 @@ public class AudioMixerMediaDevice
                      * made available to the mixing yet. Slow code here is
                      * likely to degrade the performance of the whole mixer.
                      */
+                    MultitrackRecorder multitrackRecorder
+                        = AudioMixerMediaDevice.this.multitrackRecorder;
+
+                    if (multitrackRecorder != null)
+                    {
+                        if (dataSource == captureDevice)
+                            multitrackRecorder.writeLocal(buffer);
+                        else if (dataSource
+                                instanceof ReceiveStreamPushBufferDataSource)
+                        {
+                            multitrackRecorder.write(
+                                    ((ReceiveStreamPushBufferDataSource)
+                                            dataSource)
+                                        .getReceiveStream(),
+                                    buffer);
+                        }
+                    }
+
                     if (dataSource == captureDevice)
                     {
                         /*
@@ -493,6 +518,18 @@ public class AudioMixerMediaDevice
             audioMixer.removeInDataSources(dataSourceFilter);
     }
 
+    /**
+     * Sets the <tt>MultitrackRecorder</tt> which is to record the audio of
+     * each participant contributed to the mix.
+     *
+     * @param multitrackRecorder the <tt>MultitrackRecorder</tt> to record the
+     * audio of each participant into or <tt>null</tt> to stop
+     */
+    public void setMultitrackRecorder(MultitrackRecorder multitrackRecorder)
+    {
+        this.multitrackRecorder = multitrackRecorder;
+    }
+
     /**
      * Represents the one and only <tt>MediaDeviceSession</tt> with the
      * <tt>MediaDevice</tt> of this <tt>AudioMixer</tt>
@@ -9,6 +9,7 @@ package org.jitsi.impl.neomedia.device;
 
 import org.jitsi.util.CustomAnnotations;
 import org.jitsi.util.Logger;
+import org.jitsi.util.NativeLibraryLoader;
 import org.jitsi.util.OSUtils;
 import org.jitsi.util.StringUtils;
 
@@ -55,14 +56,18 @@ public class CoreAudioDevice
                 if (OSUtils.IS_MAC)
                 {
                     logger.info("About to load Mac Core audio library");
-                    System.loadLibrary("jnmaccoreaudio");
+                    NativeLibraryLoader.loadLibrary(
+                            "jnmaccoreaudio",
+                            CoreAudioDevice.class);
                     isLoaded = true;
                     logger.info("Finished loading Mac Core audio library");
                 }
                 else if (OSUtils.IS_WINDOWS)
                 {
                     logger.info("About to load Win Core audio library");
-                    System.loadLibrary("jnwincoreaudio");
+                    NativeLibraryLoader.loadLibrary(
+                            "jnwincoreaudio",
+                            CoreAudioDevice.class);
                     isLoaded = true;
                     logger.info("Finished loading Win Core audio library");
                 }
@@ -168,4 +168,41 @@ public class MacCoreAudioDevice
         return countOutputChannels(deviceUID);
     }
     public static native int countOutputChannels(String deviceUID);
+
+    /**
+     * Copies the echo cancellation metrics of a specific capture stream, as
+     * laid out by {@link AECMetrics}. The stream must not have been stopped.
+     *
+     * @param stream the stream returned by <tt>startStream</tt>
+     * @param values the array to fill
+     * @return the number of values filled, <tt>0</tt> if the stream does not
+     * cancel echo
+     */
+    public static native int getStreamAECMetrics(long stream, long[] values);
+
+    /**
+     * Copies the IO health of a specific stream, as laid out by
+     * {@link AudioIOHealth}. The stream must not have been stopped.
+     *
+     * @param stream the stream returned by <tt>startStream</tt>
+     * @param values the array to fill
+     * @return the number of values filled
+     */
+    public static native int getStreamIOHealth(long stream, long[] values);
+
+    /**
+     * Copies the native latency histograms of the CoreAudio callbacks of a
+     * specific stream, as laid out by
+     * {@link org.jitsi.impl.neomedia.LatencyTracer}. The stream must not have
+     * been stopped.
+     *
+     * @param stream the stream returned by <tt>startStream</tt>
+     * @param values the array to fill
+     * @param reset whether to reset the histograms after copying them
+     * @return the number of values filled
+     */
+    public static native int getStreamLatencySnapshot(
+            long stream,
+            long[] values,
+            boolean reset);
 }
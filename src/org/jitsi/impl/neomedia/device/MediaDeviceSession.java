@@ -1402,6 +1402,18 @@ public class MediaDeviceSession
                 if (formatParameters != null)
                     fpac.setFormatParameters(formatParameters);
             }
+            for (AdvancedAttributesAwareCodec aaac
+                    : getAllTrackControls(
+                            AdvancedAttributesAwareCodec.class,
+                            processor))
+            {
+                Map<String, String> advancedAttributes
+                        = format == null
+                        ? null
+                        : format.getAdvancedAttributes();
+                if (advancedAttributes != null)
+                    aaac.setAdvancedAttributes(advancedAttributes);
+            }
         }
     }
 
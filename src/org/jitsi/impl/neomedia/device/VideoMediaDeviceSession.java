@@ -141,6 +141,12 @@ public class VideoMediaDeviceSession
      */
     private Dimension outputSize;
 
+    /**
+     * The H.264 decoder inserted into the codec chain of the <tt>Player</tt>
+     * rendering the media received from the remote peer.
+     */
+    private volatile JNIDecoder playerDecoder;
+
     /**
      * The <tt>SwScale</tt> inserted into the codec chain of the
      * <tt>Player</tt> rendering the media received from the remote peer and
@@ -148,6 +154,17 @@ public class VideoMediaDeviceSession
      */
     private SwScale playerScaler;
 
+    /**
+     * The size at which the video received from the remote peer is displayed
+     * or <tt>null</tt> if it is unknown.
+     */
+    private volatile Dimension remoteDisplaySize;
+
+    /**
+     * Whether the video received from the remote peer is of low priority.
+     */
+    private volatile boolean remoteLowPriority;
+
     /**
      * Remote SSRC.
      */
@@ -996,6 +1013,7 @@ public class VideoMediaDeviceSession
 
         TrackControl[] trackControls = player.getTrackControls();
         SwScale playerScaler = null;
+        JNIDecoder playerDecoder = null;
 
         if ((trackControls != null) && (trackControls.length != 0))
         {
@@ -1021,6 +1039,11 @@ public class VideoMediaDeviceSession
                         final DePacketizer depacketizer = new DePacketizer();
                         JNIDecoder decoder = new JNIDecoder();
 
+                        decoder.setDisplayHints(
+                                remoteDisplaySize,
+                                remoteLowPriority);
+                        playerDecoder = decoder;
+
                         if (keyFrameControl != null)
                         {
                             depacketizer.setKeyFrameControl(keyFrameControl);
@@ -1061,9 +1084,11 @@ public class VideoMediaDeviceSession
                             + " to codec chain",
                         upiex);
                 playerScaler = null;
+                playerDecoder = null;
             }
         }
         this.playerScaler = playerScaler;
+        this.playerDecoder = playerDecoder;
     }
 
     /**
@@ -1444,6 +1469,26 @@ public class VideoMediaDeviceSession
         this.localSSRC = localSSRC;
     }
 
+    /**
+     * Sets the size and priority at which the video received from the remote
+     * peer is displayed, so that its decoder may skip work which would not
+     * be visible.
+     *
+     * @param displaySize the size at which the video is displayed or
+     * <tt>null</tt> if it is unknown
+     * @param lowPriority <tt>true</tt> if the video is of low priority
+     */
+    public void setRemoteDisplayHints(Dimension displaySize, boolean lowPriority)
+    {
+        remoteDisplaySize = displaySize;
+        remoteLowPriority = lowPriority;
+
+        JNIDecoder playerDecoder = this.playerDecoder;
+
+        if (playerDecoder != null)
+            playerDecoder.setDisplayHints(displaySize, lowPriority);
+    }
+
     /**
      * Sets the size of the output video.
      *
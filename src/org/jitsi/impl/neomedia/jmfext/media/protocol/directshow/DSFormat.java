@@ -8,6 +8,8 @@ package org.jitsi.impl.neomedia.jmfext.media.protocol.directshow;
 
 import javax.media.*;
 
+import org.jitsi.util.*;
+
 /**
  * DirectShow video format.
  *
@@ -63,7 +65,7 @@ public class DSFormat
 
     static
     {
-        System.loadLibrary("jndirectshow");
+        NativeLibraryLoader.loadLibrary("jndirectshow", DSFormat.class);
 
         RGB24 = RGB24();
         RGB32 = RGB32();
@@ -37,7 +37,7 @@ public class DSManager
 
     static
     {
-        System.loadLibrary("jndirectshow");
+        NativeLibraryLoader.loadLibrary("jndirectshow", DSManager.class);
     }
 
     /**
@@ -64,6 +64,12 @@ public class MacCoreaudioStream
      */
     private byte[] buffer = null;
 
+    /**
+     * The <tt>System.nanoTime()</tt> at which the first data of
+     * {@link #buffer} has been received from the coreaudio library.
+     */
+    private long bufferTimeStamp;
+
     /**
      * A list of already allocated buffers, ready to accept new captured data.
      */
@@ -75,6 +81,13 @@ public class MacCoreaudioStream
      */
     private Vector<byte[]> fullBufferList = new Vector<>();
 
+    /**
+     * The times at which the first data of the buffers of
+     * {@link #fullBufferList} have been received, in the same order. An entry
+     * is added before its buffer so that it is there when the buffer is.
+     */
+    private Vector<Long> fullBufferTimeStamps = new Vector<>();
+
     /**
      * The number of data available to feed the RTP stack.
      */
@@ -244,6 +257,30 @@ public class MacCoreaudioStream
         return (format == null) ? super.doGetFormat() : format;
     }
 
+    /**
+     * Gets the current echo cancellation metrics of this stream, as laid out
+     * by {@link AECMetrics}, so that the suppression level may be weighed
+     * against its cost.
+     *
+     * @return the metrics or <tt>null</tt> if this stream is not started or
+     * does not cancel echo
+     */
+    public long[] getAECMetrics()
+    {
+        synchronized (stopLock)
+        {
+            if (stream == 0)
+                return null;
+
+            long[] values = new long[AECMetrics.LENGTH];
+
+            return
+                (MacCoreAudioDevice.getStreamAECMetrics(stream, values) > 0)
+                    ? values
+                    : null;
+        }
+    }
+
     /**
      * Reads media data from this <tt>PullBufferStream</tt> into a specific
      * <tt>Buffer</tt> with blocking.
@@ -259,6 +296,7 @@ public class MacCoreaudioStream
                         buffer,
                         bytesPerBuffer,
                         false);
+        long bufferTimeStamp = Buffer.TIME_UNKNOWN;
 
         startStopLock.lock();
         try
@@ -280,6 +318,8 @@ public class MacCoreaudioStream
                 this.freeBufferList.add(data);
                 data = this.fullBufferList.remove(0);
                 length = data.length;
+                if (!this.fullBufferTimeStamps.isEmpty())
+                    bufferTimeStamp = this.fullBufferTimeStamps.remove(0);
             }
         }
         finally
@@ -298,7 +338,10 @@ public class MacCoreaudioStream
                     length);
         }
 
-        long bufferTimeStamp = System.nanoTime();
+        // Carry the time the audio has reached Java so that the time it spends
+        // in the capture queue, the mixer and the encoder may be traced.
+        if (bufferTimeStamp == Buffer.TIME_UNKNOWN)
+            bufferTimeStamp = System.nanoTime();
 
         buffer.setData(data);
         buffer.setFlags(Buffer.FLAG_SYSTEM_TIME);
@@ -365,6 +408,7 @@ public class MacCoreaudioStream
                 buffer = new byte[bytesPerBuffer];
                 nbBufferData = 0;
                 this.fullBufferList.clear();
+                this.fullBufferTimeStamps.clear();
                 this.freeBufferList.clear();
 
                 MacCoreaudioSystem.willOpenStream();
@@ -405,10 +449,36 @@ public class MacCoreaudioStream
                 if(stream != 0 && deviceUID != null)
                 {
                     Log.logMediaStackObjectStopped(this);
+
+                    long[] health = new long[AudioIOHealth.LENGTH];
+
+                    MacCoreAudioDevice.getStreamIOHealth(stream, health);
+                    AudioIOHealth.log(logger, "capture " + deviceUID, health);
+
+                    long[] aecMetrics = new long[AECMetrics.LENGTH];
+
+                    if (MacCoreAudioDevice.getStreamAECMetrics(
+                                stream,
+                                aecMetrics)
+                            > 0)
+                    {
+                        AECMetrics.log(
+                                logger,
+                                "capture " + deviceUID,
+                                aecMetrics);
+                    }
+                    long[] latency = new long[LatencyTracer.LENGTH];
+
+                    MacCoreAudioDevice.getStreamLatencySnapshot(
+                            stream,
+                            latency,
+                            false);
+                    LatencyTracer.log(logger, "capture " + deviceUID, latency);
                     MacCoreAudioDevice.stopStream(deviceUID, stream);
 
                     stream = 0;
                     this.fullBufferList.clear();
+                    this.fullBufferTimeStamps.clear();
                     this.freeBufferList.clear();
                     startStopCondition.signal();
                 }
@@ -429,8 +499,14 @@ public class MacCoreaudioStream
     public void readInput(byte[] buffer, int bufferLength)
     {
         int nbCopied = 0;
+        long now = System.nanoTime();
+
         while(bufferLength > 0)
         {
+            if(nbBufferData == 0)
+            {
+                bufferTimeStamp = now;
+            }
             int length = this.buffer.length - nbBufferData;
             if(bufferLength < length)
             {
@@ -450,6 +526,7 @@ public class MacCoreaudioStream
 
             if(nbBufferData == this.buffer.length)
             {
+                this.fullBufferTimeStamps.add(bufferTimeStamp);
                 this.fullBufferList.add(this.buffer);
                 this.buffer = null;
                 nbBufferData = 0;
@@ -137,6 +137,12 @@ public class AudioCaptureClient
      */
     private long iAudioClient;
 
+    /**
+     * The IO health of the capture stream of this instance allocated with
+     * <tt>WASAPI.IOHealth_alloc</tt>.
+     */
+    private long ioHealth;
+
     /**
      * The <tt>AudioFormat</tt> of the data output/made available by this
      * <tt>AudioCaptureClient</tt>.
@@ -380,6 +386,11 @@ public class AudioCaptureClient
             IAudioClient_Release(iAudioClient);
             iAudioClient = 0;
         }
+        if (ioHealth != 0)
+        {
+            IOHealth_free(ioHealth);
+            ioHealth = 0;
+        }
         if (eventHandle != 0)
         {
             try
@@ -626,6 +637,7 @@ public class AudioCaptureClient
                 int read
                     = IAudioCaptureClient_Read(
                             iAudioCaptureClient,
+                            ioHealth,
                             available, availableLength, toRead,
                             srcSampleSize, srcChannels,
                             dstSampleSize, dstChannels);
@@ -804,6 +816,10 @@ public class AudioCaptureClient
             {
                 IAudioClient_Start(iAudioClient);
                 started = true;
+                if (ioHealth == 0)
+                    ioHealth = IOHealth_alloc();
+                if (ioHealth != 0)
+                    IOHealth_setPeriod(ioHealth, devicePeriod * 1000000L);
 
                 availableLength = 0;
                 if ((eventHandle != 0) && (this.eventHandleCmd == null))
@@ -876,6 +892,14 @@ public class AudioCaptureClient
                 started = false;
                 waitWhileEventHandleCmd();
                 availableLength = 0;
+
+                if (ioHealth != 0)
+                {
+                    long[] health = new long[AudioIOHealth.LENGTH];
+
+                    IOHealth_get(ioHealth, health);
+                    AudioIOHealth.log(logger, "capture", health);
+                }
             }
             catch (HResultException hre)
             {
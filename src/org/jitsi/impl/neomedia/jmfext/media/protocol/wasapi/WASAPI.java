@@ -143,7 +143,7 @@ public class WASAPI
 
     static
     {
-        System.loadLibrary("jnwasapi");
+        NativeLibraryLoader.loadLibrary("jnwasapi", WASAPI.class);
 
         AUDCLNT_E_NOT_STOPPED
             = MAKE_HRESULT(SEVERITY_ERROR, FACILIY_AUDCLNT, 5);
@@ -224,6 +224,7 @@ public class WASAPI
 
     public static native int IAudioCaptureClient_Read(
             long thiz,
+            long ioHealth,
             byte[] data, int offset, int length,
             int srcSampleSize, int srcChannels,
             int dstSampleSize, int dstChannels)
@@ -306,6 +307,8 @@ public class WASAPI
      * @param thiz the <tt>IAudioRenderClient</tt> which abstracts the rendering
      * endpoint buffer into which the specified audio <tt>data</tt> is to be
      * written
+     * @param ioHealth the IO health of the stream returned by
+     * {@link #IOHealth_alloc()} or <tt>0</tt>
      * @param data the bytes of the audio samples to be written into the
      * specified rendering endpoint buffer
      * @param offset the offset in bytes within <tt>data</tt> at which valid
@@ -328,6 +331,7 @@ public class WASAPI
      */
     public static native int IAudioRenderClient_Write(
             long thiz,
+            long ioHealth,
             byte[] data, int offset, int length,
             int srcSampleSize, int srcChannels,
             int dstSampleSize, int dstChannels)
@@ -382,6 +386,55 @@ public class WASAPI
 
     public static native void IMMEndpoint_Release(long thiz);
 
+    /**
+     * Allocates the IO health of a capture or render stream, to be passed to
+     * <tt>IAudioCaptureClient_Read</tt> or <tt>IAudioRenderClient_Write</tt>
+     * and released with {@link #IOHealth_free(long)}.
+     *
+     * @return the IO health or <tt>0</tt> if the allocation fails
+     */
+    public static native long IOHealth_alloc();
+
+    public static native void IOHealth_free(long ioHealth);
+
+    /**
+     * Copies the IO health of a stream into a specific array laid out as
+     * documented for {@link org.jitsi.impl.neomedia.device.AudioIOHealth}.
+     * Each <tt>IAudioCaptureClient_Read</tt> or
+     * <tt>IAudioRenderClient_Write</tt> which exchanges audio counts as a
+     * callback.
+     *
+     * @param ioHealth the IO health returned by {@link #IOHealth_alloc()}
+     * @param values the array to copy the IO health into
+     * @return the number of values copied
+     */
+    public static native int IOHealth_get(long ioHealth, long[] values);
+
+    /**
+     * Reports the padding of the rendering endpoint buffer of a stream. The
+     * padding falling to <tt>0</tt> is counted as an underrun because the
+     * audio engine plays silence once it has consumed all queued audio.
+     *
+     * @param ioHealth the IO health returned by {@link #IOHealth_alloc()}
+     * @param numPaddingFrames the value returned by
+     * <tt>IAudioClient_GetCurrentPadding</tt>
+     */
+    public static native void IOHealth_setPadding(
+            long ioHealth,
+            int numPaddingFrames);
+
+    /**
+     * Sets the device period against which the IO health of a stream is
+     * measured and resets the IO health. Invoked when the stream is started,
+     * before any read or write.
+     *
+     * @param ioHealth the IO health returned by {@link #IOHealth_alloc()}
+     * @param periodNanos the device period in nanoseconds
+     */
+    public static native void IOHealth_setPeriod(
+            long ioHealth,
+            long periodNanos);
+
     public static native String IPropertyStore_GetString(long thiz, long key)
         throws HResultException;
 
@@ -15,6 +15,7 @@ import java.util.concurrent.locks.*;
 import javax.media.*;
 import javax.media.format.*;
 
+import org.jitsi.impl.neomedia.*;
 import org.jitsi.impl.neomedia.device.*;
 import org.jitsi.service.neomedia.*;
 import org.jitsi.util.*;
@@ -689,6 +690,22 @@ public class MacCoreaudioRenderer
                     if(stream != 0 && deviceUID != null)
                     {
                         Log.logMediaStackObjectStopped(this);
+
+                        long[] health = new long[AudioIOHealth.LENGTH];
+
+                        MacCoreAudioDevice.getStreamIOHealth(stream, health);
+                        AudioIOHealth.log(logger, "render " + deviceUID, health);
+
+                        long[] latency = new long[LatencyTracer.LENGTH];
+
+                        MacCoreAudioDevice.getStreamLatencySnapshot(
+                                stream,
+                                latency,
+                                false);
+                        LatencyTracer.log(
+                                logger,
+                                "render " + deviceUID,
+                                latency);
                         MacCoreAudioDevice.stopStream(deviceUID, stream);
 
                         stream = 0;
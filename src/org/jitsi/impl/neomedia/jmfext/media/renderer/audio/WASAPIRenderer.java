@@ -134,6 +134,12 @@ public class WASAPIRenderer
      */
     private long iAudioRenderClient;
 
+    /**
+     * The IO health of the render stream of this instance allocated with
+     * <tt>WASAPI.IOHealth_alloc</tt>.
+     */
+    private long ioHealth;
+
     /**
      * The indicator which determines whether the value of the <tt>locator</tt>
      * property of this instance was equal to null when this <tt>Renderer</tt>
@@ -389,6 +395,11 @@ public class WASAPIRenderer
                     + " released");
                 iAudioClient = 0;
             }
+            if (ioHealth != 0)
+            {
+                IOHealth_free(ioHealth);
+                ioHealth = 0;
+            }
             if (eventHandle != 0)
             {
                 try
@@ -617,6 +628,7 @@ public class WASAPIRenderer
             written
                 = IAudioRenderClient_Write(
                         iAudioRenderClient,
+                        ioHealth,
                         data, offset, length,
                         srcSampleSize, srcChannels,
                         dstSampleSize, dstChannels);
@@ -1450,6 +1462,9 @@ public class WASAPIRenderer
                         }
                     }
 
+                    if (ioHealth != 0)
+                        IOHealth_setPadding(ioHealth, numPaddingFrames);
+
                     int numFramesRequested = numBufferFrames - numPaddingFrames;
 
                     /*
@@ -1720,6 +1735,10 @@ public class WASAPIRenderer
                 IAudioClient_Start(iAudioClient);
                 logger.debug("Started audio client");
                 started = true;
+                if (ioHealth == 0)
+                    ioHealth = IOHealth_alloc();
+                if (ioHealth != 0)
+                    IOHealth_setPeriod(ioHealth, devicePeriod * 1000000L);
 
                 if ((eventHandle != 0) && (this.eventHandleCmd == null))
                 {
@@ -1810,6 +1829,14 @@ public class WASAPIRenderer
             }
 
             waitWhileEventHandleCmd();
+
+            if (ioHealth != 0)
+            {
+                long[] health = new long[AudioIOHealth.LENGTH];
+
+                IOHealth_get(ioHealth, health);
+                AudioIOHealth.log(logger, "render", health);
+            }
         }
     }
 
@@ -67,7 +67,7 @@ public class JAWTRenderer
 
     static
     {
-        System.loadLibrary("jnawtrenderer");
+        NativeLibraryLoader.loadLibrary("jnawtrenderer", JAWTRenderer.class);
     }
 
     /**
@@ -151,7 +151,9 @@ public class JAWTRenderer
      * <tt>offset</tt> which represent the data to be processed and rendered
      * @param width the width of the video frame in <tt>data</tt>
      * @param height the height of the video frame in <tt>data</tt>
-     * @return <tt>true</tt> if data has been successfully processed
+     * @return <tt>true</tt> if data has been successfully processed and the
+     * component is to be repainted; <tt>false</tt> if the processing failed or
+     * the frame has replaced one which is still waiting to be painted
      */
     static native boolean process(
             long handle,
@@ -164,6 +166,12 @@ public class JAWTRenderer
      */
     private Component component;
 
+    /**
+     * The number of frames which have been dropped because they were replaced
+     * by a newer frame before they could be painted.
+     */
+    private long droppedFrameCount = 0;
+
     /**
      * The handle to the native counterpart of this <tt>JAWTRenderer</tt>.
      */
@@ -175,6 +183,12 @@ public class JAWTRenderer
      */
     private int height = 0;
 
+    /**
+     * The number of frames which have been handed to the native counterpart
+     * of this <tt>JAWTRenderer</tt> to be painted.
+     */
+    private long presentedFrameCount = 0;
+
     /**
      * The <tt>Runnable</tt> which is executed to bring the invocations of
      * {@link #reflectInputFormatOnComponent()} into the AWT event dispatching
@@ -212,9 +226,39 @@ public class JAWTRenderer
         {
             close(handle, component);
             handle = 0;
+
+            if (logger.isDebugEnabled()
+                    && ((presentedFrameCount != 0) || (droppedFrameCount != 0)))
+            {
+                logger.debug(
+                        "Presented " + presentedFrameCount + " and dropped "
+                            + droppedFrameCount + " frames.");
+            }
         }
     }
 
+    /**
+     * Gets the number of frames which have been dropped because they were
+     * replaced by a newer frame before they could be painted.
+     *
+     * @return the number of dropped frames
+     */
+    public synchronized long getDroppedFrameCount()
+    {
+        return droppedFrameCount;
+    }
+
+    /**
+     * Gets the number of frames which have been handed to the native
+     * counterpart of this <tt>JAWTRenderer</tt> to be painted.
+     *
+     * @return the number of presented frames
+     */
+    public synchronized long getPresentedFrameCount()
+    {
+        return presentedFrameCount;
+    }
+
     /**
      * Gets the region in the component of this <tt>VideoRenderer</tt> where the
      * video is rendered. <tt>JAWTRenderer</tt> always uses the entire component
@@ -450,7 +494,14 @@ public class JAWTRenderer
                             size.height);
 
                 if (repaint)
+                {
+                    presentedFrameCount++;
                     component.repaint();
+                }
+                else
+                {
+                    droppedFrameCount++;
+                }
             }
 
             return BUFFER_PROCESSED_OK;
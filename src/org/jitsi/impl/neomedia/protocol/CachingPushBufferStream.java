@@ -31,6 +31,13 @@ import org.jitsi.util.*;
  * <tt>PushBufferStream</tt> "play" itself faster than the
  * <tt>CaptureDevice</tt>.
  * </p>
+ * <p>
+ * Linear audio is passed through a {@link NativePcmFifo} where it is
+ * available. The pushing thread then neither waits for room nor allocates a
+ * <tt>Buffer</tt> per push, and the reading thread takes no lock: when the
+ * reader falls behind by more than the buffer length, the oldest audio is
+ * dropped rather than the pushing thread blocked.
+ * </p>
  *
  * @author Lyubomir Marinov
  */
@@ -58,11 +65,17 @@ public class CachingPushBufferStream
      */
     private static final int MAX_CACHE_SIZE = 1024;
 
+    /**
+     * The factor by which the capacity of {@link #fifo} exceeds the buffer
+     * length so that the latter may grow without the former being replaced.
+     */
+    private static final int FIFO_CAPACITY_FACTOR = 2;
+
     /**
      * The <tt>BufferControl</tt> of this <tt>PushBufferStream</tt> which allows
      * the adjustment of the size of the buffering it performs.
      */
-    private BufferControl bufferControl;
+    private volatile BufferControl bufferControl;
 
     /**
      * The <tt>Object</tt> which synchronizes the access to
@@ -83,13 +96,38 @@ public class CachingPushBufferStream
      */
     private long cacheLengthInMillis = 0;
 
+    /**
+     * The <tt>NativePcmFifo</tt> through which the audio read from the
+     * wrapped <tt>PushBufferStream</tt> is passed instead of {@link #cache} or
+     * <tt>null</tt> if <tt>cache</tt> is used.
+     */
+    private volatile NativePcmFifo fifo;
+
+    /**
+     * The indicator which determines whether {@link #fifo} may be used.
+     */
+    private final boolean fifoEnabled = NativePcmFifo.isEnabled();
+
+    /**
+     * The <tt>Buffer</tt> into which the wrapped <tt>PushBufferStream</tt> is
+     * read when {@link #fifo} is used, reused so that no garbage is produced
+     * per push.
+     */
+    private Buffer fifoInBuffer = new Buffer();
+
+    /**
+     * The <tt>Object</tt> which synchronizes the writing into {@link #fifo}
+     * so that it only ever has a single producer.
+     */
+    private final Object fifoWriteSyncRoot = new Object();
+
     /**
      * The last <tt>IOException</tt> this stream has received from the
      * <tt>#read(Buffer)</tt> method of the wrapped stream and to be thrown
      * by this stream on the earliest call of its <tt>#read(Buffer)</tt>
      * method.
      */
-    private IOException readException;
+    private volatile IOException readException;
 
     /**
      * The <tt>PushBufferStream</tt> being paced by this instance with
@@ -100,7 +138,7 @@ public class CachingPushBufferStream
     /**
      * The <tt>BufferTransferHandler</tt> set on {@link #stream}.
      */
-    private BufferTransferHandler transferHandler;
+    private volatile BufferTransferHandler transferHandler;
 
     /**
      * Initializes a new <tt>CachingPushBufferStream</tt> instance which is
@@ -212,13 +250,12 @@ public class CachingPushBufferStream
      */
     private long getBufferLength()
     {
-        synchronized (bufferControlSyncRoot)
-        {
-            return
-                (bufferControl == null)
-                    ? BufferControl.DEFAULT_VALUE
-                    : bufferControl.getBufferLength();
-        }
+        BufferControl bufferControl = this.bufferControl;
+
+        return
+            (bufferControl == null)
+                ? BufferControl.DEFAULT_VALUE
+                : bufferControl.getBufferLength();
     }
 
     /**
@@ -338,6 +375,25 @@ public class CachingPushBufferStream
         return stream.getFormat();
     }
 
+    /**
+     * Gets the length in milliseconds of the media which has been read from
+     * the wrapped <tt>PushBufferStream</tt> and is yet to be read from this
+     * instance.
+     *
+     * @return the fill level of the buffering of this instance in milliseconds
+     */
+    public long getFillInMillis()
+    {
+        NativePcmFifo fifo = this.fifo;
+
+        if (fifo != null)
+            return fifo.getFillInMillis();
+        synchronized (cache)
+        {
+            return cacheLengthInMillis;
+        }
+    }
+
     /**
      * Gets the length in milliseconds of the media in a specific
      * <tt>Buffer</tt> (often referred to as duration).
@@ -396,6 +452,14 @@ public class CachingPushBufferStream
     public void read(Buffer buffer)
         throws IOException
     {
+        NativePcmFifo fifo = this.fifo;
+
+        if ((fifo != null) && (readException == null))
+        {
+            read(fifo, buffer);
+            return;
+        }
+
         synchronized (cache)
         {
             if (readException != null)
@@ -438,6 +502,54 @@ public class CachingPushBufferStream
         }
     }
 
+    /**
+     * Reads from a specific <tt>NativePcmFifo</tt> as much audio as fits into
+     * a specific <tt>Buffer</tt>. The array of the <tt>Buffer</tt> is used if
+     * it is a <tt>byte</tt> array; otherwise, an array for all the audio
+     * available is allocated.
+     *
+     * @param fifo the <tt>NativePcmFifo</tt> to read from
+     * @param buffer the <tt>Buffer</tt> to receive the read audio
+     */
+    private void read(NativePcmFifo fifo, Buffer buffer)
+    {
+        Object data = buffer.getData();
+        int offset = buffer.getOffset();
+        byte[] bytes;
+
+        buffer.setLength(0);
+        if ((data instanceof byte[]) && (((byte[]) data).length > offset))
+        {
+            bytes = (byte[]) data;
+        }
+        else
+        {
+            int fill = fifo.getFill();
+
+            if (fill < 1)
+                return;
+            bytes = new byte[fill];
+            offset = 0;
+        }
+
+        int length = fifo.read(bytes, offset, bytes.length - offset);
+
+        if (length > 0)
+        {
+            Log.logReceivedBytes(this, length);
+
+            buffer.setData(bytes);
+            buffer.setOffset(offset);
+            buffer.setLength(length);
+            buffer.setFormat(fifo.getFormat());
+            buffer.setDiscard(false);
+            buffer.setEOM(false);
+            buffer.setFlags(fifo.getReadFlags());
+            buffer.setTimeStamp(fifo.getReadTimeStamp());
+            buffer.setDuration(Buffer.TIME_UNKNOWN);
+        }
+    }
+
     /**
      * Reads data from a specific input <tt>Buffer</tt> (if such data is
      * available) and writes the read data into a specific output
@@ -598,6 +710,37 @@ public class CachingPushBufferStream
             this.transferHandler = substituteTransferHandler;
             cache.notifyAll();
         }
+
+        if (transferHandler == null)
+        {
+            NativePcmFifo fifo = this.fifo;
+
+            if (fifo != null)
+                logFifoStats(fifo);
+        }
+    }
+
+    /**
+     * Logs the statistics of a specific <tt>NativePcmFifo</tt> of this
+     * instance.
+     *
+     * @param fifo the <tt>NativePcmFifo</tt> to log the statistics of
+     */
+    private void logFifoStats(NativePcmFifo fifo)
+    {
+        long[] stats = fifo.getStats();
+
+        logger.info(
+                "CachingPushBufferStream " + hashCode() + " FIFO of "
+                    + fifo.getCapacityInMillis() + " ms: read "
+                    + fifo.toMillis(stats[NativePcmFifo.STAT_BYTES_READ])
+                    + " ms, dropped "
+                    + fifo.toMillis(stats[NativePcmFifo.STAT_BYTES_DROPPED])
+                    + " ms in " + stats[NativePcmFifo.STAT_OVERFLOWS]
+                    + " overflows, " + stats[NativePcmFifo.STAT_UNDERRUNS]
+                    + " underruns, maximum fill "
+                    + fifo.toMillis(stats[NativePcmFifo.STAT_MAX_FILL_BYTES])
+                    + " ms");
     }
 
     /**
@@ -612,6 +755,9 @@ public class CachingPushBufferStream
      */
     protected void transferData(BufferTransferHandler transferHandler)
     {
+        if (fifoEnabled && transferDataToFifo(transferHandler))
+            return;
+
         /*
          * Obviously, we cannot cache every Buffer because we will run out of
          * memory. So wait for room to appear within cache (or for this instance
@@ -707,6 +853,116 @@ public class CachingPushBufferStream
         }
     }
 
+    /**
+     * Reads data from the wrapped/input <tt>PushBufferStream</tt> into
+     * {@link #fifo} if the wrapped stream provides linear audio, dropping the
+     * oldest audio in <tt>fifo</tt> if it would otherwise hold more than the
+     * buffer length. Never blocks the calling thread.
+     *
+     * @param transferHandler the <tt>BufferTransferHandler</tt> which has been
+     * notified
+     * @return <tt>true</tt> if the wrapped stream has been handled;
+     * <tt>false</tt> if its media is to be read into {@link #cache} instead
+     */
+    private boolean transferDataToFifo(BufferTransferHandler transferHandler)
+    {
+        if (!NativePcmFifo.isSupported(stream.getFormat()))
+            return false;
+
+        synchronized (fifoWriteSyncRoot)
+        {
+            /*
+             * The specified transferHandler has already been obsoleted/replaced
+             * so it does not have the right to cause a read or a write.
+             */
+            if (this.transferHandler != transferHandler)
+                return true;
+
+            Buffer buffer = fifoInBuffer;
+
+            buffer.setDiscard(false);
+            buffer.setEOM(false);
+            buffer.setFlags(0);
+            buffer.setFormat(null);
+            buffer.setLength(0);
+            buffer.setOffset(0);
+            buffer.setTimeStamp(Buffer.TIME_UNKNOWN);
+            try
+            {
+                stream.read(buffer);
+            }
+            catch (IOException ioe)
+            {
+                readException = ioe;
+                fifo = null;
+                return true;
+            }
+            if (buffer.isDiscard()
+                    || (buffer.getLength() < 1)
+                    || !(buffer.getData() instanceof byte[]))
+                return true;
+
+            Format format = buffer.getFormat();
+
+            if (format == null)
+                format = stream.getFormat();
+
+            long bufferLength = getBufferLength();
+
+            if (bufferLength < 1)
+                bufferLength = DEFAULT_BUFFER_LENGTH;
+
+            NativePcmFifo fifo = this.fifo;
+
+            if ((fifo == null)
+                    || !fifo.getFormat().equals(format)
+                    || (fifo.getCapacityInMillis() < bufferLength))
+            {
+                if (fifo != null)
+                    logFifoStats(fifo);
+                fifo
+                    = NativePcmFifo.isSupported(format)
+                        ? NativePcmFifo.create(
+                                (AudioFormat) format,
+                                FIFO_CAPACITY_FACTOR
+                                    * Math.max(
+                                            bufferLength,
+                                            DEFAULT_BUFFER_LENGTH))
+                        : null;
+                synchronized (cache)
+                {
+                    if (fifo == null)
+                    {
+                        /*
+                         * The media cannot pass through a FIFO so it goes into
+                         * the cache and the Buffer is given away with it.
+                         */
+                        cache.add(buffer);
+                        cacheLengthInMillis += getLengthInMillis(buffer);
+                        fifoInBuffer = new Buffer();
+                    }
+                    else
+                    {
+                        cache.clear();
+                        cacheLengthInMillis = 0;
+                    }
+                    this.fifo = fifo;
+                }
+                if (fifo == null)
+                    return true;
+            }
+
+            fifo.write(
+                    (byte[]) buffer.getData(),
+                    buffer.getOffset(),
+                    buffer.getLength(),
+                    bufferLength,
+                    buffer.getTimeStamp(),
+                    buffer.getFlags());
+        }
+        return true;
+    }
+
     /**
      * Implements a <tt>BufferControl</tt> which enables the adjustment of the
      * length of the buffering performed by a <tt>CachingPushBufferStream</tt>.
@@ -718,7 +974,7 @@ public class CachingPushBufferStream
          * The length of the buffering to be performed by the owner of this
          * instance.
          */
-        private long bufferLength = DEFAULT_VALUE;
+        private volatile long bufferLength = DEFAULT_VALUE;
 
         /**
          * The indicator which determines whether threshold calculations are
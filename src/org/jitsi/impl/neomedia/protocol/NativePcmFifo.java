@@ -0,0 +1,565 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.protocol;
+
+import java.lang.ref.*;
+import java.util.concurrent.atomic.*;
+
+import javax.media.*;
+import javax.media.format.*;
+
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.util.*;
+
+/**
+ * A FIFO of PCM audio in native memory between a single producer and a single
+ * consumer thread, sized in milliseconds. Neither {@link #write} nor
+ * {@link #read} blocks or takes a lock. When a write would make the FIFO hold
+ * more than the specified limit, the oldest audio in it is dropped so that
+ * the latency through the FIFO stays bounded.
+ * <p>
+ * The native memory is released once the instance is no longer reachable,
+ * so that a consumer may keep reading from an instance which the producer
+ * has just replaced.
+ * </p>
+ * <p>
+ * The time stamp and the flags of each write are kept with the position in
+ * the FIFO of its first byte, so that each read is stamped with the time of
+ * the oldest audio it returns rather than with that of the last write.
+ * </p>
+ */
+public class NativePcmFifo
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>NativePcmFifo</tt> class and its
+     * instances for logging output.
+     */
+    private static final Logger logger = Logger.getLogger(NativePcmFifo.class);
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which enables
+     * the native FIFO in <tt>CachingPushBufferStream</tt> where it is
+     * available.
+     */
+    public static final String ENABLED_PNAME
+        = "org.jitsi.impl.neomedia.protocol.NativePcmFifo.enabled";
+
+    /**
+     * The indexes of the statistics returned by {@link #getStats()}.
+     */
+    public static final int STAT_BYTES_WRITTEN = 0;
+    public static final int STAT_BYTES_READ = 1;
+    public static final int STAT_BYTES_DROPPED = 2;
+    public static final int STAT_OVERFLOWS = 3;
+    public static final int STAT_UNDERRUNS = 4;
+    public static final int STAT_MAX_FILL_BYTES = 5;
+
+    private static final int STATS_LENGTH = 6;
+
+    /**
+     * The number of the most recent writes of which the positions, the time
+     * stamps and the flags are kept.
+     */
+    private static final int MARKS_LENGTH = 64;
+
+    /**
+     * The number of values kept per write in {@link #marks}: the position of
+     * its first byte, its time stamp and its flags.
+     */
+    private static final int MARK_LENGTH = 3;
+
+    /**
+     * The <tt>Cleaner</tt> which destroys the native FIFOs of the instances
+     * which are no longer reachable.
+     */
+    private static final Cleaner cleaner = Cleaner.create();
+
+    /**
+     * Tells if the jnpcm library is correctly loaded.
+     */
+    public static final boolean isLoaded;
+
+    static
+    {
+        boolean loaded = false;
+
+        try
+        {
+            NativeLibraryLoader.loadLibrary("jnpcm", NativePcmFifo.class);
+            loaded = true;
+        }
+        catch (NullPointerException | UnsatisfiedLinkError | SecurityException e)
+        {
+            logger.info("Not using the native PCM FIFO: " + e.getMessage());
+        }
+        isLoaded = loaded;
+    }
+
+    private static native long create(int capacity, int frameSize);
+
+    private static native void destroy(long fifo);
+
+    private static native int getFill(long fifo);
+
+    private static native void getStats(long fifo, long[] stats);
+
+    private static native int read(
+            long fifo,
+            byte[] out, int offset, int length,
+            long[] position);
+
+    private static native int write(
+            long fifo,
+            byte[] in, int offset, int length,
+            int limit);
+
+    /**
+     * Determines whether the native FIFO is available and enabled.
+     *
+     * @return <tt>true</tt> if the native FIFO is to be used
+     */
+    public static boolean isEnabled()
+    {
+        if (!isLoaded)
+            return false;
+
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+
+        return (cfg == null) || cfg.global().getBoolean(ENABLED_PNAME, true);
+    }
+
+    /**
+     * Determines whether a specific <tt>Format</tt> is of audio which may be
+     * passed through a <tt>NativePcmFifo</tt>.
+     *
+     * @param format the <tt>Format</tt> to check
+     * @return <tt>true</tt> if <tt>format</tt> is of linear audio in whole
+     * bytes with a known sample rate and number of channels
+     */
+    public static boolean isSupported(Format format)
+    {
+        if (!(format instanceof AudioFormat)
+                || !Format.byteArray.equals(format.getDataType()))
+            return false;
+
+        AudioFormat audioFormat = (AudioFormat) format;
+        int sampleSizeInBits = audioFormat.getSampleSizeInBits();
+
+        return
+            AudioFormat.LINEAR.equalsIgnoreCase(audioFormat.getEncoding())
+                && (audioFormat.getSampleRate() > 0)
+                && (audioFormat.getChannels() > 0)
+                && (sampleSizeInBits > 0)
+                && (sampleSizeInBits % 8 == 0);
+    }
+
+    /**
+     * Creates a new <tt>NativePcmFifo</tt> for audio in a specific format.
+     *
+     * @param format the format of the audio to pass through the new FIFO
+     * @param capacityInMillis the length in milliseconds of the audio which
+     * the new FIFO is to be able to hold
+     * @return a new <tt>NativePcmFifo</tt> or <tt>null</tt> if the native FIFO
+     * is not available for <tt>format</tt>
+     */
+    public static NativePcmFifo create(
+            AudioFormat format,
+            long capacityInMillis)
+    {
+        if (!isLoaded || !isSupported(format) || (capacityInMillis < 1))
+            return null;
+
+        int frameSize
+            = format.getChannels() * (format.getSampleSizeInBits() / 8);
+        double bytesPerMilli = format.getSampleRate() * frameSize / 1000d;
+        long capacity = (long) (capacityInMillis * bytesPerMilli);
+
+        if (capacity > Integer.MAX_VALUE)
+            return null;
+
+        long fifo = create((int) capacity, frameSize);
+
+        if (fifo == 0)
+        {
+            logger.warn("Failed to create native PCM FIFO for " + format);
+            return null;
+        }
+        return new NativePcmFifo(fifo, format, frameSize, capacityInMillis);
+    }
+
+    /**
+     * The number of bytes per millisecond of the audio in this FIFO.
+     */
+    private final double bytesPerMilli;
+
+    /**
+     * The length in milliseconds of the audio which this FIFO may hold.
+     */
+    private final long capacityInMillis;
+
+    /**
+     * The native <tt>PcmFifo</tt>.
+     */
+    private final long fifo;
+
+    /**
+     * The format of the audio in this FIFO.
+     */
+    private final AudioFormat format;
+
+    /**
+     * The size in bytes of a frame i.e. a sample of all channels.
+     */
+    private final int frameSize;
+
+    /**
+     * The number of writes into this FIFO. Written by the producer only, after
+     * the mark of the write has been stored in {@link #marks}.
+     */
+    private volatile long markCount = 0;
+
+    /**
+     * The positions, the time stamps and the flags of the last
+     * {@link #MARKS_LENGTH} writes into this FIFO, indexed by the number of
+     * the write modulo <tt>MARKS_LENGTH</tt>.
+     */
+    private final AtomicLongArray marks
+        = new AtomicLongArray(MARKS_LENGTH * MARK_LENGTH);
+
+    /**
+     * The flags of the write which the first byte last read belongs to. Used
+     * by the consumer only.
+     */
+    private int readFlags = 0;
+
+    /**
+     * The position of the first byte last read, reused by the consumer so that
+     * no garbage is produced per read.
+     */
+    private final long[] readPosition = new long[1];
+
+    /**
+     * The time stamp of the first byte last read. Used by the consumer only.
+     */
+    private long readTimeStamp = Buffer.TIME_UNKNOWN;
+
+    /**
+     * The number of bytes written into this FIFO. Used by the producer only.
+     */
+    private long writePosition = 0;
+
+    private NativePcmFifo(
+            long fifo,
+            AudioFormat format,
+            int frameSize,
+            long capacityInMillis)
+    {
+        this.fifo = fifo;
+        this.format = format;
+        this.frameSize = frameSize;
+        this.capacityInMillis = capacityInMillis;
+        bytesPerMilli = format.getSampleRate() * frameSize / 1000d;
+
+        cleaner.register(this, () -> destroy(fifo));
+    }
+
+    /**
+     * Advances a time stamp of the audio in this FIFO by the duration of a
+     * specific number of bytes. Time stamps which are unknown or in RTP time
+     * are left as they are.
+     *
+     * @param timeStamp the time stamp in nanoseconds
+     * @param flags the <tt>Buffer</tt> flags which <tt>timeStamp</tt> comes
+     * with
+     * @param bytes the number of bytes, negative to go back in time
+     * @return <tt>timeStamp</tt> advanced by the duration of <tt>bytes</tt>
+     */
+    private long advance(long timeStamp, int flags, long bytes)
+    {
+        if ((timeStamp == Buffer.TIME_UNKNOWN)
+                || ((flags & Buffer.FLAG_RTP_TIME) != 0))
+            return timeStamp;
+        return timeStamp + (long) (bytes * 1000000d / bytesPerMilli);
+    }
+
+    /**
+     * Gets the length in milliseconds of the audio which this FIFO may hold.
+     *
+     * @return the capacity of this FIFO in milliseconds
+     */
+    public long getCapacityInMillis()
+    {
+        return capacityInMillis;
+    }
+
+    /**
+     * Gets the length in bytes of the audio available for reading.
+     *
+     * @return the fill level of this FIFO in bytes
+     */
+    public int getFill()
+    {
+        try
+        {
+            return getFill(fifo);
+        }
+        finally
+        {
+            Reference.reachabilityFence(this);
+        }
+    }
+
+    /**
+     * Gets the length in milliseconds of the audio available for reading.
+     *
+     * @return the fill level of this FIFO in milliseconds
+     */
+    public long getFillInMillis()
+    {
+        return toMillis(getFill());
+    }
+
+    /**
+     * Gets the format of the audio in this FIFO.
+     *
+     * @return the format of the audio in this FIFO
+     */
+    public AudioFormat getFormat()
+    {
+        return format;
+    }
+
+    /**
+     * Gets the flags of the write which the first byte returned by the last
+     * {@link #read} belongs to. May be called by the consumer thread only.
+     *
+     * @return the flags of the audio last read
+     */
+    public int getReadFlags()
+    {
+        return readFlags;
+    }
+
+    /**
+     * Gets the time stamp of the first byte returned by the last
+     * {@link #read}, i.e. the time stamp of the write it belongs to advanced
+     * by the duration of the audio which preceded it in that write. May be
+     * called by the consumer thread only.
+     *
+     * @return the time stamp of the audio last read or
+     * <tt>Buffer.TIME_UNKNOWN</tt>
+     */
+    public long getReadTimeStamp()
+    {
+        return readTimeStamp;
+    }
+
+    /**
+     * Gets the statistics of this <tt>NativePcmFifo</tt>.
+     *
+     * @return the statistics indexed by the <tt>STAT_</tt> constants
+     */
+    public long[] getStats()
+    {
+        long[] stats = new long[STATS_LENGTH];
+
+        try
+        {
+            getStats(fifo, stats);
+        }
+        finally
+        {
+            Reference.reachabilityFence(this);
+        }
+        return stats;
+    }
+
+    /**
+     * Stores the position, the time stamp and the flags of the write which is
+     * about to be made. Called by the producer only.
+     *
+     * @param timeStamp the time stamp of the first byte of the write
+     * @param flags the flags of the write
+     */
+    private void mark(long timeStamp, int flags)
+    {
+        long count = markCount;
+        int index = (int) (count % MARKS_LENGTH) * MARK_LENGTH;
+
+        marks.set(index, writePosition);
+        marks.set(index + 1, timeStamp);
+        marks.set(index + 2, flags);
+        markCount = count + 1;
+    }
+
+    /**
+     * Reads whole frames from this FIFO and makes their time stamp and flags
+     * available through {@link #getReadTimeStamp()} and
+     * {@link #getReadFlags()}. May be called by the consumer thread only.
+     *
+     * @param out the array to read into
+     * @param offset the offset in <tt>out</tt> at which to start writing
+     * @param length the maximum number of bytes to read
+     * @return the number of bytes read, <tt>0</tt> if this FIFO is empty
+     */
+    public int read(byte[] out, int offset, int length)
+    {
+        if ((offset < 0) || (length < 0) || (offset + length > out.length))
+            throw new ArrayIndexOutOfBoundsException(offset + length);
+        if (length < frameSize)
+            return 0;
+
+        int read;
+
+        try
+        {
+            read = read(fifo, out, offset, length, readPosition);
+        }
+        finally
+        {
+            Reference.reachabilityFence(this);
+        }
+        if (read > 0)
+            setReadMark(readPosition[0]);
+        return read;
+    }
+
+    /**
+     * Sets {@link #readTimeStamp} and {@link #readFlags} from the mark of the
+     * write which a specific position in this FIFO belongs to. Called by the
+     * consumer only.
+     *
+     * @param position the position of the first byte read
+     */
+    private void setReadMark(long position)
+    {
+        while (true)
+        {
+            long count = markCount;
+
+            if (count < 1)
+            {
+                readTimeStamp = Buffer.TIME_UNKNOWN;
+                readFlags = 0;
+                return;
+            }
+
+            /*
+             * The newest write which starts at or before position. If position
+             * precedes all the kept writes, the oldest one is extrapolated.
+             */
+            long oldest = Math.max(0, count - MARKS_LENGTH);
+            long mark = count - 1;
+
+            while ((mark > oldest)
+                    && (marks.get((int) (mark % MARKS_LENGTH) * MARK_LENGTH)
+                            > position))
+                mark--;
+
+            int index = (int) (mark % MARKS_LENGTH) * MARK_LENGTH;
+            long markPosition = marks.get(index);
+            long timeStamp = marks.get(index + 1);
+            int flags = (int) marks.get(index + 2);
+
+            // The producer may have reused the mark while it was being read.
+            if (markCount - mark < MARKS_LENGTH)
+            {
+                readTimeStamp
+                    = advance(timeStamp, flags, position - markPosition);
+                readFlags = flags;
+                return;
+            }
+        }
+    }
+
+    /**
+     * Converts a length in bytes of the audio in this FIFO to a length in
+     * milliseconds.
+     *
+     * @param bytes the length in bytes
+     * @return the length in milliseconds of <tt>bytes</tt> of audio
+     */
+    public long toMillis(long bytes)
+    {
+        return (long) (bytes / bytesPerMilli);
+    }
+
+    /**
+     * Converts a length in milliseconds to a length in bytes of whole frames
+     * of the audio in this FIFO.
+     *
+     * @param millis the length in milliseconds
+     * @return the length in bytes of <tt>millis</tt> of audio
+     */
+    public int toBytes(long millis)
+    {
+        int bytes = (int) (Math.min(millis, capacityInMillis) * bytesPerMilli);
+
+        return bytes - (bytes % frameSize);
+    }
+
+    /**
+     * Writes whole frames into this FIFO, dropping the oldest audio in it if
+     * it would otherwise hold more than a specific length of audio. May be
+     * called by the producer thread only.
+     *
+     * @param in the array of the frames to write
+     * @param offset the offset in <tt>in</tt> of the frames to write
+     * @param length the number of bytes to write
+     * @param limitInMillis the maximum length in milliseconds of the audio to
+     * be held by this FIFO, at most its capacity
+     * @param timeStamp the time stamp of the first frame to write
+     * @param flags the <tt>Buffer</tt> flags of the frames to write
+     * @return the number of bytes dropped
+     */
+    public int write(
+            byte[] in, int offset, int length,
+            long limitInMillis,
+            long timeStamp, int flags)
+    {
+        if ((offset < 0) || (length < 0) || (offset + length > in.length))
+            throw new ArrayIndexOutOfBoundsException(offset + length);
+        length -= length % frameSize;
+        if (length < 1)
+            return 0;
+
+        int limit = toBytes(limitInMillis);
+
+        if (limit < frameSize)
+            limit = toBytes(capacityInMillis);
+
+        /*
+         * Skip what does not fit here rather than in the native FIFO so that
+         * the mark of the write is the position of its first byte kept.
+         */
+        int skipped = 0;
+
+        if (length > limit)
+        {
+            skipped = length - limit;
+            offset += skipped;
+            length = limit;
+            timeStamp = advance(timeStamp, flags, skipped);
+        }
+
+        int dropped;
+
+        mark(timeStamp, flags);
+        try
+        {
+            dropped = write(fifo, in, offset, length, limit);
+        }
+        finally
+        {
+            Reference.reachabilityFence(this);
+        }
+        writePosition += length;
+        return skipped + dropped;
+    }
+}
@@ -30,6 +30,13 @@ public class ControlTransformInputStream
     private final List<RTCPFeedbackListener> listeners
         = new LinkedList<>();
 
+    /**
+     * The <tt>RTPConnectorOutputStream</tt> which resends the RTP packets
+     * requested by the generic NACKs received through this instance or
+     * <tt>null</tt> if NACKs are ignored.
+     */
+    private volatile RTPConnectorOutputStream retransmitter;
+
     /**
      * Initializes a new <tt>ControlTransformInputStream</tt> which is to
      * receive packet data from a specific UDP socket.
@@ -54,6 +61,18 @@ public class ControlTransformInputStream
             listeners.add(listener);
     }
 
+    /**
+     * Sets the <tt>RTPConnectorOutputStream</tt> which is to resend the RTP
+     * packets requested by the generic NACKs received through this instance.
+     *
+     * @param retransmitter the <tt>RTPConnectorOutputStream</tt> to resend
+     * the requested packets or <tt>null</tt> to ignore NACKs
+     */
+    public void setRetransmitter(RTPConnectorOutputStream retransmitter)
+    {
+        this.retransmitter = retransmitter;
+    }
+
     /**
      * Copies the content of the most recently received packet into
      * <tt>inBuffer</tt>.
@@ -81,6 +100,11 @@ public class ControlTransformInputStream
                 buffer, offset, pktLength,
                 listeners);
 
+        RTPConnectorOutputStream retransmitter = this.retransmitter;
+
+        if ((retransmitter != null) && (pktLength > 0))
+            retransmitter.retransmit(buffer, offset, pktLength);
+
         return pktLength;
     }
 }
@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia.transform;
 
 import org.jitsi.impl.neomedia.*;
@@ -98,6 +99,16 @@ public class TransformEngineChain
          */
         private final boolean isRtp;
 
+        /**
+         * The engines of this chain, in order, or an empty array once this
+         * transformer is closed. The <tt>PacketTransformer</tt> of each engine
+         * is resolved per packet rather than once because an engine may
+         * replace or drop it, e.g. <tt>SDesTransformEngine</tt> drops its
+         * transformers when the <tt>SrtpControl</tt> is cleaned up, which
+         * happens before the stream stops transforming packets.
+         */
+        private volatile TransformEngine[] engines;
+
         /**
          * Creates an instance of this packet transformer and prepares it to
          * deal with RTP or RTCP according to the <tt>isRtp</tt> arg.
@@ -109,6 +120,22 @@ public class TransformEngineChain
         public PacketTransformerChain(boolean isRtp)
         {
             this.isRtp = isRtp;
+            engines = engineChain;
+        }
+
+        /**
+         * Gets the current <tt>PacketTransformer</tt> of a specific engine
+         * which deals with the kind of packets of this transformer.
+         *
+         * @param engine the engine
+         * @return the <tt>PacketTransformer</tt> of <tt>engine</tt> or
+         * <tt>null</tt> if it does not transform the packets of this
+         * transformer (anymore)
+         */
+        private PacketTransformer getTransformer(TransformEngine engine)
+        {
+            return
+                isRtp ? engine.getRTPTransformer() : engine.getRTCPTransformer();
         }
 
         /**
@@ -119,16 +146,16 @@ public class TransformEngineChain
         @Override
         public void close()
         {
-            for (TransformEngine engine : engineChain)
+            TransformEngine[] engines = this.engines;
+
+            this.engines = new TransformEngine[0];
+            for (TransformEngine engine : engines)
             {
-                PacketTransformer pTransformer
-                    = isRtp
-                        ? engine.getRTPTransformer()
-                        : engine.getRTCPTransformer();
+                PacketTransformer pTransformer = getTransformer(engine);
 
                 //the packet transformer may be null if for example the engine
                 //only does RTP transformations and this is an RTCP transformer.
-                if( pTransformer != null)
+                if (pTransformer != null)
                     pTransformer.close();
             }
         }
@@ -142,16 +169,11 @@ public class TransformEngineChain
         @Override
         public RawPacket transform(RawPacket pkt)
         {
-            for (TransformEngine engine : engineChain)
+            for (TransformEngine engine : engines)
             {
-                PacketTransformer pTransformer
-                    = isRtp
-                        ? engine.getRTPTransformer()
-                        : engine.getRTCPTransformer();
+                PacketTransformer pTransformer = getTransformer(engine);
 
-                //the packet transformer may be null if for example the engine
-                //only does RTP transformations and this is an RTCP transformer.
-                if( pTransformer != null)
+                if (pTransformer != null)
                     pkt = pTransformer.transform(pkt);
             }
 
@@ -168,17 +190,13 @@ public class TransformEngineChain
         @Override
         public RawPacket reverseTransform(RawPacket pkt)
         {
-            for (int i = engineChain.length - 1 ; i >= 0; i--)
+            TransformEngine[] engines = this.engines;
+
+            for (int i = engines.length - 1 ; i >= 0; i--)
             {
-                TransformEngine engine = engineChain[i];
-                PacketTransformer pTransformer
-                    = isRtp
-                        ? engine.getRTPTransformer()
-                        : engine.getRTCPTransformer();
+                PacketTransformer pTransformer = getTransformer(engines[i]);
 
-                //the packet transformer may be null if for example the engine
-                //only does RTP transformations and this is an RTCP transformer.
-                if( pTransformer != null)
+                if (pTransformer != null)
                 {
                     pkt = pTransformer.reverseTransform(pkt);
                     if (pkt == null)
@@ -4,10 +4,10 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia.transform.pt;
 
 import java.util.*;
-import java.util.concurrent.*;
 
 import org.jitsi.impl.neomedia.*;
 import org.jitsi.impl.neomedia.transform.*;
@@ -28,12 +28,13 @@ public class PayloadTypeTransformEngine
                PacketTransformer
 {
     /**
-     * The mapping we use to override payloads. By default it is empty
-     * and we do nothing, packets are passed through without modification.
-     * Maps source payload to target payload.
+     * The mapping we use to override payloads, indexed by source payload type
+     * and holding the target payload type or <tt>-1</tt> to keep the source.
+     * By default it is <tt>null</tt> and we do nothing, packets are passed
+     * through without modification. Replaced rather than modified so that
+     * packets are transformed without locking or boxing.
      */
-    private final Map<Byte, Byte> mappingOverrides =
-            new ConcurrentHashMap<>();
+    private volatile byte[] mappingOverrides;
 
     /**
      * Checks if there are any override mappings, if no setting just pass
@@ -50,10 +51,14 @@ public class PayloadTypeTransformEngine
     @Override
     public RawPacket transform(RawPacket pkt)
     {
-        Byte newPT = mappingOverrides.get(pkt.getPayloadType());
-        if(newPT != null)
+        byte[] mappingOverrides = this.mappingOverrides;
+
+        if (mappingOverrides != null)
         {
-            pkt.setPayload(newPT);
+            byte newPT = mappingOverrides[pkt.getPayloadType() & 0x7F];
+
+            if (newPT != -1)
+                pkt.setPayload(newPT);
         }
 
         return pkt;
@@ -116,9 +121,23 @@ public class PayloadTypeTransformEngine
      * @param originalPt the payload type that we are overriding
      * @param overridePt the payload type that we are overriding it with
      */
-    public void addPTMappingOverride(byte originalPt, byte overridePt)
+    public synchronized void addPTMappingOverride(
+            byte originalPt,
+            byte overridePt)
     {
-        mappingOverrides.put(originalPt, overridePt);
+        byte[] newMappingOverrides = new byte[128];
+
+        if (mappingOverrides == null)
+            Arrays.fill(newMappingOverrides, (byte) -1);
+        else
+        {
+            System.arraycopy(
+                    mappingOverrides, 0,
+                    newMappingOverrides, 0,
+                    newMappingOverrides.length);
+        }
+        newMappingOverrides[originalPt & 0x7F] = overridePt;
+        mappingOverrides = newMappingOverrides;
     }
 
     /**
@@ -126,8 +145,8 @@ public class PayloadTypeTransformEngine
      * {@link addPTMappingOverride(byte, byte)} so that we can set new
      * overrides.
      */
-    public void clearPTMappingOverrides()
+    public synchronized void clearPTMappingOverrides()
     {
-        mappingOverrides.clear();
+        mappingOverrides = null;
     }
 }
@@ -1089,6 +1089,8 @@ public class StatisticsEngine
                  long time = System.currentTimeMillis();
                  rtcpReports.setFirstReceivedPacketTime(ssrc, time);
             }
+
+            mediaStream.rtpPacketReceived(pkt);
         }
 
         return pkt;
@@ -12,6 +12,7 @@ import java.util.*;
 
 import org.jitsi.impl.neomedia.*;
 import org.jitsi.impl.neomedia.transform.*;
+import org.jitsi.impl.neomedia.transform.srtp.*;
 import org.jitsi.service.neomedia.*;
 import org.jitsi.service.neomedia.event.*;
 import org.jitsi.service.protocol.event.CallPeerSecurityStatusEvent;
@@ -21,7 +22,8 @@ import ch.imvs.sdes4j.srtp.*;
 
 /**
  * Default implementation of {@link SDesControl} that supports the crypto suites
- * of the original RFC4568 and the KDR parameter, but nothing else.
+ * of the original RFC4568, the AEAD_AES_128_GCM and AEAD_AES_256_GCM crypto
+ * suites of RFC 7714 when enabled and the KDR parameter, but nothing else.
  *
  * @author Ingo Bauersachs
  */
@@ -61,7 +63,7 @@ public class SDesControlImpl
      */
     public SDesControlImpl()
     {
-        sdesFactory = new SrtpSDesFactory();
+        sdesFactory = new SrtpAeadSDesFactory();
         Random r = new SecureRandom();
         sdesFactory.setRandomGenerator(r);
     }
@@ -71,7 +73,14 @@ public class SDesControlImpl
     {
         enabledCryptoSuites.clear();
         for(String c : ciphers)
+        {
+            if (SrtpAeadCryptoSuite.isAead(c) && !SRTPGCMSelfTest.passed())
+            {
+                logger.warn("Not enabling " + c);
+                continue;
+            }
             enabledCryptoSuites.add(c);
+        }
     }
 
     @Override
@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.impl.neomedia.transform.sdes;
 
 import org.jitsi.impl.neomedia.transform.*;
@@ -58,6 +59,27 @@ public class SDesTransformEngine
         }
 
         SrtpCryptoSuite cs = attribute.getCryptoSuite();
+
+        if (SrtpAeadCryptoSuite.isAead(cs.encode()))
+        {
+            // GCM authenticates so there is no authentication key or HMAC.
+            return new SRTPContextFactory(
+                getKey(attribute),
+                getSalt(attribute),
+                new SRTPPolicy(
+                    SRTPPolicy.AESGCM_ENCRYPTION, cs.getEncKeyLength() / 8,
+                    SRTPPolicy.NULL_AUTHENTICATION, 0,
+                    SRTPCipherGCM.TAG_LENGTH,
+                    cs.getSaltKeyLength() / 8
+                ),
+                new SRTPPolicy(
+                    SRTPPolicy.AESGCM_ENCRYPTION, cs.getEncKeyLength() / 8,
+                    SRTPPolicy.NULL_AUTHENTICATION, 0,
+                    SRTPCipherGCM.TAG_LENGTH,
+                    cs.getSaltKeyLength() / 8
+                )
+            );
+        }
         return new SRTPContextFactory(
             getKey(attribute),
             getSalt(attribute),
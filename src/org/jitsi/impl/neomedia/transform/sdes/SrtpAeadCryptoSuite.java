@@ -0,0 +1,114 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transform.sdes;
+
+import ch.imvs.sdes4j.srtp.*;
+
+/**
+ * The AEAD_AES_128_GCM and AEAD_AES_256_GCM crypto suites of SDES defined in
+ * section 14.2 of RFC 7714, which sdes4j does not know about. Their key
+ * lengths are in bits like those of the other <tt>SrtpCryptoSuite</tt>s; they
+ * have no authentication key and their tag is the 128 bit GCM tag.
+ */
+public class SrtpAeadCryptoSuite
+    extends SrtpCryptoSuite
+{
+    public static final String AEAD_AES_128_GCM = "AEAD_AES_128_GCM";
+
+    public static final String AEAD_AES_256_GCM = "AEAD_AES_256_GCM";
+
+    private final String name;
+
+    private final int encKeyLength;
+
+    /**
+     * Determines whether a crypto suite is one of the AEAD ones.
+     *
+     * @param suite the name of the crypto suite
+     * @return <tt>true</tt> if <tt>suite</tt> names an AEAD crypto suite
+     */
+    public static boolean isAead(String suite)
+    {
+        return AEAD_AES_128_GCM.equals(suite) || AEAD_AES_256_GCM.equals(suite);
+    }
+
+    /**
+     * Creates a new AEAD crypto suite.
+     *
+     * @param suite <tt>AEAD_AES_128_GCM</tt> or <tt>AEAD_AES_256_GCM</tt>
+     */
+    public SrtpAeadCryptoSuite(String suite)
+    {
+        // sdes4j rejects suites it does not know about.
+        super(AES_CM_128_HMAC_SHA1_80);
+
+        if (AEAD_AES_128_GCM.equals(suite))
+            encKeyLength = 128;
+        else if (AEAD_AES_256_GCM.equals(suite))
+            encKeyLength = 256;
+        else
+            throw new IllegalArgumentException("Unknown crypto suite " + suite);
+        name = suite;
+    }
+
+    @Override
+    public String encode()
+    {
+        return name;
+    }
+
+    @Override
+    public int getEncKeyLength()
+    {
+        return encKeyLength;
+    }
+
+    @Override
+    public int getSaltKeyLength()
+    {
+        return 96;
+    }
+
+    @Override
+    public int getSrtpAuthKeyLength()
+    {
+        return 0;
+    }
+
+    @Override
+    public int getSrtcpAuthKeyLength()
+    {
+        return 0;
+    }
+
+    @Override
+    public int getSrtpAuthTagLength()
+    {
+        return 128;
+    }
+
+    @Override
+    public int getSrtcpAuthTagLength()
+    {
+        return 128;
+    }
+
+    @Override
+    public boolean equals(Object obj)
+    {
+        return
+            (obj instanceof SrtpCryptoSuite)
+                && name.equals(((SrtpCryptoSuite) obj).encode());
+    }
+
+    @Override
+    public int hashCode()
+    {
+        return name.hashCode();
+    }
+}
@@ -0,0 +1,29 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transform.sdes;
+
+import ch.imvs.sdes4j.srtp.*;
+
+/**
+ * An <tt>SrtpSDesFactory</tt> which knows the AEAD crypto suites of RFC 7714
+ * besides those of sdes4j. Crypto attributes offering or answering the AEAD
+ * crypto suites must be created and parsed with it for them to be negotiated
+ * by <tt>SDesControlImpl</tt>.
+ */
+public class SrtpAeadSDesFactory
+    extends SrtpSDesFactory
+{
+    @Override
+    public SrtpCryptoSuite createCryptoSuite(String suite)
+    {
+        return
+            SrtpAeadCryptoSuite.isAead(suite)
+                ? new SrtpAeadCryptoSuite(suite)
+                : super.createCryptoSuite(suite);
+    }
+}
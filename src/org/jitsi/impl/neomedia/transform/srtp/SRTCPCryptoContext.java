@@ -142,6 +142,10 @@ public class SRTCPCryptoContext
     // implements the counter cipher mode for RTP according to RFC 3711
     private final SRTPCipherCTR cipherCtr = new SRTPCipherCTR();
 
+    // implements the AEAD_AES_*_GCM transforms according to RFC 7714, used
+    // inside GCM mode only
+    private SRTPCipherGCM cipherGcm = null;
+
     // Here some fields that a allocated here or in constructor. The methods
     // use these fields to avoid too many new operations
 
@@ -184,7 +188,9 @@ public class SRTCPCryptoContext
         System.arraycopy(masterKey, 0, this.masterKey, 0, policy
                 .getEncKeyLength());
 
-        this.masterSalt = new byte[policy.getSaltKeyLength()];
+        // The 96 bit salt of GCM is padded with zeros to the 112 bits of the
+        // key derivation, see RFC 7714 section 11.
+        this.masterSalt = new byte[Math.max(policy.getSaltKeyLength(), 14)];
         System.arraycopy(masterSalt, 0, this.masterSalt, 0, policy
                 .getSaltKeyLength());
 
@@ -211,6 +217,14 @@ public class SRTCPCryptoContext
             encKey = new byte[this.policy.getEncKeyLength()];
             saltKey = new byte[this.policy.getSaltKeyLength()];
             break;
+
+        case SRTPPolicy.AESGCM_ENCRYPTION:
+            // AES-CM derives the keys, AES-GCM protects the packets.
+            cipher = new AESEngine();
+            cipherGcm = new SRTPCipherGCM();
+            encKey = new byte[this.policy.getEncKeyLength()];
+            saltKey = new byte[this.policy.getSaltKeyLength()];
+            break;
         }
 
         switch (policy.getAuthType()) {
@@ -276,6 +290,14 @@ public class SRTCPCryptoContext
      */
     public void transformPacket(RawPacket pkt)
     {
+        if (policy.getEncType() == SRTPPolicy.AESGCM_ENCRYPTION)
+        {
+            processPacketAESGCM(pkt, sentIndex | 0x80000000);
+            sentIndex++;
+            sentIndex &= ~0x80000000;       // clear possible overflow
+            return;
+        }
+
         boolean encrypt = false;
         /* Encrypt the packet using Counter Mode encryption */
         if (policy.getEncType() == SRTPPolicy.AESCM_ENCRYPTION ||
@@ -332,6 +354,9 @@ public class SRTCPCryptoContext
      */
     public boolean reverseTransformPacket(RawPacket pkt)
     {
+        if (policy.getEncType() == SRTPPolicy.AESGCM_ENCRYPTION)
+            return reverseProcessPacketAESGCM(pkt);
+
         boolean decrypt = false;
         int tagLength = policy.getAuthTagLength();
         int indexEflag = pkt.getSRTCPIndex(tagLength);
@@ -438,6 +463,118 @@ public class SRTCPCryptoContext
             payloadLength, ivStore);
     }
 
+    /**
+     * Computes the GCM IV of an SRTCP packet into ivStore, see section 9.1 in
+     * RFC 7714.
+     *
+     * @param pkt the RTCP packet
+     * @param index the SRTCP index of the packet without the E flag
+     */
+    private void computeIvAESGCM(RawPacket pkt, int index)
+    {
+        long ssrc = pkt.getRTCPSSRC();
+
+        /*
+         *   0  0 |  SSRC     |  0  0 |  index
+         * ------------------------------------------XOR
+         *   salt (12 bytes)
+         */
+        ivStore[0] = saltKey[0];
+        ivStore[1] = saltKey[1];
+        ivStore[2] = (byte) (((ssrc >> 24) & 0xff) ^ saltKey[2]);
+        ivStore[3] = (byte) (((ssrc >> 16) & 0xff) ^ saltKey[3]);
+        ivStore[4] = (byte) (((ssrc >> 8) & 0xff) ^ saltKey[4]);
+        ivStore[5] = (byte) ((ssrc & 0xff) ^ saltKey[5]);
+        ivStore[6] = saltKey[6];
+        ivStore[7] = saltKey[7];
+        ivStore[8] = (byte) (((index >> 24) & 0x7f) ^ saltKey[8]);
+        ivStore[9] = (byte) (((index >> 16) & 0xff) ^ saltKey[9]);
+        ivStore[10] = (byte) (((index >> 8) & 0xff) ^ saltKey[10]);
+        ivStore[11] = (byte) ((index & 0xff) ^ saltKey[11]);
+    }
+
+    /**
+     * Perform GCM AES encryption and authentication, see section 9 in
+     * RFC 7714. The packet becomes the fixed header, the encrypted rest of the
+     * packet, the authentication tag and then the E flag and SRTCP index.
+     *
+     * @param pkt the RTCP packet to be encrypted
+     * @param indexEflag the SRTCP index of the packet with the E flag set
+     */
+    private void processPacketAESGCM(RawPacket pkt, int indexEflag)
+    {
+        computeIvAESGCM(pkt, indexEflag);
+
+        // The associated data is the fixed header and the E flag and index.
+        rbStore[0] = (byte) (indexEflag >> 24);
+        rbStore[1] = (byte) (indexEflag >> 16);
+        rbStore[2] = (byte) (indexEflag >> 8);
+        rbStore[3] = (byte) indexEflag;
+
+        final int payloadOffset = 8;
+        final int payloadLength = pkt.getLength() - payloadOffset;
+
+        if (pkt.getBuffer().length - pkt.getOffset()
+                < pkt.getLength() + SRTPCipherGCM.TAG_LENGTH + 4)
+            pkt.grow(SRTPCipherGCM.TAG_LENGTH + 4);
+        cipherGcm.encrypt(
+                ivStore,
+                pkt.getBuffer(), pkt.getOffset(), payloadOffset,
+                rbStore,
+                pkt.getOffset() + payloadOffset, payloadLength);
+        pkt.setLength(pkt.getLength() + SRTPCipherGCM.TAG_LENGTH);
+        pkt.writeInt(pkt.getLength(), indexEflag);
+        pkt.setLength(pkt.getLength() + 4);
+    }
+
+    /**
+     * Perform GCM AES authentication check and decryption, see section 9 in
+     * RFC 7714, accepting packets which are only authenticated (the E flag is
+     * not set) too.
+     *
+     * @param pkt the received SRTCP packet
+     * @return true if the packet can be accepted
+     *         false if authentication or replay check failed
+     */
+    private boolean reverseProcessPacketAESGCM(RawPacket pkt)
+    {
+        final int payloadOffset = 8;
+
+        if (pkt.getLength() < payloadOffset + SRTPCipherGCM.TAG_LENGTH + 4)
+            return false;
+
+        int indexEflag = pkt.readInt(pkt.getLength() - 4);
+        int index = indexEflag & ~0x80000000;
+
+        /* Replay control */
+        if (!checkReplay(index))
+            return false;
+
+        pkt.readRegionToBuff(pkt.getLength() - 4, 4, rbStore);
+        pkt.shrink(4);
+        computeIvAESGCM(pkt, index);
+
+        /*
+         * Without the E flag the whole packet is associated data and only the
+         * authentication tag is left to check.
+         */
+        int aadLength
+            = ((indexEflag & 0x80000000) != 0)
+                ? payloadOffset
+                : (pkt.getLength() - SRTPCipherGCM.TAG_LENGTH);
+
+        if (!cipherGcm.decrypt(
+                ivStore,
+                pkt.getBuffer(), pkt.getOffset(), aadLength,
+                rbStore,
+                pkt.getOffset() + aadLength, pkt.getLength() - aadLength))
+            return false;
+        pkt.shrink(SRTPCipherGCM.TAG_LENGTH);
+        update(index);
+
+        return true;
+    }
+
     /**
      * Perform F8 Mode AES encryption / decryption
      *
@@ -602,6 +739,8 @@ public class SRTCPCryptoContext
         Arrays.fill(masterSalt, (byte)0);
 
         // As last step: initialize cipher with derived encryption key.
+        if (cipherGcm != null)
+            cipherGcm.init(encKey);
         if (cipherF8 != null)
             SRTPCipherF8.deriveForIV(cipherF8, encKey, saltKey);
         encryptionKey = new KeyParameter(encKey);
@@ -609,6 +748,22 @@ public class SRTCPCryptoContext
         Arrays.fill(encKey, (byte)0);
     }
 
+    /**
+     * Sets the session keys of the AEAD_AES_*_GCM transforms rather than
+     * deriving them from the master key, for the known answer tests of
+     * RFC 7714 which are given in terms of the session keys.
+     *
+     * @param sessionKey the session encryption key
+     * @param sessionSalt the 96 bit session salt
+     * @param index the SRTCP index of the next packet to be sent
+     */
+    void setGcmSessionKeys(byte[] sessionKey, byte[] sessionSalt, int index)
+    {
+        System.arraycopy(sessionSalt, 0, saltKey, 0, saltKey.length);
+        cipherGcm.init(sessionKey);
+        sentIndex = index;
+    }
+
     /**
      * Update the SRTP packet index.
      *
@@ -0,0 +1,154 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transform.srtp;
+
+import java.security.*;
+
+import javax.crypto.*;
+import javax.crypto.spec.*;
+
+/**
+ * SRTPCipherGCM implements the AEAD_AES_128_GCM and AEAD_AES_256_GCM
+ * transforms of SRTP and SRTCP defined in RFC 7714, which encrypt and
+ * authenticate a packet in a single pass instead of AES-CM followed by
+ * HMAC-SHA1.
+ *
+ * The AES/GCM of the Java runtime is used rather than a BouncyCastle engine
+ * because HotSpot compiles it to the AES-NI and carry-less multiplication
+ * instructions of the CPU where they are available.
+ */
+public class SRTPCipherGCM
+{
+    /**
+     * The length in bytes of the IV of RFC 7714.
+     */
+    public static final int IV_LENGTH = 12;
+
+    /**
+     * The length in bytes of the authentication tag of the AEAD_AES_*_GCM
+     * transforms.
+     */
+    public static final int TAG_LENGTH = 16;
+
+    private final Cipher cipher;
+
+    /**
+     * The session encryption key.
+     */
+    private SecretKeySpec key;
+
+    /**
+     * Creates a new <tt>SRTPCipherGCM</tt> which is to be given its key by
+     * {@link #init(byte[])}.
+     */
+    public SRTPCipherGCM()
+    {
+        try
+        {
+            cipher = Cipher.getInstance("AES/GCM/NoPadding");
+        }
+        catch (GeneralSecurityException gse)
+        {
+            throw new IllegalStateException("AES/GCM is not available", gse);
+        }
+    }
+
+    /**
+     * Sets the session encryption key.
+     *
+     * @param key the session encryption key, 16 or 32 bytes long
+     */
+    public void init(byte[] key)
+    {
+        this.key = new SecretKeySpec(key, "AES");
+    }
+
+    /**
+     * Encrypts and authenticates data in place, appending the authentication
+     * tag, so the buffer must have <tt>TAG_LENGTH</tt> bytes of room after
+     * the data.
+     *
+     * @param iv the IV of the packet in its first <tt>IV_LENGTH</tt> bytes
+     * @param buf the buffer holding the data
+     * @param aadOffset the offset of the additional authenticated data
+     * @param aadLength the length of the additional authenticated data
+     * @param aad2 more additional authenticated data following that of
+     * <tt>buf</tt> or <tt>null</tt>
+     * @param off the offset of the data to encrypt
+     * @param len the length of the data to encrypt
+     */
+    public void encrypt(
+            byte[] iv,
+            byte[] buf,
+            int aadOffset, int aadLength,
+            byte[] aad2,
+            int off, int len)
+    {
+        try
+        {
+            cipher.init(
+                    Cipher.ENCRYPT_MODE,
+                    key,
+                    new GCMParameterSpec(TAG_LENGTH * 8, iv, 0, IV_LENGTH));
+            cipher.updateAAD(buf, aadOffset, aadLength);
+            if (aad2 != null)
+                cipher.updateAAD(aad2);
+            cipher.doFinal(buf, off, len, buf, off);
+        }
+        catch (GeneralSecurityException gse)
+        {
+            throw new IllegalStateException("AES/GCM encryption failed", gse);
+        }
+    }
+
+    /**
+     * Verifies and decrypts data in place.
+     *
+     * @param iv the IV of the packet in its first <tt>IV_LENGTH</tt> bytes
+     * @param buf the buffer holding the data
+     * @param aadOffset the offset of the additional authenticated data
+     * @param aadLength the length of the additional authenticated data
+     * @param aad2 more additional authenticated data following that of
+     * <tt>buf</tt> or <tt>null</tt>
+     * @param off the offset of the encrypted data
+     * @param len the length of the encrypted data including the
+     * authentication tag
+     * @return <tt>true</tt> if the data was authentic and has been decrypted;
+     * otherwise, <tt>false</tt>
+     */
+    public boolean decrypt(
+            byte[] iv,
+            byte[] buf,
+            int aadOffset, int aadLength,
+            byte[] aad2,
+            int off, int len)
+    {
+        if (len < TAG_LENGTH)
+            return false;
+        try
+        {
+            cipher.init(
+                    Cipher.DECRYPT_MODE,
+                    key,
+                    new GCMParameterSpec(TAG_LENGTH * 8, iv, 0, IV_LENGTH));
+            cipher.updateAAD(buf, aadOffset, aadLength);
+            if (aad2 != null)
+                cipher.updateAAD(aad2);
+            cipher.doFinal(buf, off, len, buf, off);
+            return true;
+        }
+        catch (AEADBadTagException abte)
+        {
+            return false;
+        }
+        catch (GeneralSecurityException gse)
+        {
+            throw new IllegalStateException("AES/GCM decryption failed", gse);
+        }
+    }
+}
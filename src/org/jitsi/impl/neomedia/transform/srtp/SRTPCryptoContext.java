@@ -160,6 +160,12 @@ public class SRTPCryptoContext
      */
     private final SRTPCipherCTR cipherCtr = new SRTPCipherCTR();
 
+    /**
+     * implements the AEAD_AES_*_GCM transforms according to RFC 7714, used
+     * inside GCM mode only
+     */
+    private SRTPCipherGCM cipherGcm = null;
+
     /**
      * Temp store.
      */
@@ -223,7 +229,9 @@ public class SRTPCryptoContext
         System.arraycopy(masterK, 0, masterKey, 0, policy
                 .getEncKeyLength());
 
-        masterSalt = new byte[policy.getSaltKeyLength()];
+        // The 96 bit salt of GCM is padded with zeros to the 112 bits of the
+        // key derivation, see RFC 7714 section 11.
+        masterSalt = new byte[Math.max(policy.getSaltKeyLength(), 14)];
         System.arraycopy(masterS, 0, masterSalt, 0, policy
                 .getSaltKeyLength());
 
@@ -254,6 +262,14 @@ public class SRTPCryptoContext
             encKey = new byte[this.policy.getEncKeyLength()];
             saltKey = new byte[this.policy.getSaltKeyLength()];
             break;
+
+        case SRTPPolicy.AESGCM_ENCRYPTION:
+            // AES-CM derives the keys, AES-GCM protects the packets.
+            cipher = new AESEngine();
+            cipherGcm = new SRTPCipherGCM();
+            encKey = new byte[policy.getEncKeyLength()];
+            saltKey = new byte[policy.getSaltKeyLength()];
+            break;
         }
 
         switch (policy.getAuthType())
@@ -319,8 +335,14 @@ public class SRTPCryptoContext
      */
     public void transformPacket(RawPacket pkt)
     {
+        /* Encrypt and authenticate the packet using GCM */
+        if (policy.getEncType() == SRTPPolicy.AESGCM_ENCRYPTION)
+        {
+            processPacketAESGCM(pkt, rolloverCounter, true);
+        }
+
         /* Encrypt the packet using Counter Mode encryption */
-        if (policy.getEncType() == SRTPPolicy.AESCM_ENCRYPTION ||
+        else if (policy.getEncType() == SRTPPolicy.AESCM_ENCRYPTION ||
                 policy.getEncType() == SRTPPolicy.TWOFISH_ENCRYPTION)
         {
             processPacketAESCM(pkt);
@@ -383,6 +405,15 @@ public class SRTPCryptoContext
         {
             return false;
         }
+
+        /* Authenticate and decrypt the packet using GCM */
+        if (policy.getEncType() == SRTPPolicy.AESGCM_ENCRYPTION)
+        {
+            if (!processPacketAESGCM(pkt, guessedROC, false))
+                return false;
+            update(seqNo, guessedIndex);
+            return true;
+        }
         /* Authenticate the packet */
         if (policy.getAuthType() != SRTPPolicy.NULL_AUTHENTICATION)
         {
@@ -473,6 +504,77 @@ public class SRTPCryptoContext
                 payloadOffset, payloadLength, ivStore);
     }
 
+    /**
+     * Perform GCM AES encryption and authentication / authentication check
+     * and decryption, see RFC 7714 sections 8.1 and 8.2.
+     *
+     * @param pkt the RTP packet to be encrypted / decrypted
+     * @param rocIn Roll-Over-Counter
+     * @param encrypt <tt>true</tt> to encrypt and append the authentication
+     * tag; <tt>false</tt> to check and remove it and decrypt
+     * @return <tt>false</tt> if the packet failed authentication
+     */
+    private boolean processPacketAESGCM(
+            RawPacket pkt,
+            int rocIn,
+            boolean encrypt)
+    {
+        long ssrc = pkt.getSSRC();
+        int seqNo = pkt.getSequenceNumber();
+
+        /* Compute the GCM IV (refer to section 8.1 in RFC 7714):
+         *
+         *   0  0 |  SSRC     |  ROC      | SEQ
+         * ------------------------------------------XOR
+         *   salt (12 bytes)
+         */
+        byte[] iv = ivStore;
+
+        iv[0] = saltKey[0];
+        iv[1] = saltKey[1];
+        iv[2] = (byte) ((ssrc >> 24) ^ saltKey[2]);
+        iv[3] = (byte) ((ssrc >> 16) ^ saltKey[3]);
+        iv[4] = (byte) ((ssrc >> 8) ^ saltKey[4]);
+        iv[5] = (byte) (ssrc ^ saltKey[5]);
+        iv[6] = (byte) ((rocIn >> 24) ^ saltKey[6]);
+        iv[7] = (byte) ((rocIn >> 16) ^ saltKey[7]);
+        iv[8] = (byte) ((rocIn >> 8) ^ saltKey[8]);
+        iv[9] = (byte) (rocIn ^ saltKey[9]);
+        iv[10] = (byte) ((seqNo >> 8) ^ saltKey[10]);
+        iv[11] = (byte) (seqNo ^ saltKey[11]);
+
+        // The whole RTP header is the associated data.
+        final int headerLength = pkt.getHeaderLength();
+
+        if (encrypt)
+        {
+            final int payloadLength = pkt.getPayloadLength();
+
+            if (pkt.getBuffer().length - pkt.getOffset()
+                    < pkt.getLength() + SRTPCipherGCM.TAG_LENGTH)
+                pkt.grow(SRTPCipherGCM.TAG_LENGTH);
+            cipherGcm.encrypt(
+                    iv,
+                    pkt.getBuffer(), pkt.getOffset(), headerLength,
+                    null,
+                    pkt.getOffset() + headerLength, payloadLength);
+            pkt.setLength(pkt.getLength() + SRTPCipherGCM.TAG_LENGTH);
+            return true;
+        }
+        else
+        {
+            if (!cipherGcm.decrypt(
+                    iv,
+                    pkt.getBuffer(), pkt.getOffset(), headerLength,
+                    null,
+                    pkt.getOffset() + headerLength,
+                    pkt.getLength() - headerLength))
+                return false;
+            pkt.shrink(SRTPCipherGCM.TAG_LENGTH);
+            return true;
+        }
+    }
+
     /**
      * Perform F8 Mode AES encryption / decryption
      *
@@ -649,6 +751,8 @@ public class SRTPCryptoContext
         Arrays.fill(masterSalt, (byte)0);
 
         // As last step: initialize cipher with derived encryption key.
+        if (cipherGcm != null)
+            cipherGcm.init(encKey);
         if (cipherF8 != null)
             SRTPCipherF8.deriveForIV(cipherF8, encKey, saltKey);
         encryptionKey = new KeyParameter(encKey);
@@ -656,6 +760,20 @@ public class SRTPCryptoContext
         Arrays.fill(encKey, (byte)0);
     }
 
+    /**
+     * Sets the session keys of the AEAD_AES_*_GCM transforms rather than
+     * deriving them from the master key, for the known answer tests of
+     * RFC 7714 which are given in terms of the session keys.
+     *
+     * @param sessionKey the session encryption key
+     * @param sessionSalt the 96 bit session salt
+     */
+    void setGcmSessionKeys(byte[] sessionKey, byte[] sessionSalt)
+    {
+        System.arraycopy(sessionSalt, 0, saltKey, 0, saltKey.length);
+        cipherGcm.init(sessionKey);
+    }
+
     /**
      * Compute (guess) the new SRTP index based on the sequence number of a
      * received RTP packet.
@@ -0,0 +1,253 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transform.srtp;
+
+import java.util.*;
+
+import org.jitsi.impl.neomedia.*;
+import org.jitsi.util.*;
+
+/**
+ * Checks the AEAD_AES_128_GCM and AEAD_AES_256_GCM transforms of
+ * <tt>SRTPCryptoContext</tt> and <tt>SRTCPCryptoContext</tt> against the
+ * known answers of sections 16 and 17 of RFC 7714 before they are offered,
+ * so that a fault in the IV, in the layout of the associated data or in the
+ * AES/GCM of the Java runtime disables them rather than breaking calls.
+ * <p>
+ * Each SRTP packet is encrypted and decrypted. Each SRTCP packet is
+ * encrypted with the E flag set, and both the encrypted packet and the
+ * packet which is only authenticated, without the E flag, are decrypted.
+ * </p>
+ */
+public class SRTPGCMSelfTest
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>SRTPGCMSelfTest</tt> class for
+     * logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(SRTPGCMSelfTest.class);
+
+    /**
+     * The session salt of all the known answers.
+     */
+    private static final String SALT = "517569642070726f2071756f";
+
+    /**
+     * The RTP packet of the known answers, with the payload
+     * "Gallia est omnis divisa in partes tres".
+     */
+    private static final String RTP
+        = "8040f17b8041f8d35501a0b2"
+            + "47616c6c696120657374206f6d6e697320646976697361"
+            + "20696e207061727465732074726573";
+
+    /**
+     * The RTCP packet of the known answers.
+     */
+    private static final String RTCP
+        = "81c8000d4d6172734e5450314e545032525450200000042a"
+            + "0000e9304c756e61deadbeefdeadbeefdeadbeefdeadbeefdeadbeef";
+
+    /**
+     * The SRTCP index of the RTCP packet of the known answers.
+     */
+    private static final int RTCP_INDEX = 0x000005d4;
+
+    /**
+     * The session keys and the protected RTP packet, the encrypted RTCP packet
+     * and the authenticated RTCP packet of the known answers of RFC 7714 for
+     * the AEAD_AES_128_GCM and AEAD_AES_256_GCM transforms.
+     */
+    private static final String[][] KNOWN_ANSWERS
+        = {
+            {
+                "000102030405060708090a0b0c0d0e0f",
+                "8040f17b8041f8d35501a0b2"
+                    + "f24de3a3fb34de6cacba861c9d7e4bcabe633bd50d294e6f"
+                    + "42a5f47a51c7d19b36de3adf8833"
+                    + "899d7f27beb16a9152cf765ee4390cce",
+                "81c8000d4d617273"
+                    + "63e94885dcdab67ca727d7662f6b7e997ff5c0f76c06f32d"
+                    + "c676a5f1730d6fda4ce09b4686303ded0bb9275b"
+                    + "c84aa45896cf4d2fc5abf87245d9eade"
+                    + "800005d4",
+                RTCP
+                    + "841dd9683dd78ec92ae58790125f62b3"
+                    + "000005d4"
+            },
+            {
+                "000102030405060708090a0b0c0d0e0f"
+                    + "101112131415161718191a1b1c1d1e1f",
+                "8040f17b8041f8d35501a0b2"
+                    + "32b1de78a822fe12ef9f78fa332e33aab18012389a58e2f3"
+                    + "b50b2a0276ffae0f1ba63799b87b"
+                    + "7aa3db36dfffd6b0f9bb7878d7a76c13",
+                "81c8000d4d617273"
+                    + "d50ae4d1f5ce5d304ba297e47d470c282c3ece5dbffe0a50"
+                    + "a2eaa5c1110555be8415f658c61de0476f1b6fad"
+                    + "1d1eb30c4446839f57ff6f6cb26ac3be"
+                    + "800005d4",
+                RTCP
+                    + "91db4afbfeee5a978fab4393ed2615fe"
+                    + "000005d4"
+            }
+        };
+
+    /**
+     * The result of the known answer tests, <tt>null</tt> until they have
+     * run.
+     */
+    private static Boolean passed;
+
+    /**
+     * Determines whether the AEAD_AES_*_GCM transforms give the known answers
+     * of RFC 7714, running the tests the first time.
+     *
+     * @return <tt>true</tt> if the transforms passed the known answer tests
+     */
+    public static synchronized boolean passed()
+    {
+        if (passed == null)
+        {
+            boolean result;
+
+            try
+            {
+                result = run();
+            }
+            catch (RuntimeException re)
+            {
+                logger.error("AES/GCM known answer tests failed", re);
+                result = false;
+            }
+            if (!result)
+            {
+                logger.error(
+                        "The AEAD_AES_*_GCM SRTP transforms failed the"
+                            + " RFC 7714 known answer tests");
+            }
+            passed = result;
+        }
+        return passed;
+    }
+
+    private static boolean run()
+    {
+        byte[] salt = fromHex(SALT);
+        byte[] rtp = fromHex(RTP);
+        byte[] rtcp = fromHex(RTCP);
+
+        for (String[] knownAnswer : KNOWN_ANSWERS)
+        {
+            byte[] key = fromHex(knownAnswer[0]);
+            SRTPPolicy policy
+                = new SRTPPolicy(
+                        SRTPPolicy.AESGCM_ENCRYPTION, key.length,
+                        SRTPPolicy.NULL_AUTHENTICATION, 0,
+                        SRTPCipherGCM.TAG_LENGTH,
+                        salt.length);
+
+            SRTPCryptoContext srtpSender
+                = new SRTPCryptoContext(0, 0, 0, key, salt, policy);
+            SRTPCryptoContext srtpReceiver
+                = new SRTPCryptoContext(0, 0, 0, key, salt, policy);
+
+            srtpSender.setGcmSessionKeys(key, salt);
+            srtpReceiver.setGcmSessionKeys(key, salt);
+            if (!checkTransform(
+                    srtpSender::transformPacket,
+                    srtpReceiver::reverseTransformPacket,
+                    rtp,
+                    fromHex(knownAnswer[1])))
+                return false;
+
+            SRTCPCryptoContext srtcpSender
+                = new SRTCPCryptoContext(0, key, salt, policy);
+            SRTCPCryptoContext srtcpReceiver
+                = new SRTCPCryptoContext(0, key, salt, policy);
+
+            srtcpSender.setGcmSessionKeys(key, salt, RTCP_INDEX);
+            srtcpReceiver.setGcmSessionKeys(key, salt, 0);
+            if (!checkTransform(
+                    srtcpSender::transformPacket,
+                    srtcpReceiver::reverseTransformPacket,
+                    rtcp,
+                    fromHex(knownAnswer[2])))
+                return false;
+
+            // Without the E flag the packet is only authenticated.
+            srtcpReceiver = new SRTCPCryptoContext(0, key, salt, policy);
+            srtcpReceiver.setGcmSessionKeys(key, salt, 0);
+            if (!checkTransform(
+                    null,
+                    srtcpReceiver::reverseTransformPacket,
+                    rtcp,
+                    fromHex(knownAnswer[3])))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Checks that a transform turns a packet into a protected packet and that
+     * a reverse transform turns the protected packet back into the packet.
+     *
+     * @param transform the transform or <tt>null</tt> to only check the
+     * reverse transform
+     * @param reverseTransform the reverse transform
+     * @param packet the packet
+     * @param protectedPacket the protected packet
+     * @return <tt>true</tt> if the transforms gave the expected packets
+     */
+    private static boolean checkTransform(
+            Transform transform,
+            ReverseTransform reverseTransform,
+            byte[] packet,
+            byte[] protectedPacket)
+    {
+        RawPacket pkt;
+
+        if (transform != null)
+        {
+            pkt = new RawPacket(packet.clone(), 0, packet.length);
+            transform.transform(pkt);
+            if (!Arrays.equals(
+                    pkt.readRegion(0, pkt.getLength()),
+                    protectedPacket))
+                return false;
+        }
+
+        pkt = new RawPacket(protectedPacket.clone(), 0, protectedPacket.length);
+        return
+            reverseTransform.reverseTransform(pkt)
+                && Arrays.equals(pkt.readRegion(0, pkt.getLength()), packet);
+    }
+
+    private static byte[] fromHex(String hex)
+    {
+        byte[] bytes = new byte[hex.length() / 2];
+
+        for (int i = 0; i < bytes.length; i++)
+        {
+            bytes[i]
+                = (byte) Integer.parseInt(hex.substring(2 * i, 2 * i + 2), 16);
+        }
+        return bytes;
+    }
+
+    private interface Transform
+    {
+        void transform(RawPacket pkt);
+    }
+
+    private interface ReverseTransform
+    {
+        boolean reverseTransform(RawPacket pkt);
+    }
+}
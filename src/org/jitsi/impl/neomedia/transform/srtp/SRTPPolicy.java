@@ -39,6 +39,14 @@ public class SRTPPolicy
      * F8 Mode TwoFish Cipher
      */
     public static final int TWOFISHF8_ENCRYPTION = 4;
+
+    /**
+     * Galois/Counter Mode AES AEAD Cipher, defined in RFC 7714, which also
+     * authenticates so it is used with NULL_AUTHENTICATION and an
+     * authentication tag length of the GCM tag
+     */
+    public static final int AESGCM_ENCRYPTION = 5;
+
     /**
      * Null Authentication, no authentication
      */
@@ -0,0 +1,582 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transport;
+
+import java.io.*;
+import java.net.*;
+import java.util.*;
+
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.util.*;
+
+/**
+ * Performs the file writes of recordings and the socket I/O of TCP media
+ * connections asynchronously through a single io_uring in the native jnrtp
+ * library. A single native thread reaps the completions of all the files and
+ * streams. The writes to a file are coalesced into buffers registered with the
+ * ring. The packets of a TCP stream are framed as per RFC 4571 and queued
+ * natively so that sending never blocks.
+ */
+public class NativeIoRing
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>NativeIoRing</tt> class and its
+     * instances for logging output.
+     */
+    private static final Logger logger = Logger.getLogger(NativeIoRing.class);
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which enables
+     * writing recordings through the ring where it is available. Disabled by
+     * default as the buffers registered with the ring count against
+     * RLIMIT_MEMLOCK.
+     */
+    public static final String RECORDING_ENABLED_PNAME
+        = "org.jitsi.impl.neomedia.transport.NativeIoRing.recordingEnabled";
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which enables
+     * sending and receiving TCP media through the ring where it is available.
+     * Disabled by default as the packets are framed as per RFC 4571, which the
+     * remote peer must expect.
+     */
+    public static final String TCP_ENABLED_PNAME
+        = "org.jitsi.impl.neomedia.transport.NativeIoRing.tcpEnabled";
+
+    /**
+     * The indexes of the statistics returned by {@link Stream#getStats()}.
+     */
+    public static final int STAT_PACKETS_RECEIVED = 0;
+    public static final int STAT_PACKETS_SENT = 1;
+    public static final int STAT_BYTES_RECEIVED = 2;
+    public static final int STAT_BYTES_SENT = 3;
+    public static final int STAT_SEND_OVERFLOWS = 4;
+    public static final int STAT_RECEIVE_PAUSES = 5;
+
+    private static final int STATS_LENGTH = 6;
+
+    /**
+     * The time in milliseconds a receive waits for a packet so that a closed
+     * stream is noticed by its receiving thread.
+     */
+    private static final int RECEIVE_TIMEOUT = 500;
+
+    /**
+     * The size of the buffer into which a <tt>Stream</tt> takes the packets
+     * received, the size of the native receive queue.
+     */
+    private static final int RECEIVE_BATCH_SIZE = 262144;
+
+    /**
+     * The largest number of packets a <tt>Stream</tt> takes at once.
+     */
+    private static final int RECEIVE_BATCH_PACKETS = 256;
+
+    /**
+     * Tells if the jnrtp library is correctly loaded and the kernel supports
+     * the io_uring operations used by the ring.
+     */
+    public static final boolean isLoaded;
+
+    static
+    {
+        boolean loaded = false;
+
+        if (OSUtils.IS_LINUX)
+        {
+            try
+            {
+                NativeLibraryLoader.loadLibrary("jnrtp", NativeIoRing.class);
+                loaded = isSupported();
+                if (!loaded)
+                    logger.info("io_uring is not fully supported by the kernel");
+            }
+            catch (NullPointerException | UnsatisfiedLinkError | SecurityException e)
+            {
+                logger.warn("Failed to load jnrtp library: ", e);
+            }
+        }
+        isLoaded = loaded;
+    }
+
+    /**
+     * The <tt>Stream</tt>s of the TCP sockets, shared by the input and output
+     * streams of each socket.
+     */
+    private static final Map<Socket, Stream> streams
+        = new HashMap<Socket, Stream>();
+
+    private static native int fileClose(long file);
+
+    private static native int fileFlush(long file);
+
+    private static native long fileOpen(String path);
+
+    private static native int fileSeek(long file, long position);
+
+    private static native long fileTell(long file);
+
+    private static native int fileWrite(
+            long file,
+            byte[] buf, int offset, int length);
+
+    private static native boolean isSupported();
+
+    private static native void streamClose(long stream);
+
+    private static native void streamGetStats(long stream, long[] stats);
+
+    private static native long streamOpen(Socket socket);
+
+    private static native int streamReceiveBatch(
+            long stream,
+            byte[] buf, int[] lengths,
+            int timeout);
+
+    private static native boolean streamSend(
+            long stream,
+            byte[] buf, int offset, int length);
+
+    /**
+     * Determines whether a specific <tt>ConfigurationService</tt> property is
+     * enabled and the ring is available.
+     */
+    private static boolean isEnabled(String pname, boolean defaultValue)
+    {
+        if (!isLoaded)
+            return false;
+
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+
+        return
+            (cfg == null)
+                ? defaultValue
+                : cfg.global().getBoolean(pname, defaultValue);
+    }
+
+    /**
+     * Determines whether recordings are to be written through the ring.
+     *
+     * @return <tt>true</tt> if recordings are to be written through the ring
+     */
+    public static boolean isRecordingEnabled()
+    {
+        return isEnabled(RECORDING_ENABLED_PNAME, false);
+    }
+
+    /**
+     * Determines whether TCP media is to be sent and received through the
+     * ring.
+     *
+     * @return <tt>true</tt> if TCP media is to be sent and received through
+     * the ring
+     */
+    public static boolean isTcpEnabled()
+    {
+        return isEnabled(TCP_ENABLED_PNAME, false);
+    }
+
+    /**
+     * Opens a file for writing through the ring, truncating it.
+     *
+     * @param path the path of the file
+     * @return the new <tt>File</tt>
+     * @throws IOException if the file could not be opened
+     */
+    public static File openFile(String path)
+        throws IOException
+    {
+        if (!isLoaded)
+            throw new IOException("io_uring is not available");
+
+        long file = fileOpen(path);
+
+        if (file == 0)
+            throw new IOException("Failed to open " + path);
+        return new File(file);
+    }
+
+    /**
+     * Gets the <tt>Stream</tt> of a specific connected TCP socket, opening it
+     * for the first user. Each call must be matched by a call to
+     * {@link Stream#release()}.
+     *
+     * @param socket the connected TCP socket
+     * @return the <tt>Stream</tt> of <tt>socket</tt> or <tt>null</tt> if it
+     * could not be opened
+     */
+    public static Stream acquireStream(Socket socket)
+    {
+        if (!isLoaded || (socket == null))
+            return null;
+
+        synchronized (streams)
+        {
+            Stream stream = streams.get(socket);
+
+            if (stream == null)
+            {
+                long handle = streamOpen(socket);
+
+                if (handle == 0)
+                {
+                    logger.warn("Failed to open native TCP stream for " + socket);
+                    return null;
+                }
+                stream = new Stream(socket, handle);
+                streams.put(socket, stream);
+            }
+            stream.references++;
+            return stream;
+        }
+    }
+
+    /**
+     * A file written through the ring. The writes are asynchronous and their
+     * failures are reported by the subsequent calls.
+     */
+    public static class File
+    {
+        /**
+         * The native <tt>IoRingFile</tt>.
+         */
+        private long file;
+
+        private File(long file)
+        {
+            this.file = file;
+        }
+
+        /**
+         * Throws an <tt>IOException</tt> if a specific return value of a
+         * native call reports an error.
+         */
+        private static void check(int ret)
+            throws IOException
+        {
+            if (ret < 0)
+                throw new IOException("Write failed with errno " + -ret);
+        }
+
+        /**
+         * Writes whatever is buffered and closes this <tt>File</tt>.
+         *
+         * @throws IOException if a write has failed
+         */
+        public synchronized void close()
+            throws IOException
+        {
+            if (file != 0)
+            {
+                int ret = fileClose(file);
+
+                file = 0;
+                check(ret);
+            }
+        }
+
+        /**
+         * Waits for the writes to this <tt>File</tt> to complete.
+         *
+         * @throws IOException if a write has failed
+         */
+        public synchronized void flush()
+            throws IOException
+        {
+            if (file != 0)
+                check(fileFlush(file));
+        }
+
+        /**
+         * Sets the position of the next write to this <tt>File</tt>.
+         *
+         * @param position the position of the next write
+         * @throws IOException if a write has failed
+         */
+        public synchronized void seek(long position)
+            throws IOException
+        {
+            if (file == 0)
+                throw new IOException("Closed");
+            check(fileSeek(file, position));
+        }
+
+        /**
+         * Gets the position of the next write to this <tt>File</tt>.
+         *
+         * @return the position of the next write
+         */
+        public synchronized long tell()
+        {
+            return (file == 0) ? 0 : fileTell(file);
+        }
+
+        /**
+         * Writes at the current position of this <tt>File</tt>.
+         *
+         * @param buf the bytes to write
+         * @param offset the offset in <tt>buf</tt> of the bytes to write
+         * @param length the number of bytes to write
+         * @throws IOException if a write has failed
+         */
+        public synchronized void write(byte[] buf, int offset, int length)
+            throws IOException
+        {
+            if (file == 0)
+                throw new IOException("Closed");
+            if ((offset < 0)
+                    || (length < 0)
+                    || (offset > buf.length - length))
+                throw new IndexOutOfBoundsException();
+            check(fileWrite(file, buf, offset, length));
+        }
+    }
+
+    /**
+     * A stream of RFC 4571 framed packets over a TCP socket, shared by the
+     * <tt>RTPConnectorTCPInputStream</tt> and the
+     * <tt>RTPConnectorTCPOutputStream</tt> of the socket.
+     */
+    public static class Stream
+    {
+        /**
+         * The native <tt>IoRingStream</tt>.
+         */
+        private long handle;
+
+        /**
+         * The packets taken from the native stream by the last receive, back
+         * to back, and not all returned yet.
+         */
+        private byte[] batch;
+
+        /**
+         * The number of packets in {@link #batch}.
+         */
+        private int batchCount;
+
+        /**
+         * The index in {@link #batch} of the next packet to return.
+         */
+        private int batchIndex;
+
+        /**
+         * The lengths of the packets in {@link #batch}.
+         */
+        private int[] batchLengths;
+
+        /**
+         * The offset in {@link #batch} of the next packet to return.
+         */
+        private int batchOffset;
+
+        /**
+         * The lock which serializes the receives so that they take turns to
+         * use {@link #batch}.
+         */
+        private final Object receiveLock = new Object();
+
+        /**
+         * The number of threads in {@link #receive(byte[], int, int)}.
+         */
+        private int receivers;
+
+        /**
+         * The number of users of this <tt>Stream</tt>.
+         */
+        private int references;
+
+        private final Socket socket;
+
+        private Stream(Socket socket, long handle)
+        {
+            this.socket = socket;
+            this.handle = handle;
+        }
+
+        /**
+         * Gets the statistics of this <tt>Stream</tt>.
+         *
+         * @return the statistics indexed by the <tt>STAT_</tt> constants
+         */
+        public synchronized long[] getStats()
+        {
+            long[] stats = new long[STATS_LENGTH];
+
+            if (handle != 0)
+                streamGetStats(handle, stats);
+            return stats;
+        }
+
+        /**
+         * Receives a packet, waiting for one for a limited time so that the
+         * receiving thread may notice that it has been closed. The packets are
+         * taken from the native stream in batches of all those received so
+         * far, so that a busy stream costs one native call per batch rather
+         * than per packet.
+         *
+         * @param buf the buffer to receive into
+         * @param offset the offset in <tt>buf</tt> to receive at
+         * @param length the largest number of bytes to receive, the rest of a
+         * longer packet being discarded
+         * @return the length of the packet received
+         * @throws SocketTimeoutException if no packet was received in time
+         * @throws IOException if this <tt>Stream</tt> or its connection has
+         * been closed or has failed
+         */
+        public int receive(byte[] buf, int offset, int length)
+            throws IOException
+        {
+            if ((offset < 0)
+                    || (length < 0)
+                    || (offset > buf.length - length))
+                throw new IndexOutOfBoundsException();
+
+            synchronized (receiveLock)
+            {
+                if (batchIndex >= batchCount)
+                    receiveBatch();
+
+                int packetLength = batchLengths[batchIndex++];
+
+                System.arraycopy(
+                        batch, batchOffset,
+                        buf, offset,
+                        Math.min(packetLength, length));
+                batchOffset += packetLength;
+                return Math.min(packetLength, length);
+            }
+        }
+
+        /**
+         * Takes the packets received from the native stream into
+         * {@link #batch}, waiting for some for a limited time.
+         *
+         * @throws SocketTimeoutException if no packet was received in time
+         * @throws IOException if this <tt>Stream</tt> or its connection has
+         * been closed or has failed
+         */
+        private void receiveBatch()
+            throws IOException
+        {
+            long handle;
+
+            synchronized (this)
+            {
+                handle = this.handle;
+                if (handle == 0)
+                    throw new IOException("Closed");
+                receivers++;
+            }
+
+            int ret;
+
+            try
+            {
+                if (batch == null)
+                {
+                    batch = new byte[RECEIVE_BATCH_SIZE];
+                    batchLengths = new int[RECEIVE_BATCH_PACKETS];
+                }
+                ret
+                    = streamReceiveBatch(
+                            handle,
+                            batch, batchLengths,
+                            RECEIVE_TIMEOUT);
+            }
+            finally
+            {
+                synchronized (this)
+                {
+                    receivers--;
+                    notifyAll();
+                }
+            }
+
+            if (ret == 0)
+                throw new SocketTimeoutException();
+            if (ret < 0)
+                throw new IOException("TCP connection closed");
+            batchCount = ret;
+            batchIndex = 0;
+            batchOffset = 0;
+        }
+
+        /**
+         * Releases this <tt>Stream</tt>, closing it when its last user has
+         * released it. The packets still queued are sent for a short while.
+         * Must be called before the socket is closed.
+         */
+        public void release()
+        {
+            long handle;
+
+            synchronized (streams)
+            {
+                if (--references > 0)
+                    return;
+                streams.remove(socket);
+            }
+            synchronized (this)
+            {
+                handle = this.handle;
+                this.handle = 0;
+
+                /* The receivers must leave before the native stream is freed. */
+                boolean interrupted = false;
+
+                while (receivers > 0)
+                {
+                    try
+                    {
+                        wait();
+                    }
+                    catch (InterruptedException ie)
+                    {
+                        interrupted = true;
+                    }
+                }
+                if (interrupted)
+                    Thread.currentThread().interrupt();
+            }
+            if (handle != 0)
+            {
+                long[] stats = new long[STATS_LENGTH];
+
+                streamGetStats(handle, stats);
+                streamClose(handle);
+                logger.info(
+                        "Closed native TCP stream: received "
+                            + stats[STAT_PACKETS_RECEIVED] + " packets, sent "
+                            + stats[STAT_PACKETS_SENT] + " packets, "
+                            + stats[STAT_SEND_OVERFLOWS] + " send overflows");
+            }
+        }
+
+        /**
+         * Queues a packet to be framed and sent. Never blocks.
+         *
+         * @param buf the packet data
+         * @param offset the offset of the packet in <tt>buf</tt>
+         * @param length the length of the packet
+         * @return <tt>true</tt> if the packet was queued; <tt>false</tt> if it
+         * was too large, the send queue was full or the connection has failed
+         */
+        public synchronized boolean send(byte[] buf, int offset, int length)
+        {
+            if (handle == 0)
+                return false;
+            if ((offset < 0)
+                    || (length < 0)
+                    || (offset > buf.length - length))
+                throw new IndexOutOfBoundsException();
+            return streamSend(handle, buf, offset, length);
+        }
+    }
+}
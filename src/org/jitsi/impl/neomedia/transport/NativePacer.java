@@ -0,0 +1,247 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transport;
+
+import java.net.*;
+
+import org.jitsi.impl.neomedia.*;
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.util.*;
+
+/**
+ * Paces the RTP packets sent through a <tt>DatagramSocket</tt> with a token
+ * bucket in the native jnrtp library. A single native thread driven by a
+ * <tt>timerfd</tt> serves all paced streams and sends the due packets of each
+ * stream in one <tt>sendmmsg</tt> call, so that bursts such as the FU-A
+ * packets of a keyframe are spread out without Java timer threads.
+ */
+public class NativePacer
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>NativePacer</tt> class and its
+     * instances for logging output.
+     */
+    private static final Logger logger = Logger.getLogger(NativePacer.class);
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which enables
+     * native pacing of video RTP packets where it is available. Disabled by
+     * default because a paced stream is not subject to
+     * <tt>MaxPacketsPerMillisPolicy</tt>.
+     */
+    public static final String ENABLED_PNAME
+        = "org.jitsi.impl.neomedia.transport.NativePacer.enabled";
+
+    /**
+     * The factor by which the pacing rate exceeds the encoder target bitrate
+     * so that the queue drains faster than the encoder fills it.
+     */
+    public static final double PACING_FACTOR = 2.5;
+
+    /**
+     * The indexes of the statistics returned by {@link #getStats()}. The
+     * queue delays are averaged and maximised since the previous call.
+     */
+    public static final int STAT_PACKETS_SENT = 0;
+    public static final int STAT_BYTES_SENT = 1;
+    public static final int STAT_PACKETS_QUEUED = 2;
+    public static final int STAT_OVERFLOWS = 3;
+    public static final int STAT_SEND_ERRORS = 4;
+    public static final int STAT_QUEUE_DELAY_AVG_NANOS = 5;
+    public static final int STAT_QUEUE_DELAY_MAX_NANOS = 6;
+
+    private static final int STATS_LENGTH = 7;
+
+    /**
+     * Tells if the jnrtp library is correctly loaded.
+     */
+    public static final boolean isLoaded;
+
+    static
+    {
+        boolean loaded = false;
+
+        if (OSUtils.IS_LINUX)
+        {
+            try
+            {
+                NativeLibraryLoader.loadLibrary("jnrtp", NativePacer.class);
+                loaded = true;
+            }
+            catch (NullPointerException | UnsatisfiedLinkError | SecurityException e)
+            {
+                logger.warn("Failed to load jnrtp library: ", e);
+            }
+        }
+        isLoaded = loaded;
+    }
+
+    private static native void closeStream(long stream);
+
+    private static native boolean enqueue(
+            long stream,
+            byte[] buf, int offset, int length,
+            byte[] addr, int port);
+
+    private static native void getStats(long stream, long[] stats);
+
+    private static native long openStream(DatagramSocket socket, long bitrate);
+
+    private static native void setBitrate(long stream, long bitrate);
+
+    /**
+     * Determines whether native pacing is available and enabled.
+     *
+     * @return <tt>true</tt> if native pacing is to be used
+     */
+    public static boolean isEnabled()
+    {
+        if (!isLoaded)
+            return false;
+
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+
+        return (cfg != null) && cfg.global().getBoolean(ENABLED_PNAME, false);
+    }
+
+    /**
+     * Creates a new <tt>NativePacer</tt> for a specific socket.
+     *
+     * @param socket the <tt>DatagramSocket</tt> to send through
+     * @param bitrate the pacing rate in bits per second
+     * @return a new <tt>NativePacer</tt> or <tt>null</tt> if native pacing is
+     * not available for <tt>socket</tt>
+     */
+    public static NativePacer create(DatagramSocket socket, long bitrate)
+    {
+        if (!isLoaded || (socket == null))
+            return null;
+
+        long stream = openStream(socket, bitrate);
+
+        if (stream == 0)
+        {
+            logger.warn("Failed to open native pacer stream for " + socket);
+            return null;
+        }
+        return new NativePacer(stream);
+    }
+
+    /**
+     * The address of the last target so that its bytes are not fetched for
+     * every packet.
+     */
+    private InetAddress lastAddress;
+
+    /**
+     * The bytes of {@link #lastAddress}.
+     */
+    private byte[] lastAddressBytes;
+
+    /**
+     * The native <tt>PacerStream</tt>.
+     */
+    private long stream;
+
+    private NativePacer(long stream)
+    {
+        this.stream = stream;
+    }
+
+    /**
+     * Closes this <tt>NativePacer</tt>, sending whatever is still queued.
+     * Must be called before the socket is closed.
+     */
+    public synchronized void close()
+    {
+        if (stream != 0)
+        {
+            long[] stats = getStats();
+
+            closeStream(stream);
+            stream = 0;
+            logger.info(
+                    "Closed native pacer: sent " + stats[STAT_PACKETS_SENT]
+                        + " packets, " + stats[STAT_OVERFLOWS]
+                        + " overflows, " + stats[STAT_SEND_ERRORS]
+                        + " send errors");
+        }
+    }
+
+    /**
+     * Gets the statistics of this <tt>NativePacer</tt>.
+     *
+     * @return the statistics indexed by the <tt>STAT_</tt> constants
+     */
+    public synchronized long[] getStats()
+    {
+        long[] stats = new long[STATS_LENGTH];
+
+        if (stream != 0)
+            getStats(stream, stats);
+        return stats;
+    }
+
+    /**
+     * Gets the native <tt>PacerStream</tt> of this <tt>NativePacer</tt>. The
+     * caller must hold the lock of this instance for as long as it uses the
+     * returned handle.
+     *
+     * @return the native <tt>PacerStream</tt> or <tt>0</tt> if closed
+     */
+    long getStream()
+    {
+        return stream;
+    }
+
+    /**
+     * Queues a specific packet for paced sending. A packet which does not fit
+     * into the queue is dropped and counted in {@link #STAT_OVERFLOWS} rather
+     * than sent ahead of the packets queued before it.
+     *
+     * @param packet the <tt>RawPacket</tt> to send
+     * @param target the address to send <tt>packet</tt> to
+     * @return <tt>true</tt> if <tt>packet</tt> was queued or dropped;
+     * <tt>false</tt> if this <tt>NativePacer</tt> is closed and the caller is
+     * to send it itself
+     */
+    public synchronized boolean send(RawPacket packet, InetSocketAddress target)
+    {
+        if (stream == 0)
+            return false;
+
+        InetAddress address = target.getAddress();
+
+        if (!address.equals(lastAddress))
+        {
+            lastAddress = address;
+            lastAddressBytes = address.getAddress();
+        }
+        if (!enqueue(
+                stream,
+                packet.getBuffer(), packet.getOffset(), packet.getLength(),
+                lastAddressBytes, target.getPort())
+            && logger.isDebugEnabled())
+        {
+            logger.debug("Dropped packet which the pacer queue cannot hold");
+        }
+        return true;
+    }
+
+    /**
+     * Sets the pacing rate of this <tt>NativePacer</tt>.
+     *
+     * @param bitrate the pacing rate in bits per second
+     */
+    public synchronized void setBitrate(long bitrate)
+    {
+        if (stream != 0)
+            setBitrate(stream, bitrate);
+    }
+}
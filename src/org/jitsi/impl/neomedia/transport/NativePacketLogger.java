@@ -0,0 +1,338 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transport;
+
+import java.io.*;
+import java.net.*;
+
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.fileaccess.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.service.packetlogging.*;
+import org.jitsi.util.*;
+
+/**
+ * Logs RTP packets into pcapng files through a lock-free ring in the native
+ * jnrtp library. Capturing a packet costs the calling thread a single copy of
+ * its header (or of its first bytes up to a configured snap length) into a
+ * slot of the ring, or nothing at all if the packet is skipped by sampling; a
+ * native thread drains the ring in the background and writes the packets
+ * with synthesized IP and UDP headers, rotating through the number and size
+ * of files configured for the <tt>PacketLoggingService</tt>.
+ * <p>
+ * An instance is used per socket to keep its sampling counter and the bytes
+ * of its addresses.
+ * </p>
+ */
+public class NativePacketLogger
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>NativePacketLogger</tt> class and
+     * its instances for logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(NativePacketLogger.class);
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which enables
+     * native RTP packet logging where it is available. Disabled by default
+     * because the packets then go to pcapng files of their own rather than
+     * to <tt>PacketLoggingService.logPacket</tt>.
+     */
+    public static final String ENABLED_PNAME
+        = "org.jitsi.impl.neomedia.transport.NativePacketLogger.enabled";
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which specifies
+     * that only every N-th packet of each socket and direction is logged.
+     */
+    public static final String SAMPLING_PNAME
+        = "org.jitsi.impl.neomedia.transport.NativePacketLogger.sampling";
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which specifies
+     * the number of bytes logged of each packet. The default of <tt>0</tt>
+     * logs the RTP header only, as the Java packet logging does.
+     */
+    public static final String SNAP_LENGTH_PNAME
+        = "org.jitsi.impl.neomedia.transport.NativePacketLogger.snapLength";
+
+    /**
+     * The name of the directory in which the pcapng files are written,
+     * relative to the private persistent directory of the application.
+     */
+    private static final String LOG_DIRECTORY = "log";
+
+    /**
+     * The prefix of the names of the pcapng files. The files are named by
+     * appending the index of the file and <tt>.pcapng</tt>.
+     */
+    private static final String FILE_NAME_PREFIX = "jitsi-rtp";
+
+    /**
+     * The indexes of the statistics returned by {@link #getStats()}.
+     */
+    public static final int STAT_PACKETS_CAPTURED = 0;
+    public static final int STAT_PACKETS_DROPPED = 1;
+    public static final int STAT_PACKETS_WRITTEN = 2;
+    public static final int STAT_BYTES_WRITTEN = 3;
+    public static final int STAT_FILES_ROTATED = 4;
+    public static final int STAT_WRITE_ERRORS = 5;
+
+    private static final int STATS_LENGTH = 6;
+
+    /**
+     * Whether the native writer has been started (<tt>1</tt>), failed to or
+     * is disabled (<tt>-1</tt>) or has not been tried yet (<tt>0</tt>).
+     */
+    private static volatile int state = 0;
+
+    /**
+     * The sampling configured by {@link #SAMPLING_PNAME}.
+     */
+    private static int sampling = 1;
+
+    private static native boolean capture(
+            byte[] buf, int offset, int length,
+            byte[] srcAddr, int srcPort,
+            byte[] dstAddr, int dstPort,
+            boolean tcp);
+
+    private static native void getStats(long[] stats);
+
+    private static native boolean start(
+            String pathPrefix,
+            long fileLimit, int fileCount,
+            int snapLength);
+
+    private static native void stop();
+
+    /**
+     * Determines whether native packet logging is available and enabled,
+     * starting the native writer the first time. RTP packets are logged
+     * natively only while the <tt>PacketLoggingService</tt> has RTP logging
+     * enabled, so that its configuration applies as it does to
+     * <tt>logPacket</tt>.
+     *
+     * @param packetLogging the <tt>PacketLoggingService</tt> the packets would
+     * otherwise be logged through
+     * @return <tt>true</tt> if packets are to be logged through
+     * <tt>NativePacketLogger</tt>s
+     */
+    public static boolean isEnabled(PacketLoggingService packetLogging)
+    {
+        if ((packetLogging == null)
+                || !packetLogging.isLoggingEnabled(
+                        PacketLoggingService.ProtocolName.RTP))
+            return false;
+
+        int state = NativePacketLogger.state;
+
+        if (state == 0)
+            state = start();
+        return (state > 0);
+    }
+
+    /**
+     * Starts the native writer with the configuration of the
+     * <tt>PacketLoggingService</tt>.
+     *
+     * @return the new value of {@link #state}
+     */
+    private static synchronized int start()
+    {
+        if (state != 0)
+            return state;
+
+        state = -1;
+        // The jnrtp library is loaded by NativePacer.
+        if (!NativePacer.isLoaded)
+            return state;
+
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+        PacketLoggingService packetLogging = LibJitsi.getPacketLoggingService();
+        FileAccessService fileAccess = LibJitsi.getFileAccessService();
+
+        if ((cfg == null) || !cfg.global().getBoolean(ENABLED_PNAME, false))
+            return state;
+        if ((packetLogging == null) || (fileAccess == null))
+            return state;
+
+        PacketLoggingConfiguration packetLoggingCfg
+            = packetLogging.getConfiguration();
+        int snapLength = 0;
+
+        if (cfg != null)
+        {
+            sampling = Math.max(1, cfg.global().getInt(SAMPLING_PNAME, 1));
+            snapLength = Math.max(0, cfg.global().getInt(SNAP_LENGTH_PNAME, 0));
+        }
+
+        try
+        {
+            File directory
+                = fileAccess.getPrivatePersistentDirectory(LOG_DIRECTORY);
+            String pathPrefix
+                = new File(directory, FILE_NAME_PREFIX).getAbsolutePath();
+
+            if (start(
+                    pathPrefix,
+                    packetLoggingCfg.getLimit(),
+                    packetLoggingCfg.getLogfileCount(),
+                    snapLength))
+            {
+                logger.info("Logging RTP packets natively to " + pathPrefix);
+                Runtime.getRuntime().addShutdownHook(
+                        new Thread("NativePacketLogger shutdown")
+                        {
+                            @Override
+                            public void run()
+                            {
+                                stop();
+                            }
+                        });
+                state = 1;
+            }
+            else
+            {
+                logger.warn("Failed to start native packet logging");
+            }
+        }
+        catch (IOException | SecurityException e)
+        {
+            logger.warn("Failed to start native packet logging", e);
+        }
+        return state;
+    }
+
+    /**
+     * Gets the statistics of native packet logging. The packets dropped
+     * because the ring was full or their addresses were invalid are counted
+     * in {@link #STAT_PACKETS_DROPPED}.
+     *
+     * @return the statistics indexed by the <tt>STAT_</tt> constants
+     */
+    public static long[] getStats()
+    {
+        long[] stats = new long[STATS_LENGTH];
+
+        if (state > 0)
+            getStats(stats);
+        return stats;
+    }
+
+    /**
+     * The bytes of the local address.
+     */
+    private final byte[] localAddress;
+
+    /**
+     * The local port.
+     */
+    private final int localPort;
+
+    /**
+     * The remote address of the last packet so that its bytes are not
+     * fetched for every packet.
+     */
+    private InetAddress lastRemoteAddress;
+
+    /**
+     * The bytes of {@link #lastRemoteAddress}.
+     */
+    private byte[] lastRemoteAddressBytes;
+
+    /**
+     * The number of packets received and sent, for sampling.
+     */
+    private long receivedCount = 0;
+
+    private long sentCount = 0;
+
+    /**
+     * Whether the packets are carried over TCP rather than UDP.
+     */
+    private final boolean tcp;
+
+    /**
+     * Initializes a new <tt>NativePacketLogger</tt> for the packets of a
+     * specific socket.
+     *
+     * @param localAddress the local address of the socket
+     * @param localPort the local port of the socket
+     * @param tcp <tt>true</tt> if the socket is a TCP socket
+     */
+    public NativePacketLogger(
+            InetAddress localAddress,
+            int localPort,
+            boolean tcp)
+    {
+        this.localAddress = localAddress.getAddress();
+        this.localPort = localPort;
+        this.tcp = tcp;
+    }
+
+    /**
+     * Gets the bytes of a specific remote address.
+     */
+    private byte[] getRemoteAddressBytes(InetAddress remoteAddress)
+    {
+        if (!remoteAddress.equals(lastRemoteAddress))
+        {
+            lastRemoteAddress = remoteAddress;
+            lastRemoteAddressBytes = remoteAddress.getAddress();
+        }
+        return lastRemoteAddressBytes;
+    }
+
+    /**
+     * Logs a specific received packet unless it is skipped by sampling.
+     *
+     * @param buf the buffer which contains the packet
+     * @param offset the offset in <tt>buf</tt> at which the packet starts
+     * @param length the length in bytes of the packet
+     * @param remoteAddress the address the packet has been received from
+     * @param remotePort the port the packet has been received from
+     */
+    public synchronized void logReceived(
+            byte[] buf, int offset, int length,
+            InetAddress remoteAddress, int remotePort)
+    {
+        if ((sampling > 1) && ((++receivedCount % sampling) != 0))
+            return;
+
+        capture(
+                buf, offset, length,
+                getRemoteAddressBytes(remoteAddress), remotePort,
+                localAddress, localPort,
+                tcp);
+    }
+
+    /**
+     * Logs a specific sent packet unless it is skipped by sampling.
+     *
+     * @param buf the buffer which contains the packet
+     * @param offset the offset in <tt>buf</tt> at which the packet starts
+     * @param length the length in bytes of the packet
+     * @param remoteAddress the address the packet has been sent to
+     * @param remotePort the port the packet has been sent to
+     */
+    public synchronized void logSent(
+            byte[] buf, int offset, int length,
+            InetAddress remoteAddress, int remotePort)
+    {
+        if ((sampling > 1) && ((++sentCount % sampling) != 0))
+            return;
+
+        capture(
+                buf, offset, length,
+                localAddress, localPort,
+                getRemoteAddressBytes(remoteAddress), remotePort,
+                tcp);
+    }
+}
@@ -0,0 +1,237 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.transport;
+
+import java.net.*;
+
+import org.jitsi.impl.neomedia.*;
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
+import org.jitsi.util.*;
+
+/**
+ * Keeps the RTP packets recently sent through a <tt>DatagramSocket</tt> in
+ * per-SSRC rings in the native jnrtp library and resends those requested by
+ * the generic NACKs (RFC 4585) received in RTCP. The lookup of a requested
+ * packet is a single index into the ring of its SSRC and the resends go out
+ * through the native <tt>NativePacer</tt> of the stream, if any, or straight
+ * through the socket so that no Java objects are allocated on either path.
+ * <p>
+ * The packets are kept as sent i.e. after SRTP protection so resends are
+ * accepted by the replay protection of the receiver as long as they are
+ * within its replay window.
+ * </p>
+ */
+public class RetransmissionHistory
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>RetransmissionHistory</tt> class
+     * and its instances for logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(RetransmissionHistory.class);
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which enables
+     * the native retransmission of video RTP packets where it is available.
+     * Off by default, like the other native transport features, because it
+     * changes the send path of every video stream.
+     */
+    public static final String ENABLED_PNAME
+        = "org.jitsi.impl.neomedia.transport.RetransmissionHistory.enabled";
+
+    /**
+     * The name of the <tt>ConfigurationService</tt> property which specifies
+     * the number of packets kept per SSRC. The memory used per SSRC is this
+     * number (rounded up to a power of 2) times 1500 bytes.
+     */
+    public static final String CAPACITY_PNAME
+        = "org.jitsi.impl.neomedia.transport.RetransmissionHistory.capacity";
+
+    /**
+     * The default value of {@link #CAPACITY_PNAME}, enough for about a second
+     * of 2 Mbps video.
+     */
+    public static final int DEFAULT_CAPACITY = 256;
+
+    /**
+     * The indexes of the statistics returned by {@link #getStats()}.
+     */
+    public static final int STAT_PACKETS_STORED = 0;
+    public static final int STAT_NACKS_RECEIVED = 1;
+    public static final int STAT_PACKETS_REQUESTED = 2;
+    public static final int STAT_PACKETS_RESENT = 3;
+    public static final int STAT_PACKETS_MISSED = 4;
+
+    private static final int STATS_LENGTH = 5;
+
+    private static native long create(DatagramSocket socket, int capacity);
+
+    private static native void destroy(long history);
+
+    private static native void getStats(long history, long[] stats);
+
+    private static native int handleRtcp(
+            long history,
+            long pacer,
+            byte[] buf, int offset, int length);
+
+    private static native void store(
+            long history,
+            byte[] buf, int offset, int length,
+            byte[] addr, int port);
+
+    /**
+     * Determines whether native retransmission is available and enabled.
+     *
+     * @return <tt>true</tt> if native retransmission is to be used
+     */
+    public static boolean isEnabled()
+    {
+        // The jnrtp library is loaded by NativePacer.
+        if (!NativePacer.isLoaded)
+            return false;
+
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+
+        return (cfg != null) && cfg.global().getBoolean(ENABLED_PNAME, false);
+    }
+
+    /**
+     * Creates a new <tt>RetransmissionHistory</tt> for a specific socket.
+     *
+     * @param socket the <tt>DatagramSocket</tt> to resend through
+     * @return a new <tt>RetransmissionHistory</tt> or <tt>null</tt> if native
+     * retransmission is not available for <tt>socket</tt>
+     */
+    public static RetransmissionHistory create(DatagramSocket socket)
+    {
+        if (!NativePacer.isLoaded || (socket == null))
+            return null;
+
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
+        int capacity
+            = (cfg == null)
+                ? DEFAULT_CAPACITY
+                : cfg.global().getInt(CAPACITY_PNAME, DEFAULT_CAPACITY);
+        long history = create(socket, capacity);
+
+        if (history == 0)
+        {
+            logger.warn("Failed to create retransmission history for " + socket);
+            return null;
+        }
+        return new RetransmissionHistory(history);
+    }
+
+    /**
+     * The native <tt>RtxHistory</tt>.
+     */
+    private long history;
+
+    /**
+     * The address of the last target so that its bytes are not fetched for
+     * every packet.
+     */
+    private InetAddress lastAddress;
+
+    /**
+     * The bytes of {@link #lastAddress}.
+     */
+    private byte[] lastAddressBytes;
+
+    private RetransmissionHistory(long history)
+    {
+        this.history = history;
+    }
+
+    /**
+     * Closes this <tt>RetransmissionHistory</tt>, releasing the packets it
+     * keeps.
+     */
+    public synchronized void close()
+    {
+        if (history != 0)
+        {
+            long[] stats = getStats();
+
+            destroy(history);
+            history = 0;
+            logger.info(
+                    "Closed retransmission history: " + stats[STAT_NACKS_RECEIVED]
+                        + " NACKs requested " + stats[STAT_PACKETS_REQUESTED]
+                        + " packets, resent " + stats[STAT_PACKETS_RESENT]
+                        + ", missed " + stats[STAT_PACKETS_MISSED]);
+        }
+    }
+
+    /**
+     * Gets the statistics of this <tt>RetransmissionHistory</tt>.
+     *
+     * @return the statistics indexed by the <tt>STAT_</tt> constants
+     */
+    public synchronized long[] getStats()
+    {
+        long[] stats = new long[STATS_LENGTH];
+
+        if (history != 0)
+            getStats(history, stats);
+        return stats;
+    }
+
+    /**
+     * Resends the packets requested by the generic NACKs in a specific
+     * (compound) RTCP packet.
+     *
+     * @param buf the buffer which contains the decrypted RTCP packet
+     * @param offset the offset in <tt>buf</tt> at which the packet starts
+     * @param length the length in bytes of the packet
+     * @param pacer the <tt>NativePacer</tt> to queue the resends on or
+     * <tt>null</tt> to send them immediately
+     * @return the number of packets resent
+     */
+    public synchronized int handleRtcp(
+            byte[] buf, int offset, int length,
+            NativePacer pacer)
+    {
+        if (history == 0)
+            return 0;
+        if (pacer == null)
+            return handleRtcp(history, 0, buf, offset, length);
+
+        // Keeps the PacerStream from being closed while it is in use.
+        synchronized (pacer)
+        {
+            return handleRtcp(history, pacer.getStream(), buf, offset, length);
+        }
+    }
+
+    /**
+     * Keeps a copy of a specific sent packet for retransmission.
+     *
+     * @param packet the <tt>RawPacket</tt> which has been sent
+     * @param target the address <tt>packet</tt> has been sent to
+     */
+    public synchronized void store(RawPacket packet, InetSocketAddress target)
+    {
+        if (history == 0)
+            return;
+
+        InetAddress address = target.getAddress();
+
+        if (!address.equals(lastAddress))
+        {
+            lastAddress = address;
+            lastAddressBytes = address.getAddress();
+        }
+        store(
+                history,
+                packet.getBuffer(), packet.getOffset(), packet.getLength(),
+                lastAddressBytes, target.getPort());
+    }
+}
@@ -4,6 +4,7 @@
  * Distributable under LGPL license.
  * See terms of license at gnu.org.
  */
+// Portions (c) Microsoft Corporation. All rights reserved.
 package org.jitsi.service.neomedia;
 
 import java.awt.*;
@@ -110,6 +111,18 @@ public interface VideoMediaStream
      */
     QualityControl getQualityControl();
 
+    /**
+     * Sets the size and priority at which the video received by this
+     * <tt>VideoMediaStream</tt> is displayed, e.g. a small tile in a gallery,
+     * so that decoding may be reduced to what is visible.
+     *
+     * @param displaySize the size at which the received video is displayed or
+     * <tt>null</tt> if it is unknown
+     * @param lowPriority <tt>true</tt> if the received video is of low
+     * priority, e.g. the tile of a participant who is not speaking
+     */
+    void setRemoteDisplayHints(Dimension displaySize, boolean lowPriority);
+
     /**
      * Updates the <tt>QualityControl</tt> of this <tt>VideoMediaStream</tt>.
      *
@@ -63,6 +63,14 @@ public class Constants
      */
     public static final String OPUS_RTP = "opus/rtp";
 
+    /**
+     * The name of the property used to control the Opus encoder
+     * "application" setting: "voip", "audio" or "lowdelay"
+     */
+    public static final String PROP_OPUS_APPLICATION
+        = "net.java.sip.communicator.impl.neomedia.codec.audio.opus.encoder"
+            + ".APPLICATION";
+
     /**
      * The name of the property used to control the Opus encoder
      * "audio bandwidth" setting
@@ -101,6 +109,14 @@ public class Constants
         = "net.java.sip.communicator.impl.neomedia.codec.audio.opus.encoder"
             + ".FEC";
 
+    /**
+     * The name of the property used to control the duration in milliseconds
+     * of the frames of the Opus encoder: 2.5, 5, 10, 20, 40 or 60
+     */
+    public static final String PROP_OPUS_FRAME_DURATION
+        = "net.java.sip.communicator.impl.neomedia.codec.audio.opus.encoder"
+            + ".FRAME_DURATION";
+
     /**
      * The name of the property used to control the Opus encoder
      * "minimum expected packet loss" setting
@@ -0,0 +1,25 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.service.neomedia.control;
+
+import javax.media.*;
+import java.util.*;
+
+/**
+ * An interface used to pass the advanced attributes of a format (received via
+ * SDP/Jingle, e.g. <tt>ptime</tt> and <tt>maxptime</tt>) to codecs.
+ */
+public interface AdvancedAttributesAwareCodec extends Control
+{
+    /**
+     * Sets the advanced attributes to <tt>attributes</tt>
+     *
+     * @param attributes The advanced attributes to set
+     */
+    void setAdvancedAttributes(Map<String, String> attributes);
+}
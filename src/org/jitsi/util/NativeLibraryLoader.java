@@ -0,0 +1,167 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.util;
+
+import java.util.*;
+
+/**
+ * Loads the native JNI libraries of libjitsi and records how long each took
+ * to load.
+ * <p>
+ * If the combined jnmedia library is available, the libraries it bundles are
+ * not loaded separately: jnmedia is loaded once and the native methods of
+ * each class which would have loaded one of them are registered explicitly
+ * when the class is initialized, i.e. when it is first used. Otherwise, or
+ * for the libraries jnmedia does not bundle, the library is loaded with
+ * <tt>System.loadLibrary</tt>.
+ * </p>
+ */
+public class NativeLibraryLoader
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>NativeLibraryLoader</tt> class for
+     * logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(NativeLibraryLoader.class);
+
+    /**
+     * The name of the system property which disables the use of the combined
+     * jnmedia library. A system property rather than a
+     * <tt>ConfigurationService</tt> property because libraries are loaded from
+     * static initializers which may run before the configuration is.
+     */
+    public static final String DISABLE_COMBINED_PNAME
+        = "org.jitsi.util.NativeLibraryLoader.disableCombined";
+
+    /**
+     * The name of the combined library.
+     */
+    private static final String COMBINED_LIBRARY = "jnmedia";
+
+    /**
+     * Whether the combined library has been loaded (<tt>1</tt>), failed to
+     * or is disabled (<tt>-1</tt>) or has not been tried yet (<tt>0</tt>).
+     */
+    private static int combinedState = 0;
+
+    /**
+     * The time in nanoseconds each library took to load (or to have the
+     * native methods of its classes registered), in the order the libraries
+     * were first loaded.
+     */
+    private static final Map<String, Long> loadTimes = new LinkedHashMap<>();
+
+    /**
+     * Registers the native methods of a specific class bundled into the
+     * combined library.
+     *
+     * @param clazz the class to register the native methods of
+     * @param className the binary name of <tt>clazz</tt> with slashes for dots
+     * @return <tt>true</tt> if <tt>clazz</tt> is bundled into the combined
+     * library and its native methods have been registered
+     */
+    private static native boolean registerNatives(
+            Class<?> clazz,
+            String className);
+
+    /**
+     * Loads the native library of a specific class, from the combined library
+     * if it bundles the class.
+     *
+     * @param libname the name of the library as passed to
+     * <tt>System.loadLibrary</tt>
+     * @param clazz the class which declares the native methods implemented by
+     * <tt>libname</tt>
+     * @throws UnsatisfiedLinkError if the library fails to load
+     */
+    public static synchronized void loadLibrary(String libname, Class<?> clazz)
+    {
+        long startTime = System.nanoTime();
+
+        if (loadCombined()
+                && registerNatives(clazz, clazz.getName().replace('.', '/')))
+        {
+            recordLoadTime(libname, startTime, true);
+            return;
+        }
+
+        /*
+         * The classes which are only implemented by the combined library have
+         * no other library to fall back to.
+         */
+        if (COMBINED_LIBRARY.equals(libname))
+        {
+            throw new UnsatisfiedLinkError(
+                    "The combined native library is not available");
+        }
+
+        System.loadLibrary(libname);
+        recordLoadTime(libname, startTime, false);
+    }
+
+    /**
+     * Gets the time each library took to load.
+     *
+     * @return the time in nanoseconds each library took to load, in the order
+     * the libraries were first loaded
+     */
+    public static synchronized Map<String, Long> getLoadTimes()
+    {
+        return new LinkedHashMap<>(loadTimes);
+    }
+
+    /**
+     * Loads the combined library the first time it is needed.
+     *
+     * @return <tt>true</tt> if the combined library is loaded
+     */
+    private static boolean loadCombined()
+    {
+        if (combinedState == 0)
+        {
+            combinedState = -1;
+            if (!Boolean.getBoolean(DISABLE_COMBINED_PNAME))
+            {
+                long startTime = System.nanoTime();
+
+                try
+                {
+                    System.loadLibrary(COMBINED_LIBRARY);
+                    combinedState = 1;
+                    recordLoadTime(COMBINED_LIBRARY, startTime, false);
+                }
+                catch (UnsatisfiedLinkError | SecurityException e)
+                {
+                    logger.info(
+                            "Not using the combined native library: "
+                                + e.getMessage());
+                }
+            }
+        }
+        return (combinedState > 0);
+    }
+
+    /**
+     * Records the time a specific library took to load, adding to the time
+     * of the library if it is registered for more than one class.
+     */
+    private static void recordLoadTime(
+            String libname,
+            long startTime,
+            boolean registered)
+    {
+        long nanos = System.nanoTime() - startTime;
+        Long previous = loadTimes.get(libname);
+
+        loadTimes.put(libname, (previous == null) ? nanos : (previous + nanos));
+        logger.info(
+                (registered ? "Registered natives of " : "Loaded ") + libname
+                    + " in " + (nanos / 1000) + "us");
+    }
+}
@@ -23,6 +23,9 @@ public class OSUtils
     /** <tt>true</tt> if architecture is 64 bit. */
     public static final boolean IS_64_BIT;
 
+    /** <tt>true</tt> if OS is Linux. */
+    public static final boolean IS_LINUX;
+
     /** <tt>true</tt> if OS is MacOSX. */
     public static final boolean IS_MAC;
 
@@ -80,6 +83,15 @@ public class OSUtils
 
         if (osName == null)
         {
+            IS_LINUX = false;
+            IS_MAC = false;
+            IS_WINDOWS = false;
+            IS_WINDOWS_VISTA = false;
+            IS_WINDOWS_7 = false;
+        }
+        else if (osName.startsWith("Linux"))
+        {
+            IS_LINUX = true;
             IS_MAC = false;
             IS_WINDOWS = false;
             IS_WINDOWS_VISTA = false;
@@ -87,6 +99,7 @@ public class OSUtils
         }
         else if (osName.startsWith("Mac"))
         {
+            IS_LINUX = false;
             IS_MAC = true;
             IS_WINDOWS = false;
             IS_WINDOWS_VISTA = false;
@@ -95,6 +108,7 @@ public class OSUtils
         }
         else if (osName.startsWith("Windows"))
         {
+            IS_LINUX = false;
             IS_MAC = false;
             IS_WINDOWS = true;
             IS_WINDOWS_VISTA = (osName.contains("Vista"));
@@ -102,6 +116,7 @@ public class OSUtils
         }
         else
         {
+            IS_LINUX = false;
             IS_MAC = false;
             IS_WINDOWS = false;
             IS_WINDOWS_VISTA = false;
@@ -0,0 +1,239 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.conference.loadgen;
+
+import java.io.*;
+import java.lang.management.*;
+import java.nio.charset.*;
+import java.nio.file.*;
+import java.util.*;
+
+import org.jitsi.service.libjitsi.*;
+
+/**
+ * Measures how the cost of hosting a conference grows with its number of
+ * participants. Runs a {@link SyntheticConference} of each of the given
+ * sizes over loopback and prints, for each, the server CPU time per
+ * participant, the mixing time and deadline misses, the end-to-end latency
+ * percentiles and the memory used.
+ * <p>
+ * Usage: <tt>ConferenceLoadGenerator [--codec opus|g722|pcmu]
+ * [--participants 10,20,40] [--duration seconds] [--warmup seconds]
+ * [--period milliseconds]</tt>
+ * </p>
+ */
+public class ConferenceLoadGenerator
+{
+    private static final String USAGE
+        = "Usage: ConferenceLoadGenerator [--codec opus|g722|pcmu]"
+            + " [--participants 10,20,40] [--duration seconds]"
+            + " [--warmup seconds] [--period milliseconds]";
+
+    /**
+     * Gets the CPU time of the process.
+     *
+     * @return the CPU time of the process in nanoseconds or <tt>-1</tt> if it
+     * is not available
+     */
+    private static long getProcessCpuNanos()
+    {
+        OperatingSystemMXBean os = ManagementFactory.getOperatingSystemMXBean();
+
+        if (os instanceof com.sun.management.OperatingSystemMXBean)
+        {
+            return
+                ((com.sun.management.OperatingSystemMXBean) os)
+                    .getProcessCpuTime();
+        }
+        return -1;
+    }
+
+    /**
+     * Gets the resident set size of the process.
+     *
+     * @return the resident set size in kilobytes or <tt>-1</tt> if it is not
+     * available
+     */
+    private static long getResidentKilobytes()
+    {
+        try
+        {
+            for (String line
+                    : Files.readAllLines(
+                            Paths.get("/proc/self/status"),
+                            StandardCharsets.US_ASCII))
+            {
+                if (line.startsWith("VmRSS:"))
+                {
+                    return
+                        Long.parseLong(
+                                line.substring(6).replace("kB", "").trim());
+                }
+            }
+        }
+        catch (IOException | NumberFormatException e)
+        {
+            // There is no /proc outside of Linux.
+        }
+        return -1;
+    }
+
+    /**
+     * Gets the sum of the CPU times of specific threads.
+     *
+     * @return the CPU time of the threads in nanoseconds
+     */
+    private static long getThreadCpuNanos(ThreadMXBean threads, long[] ids)
+    {
+        long sum = 0;
+
+        for (long id : ids)
+        {
+            long nanos = threads.getThreadCpuTime(id);
+
+            if (nanos > 0)
+                sum += nanos;
+        }
+        return sum;
+    }
+
+    public static void main(String[] args)
+        throws Exception
+    {
+        SyntheticCodec codec = SyntheticCodec.OPUS;
+        int[] sizes = { 10, 20, 40 };
+        int durationSeconds = 30;
+        int warmupSeconds = 5;
+        int periodMillis = 20;
+
+        for (int i = 0; i < args.length; i++)
+        {
+            String arg = args[i];
+            String value = (i + 1 < args.length) ? args[++i] : null;
+
+            if (value == null)
+            {
+                System.err.println(USAGE);
+                System.exit(1);
+            }
+            switch (arg)
+            {
+            case "--codec":
+                codec = SyntheticCodec.forName(value);
+                if (codec == null)
+                {
+                    System.err.println("Unknown codec " + value);
+                    System.exit(1);
+                }
+                break;
+            case "--participants":
+                String[] counts = value.split(",");
+
+                sizes = new int[counts.length];
+                for (int j = 0; j < counts.length; j++)
+                    sizes[j] = Integer.parseInt(counts[j].trim());
+                break;
+            case "--duration":
+                durationSeconds = Integer.parseInt(value);
+                break;
+            case "--warmup":
+                warmupSeconds = Integer.parseInt(value);
+                break;
+            case "--period":
+                periodMillis = Integer.parseInt(value);
+                break;
+            default:
+                System.err.println(USAGE);
+                System.exit(1);
+            }
+        }
+
+        ThreadMXBean threads = ManagementFactory.getThreadMXBean();
+
+        if (threads.isThreadCpuTimeSupported())
+            threads.setThreadCpuTimeEnabled(true);
+
+        LibJitsi.start();
+        try
+        {
+            System.out.println(
+                    "codec=" + codec.displayName + " period=" + periodMillis
+                        + "ms duration=" + durationSeconds + "s warmup="
+                        + warmupSeconds + "s cpus="
+                        + Runtime.getRuntime().availableProcessors());
+            System.out.println(
+                    "participants\tserver_cpu_ms_per_participant_s"
+                        + "\tprocess_cpu_pct\tmix_avg_ms\tmix_max_ms"
+                        + "\tdeadline_misses\tcycles\tlatency_p50_ms"
+                        + "\tlatency_p95_ms\tlatency_p99_ms\tlatency_max_ms"
+                        + "\tdropped\theap_kb\trss_kb");
+
+            for (int size : sizes)
+            {
+                SyntheticConference conference
+                    = new SyntheticConference(codec, periodMillis, size);
+
+                conference.start();
+                try
+                {
+                    Thread.sleep(warmupSeconds * 1000L);
+                    conference.resetStatistics();
+
+                    long[] ids = conference.getServerThreadIds();
+                    long threadCpu0 = getThreadCpuNanos(threads, ids);
+                    long processCpu0 = getProcessCpuNanos();
+                    long wall0 = System.nanoTime();
+
+                    Thread.sleep(durationSeconds * 1000L);
+
+                    long wall = System.nanoTime() - wall0;
+                    long threadCpu
+                        = getThreadCpuNanos(threads, ids) - threadCpu0;
+                    long processCpu = getProcessCpuNanos() - processCpu0;
+                    long[] packets = conference.getPacketCounts();
+
+                    System.gc();
+
+                    Runtime runtime = Runtime.getRuntime();
+                    long heap
+                        = (runtime.totalMemory() - runtime.freeMemory()) / 1024;
+
+                    System.out.println(
+                            String.format(
+                                    Locale.ROOT,
+                                    "%d\t%.2f\t%.1f\t%.3f\t%.3f\t%d\t%d"
+                                        + "\t%d\t%d\t%d\t%.1f\t%d\t%d\t%d",
+                                    size,
+                                    threadCpu / 1e6 / size / (wall / 1e9),
+                                    (processCpu < 0)
+                                        ? -1.0
+                                        : 100.0 * processCpu / wall,
+                                    conference.getMixAverageMillis(),
+                                    conference.getMixMaxMillis(),
+                                    conference.getDeadlineMisses(),
+                                    conference.getCycles(),
+                                    conference.getLatencyPercentileMillis(0.5),
+                                    conference.getLatencyPercentileMillis(0.95),
+                                    conference.getLatencyPercentileMillis(0.99),
+                                    conference.getLatencyMaxMillis(),
+                                    packets[2],
+                                    heap,
+                                    getResidentKilobytes()));
+                }
+                finally
+                {
+                    conference.stop();
+                }
+            }
+        }
+        finally
+        {
+            LibJitsi.stop();
+        }
+    }
+}
@@ -0,0 +1,197 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.conference.loadgen;
+
+import java.io.*;
+import java.util.*;
+import java.util.concurrent.*;
+
+import javax.media.*;
+import javax.media.control.*;
+import javax.media.format.*;
+
+import org.jitsi.impl.neomedia.jmfext.media.protocol.*;
+
+/**
+ * A <tt>PushBufferDataSource</tt> of a single stream of PCM frames which are
+ * handed to it with {@link #push(byte[], int, long)}. It stands in for the
+ * <tt>DataSource</tt>s of the received streams of a conference, and for its
+ * capture device whose pushes drive the <tt>AudioMixer</tt>.
+ */
+public class SyntheticAudioDataSource
+    extends AbstractPushBufferCaptureDevice<SyntheticAudioDataSource.Stream>
+{
+    /**
+     * The number of frames a stream holds before it drops the oldest if it
+     * is not read.
+     */
+    private static final int CAPACITY = 8;
+
+    /**
+     * The <tt>AudioFormat</tt> of the frames.
+     */
+    private final AudioFormat format;
+
+    /**
+     * Initializes a new <tt>SyntheticAudioDataSource</tt>.
+     *
+     * @param format the <tt>AudioFormat</tt> of the frames
+     */
+    public SyntheticAudioDataSource(AudioFormat format)
+    {
+        this.format = format;
+    }
+
+    @Override
+    protected Stream createStream(int streamIndex, FormatControl formatControl)
+    {
+        return new Stream(this, formatControl);
+    }
+
+    @Override
+    protected Format getFormat(int streamIndex, Format oldValue)
+    {
+        return format;
+    }
+
+    /**
+     * Gets the stream of this <tt>DataSource</tt>.
+     *
+     * @return the stream of this <tt>DataSource</tt> or <tt>null</tt> if it is
+     * not connected
+     */
+    private Stream getStream()
+    {
+        synchronized (getStreamSyncRoot())
+        {
+            List<Stream> streams = streams();
+
+            return streams.isEmpty() ? null : streams.get(0);
+        }
+    }
+
+    @Override
+    protected Format[] getSupportedFormats(int streamIndex)
+    {
+        return new Format[] { format };
+    }
+
+    /**
+     * Hands a frame to the stream of this <tt>DataSource</tt>.
+     *
+     * @param pcm the PCM of the frame
+     * @param length the length in bytes of <tt>pcm</tt>
+     * @param timeStamp the time stamp of the frame in nanoseconds of
+     * <tt>System.nanoTime()</tt> or <tt>Buffer.TIME_UNKNOWN</tt>
+     * @return <tt>false</tt> if an older frame had to be dropped
+     */
+    public boolean push(byte[] pcm, int length, long timeStamp)
+    {
+        Stream stream = getStream();
+
+        return (stream == null) || stream.push(pcm, length, timeStamp);
+    }
+
+    /**
+     * A frame queued in a {@link Stream}.
+     */
+    private static class Frame
+    {
+        final byte[] data;
+
+        final long timeStamp;
+
+        Frame(byte[] data, long timeStamp)
+        {
+            this.data = data;
+            this.timeStamp = timeStamp;
+        }
+    }
+
+    /**
+     * The <tt>PushBufferStream</tt> of a <tt>SyntheticAudioDataSource</tt>.
+     */
+    static class Stream
+        extends AbstractPushBufferStream<SyntheticAudioDataSource>
+    {
+        private final BlockingQueue<Frame> frames
+            = new ArrayBlockingQueue<>(CAPACITY);
+
+        private long sequenceNumber;
+
+        Stream(
+                SyntheticAudioDataSource dataSource,
+                FormatControl formatControl)
+        {
+            super(dataSource, formatControl);
+        }
+
+        @Override
+        protected Format doGetFormat()
+        {
+            return dataSource.format;
+        }
+
+        boolean push(byte[] pcm, int length, long timeStamp)
+        {
+            byte[] data = new byte[length];
+            boolean dropped = false;
+
+            System.arraycopy(pcm, 0, data, 0, length);
+
+            Frame frame = new Frame(data, timeStamp);
+
+            while (!frames.offer(frame))
+            {
+                frames.poll();
+                dropped = true;
+            }
+
+            BufferTransferHandler transferHandler = this.transferHandler;
+
+            if (transferHandler != null)
+                transferHandler.transferData(this);
+            return !dropped;
+        }
+
+        @Override
+        public void read(Buffer buffer)
+            throws IOException
+        {
+            Frame frame = frames.poll();
+
+            if (frame == null)
+            {
+                buffer.setDiscard(true);
+                buffer.setLength(0);
+                return;
+            }
+
+            Object data = buffer.getData();
+            byte[] bytes;
+
+            if ((data instanceof byte[])
+                    && (((byte[]) data).length >= frame.data.length))
+            {
+                bytes = (byte[]) data;
+            }
+            else
+            {
+                bytes = new byte[frame.data.length];
+                buffer.setData(bytes);
+            }
+            System.arraycopy(frame.data, 0, bytes, 0, frame.data.length);
+            buffer.setOffset(0);
+            buffer.setLength(frame.data.length);
+            buffer.setFormat(dataSource.format);
+            buffer.setTimeStamp(frame.timeStamp);
+            buffer.setSequenceNumber(sequenceNumber++);
+            buffer.setFlags(Buffer.FLAG_SYSTEM_TIME | Buffer.FLAG_LIVE_DATA);
+        }
+    }
+}
@@ -0,0 +1,282 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.conference.loadgen;
+
+import javax.media.*;
+import javax.media.format.*;
+
+/**
+ * The codecs the conference load generator can run with. Each of them is
+ * instantiated through the same <tt>Codec</tt> plugins as in a real call, so
+ * that the payloads and the cost of coding them are real.
+ */
+public enum SyntheticCodec
+{
+    OPUS("opus", 111, 48000, 48000)
+    {
+        @Override
+        Codec createDecoder()
+        {
+            return new org.jitsi.impl.neomedia.codec.audio.opus.JNIDecoder();
+        }
+
+        @Override
+        Codec createEncoder()
+        {
+            return new org.jitsi.impl.neomedia.codec.audio.opus.JNIEncoder();
+        }
+    },
+
+    G722("g722", 9, 16000, 8000)
+    {
+        @Override
+        Codec createDecoder()
+        {
+            return
+                new net.java.sip.communicator.impl.neomedia.codec.audio.g722
+                    .JNIDecoder();
+        }
+
+        @Override
+        Codec createEncoder()
+        {
+            return
+                new net.java.sip.communicator.impl.neomedia.codec.audio.g722
+                    .JNIEncoder();
+        }
+    },
+
+    /**
+     * G.711 u-law. It has no native implementation in the tree so the Java
+     * one used by calls is used here as well.
+     */
+    PCMU("pcmu", 0, 8000, 8000)
+    {
+        @Override
+        Codec createDecoder()
+        {
+            return new org.jitsi.impl.neomedia.codec.audio.ulaw.JavaDecoder();
+        }
+
+        @Override
+        Codec createEncoder()
+        {
+            return new org.jitsi.impl.neomedia.codec.audio.ulaw.JavaEncoder();
+        }
+    };
+
+    /**
+     * Gets the <tt>SyntheticCodec</tt> with a specific name.
+     *
+     * @param name the name of the codec, case insensitive
+     * @return the <tt>SyntheticCodec</tt> named <tt>name</tt> or
+     * <tt>null</tt> if there is no such codec
+     */
+    public static SyntheticCodec forName(String name)
+    {
+        for (SyntheticCodec codec : values())
+        {
+            if (codec.displayName.equalsIgnoreCase(name))
+                return codec;
+        }
+        return null;
+    }
+
+    /**
+     * The name of the codec on the command line.
+     */
+    public final String displayName;
+
+    /**
+     * The RTP payload type of the codec.
+     */
+    public final int payloadType;
+
+    /**
+     * The rate of the PCM the codec encodes and decodes, which is the rate
+     * of the conference.
+     */
+    public final int sampleRate;
+
+    /**
+     * The RTP clock rate of the codec.
+     */
+    public final int clockRate;
+
+    SyntheticCodec(
+            String displayName,
+            int payloadType,
+            int sampleRate,
+            int clockRate)
+    {
+        this.displayName = displayName;
+        this.payloadType = payloadType;
+        this.sampleRate = sampleRate;
+        this.clockRate = clockRate;
+    }
+
+    abstract Codec createDecoder();
+
+    abstract Codec createEncoder();
+
+    /**
+     * Gets the format of the PCM the codec encodes and decodes.
+     *
+     * @return the <tt>AudioFormat</tt> of the PCM of the codec
+     */
+    public AudioFormat getPcmFormat()
+    {
+        return
+            new AudioFormat(
+                    AudioFormat.LINEAR,
+                    sampleRate,
+                    16,
+                    1,
+                    AudioFormat.LITTLE_ENDIAN,
+                    AudioFormat.SIGNED,
+                    Format.NOT_SPECIFIED /* frameSizeInBits */,
+                    Format.NOT_SPECIFIED /* frameRate */,
+                    Format.byteArray);
+    }
+
+    /**
+     * Opens a new encoder of this codec.
+     *
+     * @return a new <tt>Channel</tt> which encodes PCM
+     * @throws ResourceUnavailableException if the encoder could not be opened
+     */
+    public Channel openEncoder()
+        throws ResourceUnavailableException
+    {
+        Codec encoder = createEncoder();
+        Format inputFormat = getPcmFormat();
+        Format[] outputFormats = encoder.getSupportedOutputFormats(inputFormat);
+
+        if ((encoder.setInputFormat(inputFormat) == null)
+                || (outputFormats == null)
+                || (outputFormats.length == 0)
+                || (encoder.setOutputFormat(outputFormats[0]) == null))
+        {
+            throw new ResourceUnavailableException(
+                    displayName + " encoder format");
+        }
+        encoder.open();
+        return new Channel(encoder, inputFormat);
+    }
+
+    /**
+     * Opens a new decoder of this codec.
+     *
+     * @return a new <tt>Channel</tt> which decodes to PCM
+     * @throws ResourceUnavailableException if the decoder could not be opened
+     */
+    public Channel openDecoder()
+        throws ResourceUnavailableException
+    {
+        Codec decoder = createDecoder();
+        Format inputFormat = decoder.getSupportedInputFormats()[0];
+        Format outputFormat = null;
+
+        decoder.setInputFormat(inputFormat);
+        for (Format format : decoder.getSupportedOutputFormats(inputFormat))
+        {
+            if ((format instanceof AudioFormat)
+                    && (((AudioFormat) format).getSampleRate() == sampleRate))
+            {
+                outputFormat = format;
+                break;
+            }
+        }
+        if ((outputFormat == null)
+                || (decoder.setOutputFormat(outputFormat) == null))
+        {
+            throw new ResourceUnavailableException(
+                    displayName + " decoder format");
+        }
+        decoder.open();
+        return new Channel(decoder, inputFormat);
+    }
+
+    /**
+     * An open encoder or decoder which processes one frame or packet at a
+     * time.
+     */
+    public static class Channel
+    {
+        private final Codec codec;
+
+        private final Format inputFormat;
+
+        private final Buffer inBuffer = new Buffer();
+
+        private final Buffer outBuffer = new Buffer();
+
+        private Channel(Codec codec, Format inputFormat)
+        {
+            this.codec = codec;
+            this.inputFormat = inputFormat;
+        }
+
+        public void close()
+        {
+            codec.close();
+        }
+
+        /**
+         * Encodes or decodes a frame or packet.
+         *
+         * @param in the frame or packet
+         * @param length the length of <tt>in</tt> in bytes
+         * @param sequenceNumber the RTP sequence number of a packet to
+         * decode, from which the decoder detects losses
+         * @param out the array to write the output to
+         * @return the length of the output in bytes, <tt>0</tt> if the codec
+         * produced nothing, or <tt>-1</tt> if it failed
+         */
+        public int process(
+                byte[] in, int length,
+                long sequenceNumber,
+                byte[] out)
+        {
+            int outLength = 0;
+            int result;
+
+            inBuffer.setData(in);
+            inBuffer.setOffset(0);
+            inBuffer.setLength(length);
+            inBuffer.setFormat(inputFormat);
+            inBuffer.setSequenceNumber(sequenceNumber);
+            inBuffer.setFlags(0);
+            do
+            {
+                outBuffer.setOffset(0);
+                outBuffer.setLength(0);
+                outBuffer.setFlags(0);
+                result = codec.process(inBuffer, outBuffer);
+                if ((result & PlugIn.BUFFER_PROCESSED_FAILED) != 0)
+                    return -1;
+
+                int processed = outBuffer.getLength();
+
+                if (!outBuffer.isDiscard()
+                        && ((result & PlugIn.OUTPUT_BUFFER_NOT_FILLED) == 0)
+                        && (processed > 0))
+                {
+                    processed = Math.min(processed, out.length - outLength);
+                    System.arraycopy(
+                            outBuffer.getData(), outBuffer.getOffset(),
+                            out, outLength,
+                            processed);
+                    outLength += processed;
+                }
+            }
+            while ((result & PlugIn.INPUT_BUFFER_NOT_CONSUMED) != 0);
+            return outLength;
+        }
+    }
+}
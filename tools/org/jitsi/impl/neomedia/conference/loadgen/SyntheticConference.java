@@ -0,0 +1,366 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.conference.loadgen;
+
+import java.io.*;
+import java.util.*;
+import java.util.concurrent.*;
+import java.util.concurrent.atomic.*;
+import java.util.concurrent.locks.*;
+
+import javax.media.*;
+
+import org.jitsi.impl.neomedia.conference.*;
+import org.jitsi.util.*;
+
+/**
+ * A conference of {@link SyntheticParticipant}s mixed by an
+ * <tt>AudioMixer</tt>. A clock thread pushes a frame of silence into the
+ * capture device of the mixer every period, as the audio system would, and
+ * each push mixes and sends the audio of the participants. A sending thread
+ * makes the client side of every participant send a frame every period.
+ */
+public class SyntheticConference
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>SyntheticConference</tt> class and
+     * its instances for logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(SyntheticConference.class);
+
+    /**
+     * The number of buckets of the latency histogram. Each is a millisecond
+     * wide and an extra one counts the latencies of a second or more.
+     */
+    private static final int LATENCY_BUCKETS = 1000;
+
+    final AudioMixer audioMixer;
+
+    final SyntheticCodec codec;
+
+    /**
+     * The number of samples per frame.
+     */
+    final int frameSamples;
+
+    private final SyntheticAudioDataSource clock;
+
+    private final byte[] silence;
+
+    private final long periodNanos;
+
+    private final List<SyntheticParticipant> participants = new ArrayList<>();
+
+    private Thread clockThread;
+
+    private Thread senderThread;
+
+    private volatile boolean running;
+
+    /* Statistics */
+
+    private final AtomicLongArray latencyHistogram
+        = new AtomicLongArray(LATENCY_BUCKETS + 1);
+
+    private final AtomicLong latencyMaxNanos = new AtomicLong();
+
+    private long cycles;
+
+    private long deadlineMisses;
+
+    private long mixNanosSum;
+
+    private long mixNanosMax;
+
+    /**
+     * Initializes a new <tt>SyntheticConference</tt>.
+     *
+     * @param codec the codec the participants send and receive with
+     * @param periodMillis the duration in milliseconds of the frames
+     * @param participantCount the number of participants
+     * @throws IOException if a participant could not be created
+     */
+    public SyntheticConference(
+            SyntheticCodec codec,
+            int periodMillis,
+            int participantCount)
+        throws IOException
+    {
+        this.codec = codec;
+        frameSamples = codec.sampleRate * periodMillis / 1000;
+        periodNanos = TimeUnit.MILLISECONDS.toNanos(periodMillis);
+        silence = new byte[frameSamples * 2];
+
+        clock = new SyntheticAudioDataSource(codec.getPcmFormat());
+        audioMixer = new AudioMixer(clock);
+        try
+        {
+            for (int i = 0; i < participantCount; i++)
+                participants.add(new SyntheticParticipant(this, i));
+        }
+        catch (IOException ioe)
+        {
+            for (SyntheticParticipant participant : participants)
+                participant.stop();
+            throw ioe;
+        }
+    }
+
+    /**
+     * Gets the number of participants.
+     *
+     * @return the number of participants
+     */
+    public int getParticipantCount()
+    {
+        return participants.size();
+    }
+
+    /**
+     * Gets the ids of the threads which receive and mix on the server side of
+     * this conference, which are the ones whose CPU time measures the cost of
+     * the conference.
+     *
+     * @return the ids of the server threads
+     */
+    public long[] getServerThreadIds()
+    {
+        long[] ids = new long[participants.size() + 1];
+        int i = 0;
+
+        ids[i++] = clockThread.getId();
+        for (SyntheticParticipant participant : participants)
+            ids[i++] = participant.getServerThreadId();
+        return ids;
+    }
+
+    /**
+     * Records the time from a client sending a frame to a client receiving
+     * the first mix containing it.
+     *
+     * @param nanos the latency in nanoseconds
+     */
+    void recordLatency(long nanos)
+    {
+        if (nanos < 0)
+            return;
+
+        int bucket = (int) Math.min(LATENCY_BUCKETS, nanos / 1000000);
+
+        latencyHistogram.incrementAndGet(bucket);
+
+        long max;
+
+        while (nanos > (max = latencyMaxNanos.get())
+                && !latencyMaxNanos.compareAndSet(max, nanos));
+    }
+
+    /**
+     * Clears the statistics, such as at the end of a warm-up.
+     */
+    public synchronized void resetStatistics()
+    {
+        for (int i = 0; i < latencyHistogram.length(); i++)
+            latencyHistogram.set(i, 0);
+        latencyMaxNanos.set(0);
+        cycles = 0;
+        deadlineMisses = 0;
+        mixNanosSum = 0;
+        mixNanosMax = 0;
+        for (SyntheticParticipant participant : participants)
+        {
+            participant.packetsSent.set(0);
+            participant.packetsReceivedByServer.set(0);
+            participant.framesDropped.set(0);
+            participant.mixPacketsSent.set(0);
+            participant.mixPacketsReceived.set(0);
+        }
+    }
+
+    private void runClock()
+    {
+        long deadline = System.nanoTime();
+
+        while (running)
+        {
+            deadline += periodNanos;
+
+            long start = System.nanoTime();
+
+            clock.push(silence, silence.length, Buffer.TIME_UNKNOWN);
+
+            long end = System.nanoTime();
+            long mixNanos = end - start;
+
+            synchronized (this)
+            {
+                cycles++;
+                if (end > deadline)
+                    deadlineMisses++;
+                mixNanosSum += mixNanos;
+                if (mixNanosMax < mixNanos)
+                    mixNanosMax = mixNanos;
+            }
+
+            if (end > deadline + 4 * periodNanos)
+            {
+                // Do not try to catch up with a backlog it cannot clear.
+                deadline = end;
+            }
+            else
+            {
+                LockSupport.parkNanos(deadline - end);
+            }
+        }
+    }
+
+    private void runSender()
+    {
+        long deadline = System.nanoTime();
+
+        while (running)
+        {
+            for (SyntheticParticipant participant : participants)
+                participant.sendFrame();
+
+            deadline += periodNanos;
+
+            long now = System.nanoTime();
+
+            if (now > deadline + 4 * periodNanos)
+                deadline = now;
+            else
+                LockSupport.parkNanos(deadline - now);
+        }
+    }
+
+    /**
+     * Starts the participants, the mixing and the sending.
+     *
+     * @throws IOException if the mixing could not be started
+     */
+    public void start()
+        throws IOException
+    {
+        running = true;
+        for (SyntheticParticipant participant : participants)
+            participant.start();
+
+        clockThread = new Thread(this::runClock, "loadgen-mixer");
+        senderThread = new Thread(this::runSender, "loadgen-sender");
+        clockThread.setDaemon(true);
+        senderThread.setDaemon(true);
+        clockThread.setPriority(Thread.MAX_PRIORITY);
+        clockThread.start();
+        senderThread.start();
+    }
+
+    /**
+     * Stops the conference and releases its participants.
+     */
+    public void stop()
+    {
+        running = false;
+        try
+        {
+            if (senderThread != null)
+                senderThread.join();
+            if (clockThread != null)
+                clockThread.join();
+        }
+        catch (InterruptedException ie)
+        {
+            Thread.currentThread().interrupt();
+        }
+        for (SyntheticParticipant participant : participants)
+            participant.stop();
+    }
+
+    /**
+     * Gets the latency below which a specific fraction of the recorded
+     * latencies lie.
+     *
+     * @param fraction the fraction, between 0 and 1
+     * @return the latency in milliseconds, or <tt>-1</tt> if none was recorded
+     */
+    public long getLatencyPercentileMillis(double fraction)
+    {
+        long count = 0;
+
+        for (int i = 0; i < latencyHistogram.length(); i++)
+            count += latencyHistogram.get(i);
+        if (count == 0)
+            return -1;
+
+        long rank = (long) Math.ceil(fraction * count);
+        long seen = 0;
+
+        for (int i = 0; i < latencyHistogram.length(); i++)
+        {
+            seen += latencyHistogram.get(i);
+            if (seen >= rank)
+                return i + 1;
+        }
+        return LATENCY_BUCKETS;
+    }
+
+    /**
+     * Gets the largest recorded latency.
+     *
+     * @return the largest latency in milliseconds
+     */
+    public double getLatencyMaxMillis()
+    {
+        return latencyMaxNanos.get() / 1000000.0;
+    }
+
+    public synchronized long getCycles()
+    {
+        return cycles;
+    }
+
+    public synchronized long getDeadlineMisses()
+    {
+        return deadlineMisses;
+    }
+
+    public synchronized double getMixAverageMillis()
+    {
+        return (cycles == 0) ? 0 : (mixNanosSum / (double) cycles) / 1000000.0;
+    }
+
+    public synchronized double getMixMaxMillis()
+    {
+        return mixNanosMax / 1000000.0;
+    }
+
+    /**
+     * Gets the sums of the packet counters of the participants.
+     *
+     * @return the packets sent by the clients, received by the server, the
+     * frames dropped by the server, the mixes sent by the server and received
+     * by the clients
+     */
+    public long[] getPacketCounts()
+    {
+        long[] counts = new long[5];
+
+        for (SyntheticParticipant participant : participants)
+        {
+            counts[0] += participant.packetsSent.get();
+            counts[1] += participant.packetsReceivedByServer.get();
+            counts[2] += participant.framesDropped.get();
+            counts[3] += participant.mixPacketsSent.get();
+            counts[4] += participant.mixPacketsReceived.get();
+        }
+        if (logger.isDebugEnabled())
+            logger.debug("Packet counts " + Arrays.toString(counts));
+        return counts;
+    }
+}
@@ -0,0 +1,496 @@
+/*
+ * Jitsi, the OpenSource Java VoIP and Instant Messaging client.
+ *
+ * Distributable under LGPL license.
+ * See terms of license at gnu.org.
+ */
+// Portions (c) Microsoft Corporation. All rights reserved.
+package org.jitsi.impl.neomedia.conference.loadgen;
+
+import java.io.*;
+import java.net.*;
+import java.util.concurrent.atomic.*;
+
+import javax.media.*;
+import javax.media.protocol.*;
+
+import org.jitsi.impl.neomedia.conference.*;
+import org.jitsi.util.*;
+
+/**
+ * A participant of a {@link SyntheticConference}. Its client side sends a
+ * tone encoded with the codec of the conference in RTP over loopback and
+ * receives the mix it is sent back. Its server side receives and decodes the
+ * RTP into the <tt>AudioMixer</tt> of the conference, and encodes and sends
+ * the mix of the other participants.
+ * <p>
+ * The times the frames were sent are shared with the server side in memory,
+ * rather than carried in the packets, so that the payloads remain exactly
+ * what the codec produced.
+ * </p>
+ */
+public class SyntheticParticipant
+    implements BufferTransferHandler
+{
+    /**
+     * The <tt>Logger</tt> used by the <tt>SyntheticParticipant</tt> class and
+     * its instances for logging output.
+     */
+    private static final Logger logger
+        = Logger.getLogger(SyntheticParticipant.class);
+
+    private static final int RTP_HEADER_LENGTH = 12;
+
+    private static final int MAX_PACKET_LENGTH = 1500;
+
+    /**
+     * The amplitude of the tone sent by a participant, about -20 dBFS.
+     */
+    private static final double TONE_AMPLITUDE = 3276;
+
+    private final SyntheticConference conference;
+
+    private final int index;
+
+    /* Client side */
+
+    private final DatagramSocket clientSocket;
+
+    private final SyntheticCodec.Channel clientEncoder;
+
+    private final SyntheticCodec.Channel clientDecoder;
+
+    private final byte[] clientPcm;
+
+    private final byte[] clientPacket = new byte[MAX_PACKET_LENGTH];
+
+    private final byte[] clientPayload
+        = new byte[MAX_PACKET_LENGTH - RTP_HEADER_LENGTH];
+
+    private final double toneStep;
+
+    private long tonePhase;
+
+    private int clientSequenceNumber;
+
+    private long clientTimestamp;
+
+    /**
+     * The times in <tt>System.nanoTime()</tt> the packets were sent by the
+     * client side, indexed by their RTP sequence numbers.
+     */
+    private final long[] sendNanos = new long[0x10000];
+
+    /* Server side */
+
+    private final DatagramSocket serverSocket;
+
+    private final SyntheticCodec.Channel serverDecoder;
+
+    private final SyntheticCodec.Channel serverEncoder;
+
+    private final SyntheticAudioDataSource inDataSource;
+
+    private final AudioMixingPushBufferDataSource outDataSource;
+
+    private final Buffer mixBuffer = new Buffer();
+
+    private final byte[] serverPacket = new byte[MAX_PACKET_LENGTH];
+
+    private final byte[] serverPayload
+        = new byte[MAX_PACKET_LENGTH - RTP_HEADER_LENGTH];
+
+    private int serverSequenceNumber;
+
+    private long serverTimestamp;
+
+    /**
+     * The times in <tt>System.nanoTime()</tt> the oldest frame in each mix
+     * was sent by a client, indexed by the RTP sequence numbers of the mix.
+     */
+    private final long[] mixOriginNanos = new long[0x10000];
+
+    private final Thread clientReceiveThread;
+
+    private final Thread serverReceiveThread;
+
+    private volatile boolean running;
+
+    /* Statistics */
+
+    final AtomicLong packetsSent = new AtomicLong();
+
+    final AtomicLong packetsReceivedByServer = new AtomicLong();
+
+    final AtomicLong framesDropped = new AtomicLong();
+
+    final AtomicLong mixPacketsSent = new AtomicLong();
+
+    final AtomicLong mixPacketsReceived = new AtomicLong();
+
+    /**
+     * Initializes a new <tt>SyntheticParticipant</tt> and adds it to the
+     * <tt>AudioMixer</tt> of a specific conference.
+     *
+     * @param conference the conference to join
+     * @param index the index of the participant in the conference
+     * @throws IOException if the sockets or codecs could not be opened
+     */
+    SyntheticParticipant(SyntheticConference conference, int index)
+        throws IOException
+    {
+        this.conference = conference;
+        this.index = index;
+
+        SyntheticCodec codec = conference.codec;
+        InetAddress loopback = InetAddress.getLoopbackAddress();
+
+        try
+        {
+            clientEncoder = codec.openEncoder();
+            clientDecoder = codec.openDecoder();
+            serverDecoder = codec.openDecoder();
+            serverEncoder = codec.openEncoder();
+        }
+        catch (ResourceUnavailableException rue)
+        {
+            throw new IOException(rue);
+        }
+        clientSocket = new DatagramSocket(0, loopback);
+        serverSocket = new DatagramSocket(0, loopback);
+        clientSocket.setSoTimeout(500);
+        serverSocket.setSoTimeout(500);
+
+        clientPcm = new byte[conference.frameSamples * 2];
+        // A distinct tone per participant so that the mixes are not silent.
+        toneStep = 2 * Math.PI * (200 + 37 * (index % 40)) / codec.sampleRate;
+
+        inDataSource = new SyntheticAudioDataSource(codec.getPcmFormat());
+        outDataSource = conference.audioMixer.createOutDataSource();
+        outDataSource.addInDataSource(inDataSource);
+
+        clientReceiveThread
+            = new Thread(this::runClientReceive, "loadgen-client-" + index);
+        serverReceiveThread
+            = new Thread(this::runServerReceive, "loadgen-server-" + index);
+        clientReceiveThread.setDaemon(true);
+        serverReceiveThread.setDaemon(true);
+    }
+
+    /**
+     * Writes the RTP header of a packet.
+     */
+    private static void writeRtpHeader(
+            byte[] packet,
+            int payloadType,
+            int sequenceNumber,
+            long timestamp,
+            int ssrc)
+    {
+        packet[0] = (byte) 0x80;
+        packet[1] = (byte) (payloadType & 0x7F);
+        packet[2] = (byte) (sequenceNumber >> 8);
+        packet[3] = (byte) sequenceNumber;
+        packet[4] = (byte) (timestamp >> 24);
+        packet[5] = (byte) (timestamp >> 16);
+        packet[6] = (byte) (timestamp >> 8);
+        packet[7] = (byte) timestamp;
+        packet[8] = (byte) (ssrc >> 24);
+        packet[9] = (byte) (ssrc >> 16);
+        packet[10] = (byte) (ssrc >> 8);
+        packet[11] = (byte) ssrc;
+    }
+
+    private static int readSequenceNumber(byte[] packet)
+    {
+        return ((packet[2] & 0xFF) << 8) | (packet[3] & 0xFF);
+    }
+
+    /**
+     * Gets the id of the thread which receives and decodes on the server
+     * side of this participant. The encoding of its mix runs on the mixing
+     * thread of the conference.
+     *
+     * @return the id of the server receive thread of this participant
+     */
+    long getServerThreadId()
+    {
+        return serverReceiveThread.getId();
+    }
+
+    /**
+     * Receives the mix on the client side and records its latency.
+     */
+    private void runClientReceive()
+    {
+        byte[] buf = new byte[MAX_PACKET_LENGTH];
+        byte[] pcm = new byte[clientPcm.length * 4];
+        DatagramPacket packet = new DatagramPacket(buf, buf.length);
+
+        while (running)
+        {
+            try
+            {
+                clientSocket.receive(packet);
+            }
+            catch (SocketTimeoutException ste)
+            {
+                continue;
+            }
+            catch (IOException ioe)
+            {
+                if (running)
+                    logger.warn("Client " + index + " failed to receive", ioe);
+                break;
+            }
+
+            int length = packet.getLength();
+
+            if (length <= RTP_HEADER_LENGTH)
+                continue;
+
+            int sequenceNumber = readSequenceNumber(buf);
+            long originNanos = mixOriginNanos[sequenceNumber];
+            byte[] payload = new byte[length - RTP_HEADER_LENGTH];
+
+            System.arraycopy(buf, RTP_HEADER_LENGTH, payload, 0, payload.length);
+            clientDecoder.process(payload, payload.length, sequenceNumber, pcm);
+            mixPacketsReceived.incrementAndGet();
+            if (originNanos != 0)
+                conference.recordLatency(System.nanoTime() - originNanos);
+        }
+    }
+
+    /**
+     * Receives and decodes the RTP of the client on the server side.
+     */
+    private void runServerReceive()
+    {
+        byte[] buf = new byte[MAX_PACKET_LENGTH];
+        byte[] pcm = new byte[clientPcm.length * 4];
+        DatagramPacket packet = new DatagramPacket(buf, buf.length);
+
+        while (running)
+        {
+            try
+            {
+                serverSocket.receive(packet);
+            }
+            catch (SocketTimeoutException ste)
+            {
+                continue;
+            }
+            catch (IOException ioe)
+            {
+                if (running)
+                    logger.warn("Server " + index + " failed to receive", ioe);
+                break;
+            }
+
+            int length = packet.getLength();
+
+            if (length <= RTP_HEADER_LENGTH)
+                continue;
+
+            int sequenceNumber = readSequenceNumber(buf);
+            byte[] payload = new byte[length - RTP_HEADER_LENGTH];
+
+            System.arraycopy(buf, RTP_HEADER_LENGTH, payload, 0, payload.length);
+            packetsReceivedByServer.incrementAndGet();
+
+            int pcmLength
+                = serverDecoder.process(
+                        payload, payload.length,
+                        sequenceNumber,
+                        pcm);
+
+            if ((pcmLength > 0)
+                    && !inDataSource.push(
+                            pcm, pcmLength,
+                            sendNanos[sequenceNumber]))
+            {
+                framesDropped.incrementAndGet();
+            }
+        }
+    }
+
+    /**
+     * Encodes and sends the next frame of the tone of the client side.
+     * Called by the sending thread of the conference every period.
+     */
+    void sendFrame()
+    {
+        int samples = conference.frameSamples;
+
+        for (int i = 0; i < samples; i++)
+        {
+            int sample
+                = (int) (TONE_AMPLITUDE * Math.sin(toneStep * tonePhase++));
+
+            clientPcm[2 * i] = (byte) sample;
+            clientPcm[2 * i + 1] = (byte) (sample >> 8);
+        }
+
+        int payloadLength
+            = clientEncoder.process(
+                    clientPcm, clientPcm.length,
+                    clientSequenceNumber,
+                    clientPayload);
+
+        clientTimestamp
+            += (long) samples * conference.codec.clockRate
+                / conference.codec.sampleRate;
+        if (payloadLength <= 0)
+            return;
+
+        writeRtpHeader(
+                clientPacket,
+                conference.codec.payloadType,
+                clientSequenceNumber,
+                clientTimestamp,
+                0x1000 + index);
+        System.arraycopy(
+                clientPayload, 0,
+                clientPacket, RTP_HEADER_LENGTH,
+                payloadLength);
+        sendNanos[clientSequenceNumber] = System.nanoTime();
+        try
+        {
+            clientSocket.send(
+                    new DatagramPacket(
+                            clientPacket,
+                            RTP_HEADER_LENGTH + payloadLength,
+                            serverSocket.getLocalSocketAddress()));
+            packetsSent.incrementAndGet();
+        }
+        catch (IOException ioe)
+        {
+            logger.warn("Client " + index + " failed to send", ioe);
+        }
+        clientSequenceNumber = (clientSequenceNumber + 1) & 0xFFFF;
+    }
+
+    /**
+     * Starts the threads of this participant and the reading of its mix.
+     *
+     * @throws IOException if the mix could not be started
+     */
+    void start()
+        throws IOException
+    {
+        running = true;
+        outDataSource.connect();
+        outDataSource.getStreams()[0].setTransferHandler(this);
+        outDataSource.start();
+        clientReceiveThread.start();
+        serverReceiveThread.start();
+    }
+
+    /**
+     * Stops this participant and releases its sockets and codecs.
+     */
+    void stop()
+    {
+        running = false;
+        try
+        {
+            outDataSource.stop();
+        }
+        catch (IOException ioe)
+        {
+            logger.warn("Failed to stop mix of participant " + index, ioe);
+        }
+        outDataSource.disconnect();
+        clientSocket.close();
+        serverSocket.close();
+        try
+        {
+            clientReceiveThread.join();
+            serverReceiveThread.join();
+        }
+        catch (InterruptedException ie)
+        {
+            Thread.currentThread().interrupt();
+        }
+        clientEncoder.close();
+        clientDecoder.close();
+        serverDecoder.close();
+        serverEncoder.close();
+    }
+
+    /**
+     * Reads, encodes and sends the mix of the other participants when the
+     * <tt>AudioMixer</tt> has produced it. Runs on the mixing thread of the
+     * conference.
+     */
+    @Override
+    public void transferData(PushBufferStream stream)
+    {
+        mixBuffer.setLength(0);
+        mixBuffer.setTimeStamp(Buffer.TIME_UNKNOWN);
+        try
+        {
+            stream.read(mixBuffer);
+        }
+        catch (IOException ioe)
+        {
+            logger.warn("Failed to read mix of participant " + index, ioe);
+            return;
+        }
+        if (mixBuffer.isDiscard() || (mixBuffer.getLength() <= 0))
+            return;
+
+        byte[] mix = (byte[]) mixBuffer.getData();
+        int offset = mixBuffer.getOffset();
+        int mixLength = mixBuffer.getLength();
+
+        if (offset != 0)
+        {
+            byte[] copy = new byte[mixLength];
+
+            System.arraycopy(mix, offset, copy, 0, mixLength);
+            mix = copy;
+        }
+
+        int payloadLength
+            = serverEncoder.process(
+                    mix, mixLength,
+                    serverSequenceNumber,
+                    serverPayload);
+
+        serverTimestamp
+            += (long) (mixLength / 2) * conference.codec.clockRate
+                / conference.codec.sampleRate;
+        if (payloadLength <= 0)
+            return;
+
+        long timeStamp = mixBuffer.getTimeStamp();
+
+        writeRtpHeader(
+                serverPacket,
+                conference.codec.payloadType,
+                serverSequenceNumber,
+                serverTimestamp,
+                0x2000 + index);
+        System.arraycopy(
+                serverPayload, 0,
+                serverPacket, RTP_HEADER_LENGTH,
+                payloadLength);
+        mixOriginNanos[serverSequenceNumber]
+            = (timeStamp == Buffer.TIME_UNKNOWN) ? 0 : timeStamp;
+        try
+        {
+            serverSocket.send(
+                    new DatagramPacket(
+                            serverPacket,
+                            RTP_HEADER_LENGTH + payloadLength,
+                            clientSocket.getLocalSocketAddress()));
+            mixPacketsSent.incrementAndGet();
+        }
+        catch (IOException ioe)
+        {
+            logger.warn("Server " + index + " failed to send", ioe);
+        }
+        serverSequenceNumber = (serverSequenceNumber + 1) & 0xFFFF;
+    }
+}